@@ -0,0 +1,101 @@
+/*
+* @class ActiveIndexList
+*
+* @brief Declaration of ActiveIndexList class
+*
+*/
+
+#ifndef RoomAcoustiCpp_ActiveIndexList_h
+#define RoomAcoustiCpp_ActiveIndexList_h
+
+// C++ headers
+#include <vector>
+#include <memory>
+#include <atomic>
+
+// Common headers
+#include "Common/ReleasePool.h"
+
+namespace RAC
+{
+	namespace Common
+	{
+		/**
+		* @brief Class that tracks the active slots of a fixed size array of voices as a dense, sorted list of indices
+		*
+		* @details Add, Remove and Publish are called by the threads that initialise and reset voices, and must be synchronised by the caller.
+		* Changes are only visible to Get after Publish. Get can be called from the audio thread at any time and does not lock or allocate
+		*/
+		class ActiveIndexList
+		{
+		public:
+			/**
+			* @brief Constructor that initialises an empty list
+			*
+			* @param capacity The number of slots
+			*/
+			ActiveIndexList(size_t capacity);
+
+			/**
+			* @brief Default destructor
+			*/
+			~ActiveIndexList() {}
+
+			/**
+			* @brief Marks a slot as active
+			*/
+			inline void Add(size_t index)
+			{
+				if (isActive[index])
+					return;
+				isActive[index] = true;
+				numActive++;
+				isChanged = true;
+			}
+
+			/**
+			* @brief Marks a slot as inactive
+			*/
+			inline void Remove(size_t index)
+			{
+				if (!isActive[index])
+					return;
+				isActive[index] = false;
+				numActive--;
+				isChanged = true;
+			}
+
+			/**
+			* @brief Publishes the active slots if they have changed since the last call
+			*/
+			void Publish();
+
+			/**
+			* @return The indices of the active slots at the last Publish, in ascending order
+			*/
+			inline std::shared_ptr<const std::vector<int>> Get() const
+			{
+#ifdef __ANDROID__
+				return std::atomic_load(&activeIndices);
+#else
+				return activeIndices.load(std::memory_order_acquire);
+#endif
+			}
+
+		private:
+			std::vector<bool> isActive;		// True for each active slot
+			size_t numActive;				// Number of active slots
+			bool isChanged;					// True if a slot has been added or removed since the last Publish
+
+#ifdef __ANDROID__
+			std::shared_ptr<const std::vector<int>> activeIndices;				// Published indices of the active slots
+#else
+			std::atomic<std::shared_ptr<const std::vector<int>>> activeIndices;	// Published indices of the active slots
+#endif
+
+			static ReleasePool releasePool;		// Garbage collector for shared pointers after atomic replacement
+		};
+	}
+}
+
+#endif // RoomAcoustiCpp_ActiveIndexList_h
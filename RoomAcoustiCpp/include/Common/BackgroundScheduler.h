@@ -0,0 +1,192 @@
+/**
+* @class BackgroundScheduler
+*
+* @brief Declaration of BackgroundScheduler class
+*
+* @details Wakes background worker threads when their inputs change instead of polling on a fixed interval
+*/
+
+#ifndef RoomAcoustiCpp_BackgroundScheduler_h
+#define RoomAcoustiCpp_BackgroundScheduler_h
+
+// C++ headers
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+// Common headers
+#include "Common/Debug.h"
+
+namespace RAC
+{
+	namespace Common
+	{
+		/**
+		* @brief Class that schedules the runs of long lived background tasks
+		*
+		* @details Each task is run by its own worker thread, which blocks in WaitForWork until the task is due.
+		* Producers call Notify when an input of the task changes. Notifications received before the task runs are
+		* coalesced into a single run. A task never runs more often than its minimum interval and, if it has a maximum
+		* interval, is run at least that often even if no notifications are received.
+		*/
+		class BackgroundScheduler
+		{
+		public:
+			using Clock = std::chrono::steady_clock;
+
+			/**
+			* @brief Default constructor
+			*/
+			BackgroundScheduler() : stop(false) {}
+
+			/**
+			* @brief Stops the scheduler on destruction
+			*/
+			~BackgroundScheduler() { Stop(); }
+
+			/**
+			* @brief Registers a new task. The task is pending so it runs as soon as a worker waits for it.
+			*
+			* @param minInterval The minimum time between the start of two runs
+			* @param maxInterval The maximum time between the start of two runs. Zero to only run when notified
+			* @return The ID of the new task
+			*/
+			inline size_t AddTask(const Clock::duration minInterval, const Clock::duration maxInterval)
+			{
+				RAC_DEBUG_ASSERT(maxInterval == Clock::duration::zero() || maxInterval >= minInterval, "Maximum interval is less than minimum interval");
+
+				std::lock_guard<std::mutex> lock(mutex);
+				tasks.push_back(Task{ minInterval, maxInterval });
+				return tasks.size() - 1;
+			}
+
+			/**
+			* @brief Requests a run of a task
+			*
+			* @param id The ID of the task
+			*/
+			inline void Notify(const size_t id)
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					RAC_DEBUG_ASSERT(id < tasks.size(), "Invalid task ID");
+					tasks[id].pending = true;
+				}
+				condition.notify_all();
+			}
+
+			/**
+			* @brief Blocks the calling worker until a task is due or the scheduler is stopped
+			*
+			* @param id The ID of the task
+			* @return True if the task should be run, false if the scheduler has stopped
+			*/
+			inline bool WaitForWork(const size_t id)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				RAC_DEBUG_ASSERT(id < tasks.size(), "Invalid task ID");
+				while (!stop)
+				{
+					// Tasks are only accessed by index as the vector may grow while waiting
+					Task& task = tasks[id];
+					const bool periodic = task.maxInterval != Clock::duration::zero();
+					if (!task.pending && !periodic)
+					{
+						condition.wait(lock);
+						continue;
+					}
+
+					const Clock::time_point due = task.lastRun + (task.pending ? task.minInterval : task.maxInterval);
+					const Clock::time_point now = Clock::now();
+					if (now >= due)
+					{
+						task.pending = false;
+						task.lastRun = now;
+						++task.started;
+						return true;
+					}
+					condition.wait_until(lock, due);
+				}
+				return false;
+			}
+
+			/**
+			* @brief Marks the current run of a task as complete
+			*
+			* @param id The ID of the task
+			*/
+			inline void Finish(const size_t id)
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					RAC_DEBUG_ASSERT(id < tasks.size(), "Invalid task ID");
+					++tasks[id].completed;
+				}
+				condition.notify_all();
+			}
+
+			/**
+			* @brief Requests a run of a task and blocks until a run that started after this call has completed
+			*
+			* @param id The ID of the task
+			* @return True if the run completed, false if the scheduler was stopped first
+			*/
+			inline bool WaitForRun(const size_t id)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				RAC_DEBUG_ASSERT(id < tasks.size(), "Invalid task ID");
+
+				// Runs of a task are sequential, so the next run to start is the one after any run in progress
+				const uint64_t target = tasks[id].started + 1;
+				tasks[id].pending = true;
+				condition.notify_all();
+				condition.wait(lock, [this, id, target] { return stop || tasks[id].completed >= target; });
+				return tasks[id].completed >= target;
+			}
+
+			/**
+			* @brief Wakes all waiting threads and causes WaitForWork to return false
+			*/
+			inline void Stop()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					stop = true;
+				}
+				condition.notify_all();
+			}
+
+			/**
+			* @return True if the scheduler has been stopped, false otherwise
+			*/
+			inline bool IsStopped()
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				return stop;
+			}
+
+		private:
+			/**
+			* @brief Struct that stores the scheduling state of a task
+			*/
+			struct Task
+			{
+				Clock::duration minInterval;		// Minimum time between the start of two runs
+				Clock::duration maxInterval;		// Maximum time between the start of two runs (zero if not periodic)
+				Clock::time_point lastRun{};		// Start time of the last run
+				bool pending{ true };				// True if a run has been requested since the last run started
+				uint64_t started{ 0 };				// Number of runs started
+				uint64_t completed{ 0 };			// Number of runs completed
+			};
+
+			std::vector<Task> tasks;				// Registered tasks (mutex must be locked to access)
+			bool stop;								// True if the scheduler has been stopped
+			std::mutex mutex;						// Protects tasks and stop
+			std::condition_variable condition;		// Signalled when a task is notified, completes or the scheduler is stopped
+		};
+	}
+}
+
+#endif
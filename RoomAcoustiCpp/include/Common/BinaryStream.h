@@ -0,0 +1,71 @@
+/**
+* @brief Functions to read and write values in a binary stream
+*
+* @details Values are written in the native byte order, so files are only portable between machines of the same endianness.
+*/
+
+#ifndef RoomAcoustiCpp_BinaryStream_h
+#define RoomAcoustiCpp_BinaryStream_h
+
+// C++ headers
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+// Common headers
+#include "Common/Types.h"
+#include "Common/Vec3.h"
+
+namespace RAC
+{
+	namespace Common
+	{
+		/**
+		* @brief Writes a value to a binary stream
+		*
+		* @param stream The stream to write to
+		* @param value The value to write
+		*/
+		template <typename T>
+		inline void WriteBinary(std::ostream& stream, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "WriteBinary requires a trivially copyable type");
+			stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		/**
+		* @brief Reads a value from a binary stream
+		*
+		* @param stream The stream to read from
+		* @param value Stores the value read
+		* @return True if the value was read, false otherwise
+		*/
+		template <typename T>
+		inline bool ReadBinary(std::istream& stream, T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "ReadBinary requires a trivially copyable type");
+			stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+			return stream.good();
+		}
+
+		/**
+		* @brief Writes a Vec3 to a binary stream
+		*/
+		inline void WriteBinary(std::ostream& stream, const Vec3& value)
+		{
+			WriteBinary(stream, value.x());
+			WriteBinary(stream, value.y());
+			WriteBinary(stream, value.z());
+		}
+
+		/**
+		* @brief Reads a Vec3 from a binary stream
+		*/
+		inline bool ReadBinary(std::istream& stream, Vec3& value)
+		{
+			return ReadBinary(stream, value.x()) && ReadBinary(stream, value.y()) && ReadBinary(stream, value.z());
+		}
+	}
+}
+
+#endif
@@ -50,6 +50,8 @@ namespace RAC
 		
 		const constexpr size_t MAX_IMAGESOURCES = 1024;		// Maximum number of image sources
 		const constexpr size_t MAX_SOURCES = 128;			// Maximum number of sources
+		const constexpr int INLINE_IMAGE_SOURCE_ORDER = 10;	// Number of reflections and diffractions stored inline in an image source path (longer paths are stored on the heap)
+		const constexpr int MAX_CACHED_IMAGE_SOURCE_ORDER = 255;	// Maximum image source order accepted when reading an image source cache file
 
 		const constexpr int MIN_FDNSIZE = 6;				// Minimum number of FDN channels
 		const constexpr int MAX_FDNSIZE = 32;				// Maximum number of FDN channels
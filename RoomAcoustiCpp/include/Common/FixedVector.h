@@ -0,0 +1,138 @@
+/**
+* @class FixedVector
+*
+* @brief Declaration of FixedVector class
+*
+* @details Vector with inline storage of a fixed capacity, so copies and growth only allocate beyond that capacity
+*/
+
+#ifndef RoomAcoustiCpp_FixedVector_h
+#define RoomAcoustiCpp_FixedVector_h
+
+// C++ headers
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+// Common headers
+#include "Common/Debug.h"
+
+namespace RAC
+{
+	namespace Common
+	{
+		/**
+		* @brief Class that stores up to Capacity elements inline
+		*
+		* @details Elements past the size are default constructed and kept, so T must be default constructible.
+		* Only the first size elements are copied. A vector that grows beyond Capacity moves all its elements to the heap
+		* until it is cleared. The heap storage is kept for reuse.
+		*/
+		template<typename T, size_t Capacity>
+		class FixedVector
+		{
+		public:
+			/**
+			* @brief Default constructor that initialises an empty vector
+			*/
+			FixedVector() : count(0) {}
+
+			/**
+			* @brief Constructor that initialises the vector with copies of a value
+			*
+			* @param size The number of elements
+			* @param value The value of the elements
+			*/
+			FixedVector(const size_t size, const T& value) : count(size)
+			{
+				if (OnHeap())
+					heap.assign(size, value);
+				else
+				{
+					for (size_t i = 0; i < count; ++i)
+						data[i] = value;
+				}
+			}
+
+			/**
+			* @brief Copy constructor that only copies the used elements
+			*/
+			FixedVector(const FixedVector& other) : count(0) { *this = other; }
+
+			/**
+			* @brief Copy assignment that only copies the used elements
+			*/
+			inline FixedVector& operator=(const FixedVector& other)
+			{
+				if (this == &other)
+					return *this;
+
+				count = other.count;
+				if (OnHeap())
+					heap.assign(other.heap.begin(), other.heap.end());
+				else
+				{
+					for (size_t i = 0; i < count; ++i)
+						data[i] = other.data[i];
+				}
+				return *this;
+			}
+
+			/**
+			* @brief Constructs an element at the end of the vector
+			*
+			* @param args The arguments to construct the element with
+			* @return A reference to the new element
+			*/
+			template<typename... Args>
+			inline T& emplace_back(Args&&... args)
+			{
+				if (count < Capacity)
+				{
+					data[count] = T(std::forward<Args>(args)...);
+					return data[count++];
+				}
+
+				// Constructed before the elements move in case args refers to one of them
+				T element(std::forward<Args>(args)...);
+				if (count == Capacity)
+					heap.assign(data.begin(), data.end());
+				++count;
+				return heap.emplace_back(std::move(element));
+			}
+
+			/**
+			* @brief Removes all elements. The storage is kept
+			*/
+			inline void clear() { count = 0; }
+
+			inline size_t size() const { return count; }
+			inline bool empty() const { return count == 0; }
+			static constexpr size_t capacity() { return Capacity; }
+
+			/**
+			* @return True if the elements are stored on the heap, false if they are stored inline
+			*/
+			inline bool OnHeap() const { return count > Capacity; }
+
+			inline T& operator[](const size_t i) { return begin()[i]; }
+			inline const T& operator[](const size_t i) const { return begin()[i]; }
+
+			inline T& back() { RAC_DEBUG_ASSERT(count > 0, "FixedVector is empty"); return begin()[count - 1]; }
+			inline const T& back() const { RAC_DEBUG_ASSERT(count > 0, "FixedVector is empty"); return begin()[count - 1]; }
+
+			inline T* begin() { return OnHeap() ? heap.data() : data.data(); }
+			inline const T* begin() const { return OnHeap() ? heap.data() : data.data(); }
+			inline T* end() { return begin() + count; }
+			inline const T* end() const { return begin() + count; }
+
+		private:
+			std::array<T, Capacity> data;	// Inline element storage
+			std::vector<T> heap;			// Element storage once the vector has grown beyond Capacity
+			size_t count;					// Number of elements in use
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,55 @@
+/**
+* @brief Functions to build FNV-1a hashes of values
+*
+* @details Used to identify room geometry and configurations independently of the order they were created in.
+* Hashes depend on the native byte order and floating point type.
+*/
+
+#ifndef RoomAcoustiCpp_Hash_h
+#define RoomAcoustiCpp_Hash_h
+
+// C++ headers
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Common headers
+#include "Common/Types.h"
+#include "Common/Vec3.h"
+
+namespace RAC
+{
+	namespace Common
+	{
+		constexpr uint64_t HASH_OFFSET_BASIS = 0xCBF29CE484222325ull;	// FNV-1a 64 bit offset basis (initial hash value)
+		constexpr uint64_t HASH_PRIME = 0x100000001B3ull;				// FNV-1a 64 bit prime
+
+		/**
+		* @brief Adds the bytes of a value to a hash
+		*
+		* @param hash The hash to update
+		* @param value The value to add
+		*/
+		template <typename T>
+		inline void HashValue(uint64_t& hash, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "HashValue requires a trivially copyable type");
+			unsigned char bytes[sizeof(T)];
+			std::memcpy(bytes, &value, sizeof(T));
+			for (const unsigned char byte : bytes)
+				hash = (hash ^ byte) * HASH_PRIME;
+		}
+
+		/**
+		* @brief Adds a Vec3 to a hash
+		*/
+		inline void HashValue(uint64_t& hash, const Vec3& value)
+		{
+			HashValue(hash, value.x());
+			HashValue(hash, value.y());
+			HashValue(hash, value.z());
+		}
+	}
+}
+
+#endif
@@ -96,6 +96,11 @@ public:
     */
     inline void Subtract() noexcept { counter.fetch_sub(1, std::memory_order_release); }
 
+    /**
+	* @brief Subtract count from the counter
+    */
+    inline void Subtract(int count) noexcept { counter.fetch_sub(count, std::memory_order_release); }
+
 private:
 	std::atomic<int> counter; // Number of tasks remaining to be processed
 };
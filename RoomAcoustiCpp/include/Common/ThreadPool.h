@@ -9,11 +9,14 @@
 
 // C++ headers
 #include <vector>
+#include <algorithm>
 #include <thread>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
+#include <atomic>
+#include <memory>
 
 // Unity headers
 #include "Unity/UnityInterface.h"
@@ -86,6 +89,59 @@ namespace RAC
                 condition.notify_one();
             }
 
+            /**
+            * @brief Runs task(i) for all i in [0, numTasks) using the calling thread and up to numHelpers pool threads
+            *
+            * @details The calling thread claims tasks alongside the helpers and only waits for tasks that have
+            * already been claimed, so this can be called from inside a pool task without deadlocking.
+            * Helpers that start after all tasks have been claimed return immediately.
+            *
+            * @param numTasks The number of tasks to run
+            * @param numHelpers The maximum number of pool threads to enlist
+            * @param task The task to run, taking the task index
+            */
+            inline void ParallelFor(size_t numTasks, size_t numHelpers, const std::function<void(size_t)>& task)
+            {
+                if (numTasks == 0)
+                    return;
+
+                // Shared so that late helpers can safely check for remaining tasks after this function returns
+                struct State
+                {
+                    std::atomic<size_t> next{ 0 };
+                    std::atomic<size_t> completed{ 0 };
+                    std::mutex mutex;
+                    std::condition_variable condition;
+                };
+                std::shared_ptr<State> state = std::make_shared<State>();
+
+                // fn is only dereferenced after claiming a task, which the calling thread waits for
+                auto runTasks = [state, numTasks](const std::function<void(size_t)>* fn)
+                    {
+                        size_t idx = state->next.fetch_add(1, std::memory_order_relaxed);
+                        while (idx < numTasks)
+                        {
+                            (*fn)(idx);
+                            if (state->completed.fetch_add(1, std::memory_order_acq_rel) + 1 == numTasks)
+                            {
+                                std::lock_guard<std::mutex> lock(state->mutex);
+                                state->condition.notify_all();
+                            }
+                            idx = state->next.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    };
+
+                const std::function<void(size_t)>* taskPtr = &task;
+                numHelpers = std::min(numHelpers, std::min(workers.size(), numTasks - 1));
+                for (size_t i = 0; i < numHelpers; ++i)
+                    Enqueue([runTasks, taskPtr]() { runTasks(taskPtr); });
+
+                runTasks(taskPtr);
+
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->condition.wait(lock, [&state, numTasks] { return state->completed.load(std::memory_order_acquire) == numTasks; });
+            }
+
         private:
             std::vector<std::thread> workers;           // Worker threads in the pool
             std::queue<std::function<void()>> tasks;    // Task queue for storing tasks to be executed
@@ -10,9 +10,11 @@
 
 // C++ headers
 #include <thread>
+#include <chrono>
 
 // DSP headers
 #include "DSP/Buffer.h"
+#include "DSP/TaskSchedule.h"
 
 // Spatialiser headers
 #include "Spatialiser/Source.h"
@@ -24,9 +26,7 @@
 #include "Common/Definitions.h"
 #include "Common/Matrix.h"
 #include "Common/SpinLock.h"
-
-// moodycamel headers
-#include "moodycamel/concurrentqueue.h"
+#include "Common/Debug.h"
 
 #ifdef _WIN32
 	// if set, it uses WaitForSingleObject() to wait for data to actually be available rather than polling. This doesn't seem to have a major impact
@@ -36,6 +36,11 @@
 #   define USE_BLOCKING_TASKS       (0)
 #endif
 
+// Time idle workers spin (yielding) before they park on std::atomic::wait (a futex on Linux) until the next batch. Not used if USE_BLOCKING_TASKS is set.
+// Workers keep spinning by default (the previous behaviour). Parking is opt in (ContextOptionalArguments::audioThreadSpinTime) until
+// the wake latency has been measured on multi-core machines with the AudioThreadWake profile test
+#define DEFAULT_AUDIO_THREAD_SPIN_TIME   (std::chrono::microseconds::max())
+
 #if USE_BLOCKING_TASKS
 #   define NOMINMAX
 #   define WIN32_LEAN_AND_MEAN
@@ -48,55 +53,65 @@ namespace RAC
     {
         /**
 		* @brief Class that implements a lock free thread pool for processing audio tasks
+        *
+        * @details Each batch is planned from the measured cost of every voice in previous audio blocks (see TaskSchedule).
+        * Every worker owns a range of chunks that it runs from the front, heaviest first. Idle workers steal chunks from the back of other ranges.
         */
         class AudioThreadPool
         {
             /**
-			* @brief Base struct for audio tasks
+			* @brief Task descriptor that processes one voice (Source, ImageSource, ReverbSource or FDN)
+            *
+            * @details Descriptors are plain data stored in a preallocated array and reused every audio block, so queueing a task does not allocate
             */
-            struct AudioTaskBase
+            struct AudioTask
             {
+                using RunFunction = void (*)(void* voice, Buffer<>& output, std::vector<Buffer<>>& reverbOutput, const AudioData& audioData);
+
+				RunFunction run;                // Processes the voice for its type
+				void* voice;                    // Pointer to the voice to process
+				const AudioData* audioData;     // Data relevant to audio processing (shared by all tasks of a batch)
+                Real* cost;                     // Estimated processing time of the voice in seconds, or 0 if unknown
+
                 /**
-				* @brief Pure virtual function to run the audio task
+				* @brief Runs the audio task
                 */
-                virtual void Run(Buffer<>& out, std::vector<Buffer<>>& reverbOutput) = 0;
+                inline void Run(Buffer<>& output, std::vector<Buffer<>>& reverbOutput) const { run(voice, output, reverbOutput, *audioData); }
 
                 /**
-				* @brief Default virtual destructor
+				* @brief Runs the audio task and updates the estimated cost of the voice
                 */
-                virtual ~AudioTaskBase() = default;
+                inline void RunTimed(Buffer<>& output, std::vector<Buffer<>>& reverbOutput) const
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    Run(output, reverbOutput);
+                    const Real time = std::chrono::duration<Real>(std::chrono::steady_clock::now() - start).count();
+
+                    // The first measurement replaces the unknown cost
+                    *cost = *cost > 0.0 ? *cost + COST_SMOOTHING * (time - *cost) : time;
+                }
             };
 
             /**
-			* @brief Template struct for audio tasks that can process different types of sources
+			* @brief Chunks of the current schedule owned by a worker, packed as [first, end) in one atomic so the owner and thieves claim chunks with one CAS
             */
-            template<typename T>
-            struct AudioTask : public AudioTaskBase
+            struct alignas(64) WorkerRange
             {
-				T* source;                  // Pointer to the audio source (Source, ImageSource or ReverbSource)
-				AudioData audioData;        // Data relevant to audio processing
-                SpinLock* tasksRemaining;   // Pointer to the spin lock for tracking remaining tasks
-
-                AudioTask(T* source = nullptr, SpinLock* tasksRemaining = nullptr, const AudioData& audioData = AudioData())
-                    : source(source), audioData(audioData), tasksRemaining(tasksRemaining) {}
-
-                void Run(Buffer<>& output, std::vector<Buffer<>>& reverbOutput) override
-                {
-                    if constexpr (std::is_same_v<T, FDN<Complex>>)
-                        source->ProcessAudio(reverbOutput, audioData);
-                    else // Source, ImageSource, ReverbSource
-                        source->ProcessAudio(output, audioData);
-                    tasksRemaining->Subtract();
-                }
-
-            private:
-                // General case
-                void ProcessAudio(Buffer<>& out, Matrix<>& reverb, std::false_type) { source->ProcessAudio(out, reverb, audioData); }
-
-                // Specialized case for ReverbSource
-                void ProcessAudio(Buffer<>& out, Matrix<>& reverb, std::true_type) { source->ProcessAudio(out); }
+                std::atomic<uint64_t> range{ 0 };
             };
 
+            /**
+			* @brief Processes a voice of type T
+            */
+            template<typename T>
+            static void RunVoice(void* voice, Buffer<>& output, std::vector<Buffer<>>& reverbOutput, const AudioData& audioData)
+            {
+                if constexpr (std::is_same_v<T, FDN<Complex>>)
+                    static_cast<T*>(voice)->ProcessAudio(reverbOutput, audioData);
+                else // Source, ImageSource, ReverbSource
+                    static_cast<T*>(voice)->ProcessAudio(output, audioData);
+            }
+
         public:
             /**
 			* @brief Constructor that initialises the audio thread pool with a given number of threads
@@ -106,8 +121,9 @@ namespace RAC
 			* @param numLateReverbChannels The number of channels for late reverb processing
             * @param numLateReverbSamples The number of samples per audio buffer for late reverb send
 			* @param numReverbSources The number of reverb sources
+			* @param spinTime Time idle workers spin before parking until the next batch. std::chrono::microseconds::max() never parks. Ignored if USE_BLOCKING_TASKS is set
             */
-            AudioThreadPool(size_t numThreads, const std::shared_ptr<DSPConfig>& dspConfig);
+            AudioThreadPool(size_t numThreads, const std::shared_ptr<DSPConfig>& dspConfig, std::chrono::microseconds spinTime = DEFAULT_AUDIO_THREAD_SPIN_TIME);
 
             /**
 			* @brief Default destructor that stops all threads
@@ -115,120 +131,114 @@ namespace RAC
             ~AudioThreadPool();
 
             /**
-			* @brief Adds an audio task to the queue
+			* @brief Stops all threads in the audio thread pool
+            */
+            void Stop();
+
+            /**
+			* @brief Processes sources and image sources
             * 
-			* @param source Pointer to the audio source object (Source, ImageSource)
-			* @param tasksRemaining Pointer to the spin lock for tracking remaining tasks
-            * @param audioData Data relevant to audio processing
+			* @param sources Sources to process
+			* @param activeSources Indices of the sources to process
+			* @param imageSources Image sources to process
+			* @param activeImageSources Indices of the image sources to process
+			* @param outputBuffer Output buffer to write to
+			* @param audioData Data relevant to audio processing
             */
-            template <typename T>
-            void Enqueue(T* source, SpinLock* tasksRemaining, const AudioData& audioData)
-            {
-                static_assert(std::is_member_function_pointer_v<decltype(&T::ProcessAudio)>, "T must have a ProcessAudio member function");
-                static_assert(std::is_same_v<decltype(&T::ProcessAudio), void (T::*)(Buffer<>&, const AudioData&)>, "T::ProcessAudio must be of type void (T::*)(Buffer<>&, const AudioData&)");
+            void ProcessAllSources(std::array<std::optional<Source>, MAX_SOURCES>& sources, const std::vector<int>& activeSources,
+                ImageSourceManager& imageSources, const std::vector<int>& activeImageSources, Buffer<>& outputBuffer, const AudioData& audioData);
 
-				std::shared_ptr<AudioTaskBase> task = std::make_shared<AudioTask<T>>(source, tasksRemaining, audioData);
+            /**
+			* @brief Processes reverb sources
+            * 
+			* @param reverbSources Reverb sources to process
+			* @param outputBuffer Output buffer to write to
+            * @param audioData Data relevant to audio processing
+            */
+            void ProcessReverbSources(std::vector<std::unique_ptr<ReverbSource>>& reverbSources, Buffer<>& outputBuffer, const AudioData& audioData);
 
-                if (workers.empty()) [[unlikely]]
-                {
-					// if we requested 0 worker threads, run it inline
-					task->Run(threadOutputBuffers[0], threadReverbOutputs[0]);
-                }
-                else 
-                {
-                    tasks.try_enqueue(std::move(task));
-#if USE_BLOCKING_TASKS
-                    SetEvent(tasksAvailable);
-#endif
-                }
-            }
+            void ProcessFDNs(std::vector<std::unique_ptr<FDN<Complex>>>& FDNs, std::vector<Buffer<>>& outputBuffers, const AudioData& audioData);
 
+        private:
             /**
-			* @brief Adds an audio task to the queue (specialized for ReverbSource)
+			* @brief Starts a new batch of tasks, reusing the task descriptors of the previous batch
             *
-            * @param source Pointer to the ReverbSource object
-            * @param tasksRemaining Pointer to the spin lock for tracking remaining tasks
-            * @param audioData Data relevant to audio processing
+			* @param maxNumTasks The maximum number of tasks that will be queued in the batch
             */
-            void Enqueue(ReverbSource* source, SpinLock* tasksRemaining, const AudioData& audioData)
-            {
-                static_assert(std::is_member_function_pointer_v<decltype(&ReverbSource::ProcessAudio)>, "T must have a ProcessAudio member function");
-                static_assert(std::is_same_v<decltype(&ReverbSource::ProcessAudio), void (ReverbSource::*)(Buffer<>&, const AudioData&)>, "ReverbSource::ProcessAudio must be of type void (ReverbSource::*)(Buffer<>&, const AudioData&)");
-                std::shared_ptr<AudioTaskBase> task = std::make_shared<AudioTask<ReverbSource>>(source, tasksRemaining, audioData);
-
-                if (workers.empty()) [[unlikely]]
-                {
-					// if we requested 0 worker threads, run it inline
-                    task->Run(threadOutputBuffers[0], threadReverbOutputs[0]);
-                }
-                else 
-                {
-                    tasks.try_enqueue(std::move(task));
-#if USE_BLOCKING_TASKS
-                    SetEvent(tasksAvailable);
-#endif
-                }
-            }
+            void BeginBatch(size_t maxNumTasks);
 
             /**
-            * @brief Adds an audio task to the queue (specialized for ReverbSource)
+			* @brief Adds an audio task to the batch, or runs it inline if there are no worker threads
             *
-            * @param fdn The FDN to computer
-            * @param tasksRemaining Pointer to the spin lock for tracking remaining tasks
-			* @param audioData Data relevant to audio processing
+			* @param voice Pointer to the voice to process (Source, ImageSource, ReverbSource or FDN)
+			* @param cost Estimated processing time of the voice, updated by the worker that runs it. Must remain valid until the batch has completed
+            * @param audioData Data relevant to audio processing. Must remain valid until the batch has completed
             */
-            void Enqueue(FDN<Complex>* fdn, SpinLock* tasksRemaining, const AudioData& audioData)
+            template <typename T>
+            void Enqueue(T* voice, Real& cost, const AudioData& audioData)
             {
-                //static_assert(std::is_member_function_pointer_v<decltype(&FDN<Complex>::ProcessAudio)>, "T must have a ProcessAudio member function");
-                //static_assert(std::is_same_v<decltype(&FDN<Complex>::ProcessAudio), void (FDN<Complex>::*)(std::vector<Buffer<>>&, Real)>, "T::ProcessAudio must be of type void (T::*)(Buffer&, Real)");
-                std::shared_ptr<AudioTaskBase> task = std::make_shared<AudioTask<FDN<Complex>>>(fdn, tasksRemaining, audioData);
+                if constexpr (!std::is_same_v<T, FDN<Complex>>)
+                    static_assert(std::is_same_v<decltype(&T::ProcessAudio), void (T::*)(Buffer<>&, const AudioData&)>, "T::ProcessAudio must be of type void (T::*)(Buffer<>&, const AudioData&)");
 
+                const AudioTask task{ &RunVoice<T>, voice, &audioData, &cost };
                 if (workers.empty()) [[unlikely]]
                 {
 					// if we requested 0 worker threads, run it inline
-					task->Run(threadOutputBuffers[0], threadReverbOutputs[0]);
-                }
-                else 
-                {
-                    tasks.try_enqueue(std::move(task));
-#if USE_BLOCKING_TASKS
-                    SetEvent(tasksAvailable);
-#endif
+                    task.Run(threadOutputBuffers[0], threadReverbOutputs[0]);
+                    return;
                 }
+
+                RAC_DEBUG_ASSERT(numBatchTasks < taskDescriptors.size(), "Too many audio tasks in batch: " + ToString(numBatchTasks));
+                taskCosts[numBatchTasks] = cost;
+                taskDescriptors[numBatchTasks++] = task;
             }
 
             /**
-			* @brief Stops all threads in the audio thread pool
+			* @brief Plans the tasks of the current batch, hands the chunks to the workers and waits until every task has run
             */
-            void Stop();
+            void RunBatch();
 
             /**
-			* @brief Processes sources and image sources
-            * 
-			* @param sources Sources to process
-			* @param imageSources Image sources to process
-			* @param outputBuffer Output buffer to write to
-			* @param reverbInput Reverb input matrix to write to
-			* @param audioData Data relevant to audio processing
+			* @brief Claims and runs one chunk of the current batch, from the worker's own range or else stolen from another worker
+            *
+			* @param worker Index of the calling worker thread
+            * @return True if a chunk was run, false if no chunks remain
             */
-            void ProcessAllSources(std::array<std::optional<Source>, MAX_SOURCES>& sources, ImageSourceManager& imageSources, Buffer<>& outputBuffer, const AudioData& audioData);
+            bool RunNextChunk(size_t worker);
 
             /**
-			* @brief Processes reverb sources
-            * 
-			* @param reverbSources Reverb sources to process
-			* @param outputBuffer Output buffer to write to
-            * @param audioData Data relevant to audio processing
+			* @brief Runs the tasks of a chunk and marks them as completed
             */
-            void ProcessReverbSources(std::vector<std::unique_ptr<ReverbSource>>& reverbSources, Buffer<>& outputBuffer, const AudioData& audioData);
+            void RunChunk(const TaskSchedule::Chunk& chunk, size_t worker);
 
-            void ProcessFDNs(std::vector<std::unique_ptr<FDN<Complex>>>& FDNs, std::vector<Buffer<>>& outputBuffers, const AudioData& audioData);
+#if !USE_BLOCKING_TASKS
+            /**
+			* @brief Spins for up to spinTime and then parks until a batch after lastBatch is published or the pool is stopped
+            *
+			* @param lastBatch Index of the last batch seen by the worker. Updated to the latest batch on return
+            */
+            void WaitForBatch(uint32_t& lastBatch);
+#endif
 
-        private:
-            moodycamel::ConcurrentQueue<std::shared_ptr<AudioTaskBase>> tasks;  // Lock-free queue
+            static constexpr Real COST_SMOOTHING = 0.25;    // Weight of the latest measurement in the estimated cost of a voice
+
+            std::vector<AudioTask> taskDescriptors;     // Task descriptors reused by every batch
+            std::vector<Real> taskCosts;                // Estimated cost of each task in the current batch
+            size_t numBatchTasks;                       // Number of tasks in the current batch
+            TaskSchedule schedule;                      // Chunks of the current batch and their workers
+            std::vector<WorkerRange> workerRanges;      // Unclaimed chunks of each worker
+            SpinLock* batchTasksRemaining;              // Tracks the remaining tasks of the current batch
+
+            std::vector<Real> sourceCosts;          // Estimated cost of each source, followed by each image source
+            std::vector<Real> reverbSourceCosts;    // Estimated cost of each reverb source
+            std::vector<Real> fdnCosts;             // Estimated cost of each FDN
 #if USE_BLOCKING_TASKS
             HANDLE tasksAvailable;
             HANDLE stopRequested;
+#else
+            std::atomic<uint32_t> batchIndex{ 0 };      // Incremented when a batch is published or the pool is stopped, and waited on by parked workers
+            std::atomic<int> numParkedWorkers{ 0 };     // Number of workers waiting on batchIndex, so the caller only wakes workers when needed
+            std::chrono::microseconds spinTime;         // Time idle workers spin before parking
 #endif
 
             std::vector<std::thread> workers;   // Worker threads
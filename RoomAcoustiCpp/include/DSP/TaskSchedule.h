@@ -0,0 +1,111 @@
+/*
+* @class TaskSchedule
+*
+* @brief Declaration of TaskSchedule class
+*
+*/
+
+#ifndef DSP_TaskSchedule_h
+#define DSP_TaskSchedule_h
+
+// C++ headers
+#include <vector>
+
+// Common headers
+#include "Common/Types.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace DSP
+	{
+		/**
+		* @brief Class that plans how a batch of audio tasks is split over worker threads, using estimated task costs
+		*
+		* @details Tasks that cost at least the target chunk cost are heavy: they run alone, most expensive first, so the longest tasks start early.
+		* The remaining cheap tasks are grouped in batch order into chunks of about the target cost, which reduces the scheduling overhead.
+		* Each chunk is assigned to the worker with the least assigned cost. A worker's chunks are stored contiguously (heaviest first),
+		* so idle workers can steal the cheap chunks from the end of another worker's range.
+		*/
+		class TaskSchedule
+		{
+		public:
+			/**
+			* @brief Range of consecutive entries of the task order
+			*/
+			struct Chunk
+			{
+				int first;	// First entry in Order()
+				int count;	// Number of tasks
+			};
+
+			/**
+			* @brief Constructor that allocates memory for a schedule
+			*
+			* @param numWorkers The number of workers to plan for
+			* @param maxNumTasks The maximum number of tasks in a batch
+			*/
+			TaskSchedule(size_t numWorkers, size_t maxNumTasks);
+
+			/**
+			* @brief Allocates memory for larger batches. Does nothing if maxNumTasks tasks already fit
+			*/
+			void Reserve(size_t maxNumTasks);
+
+			/**
+			* @brief Plans a batch of tasks. Does not allocate memory if numTasks does not exceed the reserved size
+			*
+			* @param costs Estimated cost of each task (only relative values matter). Costs <= 0 are unknown and replaced by the mean known cost
+			* @param numTasks The number of tasks in the batch
+			*/
+			void Plan(const std::vector<Real>& costs, int numTasks);
+
+			/**
+			* @return The number of workers
+			*/
+			inline int NumWorkers() const { return static_cast<int>(workerCosts.size()); }
+
+			/**
+			* @return The number of chunks in the latest plan
+			*/
+			inline int NumChunks() const { return numChunks; }
+
+			/**
+			* @return Task indices in the order they are grouped into chunks
+			*/
+			inline const std::vector<int>& Order() const { return order; }
+
+			/**
+			* @return The chunk at index i, where the chunks of worker w have indices WorkerBegin(w) to WorkerEnd(w) - 1
+			*/
+			inline const Chunk& GetChunk(int i) const { return chunks[i]; }
+
+			/**
+			* @return Index of the first chunk of a worker
+			*/
+			inline int WorkerBegin(int worker) const { return workerBegin[worker]; }
+
+			/**
+			* @return Index one past the last chunk of a worker
+			*/
+			inline int WorkerEnd(int worker) const { return workerBegin[worker + 1]; }
+
+			/**
+			* @return The estimated cost of the chunks assigned to a worker
+			*/
+			inline Real WorkerCost(int worker) const { return workerCosts[worker]; }
+
+		private:
+			std::vector<int> order;					// Task indices in chunk order
+			std::vector<Real> taskCosts;			// Estimated cost of each task, with unknown costs replaced
+			std::vector<Chunk> plannedChunks;		// Chunks in the order they are assigned
+			std::vector<int> chunkWorkers;			// Worker of each planned chunk
+			std::vector<Chunk> chunks;				// Chunks grouped by worker
+			std::vector<int> workerBegin;			// Index of the first chunk of each worker, followed by the number of chunks
+			std::vector<Real> workerCosts;			// Estimated cost assigned to each worker
+			int numChunks;							// Number of chunks in the latest plan
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,213 @@
+/*
+* @brief Declaration of the bounding volume hierarchy types shared by WallBVH, EdgeBVH and TriangleBVH
+*
+*/
+
+#ifndef RoomAcoustiCpp_BVHTypes_h
+#define RoomAcoustiCpp_BVHTypes_h
+
+// C++ headers
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+
+// Common headers
+#include "Common/Types.h"
+#include "Common/Vec3.h"
+#include "Common/Definitions.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		/**
+		* @brief Struct that stores an axis aligned bounding box
+		*/
+		struct AABB
+		{
+			std::array<Real, 3> min{ std::numeric_limits<Real>::max(), std::numeric_limits<Real>::max(), std::numeric_limits<Real>::max() };		// Minimum corner
+			std::array<Real, 3> max{ std::numeric_limits<Real>::lowest(), std::numeric_limits<Real>::lowest(), std::numeric_limits<Real>::lowest() };	// Maximum corner
+
+			/**
+			* @brief Expands the bounding box to include a point
+			*/
+			inline void Grow(const std::array<Real, 3>& p)
+			{
+				for (int i = 0; i < 3; ++i)
+				{
+					min[i] = std::min(min[i], p[i]);
+					max[i] = std::max(max[i], p[i]);
+				}
+			}
+
+			/**
+			* @brief Expands the bounding box to include a point
+			*/
+			inline void Grow(const Vec3& p) { Grow(std::array<Real, 3>{ p.x(), p.y(), p.z() }); }
+
+			/**
+			* @brief Expands the bounding box to include another bounding box
+			*/
+			inline void Grow(const AABB& box)
+			{
+				for (int i = 0; i < 3; ++i)
+				{
+					min[i] = std::min(min[i], box.min[i]);
+					max[i] = std::max(max[i], box.max[i]);
+				}
+			}
+
+			/**
+			* @return The axis along which the bounding box is largest
+			*/
+			inline int LargestAxis() const
+			{
+				int axis = 0;
+				for (int i = 1; i < 3; ++i)
+				{
+					if (max[i] - min[i] > max[axis] - min[axis])
+						axis = i;
+				}
+				return axis;
+			}
+
+			/**
+			* @return The squared distance from a point to the bounding box (0 if the point is inside)
+			*/
+			inline Real DistanceSquared(const std::array<Real, 3>& p) const
+			{
+				Real distanceSquared = 0.0;
+				for (int i = 0; i < 3; ++i)
+				{
+					const Real d = std::max(std::max(min[i] - p[i], p[i] - max[i]), REAL_CONST(0.0));
+					distanceSquared += d * d;
+				}
+				return distanceSquared;
+			}
+
+			/**
+			* @return Half the surface area of the bounding box
+			*/
+			inline Real HalfArea() const
+			{
+				if (min[0] > max[0])
+					return 0.0;
+				const Real x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+				return x * y + y * z + z * x;
+			}
+		};
+
+		/**
+		* @brief Struct that stores a flattened BVH node
+		*
+		* @details Interior nodes store their left child at the next index and their right child at rightChild.
+		* Leaf nodes store count > 0 primitives starting at firstPrimitive.
+		*/
+		struct BVHNode
+		{
+			AABB bounds;				// Bounding box of all primitives below the node
+			int firstPrimitive{ 0 };	// Index of the first primitive in leaf order (leaf only)
+			int count{ 0 };				// Number of primitives (0 for interior nodes)
+			int rightChild{ -1 };		// Index of the right child (interior only)
+		};
+
+		/**
+		* @brief Finds the range of primitives stored in the leaves below a node
+		*
+		* @details Leaves are stored in depth first order, so the primitives below a node are contiguous.
+		* Traversals fall back to visiting this range when their stack is full.
+		*
+		* @param nodes The flattened nodes
+		* @param node The index of the node
+		* @param first Stores the index of the first primitive
+		* @param last Stores the index one past the last primitive
+		*/
+		inline void SubtreePrimitives(const std::vector<BVHNode>& nodes, const int node, int& first, int& last)
+		{
+			int leftmost = node, rightmost = node;
+			while (nodes[leftmost].count == 0)
+				leftmost = leftmost + 1;
+			while (nodes[rightmost].count == 0)
+				rightmost = nodes[rightmost].rightChild;
+			first = nodes[leftmost].firstPrimitive;
+			last = nodes[rightmost].firstPrimitive + nodes[rightmost].count;
+		}
+
+		/**
+		* @brief Finds the bounding box and the centroid bounding box of the primitives in [first, last)
+		*
+		* @details Primitive must store its bounding box in bounds and the centre of its bounding box in centroid.
+		*/
+		template <typename Primitive>
+		inline void GrowBounds(const std::vector<Primitive>& primitives, const int first, const int last, AABB& bounds, AABB& centroidBounds)
+		{
+			for (int i = first; i < last; ++i)
+			{
+				bounds.Grow(primitives[i].bounds);
+				centroidBounds.Grow(primitives[i].centroid);
+			}
+		}
+
+		/**
+		* @brief Splits the primitives in [first, last) at the median centroid along the largest axis of the centroid bounding box
+		*
+		* @param less Orders primitives with the same centroid so the split does not depend on the initial order
+		*
+		* @return The index of the first primitive of the right half
+		*/
+		template <typename Primitive, typename Less>
+		inline int MedianSplit(std::vector<Primitive>& primitives, const int first, const int last, const AABB& centroidBounds, Less&& less)
+		{
+			const int axis = centroidBounds.LargestAxis();
+			const int mid = first + (last - first) / 2;
+			std::nth_element(primitives.begin() + first, primitives.begin() + mid, primitives.begin() + last,
+				[axis, &less](const Primitive& a, const Primitive& b)
+				{
+					if (a.centroid[axis] != b.centroid[axis])
+						return a.centroid[axis] < b.centroid[axis];
+					return less(a, b);
+				});
+			return mid;
+		}
+
+		/**
+		* @brief Recursively builds a BVH over the primitives in [first, last), splitting nodes at the median centroid
+		*
+		* @details The primitives are reordered so each leaf stores a contiguous range of them.
+		*
+		* @param nodes The flattened nodes to append to
+		* @param primitives The primitives to build the BVH over
+		* @param maxLeafSize The maximum number of primitives stored in a leaf node
+		* @param less Orders primitives with the same centroid so the tree does not depend on the initial order
+		*
+		* @return The index of the created node
+		*/
+		template <typename Primitive, typename Less>
+		int BuildMedianBVH(std::vector<BVHNode>& nodes, std::vector<Primitive>& primitives, const int first, const int last, const int maxLeafSize, Less&& less)
+		{
+			const int nodeIdx = ToInt(nodes.size());
+			nodes.emplace_back();
+
+			AABB bounds, centroidBounds;
+			GrowBounds(primitives, first, last, bounds, centroidBounds);
+			nodes[nodeIdx].bounds = bounds;
+
+			if (last - first <= maxLeafSize)
+			{
+				nodes[nodeIdx].firstPrimitive = first;
+				nodes[nodeIdx].count = last - first;
+				return nodeIdx;
+			}
+
+			const int mid = MedianSplit(primitives, first, last, centroidBounds, less);
+			BuildMedianBVH(nodes, primitives, first, mid, maxLeafSize, less);
+			const int right = BuildMedianBVH(nodes, primitives, mid, last, maxLeafSize, less);
+			nodes[nodeIdx].rightChild = right;
+			return nodeIdx;
+		}
+	}
+}
+
+#endif
@@ -288,6 +288,10 @@ namespace RAC
 			int specularDiffOrder{ 0 };						// Maximum number of reflections or diffractions in specular diffraction paths
 			Real minEdgeLength{ 0.0 };						// Minimum edge length for diffraction
 			Real maxPathLength{ 1e10 };						// Maximum path length for imageSources
+			Real energyFloor{ 0.0 };						// Minimum path energy (relative to the source at 1m) for image sources (0 disables pruning)
+			int maxImageSources{ MAX_IMAGESOURCES };		// Maximum number of image sources rendered across all sources
+			Real timeBudget{ 0.0 };							// Time budget (s) of each update, after which higher orders are finished by later updates (0 disables)
+			Real listenerTreeMargin{ 0.5 };					// Distance (m) the listener can move before the image source trees are rebuilt
 
 			/**
 			* @brief Constructor for the EarlyReverbData struct
@@ -298,10 +302,16 @@ namespace RAC
 			* @param specularDiffOrder The maximum number of reflections or diffractions in specular diffraction paths
 			* @param minEdgeLength The minimum edge length for diffraction
 			* @param maxPathLength The maximum path length for image sources
+			* @param energyFloor The minimum path energy (relative to the source at 1m) for image sources
+			* @param maxImageSources The maximum number of image sources rendered across all sources
+			* @param timeBudget The time budget (s) of each update, after which higher orders are finished by later updates
+			* @param listenerTreeMargin The distance (m) the listener can move before the image source trees are rebuilt
 			*/
-			EarlyReverbData(DirectSound direct, int reflOrder, int shadowDiffOrder, int specularDiffOrder, Real minEdgeLength, Real maxPathLength) :
+			EarlyReverbData(DirectSound direct, int reflOrder, int shadowDiffOrder, int specularDiffOrder, Real minEdgeLength, Real maxPathLength,
+				Real energyFloor = 0.0, int maxImageSources = MAX_IMAGESOURCES, Real timeBudget = 0.0, Real listenerTreeMargin = 0.5) :
 				direct(direct), reflOrder(reflOrder), shadowDiffOrder(shadowDiffOrder), specularDiffOrder(specularDiffOrder),
-				minEdgeLength(minEdgeLength), maxPathLength(maxPathLength) {
+				minEdgeLength(minEdgeLength), maxPathLength(maxPathLength), energyFloor(energyFloor), maxImageSources(maxImageSources), timeBudget(timeBudget),
+				listenerTreeMargin(listenerTreeMargin) {
 			}
 
 		private:
@@ -315,7 +325,8 @@ namespace RAC
 			*/
 			EarlyReverbData(const EarlyReverbData& data, DiffractionModel model) :
 				direct(data.direct), reflOrder(data.reflOrder), shadowDiffOrder(data.shadowDiffOrder), specularDiffOrder(data.specularDiffOrder),
-				minEdgeLength(data.minEdgeLength), maxPathLength(data.maxPathLength)
+				minEdgeLength(data.minEdgeLength), maxPathLength(data.maxPathLength), energyFloor(data.energyFloor), maxImageSources(data.maxImageSources),
+				timeBudget(data.timeBudget), listenerTreeMargin(data.listenerTreeMargin)
 			{
 				UpdateMaxOrder();
 				UpdateSpecularOrder(model);
@@ -335,6 +346,10 @@ namespace RAC
 				this->specularDiffOrder = data.specularDiffOrder;
 				this->minEdgeLength = data.minEdgeLength;
 				this->maxPathLength = data.maxPathLength;
+				this->energyFloor = data.energyFloor;
+				this->maxImageSources = data.maxImageSources;
+				this->timeBudget = data.timeBudget;
+				this->listenerTreeMargin = data.listenerTreeMargin;
 				UpdateMaxOrder();
 				UpdateSpecularOrder(model);
 			}
@@ -390,6 +405,8 @@ namespace RAC
 		public:
 			bool enabled{ false };		// True if late reverberation is enabled, false otherwise
 			int numRays{ 1000 };		// Number of rays to use for ray tracing
+			int numThreads{ 0 };		// Number of threads used to trace rays, including the ray tracing thread. 0 to use up to 8 based on the hardware
+			int progressiveRays{ 0 };	// Rays traced on each update in progressive mode, averaged over updates up to numRays. 0 to trace all rays on each update
 
 			FDNMatrix feedbackMatrix{ FDNMatrix::randomOrthogonal };	// Feedback matrix type for the FDN
 
@@ -14,6 +14,7 @@
 #include <thread>
 
 // Common headers
+#include "Common/BackgroundScheduler.h"
 #include "Common/Matrix.h"
 #include "Common/Vec.h"
 #include "Common/Vec3.h"
@@ -125,7 +126,11 @@ namespace RAC
 			/**
 			* @brief Stop the spatialiser running.
 			*/
-			void StopRunning() { mIsRunning.store(false, std::memory_order_release); }
+			void StopRunning()
+			{
+				mIsRunning.store(false, std::memory_order_release);
+				scheduler.Stop();
+			}
 
 			/**
 			* @brief Check if the spatialiser is running.
@@ -146,7 +151,35 @@ namespace RAC
 			*
 			* @param data The new IEM configuration.
 			*/
-			inline void UpdateEarlyConfig(const EarlyReverbData& data) { mImageEdgeModel->UpdateIEMConfig(data, dspConfig); }
+			inline void UpdateEarlyConfig(const EarlyReverbData& data)
+			{
+				mImageEdgeModel->UpdateIEMConfig(data, dspConfig);
+				scheduler.Notify(iemTask);
+			}
+
+			/**
+			* @brief Bakes the image source trees of the current sources for a listener anywhere in the room.
+			* @details Blocks until the bake has been written. Intended for static scenes, where the baked file is loaded
+			* with LoadImageSourceCache at start up.
+			*
+			* @param filePath The path of the file to write.
+			* @return True if the file was written, false otherwise.
+			*/
+			bool BakeImageSources(const std::string& filePath);
+
+			/**
+			* @brief Loads image source trees baked with BakeImageSources.
+			*
+			* @param filePath The path of the baked file.
+			* @return True if the file was loaded, false otherwise.
+			*/
+			inline bool LoadImageSourceCache(const std::string& filePath)
+			{
+				if (!mImageEdgeModel->LoadImageSourceCache(filePath))
+					return false;
+				scheduler.Notify(iemTask);
+				return true;
+			}
 
 			/**
 			* @brief Enables the late reverberation DSP.
@@ -170,7 +203,10 @@ namespace RAC
 			inline void UpdateLateReverbNumberOfRays(const int numRays)
 			{
 				if (lateReverbInitialised.load(std::memory_order_acquire))
+				{
 					mRayTracing->SetNumberOfRays(numRays);
+					scheduler.Notify(tracingTask);
+				}
 			}
 
 			/**
@@ -182,7 +218,10 @@ namespace RAC
 			inline void UpdateLateReverbDistanceThresholds(const Real sourceThresh, const Real listenerThresh)
 			{
 				if (lateReverbInitialised.load(std::memory_order_acquire))
+				{
 					mRayTracing->SetUpdateThresholds(sourceThresh, listenerThresh);
+					scheduler.Notify(tracingTask);
+				}
 			}
 
 			/**
@@ -193,7 +232,10 @@ namespace RAC
 			inline void UpdateSelfShadowingRadius(const Real radius)
 			{
 				if (lateReverbInitialised.load(std::memory_order_acquire))
+				{
 					mRayTracing->SetUpdateSelfShadowingRadius(radius);
+					scheduler.Notify(tracingTask);
+				}
 			}
 
 			/**
@@ -287,7 +329,11 @@ namespace RAC
 			* @param id The ID of the source to update.
 			* @param directivity The new directivity of the source.
 			*/
-			inline void UpdateSourceDirectivity(size_t id, const SourceDirectivity& directivity) { mSources->UpdateSourceDirectivity(id, directivity); }
+			inline void UpdateSourceDirectivity(size_t id, const SourceDirectivity& directivity)
+			{
+				mSources->UpdateSourceDirectivity(id, directivity);
+				NotifyBackgroundThreads();
+			}
 
 			/**
 			* @brief Removes a source from the spatialiser.
@@ -319,7 +365,11 @@ namespace RAC
 			* @param id The ID of the wall to update.
 			* @param vData The new vertices of the wall.
 			*/
-			inline void UpdateWall(size_t id, const Vertices& vData) { mRoom->UpdateWall(id, vData); }
+			inline void UpdateWall(size_t id, const Vertices& vData)
+			{
+				mRoom->UpdateWall(id, vData);
+				NotifyBackgroundThreads();
+			}
 
 			/**
 			* @brief Removes a wall from the spatialiser.
@@ -369,6 +419,15 @@ namespace RAC
 
 			void InitLateReverb(const LateReverbData& data);
 
+			/**
+			* @brief Requests a run of the image edge model and ray tracing after a change to shared inputs (listener, sources or geometry).
+			*/
+			inline void NotifyBackgroundThreads()
+			{
+				scheduler.Notify(iemTask);
+				scheduler.Notify(tracingTask);
+			}
+
 			inline void EnsureAudioThreadPoolInitialized()
 			{
 				if (!audioThreadPool)
@@ -378,6 +437,8 @@ namespace RAC
 			void CreateAudioThreadPool();
 
 			size_t numDesiredWorkerThreads;			// The number of desired threads
+			std::chrono::microseconds audioThreadSpinTime;	// Time idle audio threads spin before sleeping until the next audio block
+			size_t numDesiredIEMThreads;			// The number of threads used to run the image edge model
 
 			/**
 			* Spatialiser
@@ -386,6 +447,9 @@ namespace RAC
 			std::atomic<bool> mIsRunning;			// Flag to check if the spatialiser is running
 			std::thread IEMThread;			// Background thread to run the image edge model
 			std::thread rayTracingThread;	// Background thread to run the ray tracing model
+			BackgroundScheduler scheduler;	// Wakes the background threads when their inputs change
+			size_t iemTask;					// Scheduler task ID of the image edge model
+			size_t tracingTask;				// Scheduler task ID of the ray tracing model
 
 			Vec3 listenerPosition;				// Stored listener position
 			bool listenerInitialised{ false };	// Flag to check if the listener has been initialised
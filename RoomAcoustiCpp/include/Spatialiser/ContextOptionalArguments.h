@@ -12,6 +12,7 @@
 #define RoomAcoustiCpp_ContextOptionalArguments_h
 
 // C++ headers
+#include <chrono>
 #include <optional>
 #include <string>
 
@@ -33,6 +34,17 @@ namespace RAC
 			 * @brief If set, overrides the number of audio threads to use
 			 */
 			std::optional<size_t> desiredAudioThreads;
+
+			/**
+			 * @brief If set, overrides how long idle audio threads spin before sleeping until the next audio block.
+			 * std::chrono::microseconds::max() never sleeps (defaults to never on Windows and 200 microseconds elsewhere)
+			 */
+			std::optional<std::chrono::microseconds> audioThreadSpinTime;
+
+			/**
+			 * @brief If set, overrides the number of threads used to run the image edge model (defaults to 1)
+			 */
+			std::optional<size_t> desiredIEMThreads;
 		};
 	}
 }
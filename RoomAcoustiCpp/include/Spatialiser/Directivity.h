@@ -17,6 +17,8 @@
 
 // C++ headers
 #include <vector>
+#include <mutex>
+#include <algorithm>
 
 namespace RAC
 {
@@ -25,6 +27,11 @@ namespace RAC
 	{
 		/**
 		* @brief Class that stores directivity as spherical harmonics for given frequency bands
+		*
+		* @details Response evaluates the spherical harmonics exactly. InterpolatedResponse reads from a magnitude table
+		* that is built the first time it is called. The table samples two equal-area grids (uniform in cos(theta) and phi),
+		* one with its poles on the forward axis and one with its poles on the x axis. Each lookup uses the grid whose poles
+		* are furthest from the direction, as bilinear interpolation is inaccurate close to the poles.
 		*/
 		class Directivity
 		{
@@ -66,6 +73,49 @@ namespace RAC
 				return output;
 			}
 
+			/**
+			* @brief Interpolate the directivity response for given frequencies and direction from the precomputed table
+			*
+			* @params frequencies The frequencies to calculate the directivity for
+			* @params direction A unit vector describing the direction to calculate the directivity for where (0, 0, 1) is the front of the source
+			*
+			* @remark Uses front-pole orientation (RHS). The table is built on the first call
+			*
+			* @return The directivity at the given frequency for a given direction
+			*/
+			inline Coefficients<> InterpolatedResponse(const Coefficients<>& frequencies, const Vec3& direction) const
+			{
+				std::call_once(tableFlag, [this]() { BuildTable(); });
+
+				// Use the grid with the direction closest to its equator
+				const int grid = direction.z() * direction.z() <= REAL_CONST(0.5) ? 0 : 1;
+				const Real u = std::clamp(grid == 0 ? direction.z() : direction.x(), REAL_CONST(-1.0), REAL_CONST(1.0));
+				const Real phi = grid == 0 ? -std::atan2(direction.x(), direction.y()) : std::atan2(direction.y(), direction.z());
+
+				const Real ringPosition = (u + REAL_CONST(1.0)) * REAL_CONST(0.5) * (TABLE_RINGS - 1);
+				const int ring = std::min(static_cast<int>(ringPosition), TABLE_RINGS - 2);
+				const Real ringWeight = ringPosition - ring;
+
+				const Real azimuthPosition = (phi + PI_1) * (TABLE_AZIMUTHS / PI_2);
+				int azimuth = std::min(static_cast<int>(azimuthPosition), TABLE_AZIMUTHS - 1);
+				const Real azimuthWeight = azimuthPosition - azimuth;
+				const int nextAzimuth = azimuth + 1 == TABLE_AZIMUTHS ? 0 : azimuth + 1;
+
+				const size_t numSets = coefficients.size();
+				const Real* row = table.data() + (static_cast<size_t>(grid * TABLE_RINGS + ring) * TABLE_AZIMUTHS) * numSets;
+				const Real* nextRow = row + TABLE_AZIMUTHS * numSets;
+
+				Coefficients<> output(frequencies.Length());
+				for (int i = 0; i < frequencies.Length(); ++i)
+				{
+					const int idx = GetFrequencyIndex(frequencies[i]);
+					const Real lower = row[azimuth * numSets + idx] + azimuthWeight * (row[nextAzimuth * numSets + idx] - row[azimuth * numSets + idx]);
+					const Real upper = nextRow[azimuth * numSets + idx] + azimuthWeight * (nextRow[nextAzimuth * numSets + idx] - nextRow[azimuth * numSets + idx]);
+					output[i] = lower + ringWeight * (upper - lower);
+				}
+				return output;
+			}
+
 			inline Coefficients<> AverageResponse(const Coefficients<>& frequencies) const
 			{
 				Coefficients<> output(frequencies.Length());
@@ -155,9 +205,64 @@ namespace RAC
 				return P_lm * E;
 			}
 
+			/**
+			* @brief Evaluate the response magnitude of every frequency band at the nodes of the interpolation grids
+			*
+			* @details Node (grid, ring, azimuth) has u = -1 + 2 * ring / (TABLE_RINGS - 1) and phi = -PI + 2 * PI * azimuth / TABLE_AZIMUTHS.
+			* For grid 0, u is the z component and phi is the angle used by Response. For grid 1, u is the x component and phi = atan2(y, z).
+			*/
+			inline void BuildTable() const
+			{
+				const size_t numSets = coefficients.size();
+				size_t maxLength = 0;
+				for (const std::vector<Complex>& set : coefficients)
+					maxLength = std::max(maxLength, set.size());
+				const int len = static_cast<int>(std::sqrt(maxLength));
+				std::vector<Complex> harmonics(maxLength);
+
+				table.resize(2 * TABLE_RINGS * TABLE_AZIMUTHS * numSets);
+				Real* value = table.data();
+				for (int grid = 0; grid < 2; ++grid)
+				{
+					for (int ring = 0; ring < TABLE_RINGS; ++ring)
+					{
+						const Real u = REAL_CONST(-1.0) + REAL_CONST(2.0) * ring / (TABLE_RINGS - 1);
+						const Real s = std::sqrt(std::max(REAL_CONST(0.0), REAL_CONST(1.0) - u * u));
+						for (int azimuth = 0; azimuth < TABLE_AZIMUTHS; ++azimuth)
+						{
+							const Real phi = -PI_1 + PI_2 * azimuth / TABLE_AZIMUTHS;
+							const Vec3 direction = grid == 0 ? Vec3(s * std::sin(-phi), s * std::cos(-phi), u) : Vec3(u, s * std::sin(phi), s * std::cos(phi));
+
+							// Spherical harmonics are shared by all frequency bands
+							const Real theta = std::acos(std::clamp(direction.z(), REAL_CONST(-1.0), REAL_CONST(1.0)));
+							const Real phiSH = -std::atan2(direction.x(), direction.y());
+							for (int l = 1; l < len; ++l)
+							{
+								for (int m = -l; m < l + 1; ++m)
+									harmonics[l * l + l + m] = SphericalHarmonic(l, m, theta, phiSH);
+							}
+
+							for (size_t idx = 0; idx < numSets; ++idx, ++value)
+							{
+								Complex output = coefficients[idx][0];
+								for (size_t k = 1; k < coefficients[idx].size(); ++k)
+									output += coefficients[idx][k] * harmonics[k];
+								*value = std::abs(output);
+							}
+						}
+					}
+				}
+			}
+
+			static constexpr int TABLE_RINGS = 65;				// Number of rings (values of cos(theta)) in each interpolation grid
+			static constexpr int TABLE_AZIMUTHS = 128;			// Number of azimuths in each ring
+
 			std::vector<Real> fm;								// Mid frequencies
 			std::vector<std::vector<Complex>> coefficients;		// Spherical harmonics coefficients
 			std::vector<Real> invDirectivityFactor;				// 1 / Directivity Factor (DF) -> DF = 10 ^ (Directivity Index / 20)
+
+			mutable std::once_flag tableFlag;					// Ensures the table is built once
+			mutable std::vector<Real> table;					// Response magnitudes at the grid nodes, indexed by ((grid * TABLE_RINGS + ring) * TABLE_AZIMUTHS + azimuth) * number of bands + band
 		};
 
 		/**
@@ -0,0 +1,97 @@
+/*
+* @class EdgeBVH
+*
+* @brief Declaration of EdgeBVH class
+*
+*/
+
+#ifndef RoomAcoustiCpp_EdgeBVH_h
+#define RoomAcoustiCpp_EdgeBVH_h
+
+// C++ headers
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+
+// Common headers
+#include "Common/Types.h"
+#include "Common/Vec3.h"
+
+// Spatialiser headers
+#include "Spatialiser/Edge.h"
+#include "Spatialiser/BVHTypes.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		/**
+		* @brief Class that stores a bounding volume hierarchy over the edges of a room
+		*
+		* @details Used by the image edge model to find the edges a diffraction path can reach.
+		* A diffraction path via an edge is at least as long as the distance from the source to the edge,
+		* so edges further from the source than the maximum path length are never visited.
+		* The tree is built once per room snapshot and is read only afterwards.
+		*/
+		class EdgeBVH
+		{
+		public:
+			/**
+			* @brief Default constructor that initialises an empty BVH
+			*/
+			EdgeBVH() {}
+
+			/**
+			* @brief Default deconstructor
+			*/
+			~EdgeBVH() {}
+
+			/**
+			* @brief Rebuilds the BVH from the given edges
+			*
+			* @param edges The edges in the room (indexed by the room snapshot)
+			*/
+			void Build(const std::vector<Edge>& edges);
+
+			/**
+			* @brief Clears the BVH
+			*/
+			inline void Clear() { mNodes.clear(); mPrimitives.clear(); }
+
+			/**
+			* @return The number of edges stored in the BVH
+			*/
+			inline size_t Size() const { return mPrimitives.size(); }
+
+			/**
+			* @brief Find all edges that may lie within a distance of a point
+			*
+			* @details The result is conservative: every edge with a point within maxDistance is returned,
+			* but edges slightly further away may also be returned.
+			*
+			* @param point The point to search around
+			* @param maxDistance The maximum distance from the point
+			* @param edgeIndices Stores the indices of the edges found in ascending order (cleared first)
+			*/
+			void FindEdgesNear(const Vec3& point, const Real maxDistance, std::vector<size_t>& edgeIndices) const;
+
+		private:
+			/**
+			* @brief Struct that stores a single edge
+			*/
+			struct Primitive
+			{
+				size_t edgeIdx{ 0 };	// Index of the edge in the room snapshot
+				AABB bounds;			// Bounding box of the edge
+				std::array<Real, 3> centroid{ 0.0, 0.0, 0.0 };	// Centre of the bounding box
+			};
+
+			std::vector<BVHNode> mNodes;			// Flattened BVH nodes (root at index 0)
+			std::vector<Primitive> mPrimitives;		// Edges ordered by leaf
+		};
+	}
+}
+
+#endif
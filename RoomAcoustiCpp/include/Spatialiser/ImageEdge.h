@@ -12,14 +12,24 @@
 
 // C++ headers
 #include <unordered_set>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <string>
 
 // Common headers
 #include "Common/Vec3.h" 
+#include "Common/ThreadPool.h"
 
 // Spatialiser headers
 #include "Spatialiser/Types.h"
 #include "Spatialiser/SourceManager.h"
 #include "Spatialiser/Room.h"
+#include "Spatialiser/RoomSnapshot.h"
+#include "Spatialiser/ReflectionBatch.h"
+#include "Spatialiser/ImageSourceDataPool.h"
+#include "Spatialiser/ImageSourceCache.h"
 #include "Spatialiser/Reverb.h"
 
 namespace RAC
@@ -39,14 +49,20 @@ namespace RAC
 			* @param sourceManager Pointer to the source manager class
 			* @param data The user defined IEM configuration data
 			* @param dspConfig The current DSP configuration
+			* @param numThreads The number of threads used to process sources in parallel (including the calling thread)
 			*/
-			ImageEdge(shared_ptr<Room> room, shared_ptr<SourceManager> sourceManager, const EarlyReverbData& data, const std::shared_ptr<DSPConfig>& dspConfig);
+			ImageEdge(shared_ptr<Room> room, shared_ptr<SourceManager> sourceManager, const EarlyReverbData& data, const std::shared_ptr<DSPConfig>& dspConfig, const size_t numThreads = 1);
 			
 			/**
 			* @brief Default deconstructor
 			*/
 			~ImageEdge() {}
 
+			/**
+			* @return The number of threads used to process sources (including the calling thread)
+			*/
+			inline size_t GetNumThreads() const { return mWorkspaces.size(); }
+
 			/**
 			* @brief Updates the image edge model configuration
 			* 
@@ -84,19 +100,278 @@ namespace RAC
 
 			/**
 			* @brief Process the image edge model and update the target image source data
+			*
+			* @details If a time budget is set, the direct sound and first order paths are published first and each higher
+			* order is published once it has been found for all sources. Orders not reached within the budget are found by
+			* later runs, with the previously rendered image sources of those orders kept until then.
 			*/
 			void RunIEM();
 
-			inline void ResetEndFlag()
+			/**
+			* @return True if the last run ran out of time before finding all orders, false otherwise
+			*/
+			inline bool HasIncompleteOrders() const { return incompleteOrders.load(std::memory_order_acquire); }
+
+			/**
+			* @brief Requests a bake of the image source trees of the current sources
+			*
+			* @details The bake is run at the start of the next run. The trees are built for a listener anywhere in the sphere
+			* bounding the room and written to a file that can be loaded with LoadImageSourceCache.
+			*
+			* @param filePath The path of the file to write
+			*/
+			inline void RequestBake(const std::string& filePath)
 			{
-				while (!iemStartFlag.load(std::memory_order_acquire))
-					std::this_thread::yield();
-				iemEndFlag.store(false, std::memory_order_release);
+				lock_guard<std::mutex> lock(dataStoreMutex);
+				bakeFilePath = filePath;
+				bakeRequested = true;
+				bakePending.store(true, std::memory_order_release);
 			}
 
-			inline bool HasCompleted() { return iemEndFlag.load(std::memory_order_acquire); }
+			/**
+			* @return True if a requested bake has not finished yet, false otherwise
+			*/
+			inline bool IsBakePending() const { return bakePending.load(std::memory_order_acquire); }
+
+			/**
+			* @return True if the last bake was written successfully, false otherwise
+			*/
+			inline bool BakeSucceeded() const { return bakeSucceeded.load(std::memory_order_acquire); }
+
+			/**
+			* @brief Loads baked image source trees
+			*
+			* @details Sources at a baked position start from the baked tree instead of searching for image sources, as long as
+			* the room geometry and IEM configuration match those of the bake and the listener is inside the baked region.
+			*
+			* @param filePath The path of the file written by a bake
+			* @return True if the file was loaded, false otherwise
+			*/
+			bool LoadImageSourceCache(const std::string& filePath);
+
+			/**
+			* @brief Returns the keys of the image sources of a source handed to the source manager by the last run
+			*
+			* @details Must be called from the thread that runs RunIEM
+			*
+			* @param id The ID of the source
+			* @return The keys of the image sources handed to the source manager
+			*/
+			std::unordered_set<ImageSourceKey, ImageSourceKeyHash> GetImageSourceKeys(const size_t id) const;
 
 		private:
+			/**
+			* @brief Struct that stores the output of one contiguous range of a higher order frontier expansion
+			*
+			* @details Segments are expanded in parallel and concatenated in order, so the image sources match the serial expansion.
+			*/
+			struct FrontierSegment
+			{
+				std::vector<std::shared_ptr<ImageSourceData>> store;	// Image sources created by the segment (entries from counter onwards are reused)
+				size_t counter{ 0 };									// Number of image sources created by the segment
+				ImageSourceDataMap imageSources;						// Visible image sources found by the segment
+				std::vector<Vec3> intersections;						// Intersection points scratch buffer
+				ImageSourceDataPool pool;								// Recycles the image sources added to the store
+
+				/**
+				* @brief Returns the next image source to write to, reusing a stored image source if available
+				*
+				* @param vS The previous order image source to extend
+				*/
+				inline std::shared_ptr<ImageSourceData>& Next(const ImageSourceData& vS)
+				{
+					if (counter < store.size())
+					{
+						store[counter]->Update(vS);
+						return store[counter++];
+					}
+					std::shared_ptr<ImageSourceData>& imageSource = store.emplace_back(pool.Acquire(vS));
+					imageSource->IncreaseImageSourceOrder();
+					counter++;
+					return imageSource;
+				}
+			};
+
+			/**
+			* @brief Struct that caches the edges a source can diffract around
+			*
+			* @details Stores the edges that are long enough, lie within the maximum path length of the source and do not
+			* have the source behind both faces, along with the zone of the source around each edge.
+			* The cache only depends on the source position, the room geometry and the IEM configuration, so it is kept
+			* when only the listener moves.
+			*/
+			struct SourceEdgeZones
+			{
+				std::vector<size_t> edges;			// Dense indices of the candidate edges in ascending order
+				std::vector<EdgeZone> zones;		// Zone of the source around each candidate edge
+				Vec3 sourcePosition;				// Source position the cache was built for
+				Real maxDistance{ 0.0 };			// Largest distance from the source of the candidate edges
+				uint64_t roomVersion{ 0 };			// Room snapshot version the cache was built for
+				uint64_t configVersion{ 0 };		// IEM configuration version the cache was built for
+				bool valid{ false };				// True if the cache has been built, false otherwise
+			};
+
+			/**
+			* @brief Struct that stores the per thread state used while running the image edge model for a single source
+			*
+			* @details Room data (planes, walls, edges, BVH) is shared between threads and read only while sources are processed.
+			*/
+			struct IEMWorkspace
+			{
+				ImageSourceDataStore sp;					// Store valid image sources while the image edge model is being run
+				ImageSourceDataMap imageSources;			// Store image sources
+				Source::DSPParameters sourceAudioData;		// Store source audio data
+				std::vector<FrontierSegment> segments;		// Higher order frontier segments
+				std::vector<size_t> reflectionOffsets;		// Offset of the first (image source, plane) pair of each previous order image source
+				std::vector<size_t> diffractionOffsets;		// Offset of the first (image source, edge) pair of each previous order image source
+				std::vector<uint8_t> reflectionMask;		// 0 if the (image source, plane) pair was culled by the batched reflection, 1 otherwise
+				std::vector<size_t> planeGroupOffsets;		// Offset of the first reflection only image source in planeGroups for each last plane
+				std::vector<size_t> planeGroups;			// Previous order reflection only image sources grouped by their last plane
+				std::vector<uint8_t> batchMask;				// Cull results of the current batch
+				ReflectionBatch batch;						// Positions of the image sources in a plane group
+				SourceEdgeZones sourceEdgeZones;			// Edge zone cache of the source being processed
+
+				/**
+				* @brief Constructor that initialises an empty workspace
+				*
+				* @param numFrequencyBands The number of frequency bands
+				*/
+				IEMWorkspace(const int numFrequencyBands) : sourceAudioData(numFrequencyBands, false)
+				{
+					sp.push_back(std::vector<std::shared_ptr<ImageSourceData>>());
+				}
+			};
+
+			/**
+			* @brief Struct that stores the image source tree of a source between runs
+			*
+			* @details The source side of the tree (image source positions, path parts and previous planes) only depends on the
+			* source position, the room geometry and the IEM configuration. If none of these have changed and the listener
+			* has not moved further than the listener margin of the tree, only the receiver side of each path is updated.
+			* Trees built by a bake (or seeded from a baked cache) cover a listener region around the whole room.
+			* The tree also stores the estimated energy of each visible image source and the image sources admitted by the
+			* image source budget in the last update.
+			* In progressive mode the tree may only be built up to numOrders. The rendered image sources of the remaining
+			* orders from the previous tree are retained and handed to the source manager until those orders are found.
+			*/
+			struct SourceTree
+			{
+				ImageSourceDataStore sp;				// Image sources of the source
+				ImageSourceDataMap imageSources;		// Visible image sources handed to the source manager
+				Source::DSPParameters sourceAudioData{ 0, false };					// Direct sound audio data handed to the source manager
+				std::vector<std::pair<ImageSourceKey, Real>> energies;				// Estimated energy of each visible image source
+				std::unordered_set<ImageSourceKey, ImageSourceKeyHash> rendered;	// Image sources admitted by the budget in the last update
+				bool pendingUpdate{ false };			// True if the tree has been updated and not yet handed to the source manager
+				Vec3 sourcePosition;					// Source position the tree was built for
+				Vec3 listenerPosition;					// Listener position the tree was built for
+				Real listenerMargin{ 0.0 };				// Distance the listener can move from listenerPosition before the tree is rebuilt
+				uint64_t roomVersion{ 0 };				// Room snapshot version the tree was built for
+				uint64_t configVersion{ 0 };			// IEM configuration version the tree was built for
+				int numOrders{ 0 };						// Number of orders of the tree that have been found
+				std::vector<ImageSourceDataMap> retained;	// Rendered image sources of orders that have not yet been found again (indexed by order - 1)
+				ImageSourceDataPool retainedPool;		// Recycles the retained image sources
+				SourceEdgeZones sourceEdgeZones;		// Edges the source can diffract around
+				bool valid{ false };					// True if the tree has been built, false otherwise
+			};
+
+			/**
+			* @brief Run the image edge model for sources in mSources using the calling thread and the worker threads
+			*
+			* @param numSources The number of sources expected to be processed (limits the number of worker threads)
+			* @param doIEM True if all sources must be updated, false if only sources that have changed
+			* @param extend True to extend incomplete image source trees by one order instead
+			*/
+			void ProcessSourcesInParallel(const size_t numSources, const bool doIEM, const bool extend);
+
+			/**
+			* @brief Run the image edge model for sources in mSources until all sources have been claimed
+			*
+			* @param workspace The workspace of the calling thread
+			* @param doIEM True if all sources must be updated, false if only sources that have changed
+			* @param extend True to only process sources with incomplete image source trees
+			*/
+			void ProcessSources(IEMWorkspace& workspace, const bool doIEM, const bool extend);
+
+			/**
+			* @brief Run the image edge model for a single source and store the result in its image source tree
+			*
+			* @param source The current source data
+			* @param workspace The workspace of the calling thread
+			* @param extend True to find the next order of an incomplete image source tree
+			*/
+			void ProcessSource(const Source::Data& source, IEMWorkspace& workspace, const bool extend);
+
+			/**
+			* @return True if all orders of the image source tree have been found, false otherwise
+			*/
+			inline bool IsComplete(const SourceTree& tree) const { return tree.numOrders >= earlyReverbData.maxOrder; }
+
+			/**
+			* @return The number of sources in mSources with incomplete image source trees
+			*/
+			size_t NumIncompleteTrees() const;
+
+			/**
+			* @brief Keep copies of the rendered higher order image sources of a tree before it is rebuilt
+			*
+			* @param workspace The workspace holding the image source tree of the source
+			* @param tree The image source tree of the source
+			*/
+			void RetainImageSources(const IEMWorkspace& workspace, SourceTree& tree) const;
+
+			/**
+			* @brief Select the loudest image sources across all sources and hand the updated sources to the source manager
+			*
+			* @details Image sources are ranked by their estimated energy. Image sources that were rendered in the last update
+			* are boosted by a hysteresis factor so image sources close to the budget limit do not flicker between updates.
+			* Sources whose admitted image sources change but that were not updated this run are filtered again from their stored tree.
+			*
+			* @param sourceManager The source manager to write the results to
+			*/
+			void SubmitImageSources(SourceManager& sourceManager);
+
+			/**
+			* @brief Swaps the image source tree of a source with the workspace
+			*/
+			static inline void SwapTree(IEMWorkspace& workspace, SourceTree& tree)
+			{
+				std::swap(workspace.sp, tree.sp);
+				std::swap(workspace.imageSources, tree.imageSources);
+				std::swap(workspace.sourceAudioData, tree.sourceAudioData);
+				std::swap(workspace.sourceEdgeZones, tree.sourceEdgeZones);
+			}
+
+			/**
+			* @brief Replaces the image source tree of a source with its baked tree, if available
+			*
+			* @param source The current source data
+			* @param tree The stored image source tree of the source
+			*/
+			void SeedTree(const Source::Data& source, SourceTree& tree) const;
+
+			/**
+			* @brief Builds the image source trees of all sources for the listener region around the room and writes them to a file
+			*
+			* @param filePath The path of the file to write
+			* @return True if the file was written, false otherwise
+			*/
+			bool BakeImageSources(const std::string& filePath);
+
+			/**
+			* @return A hash of the IEM configuration that the source side of the image source trees depend on
+			*/
+			uint64_t GetConfigHash() const;
+
+			/**
+			* @brief Check if the stored image source tree of a source can be reused
+			*
+			* @param source The current source data
+			* @param tree The stored image source tree of the source
+			*
+			* @return True if only the receiver side of the tree needs updating, false if the tree must be rebuilt
+			*/
+			bool CanReuseTree(const Source::Data& source, const SourceTree& tree) const;
+
 			/**
 			* @brief Update the receiver validity for planes and edges
 			*/
@@ -117,26 +392,27 @@ namespace RAC
 			*
 			* @param start Start point of the line
 			* @param end End point of the line
+			* @param planeID The ID of the plane to check for intersection
 			* @param plane The plane to check for intersection
 			* @param absorption Image source absorption to write to
 			* @param intersection A vec3 to store the intersection point
 			*
 			* @return True if a valid intersection is found, false otherwise
 			*/
-			bool LinePlaneIntersection(const Vec3& start, const Vec3& end, const Plane& plane, Coefficients<>& absorption, Vec3& intersection) const;
+			bool LinePlaneIntersection(const Vec3& start, const Vec3& end, const size_t planeID, const Plane& plane, Coefficients<>& absorption, Vec3& intersection) const;
 
 			/**
-			* @brief Locate intersection between a line and a collection of walls
+			* @brief Locate intersection between a line and the walls of a plane
 			* 
 			* @param start Start point of the line
 			* @param end End point of the line
-			* @param wallIDs The walls to check for intersection
+			* @param planeID The ID of the plane whose walls are checked for intersection
 			* @param absorption Image source absorption to write to
 			* @param intersection A vec3 to store the intersection point
 			* 
 			* @return True if a valid intersection is found, false otherwise
 			*/
-			bool LineWallIntersection(const Vec3& start, const Vec3& end, const std::vector<size_t>& wallIDs, Coefficients<>& absorption, Vec3& intersection) const;
+			bool LineWallIntersection(const Vec3& start, const Vec3& end, const size_t planeID, Coefficients<>& absorption, Vec3& intersection) const;
 
 			/**
 			* @brief Check for obstructions along an image source path
@@ -156,81 +432,166 @@ namespace RAC
 			*
 			* @return True if an obstruction is found, false otherwise
 			*/
-			bool LineRoomObstruction(const Vec3& start, const Vec3& end, const std::unordered_set<size_t>& excludedPlaneIds = {}) const;
+			bool LineRoomObstruction(const Vec3& start, const Vec3& end, std::initializer_list<size_t> excludedPlaneIds = {}) const;
 
 			/**
-			* @brief Check for obstruction between a line and a plane
-			* 
-			* @param start Start point of the line
-			* @param end End point of the line
-			* @param plane The plane to check for obstruction
+			* @brief Calculate the directivity of a source
+			*
+			* @param source The current source data
+			* @param point A point in the direction the source is emitting sound
+			*
+			* @return The directivity of the source
 			* 
-			* @return True if an obstruction is found, false otherwise
+			* @remarks Directivities taken from: Eargle's the Microphone Book : From Mono to Stereo to Surround - a Guide to Microphone Design and Application
 			*/
-			bool LinePlaneObstruction(const Vec3& start, const Vec3 end, const Plane& plane) const;
+			Coefficients<> CalculateDirectivity(const Source::Data& source, const Vec3& point) const;
 
 			/**
-			* @brief Check for obstruction between a line and a collection of walls
+			* @brief Run the image edge model for the given source
 			*
-			* @param start Start point of the line
-			* @param end End point of the line
-			* @param wallIDs The walls to check for obstruction
+			* @param source The current source data to run the image edge model for
+			* @param workspace The workspace to write the direct sound audio data and image sources to
+			* @param numOrders The number of orders to find (first order paths are always found)
 			*
-			* @return True if an obstruction is found, false otherwise
+			* @return The number of orders found (the maximum order if no further paths exist)
 			*/
-			bool LineWallObstruction(const Vec3& start, const Vec3& end, const std::vector<size_t>& wallIDs) const;
+			int ReflectPointInRoom(const Source::Data& source, IEMWorkspace& workspace, const int numOrders) const;
 
 			/**
-			* @brief Calculate the directivity of a source
+			* @brief Update the receiver side of a stored image source tree after the listener has moved
 			*
 			* @param source The current source data
-			* @param point A point in the direction the source is emitting sound
+			* @param workspace The workspace holding the stored image source tree of the source
+			* @param numOrders The number of orders of the tree that have been found
+			*/
+			void UpdateReceiverPaths(const Source::Data& source, IEMWorkspace& workspace, const int numOrders) const;
+
+			/**
+			* @brief Update the direct sound of a source
 			*
-			* @return The directivity of the source
-			* 
-			* @remarks Directivities taken from: Eargle's the Microphone Book : From Mono to Stereo to Surround - a Guide to Microphone Design and Application
+			* @param source The current source data
+			* @param direct The source audio data to write to
 			*/
-			Coefficients<> CalculateDirectivity(const Source::Data& source, const Vec3& point) const;
+			void UpdateDirect(const Source::Data& source, Source::DSPParameters& direct) const;
+
+			Coefficients<> Direct(const Source::Data& source, bool lineOfSight) const;
 
 			/**
-			* @brief Run the image edge model for the given source
+			* @brief Estimate the energy of a visible image source
 			*
-			* @param source The current source data to run the image edge model for
-			* @param imageSources The image source data to write to
-			* @param direct The direct sound audio data for the current source
+			* @param imageSource The image source including wall absorption and source directivity
+			*
+			* @return The mean energy over frequency bands relative to the source at 1m
+			*/
+			static Real EstimateEnergy(const ImageSourceData& imageSource);
+
+			/**
+			* @brief Check if a branch of the image source tree can be pruned by the energy floor
+			*
+			* @details Further reflections and diffractions can only reduce the reflectance and increase the path length,
+			* so a branch is pruned if its reflectance bound with 1 / r spreading is below the energy floor.
+			* The source directivity is assumed not to amplify the source.
+			*
+			* @param reflectanceBound The upper bound on the reflectance of the image source path
+			* @param distance The length of the image source path
+			*
+			* @return True if the branch is below the energy floor, false otherwise
 			*/
-			void ReflectPointInRoom(const Source::Data& source, Source::DSPParameters& direct, ImageSourceDataMap& imageSources);
+			bool BelowEnergyFloor(const Real reflectanceBound, const Real distance) const;
 
-			Coefficients<> Direct(const Source::Data& source, bool lineOfSight);
+			/**
+			* @brief Rebuilds the edge zone cache of a source if the source has moved or the room or configuration has changed
+			*
+			* @param source The current source data
+			* @param cache The edge zone cache of the source
+			*/
+			void UpdateSourceEdgeZones(const Source::Data& source, SourceEdgeZones& cache) const;
 
 			/**
 			* @brief Find all first order diffractions
 			* 
 			* @param source The current source data
-			* @param imageSources The image source data to write to
+			* @param workspace The workspace to write the image source data to
 			* 
 			* @return The number of first order diffractions found
 			*/
-			size_t FirstOrderDiffraction(const Source::Data& source, ImageSourceDataMap& imageSources);
+			size_t FirstOrderDiffraction(const Source::Data& source, IEMWorkspace& workspace) const;
 
 			/**
 			* @brief Find all first order reflections
 			* 
 			* @param source The current source data
-			* @param imageSources The image source data to write to
+			* @param workspace The workspace to write the image source data to
 			* @param counter The number of first order diffractions found so far
 			* 
 			* @return counter + The number of first order reflections found
 			*/
-			size_t FirstOrderReflections(const Source::Data& source, ImageSourceDataMap& imageSources, size_t counter);
+			size_t FirstOrderReflections(const Source::Data& source, IEMWorkspace& workspace, size_t counter) const;
 
 			/**
-			* @brief Find all higher order reflection and diffraction paths
+			* @brief Find the higher order reflection and diffraction paths of a range of orders
 			* 
 			* @params source The current source data
-			* @params imageSources The image source data to write to
+			* @params workspace The workspace to write the image source data to
+			* @params firstRefIdx The index of the first order to find (order - 1)
+			* @params endRefIdx The index of the order to stop before (order - 1)
+			*
+			* @return endRefIdx, or the maximum order if an order has no image sources to extend
 			*/
-			void HigherOrderPaths(const Source::Data& source, ImageSourceDataMap& imageSources);
+			int HigherOrderPaths(const Source::Data& source, IEMWorkspace& workspace, const int firstRefIdx, const int endRefIdx) const;
+
+			/**
+			* @brief Cull the (image source, plane) pairs of reflection only previous order image sources in batches
+			*
+			* @details Image sources are grouped by their last plane, as they share a candidate list. Each group is reflected
+			* in each candidate plane at once and the pairs that are behind the plane or too far from the listener are marked in
+			* workspace.reflectionMask. The remaining pairs are checked exactly by ReflectImageSource.
+			*
+			* @param workspace The workspace containing the previous order image sources and reflection offsets
+			* @param prevRefIdx The index of the previous order (order - 1)
+			*/
+			void CullReflections(IEMWorkspace& workspace, const int prevRefIdx) const;
+
+			/**
+			* @brief Returns the planes a previous order image source can be reflected in
+			*
+			* @param vS The previous order image source
+			* @param prevRefIdx The index of the previous order (order - 1)
+			*
+			* @return The dense indices of the planes visible from the last plane or edge in the image source path
+			*/
+			const std::vector<size_t>& ReflectionCandidates(const ImageSourceData& vS, const int prevRefIdx) const;
+
+			/**
+			* @brief Returns the edges a previous order image source can be diffracted around
+			*
+			* @param vS The previous order image source
+			*
+			* @return The dense indices of the edges visible from the last plane in the image source path
+			*/
+			const std::vector<size_t>& DiffractionCandidates(const ImageSourceData& vS) const;
+
+			/**
+			* @brief Extend a previous order image source by reflecting it in a plane
+			* 
+			* @param source The current source data
+			* @param planeIdx The index of the plane to reflect in within the room snapshot
+			* @param vS The previous order image source
+			* @param refIdx The index of the current order (order - 1)
+			* @param segment The frontier segment to write to
+			*/
+			void ReflectImageSource(const Source::Data& source, const size_t planeIdx, const ImageSourceData& vS, const int refIdx, FrontierSegment& segment) const;
+
+			/**
+			* @brief Extend a previous order image source by diffracting it around an edge
+			*
+			* @param source The current source data
+			* @param edgeIdx The index of the edge to diffract around within the room snapshot
+			* @param vS The previous order image source
+			* @param refIdx The index of the current order (order - 1)
+			* @param segment The frontier segment to write to
+			*/
+			void DiffractImageSource(const Source::Data& source, const size_t edgeIdx, const ImageSourceData& vS, const int refIdx, FrontierSegment& segment) const;
 
 			/**
 			* @brief Initialise an image source
@@ -240,10 +601,61 @@ namespace RAC
 			* @param imageSource The image source data to save
 			* @param imageSources The image source data to write to
 			* @param feedsFDN True if the image source should feed the FDN, false otherwise
+			*
+			* @return True if the image source is visible, false if it is below the energy floor
+			*/
+			bool InitImageSource(const Source::Data& source, const Vec3& intersection, std::shared_ptr<ImageSourceData>& imageSource, ImageSourceDataMap& imageSources, bool feedsFDN) const;
+
+			/**
+			* @brief Run the receiver checks for a valid image source and initialise it if a path to the listener exists
+			*
+			* @param source The current source data
+			* @param imageSource The valid image source
+			* @param refIdx The index of the image source order (order - 1)
+			* @param intersections Intersection points scratch buffer (size refIdx + 1)
+			* @param imageSources The image source data to write to
+			*/
+			void FindReceiverPath(const Source::Data& source, std::shared_ptr<ImageSourceData>& imageSource, const int refIdx, std::vector<Vec3>& intersections, ImageSourceDataMap& imageSources) const;
+
+			/**
+			* @brief Reclaims image sources handed to the source manager and rebuilds the image source map from the visible image sources
+			*
+			* @details Unlike ResetImageSources, the image sources are left visible, so the found orders do not need their receiver paths updated.
+			*
+			* @param sp The stored image sources
+			* @param imageSources The image source map last handed to the source manager
+			*/
+			static void RestoreImageSources(ImageSourceDataStore& sp, ImageSourceDataMap& imageSources);
+
+			/**
+			* @brief Rebuilds the image source map of a tree that has already been handed to the source manager from the admitted image sources
+			*
+			* @details The image sources handed over by the last update are reclaimed first, so the tree does not share them with the source manager.
+			*
+			* @param tree The image source tree of the source
+			* @param admitted The keys of the image sources admitted by the budget
+			*/
+			static void FilterImageSources(SourceTree& tree, const std::unordered_set<ImageSourceKey, ImageSourceKeyHash>& admitted);
+
+			/**
+			* @brief Reclaims an image source from the source manager if the map holds a different image source with its key
+			*
+			* @param vS The visible image source stored in the tree
+			* @param imageSources The image source map last handed to the source manager
+			* @param keepTree True if the reclaimed image source will be reused, false if it will be overwritten
 			*/
-			void InitImageSource(const Source::Data& source, const Vec3& intersection, std::shared_ptr<ImageSourceData>& imageSource, ImageSourceDataMap& imageSources, bool feedsFDN);
+			static void ReclaimImageSource(std::shared_ptr<ImageSourceData>& vS, ImageSourceDataMap& imageSources, const bool keepTree);
 
-			void ResetImageSources();
+			/**
+			* @brief Reclaims image sources handed to the source manager and clears the image source map of a workspace
+			*
+			* @details An image source was handed over if it is visible and the map holds a different image source with its key.
+			* All image sources in the workspace are left invisible.
+			*
+			* @param workspace The workspace to reset
+			* @param keepTree True if the image sources in the workspace will be reused, false if they will be overwritten
+			*/
+			static void ResetImageSources(IEMWorkspace& workspace, const bool keepTree);
 
 			/**
 			 * @brief Creates an empty image source
@@ -255,14 +667,14 @@ namespace RAC
 
 			Coefficients<> frequencyBands;			// Frequency bands for graphic equalisers
 
-			PlaneMap mPlanes;									// Store planes
-			WallMap mWalls;										// Store walls
-			MaterialMap mMaterials;								// Store materials
-			EdgeMap mEdges;										// Store edges
+			std::shared_ptr<const RoomSnapshot> mRoomSnapshot;	// Shared read only room geometry (planes, walls, materials, edges and wall BVH)
+			std::vector<bool> mPlaneReceiverValid;				// True if the listener is in front of the plane (indexed by the room snapshot)
+			std::vector<EdgeZone> mEdgeReceiverZones;			// The edge zone where the listener is located (indexed by the room snapshot)
 			std::vector<Source::Data> mSources;					// Store sources
-			ImageSourceDataMap imageSources;					// Store image sources
-			Source::DSPParameters sourceAudioData;				// Store source audio data
-			ImageSourceDataStore sp;							// Store valid image sources while the image edge model is being run
+			std::vector<IEMWorkspace> mWorkspaces;				// Per thread image source stores (index 0 is used by the calling thread)
+			std::vector<SourceTree> mSourceTrees;				// Stored image source trees (indexed by source ID)
+			std::vector<Real> mBudgetScores;					// Scratch buffer used to rank image sources against the budget
+			std::unordered_set<ImageSourceKey, ImageSourceKeyHash> mAdmitted;	// Scratch set of the image sources of a source admitted by the budget
 
 			EarlyReverbData earlyReverbData;					// The user defined IEM configuration data (can be accessed freely)
 			EarlyReverbData earlyReverbDataIncoming;			// The user defined IEM configuration data (Mutex must be locked to access)
@@ -271,17 +683,33 @@ namespace RAC
 			bool doSpecularDiffraction;
 			Vec3 mListenerPosition;					// The listener position (can be accessed freely)
 			Vec3 mListenerPositionIncoming;			// The listener position (Mutex must be locked to access)
+			Real mTreeMargin;						// Distance the listener can move before image source trees built by this run are rebuilt
+
+			std::shared_ptr<const ImageSourceCache> mImageSourceCache;			// Baked image source trees (can be accessed freely)
+			std::shared_ptr<const ImageSourceCache> mImageSourceCacheIncoming;	// Newly loaded baked image source trees (Mutex must be locked to access)
+			std::string bakeFilePath;				// File to write the requested bake to (Mutex must be locked to access)
 
 			std::vector<Vec3> reverbDirections;				// The directions of the late reverb sources
 			std::vector<Coefficients<>> reverbAbsorptions;		// The absorption Coefficients<> of the late reverb sources
 
+			uint64_t mConfigVersion{ 0 };			// Incremented each time a new IEM configuration is applied
 			bool configChanged{ true };				// True if the image edge model configuration has changed since the last run
 			bool listenerMoved{ true };				// True if the listener has moved since the last run
+			bool imageSourceCacheLoaded{ false };	// True if baked image source trees have been loaded since the last run
+			bool bakeRequested{ false };			// True if a bake has been requested since the last run
 			bool reverbRunning{ false };				// True if the late reverb is running, false otherwise
 
 			std::mutex dataStoreMutex;					// Protects mListenerPositionStore, mIEMConfigStore
-			std::atomic<bool> iemStartFlag{ false };	// True if the image edge model is running, false otherwise
-			std::atomic<bool> iemEndFlag{ false };		// True if the image edge model has finished running, false otherwise
+
+			std::atomic<size_t> nextSource{ 0 };		// Index of the next source in mSources to be processed
+			std::atomic<bool> incompleteOrders{ false };	// True if the last run ran out of time before finding all orders
+			std::atomic<bool> bakePending{ false };			// True if a requested bake has not finished
+			std::atomic<bool> bakeSucceeded{ false };		// True if the last bake was written successfully
+			size_t numFrontierHelpers{ 0 };				// Number of idle pool threads available to each source for frontier expansion
+			size_t activeWorkers{ 0 };					// Number of pool threads still processing sources (Mutex must be locked to access)
+			std::mutex workerMutex;						// Protects activeWorkers
+			std::condition_variable workerCondition;	// Notifies the calling thread when all pool threads have finished
+			std::unique_ptr<ThreadPool> mThreadPool;	// Worker threads (nullptr if running single threaded). Declared last so threads are joined first
 		};
 	}
 }
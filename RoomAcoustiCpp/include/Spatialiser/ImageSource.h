@@ -15,12 +15,15 @@
 #include <unordered_map>
 #include <charconv>
 #include <array>
+#include <istream>
+#include <ostream>
 
 // Common headers
 #include "Common/Vec3.h"
 #include "Common/Vec4.h"
 #include "Common/Matrix.h"
 #include "Common/Access.h"
+#include "Common/FixedVector.h"
 
 // Spatialiser headers
 #include "Spatialiser/Wall.h"
@@ -52,6 +55,9 @@ namespace RAC
 
 		/**
 		* @brief Stores data used to create an image source
+		*
+		* @details The path is stored inline up to INLINE_IMAGE_SOURCE_ORDER, so copying or extending an image source only
+		* allocates for the absorption.
 		*/
 		class ImageSourceData
 		{
@@ -63,6 +69,11 @@ namespace RAC
 				bool	 isReflection;
 				partid_t id;										// ID of the reflecting plane or diffracting edge
 
+				/**
+				* @brief Default constructor that initialises the part as a reflection
+				*/
+				Part() : isReflection(true), id(0) {};
+
 				/**
 				* @brief Constructor that initialises the part
 				*
@@ -80,6 +91,11 @@ namespace RAC
 				Vec3 base;				// Base coordinate of the image edge
 				Vec3 edgeVector;		// Vector from the base to the top of the image edge
 
+				/**
+				* @brief Default constructor that initialises the ImageEdgeData at the origin
+				*/
+				ImageEdgeData() {};
+
 				/**
 				* @brief Constructor that initialises the ImageEdgeData
 				*
@@ -138,7 +154,9 @@ namespace RAC
 			inline const Coefficients<>& GetAbsorption() const { return mAbsorption; }
 
 			/**
-			* @brief Creates a string key representing the image source path
+			* @brief Creates an integer key representing the image source path
+			*
+			* @param sourceID The ID of the source the image source belongs to
 			*/
 			void CreateKey(int sourceID);
 
@@ -197,9 +215,27 @@ namespace RAC
 			}
 
 			/**
+			* @return The integer key representing the image source path
+			*/
+			inline const ImageSourceKey& GetKey() const { return key; }
+
+			/**
+			* @brief Creates a readable string key representing the image source path
+			*
+			* @details Format: <sourceID>s followed by <id>r for each reflection and <id>d for each diffraction.
+			* Allocates, so only intended for debug output.
+			*
 			* @return The string key representing the image source path
 			*/
-			inline std::string GetKey() const { return key; }
+			std::string GetKeyString() const;
+
+			/**
+			* @brief Checks if another image source follows the same reflection and diffraction path
+			*
+			* @param imageSource The image source to compare against
+			* @return True if the path parts are identical, false otherwise
+			*/
+			bool SamePath(const ImageSourceData& imageSource) const;
 
 			/**
 			* @return The index of the corresponding image source
@@ -267,6 +303,7 @@ namespace RAC
 				mEdges.back().edgeVector = edge.GetEdgeVector();
 				mDiffractionPath.UpdateParameters(source, receiver, edge);
 				SetTransform(source, mDiffractionPath.CalculateVirtualPostion());
+				SetDistance(receiver);
 			}
 
 			/**
@@ -287,6 +324,19 @@ namespace RAC
 				SetDistance(receiver);
 			}
 
+			/**
+			* @brief Updates the receiver side of the existing diffraction path
+			*
+			* @param receiver The position of the listener
+			*/
+			inline void UpdateDiffractionPath(const Vec3& receiver)
+			{
+				const Vec3 source = mDiffractionPath.sData.point;
+				mDiffractionPath.UpdateParameters(source, receiver);
+				SetTransform(source, mDiffractionPath.CalculateVirtualPostion());
+				SetDistance(receiver);
+			}
+
 			/**
 			* @return The edge in the diffraction path
 			*/
@@ -347,6 +397,30 @@ namespace RAC
 			*/
 			void Update(const ImageSourceData& imageSource);
 
+			/**
+			* @brief Copies all image source data from another image source of the same order
+			*
+			* @param imageSource The image source to copy from
+			*/
+			void Copy(const ImageSourceData& imageSource);
+
+			/**
+			* @brief Writes the source side of the image source to a binary stream
+			*
+			* @details The receiver side (distance, transform, visibility and key) is not written as it is found again by the receiver checks.
+			*
+			* @param stream The stream to write to
+			*/
+			void Write(std::ostream& stream) const;
+
+			/**
+			* @brief Reads the source side of an image source written by Write and marks the image source as valid
+			*
+			* @param stream The stream to read from
+			* @return True if the image source was read, false otherwise
+			*/
+			bool Read(std::istream& stream);
+
 			/**
 			* @brief Sets the distance of the image source from the listener
 			*
@@ -396,6 +470,18 @@ namespace RAC
 			*/
 			inline Real GetDistance() const { return distance; }
 
+			/**
+			* @return The upper bound on the reflectance of the image source path (product of the largest plane reflectances)
+			*/
+			inline Real GetReflectanceBound() const { return reflectanceBound; }
+
+			/**
+			* @brief Sets the upper bound on the reflectance of the image source path
+			*
+			* @param bound The new reflectance bound
+			*/
+			inline void SetReflectanceBound(const Real bound) { reflectanceBound = bound; }
+
 			/**
 			* @return The 3DTI transform of the image source
 			*/
@@ -411,43 +497,21 @@ namespace RAC
 			}
 
 		private:
-
-			/**
-			* @brief Adds the sourceID to the key
-			*/
-			void AddSourceIDToKey(int sourceID);
-
-			/**
-			* @brief Adds a reflection to the image source path
-			*
-			* @param id The ID of the reflecting plane
-			*/
-			void AddPlaneIDToKey(const size_t id);
-
-			/**
-			* @brief Adds a diffraction to the image source path
-			*
-			* @param id The ID of the diffracting edge
-			*/
-			void AddEdgeIDToKey(const size_t id);
-
 			int arrayID{ -1 };
 
-			std::string key;								// String key that defines the image source path
-			std::array<char, 21> idKey{ '0' };				// Char that stores the ID of a plane, edge or source
-			std::array<char, 1> sourceKey{ 's' };			// Char that stores the source key
-			std::array<char, 1> reflectionKey{ 'r' };		// Char that stores the reflection key
-			std::array<char, 1> diffractionKey{ 'd' };		// Char that stores the diffraction key
+			ImageSourceKey key;								// Integer key that defines the image source path
+			int keySourceID{ -1 };							// Source ID used to create the key
 
-			std::vector<Part> pathParts;			// Reflection and diffraction parts of the image source path
-			std::vector<Vec3> mPositions;			// Positions of the image source along the path
-			std::vector<ImageEdgeData> mEdges;		// Image edges along the image source path
+			FixedVector<Part, INLINE_IMAGE_SOURCE_ORDER> pathParts;			// Reflection and diffraction parts of the image source path
+			FixedVector<Vec3, INLINE_IMAGE_SOURCE_ORDER> mPositions;			// Positions of the image source along the path
+			FixedVector<ImageEdgeData, INLINE_IMAGE_SOURCE_ORDER> mEdges;	// Image edges along the image source path
 			int diffractionIndex;					// Index of the first diffraction in the image source path
 			Vec4 previousPlane;						// Previous reflected plane information where: w -> D, x, y, z -> Normal
 
 			Diffraction::Path mDiffractionPath;			// Diffraction path of the image source
 			Coefficients<> mAbsorption;					// Wall absorption of the image source
 			Real distance{ 0.0 };						// Distance of the image source from the listener
+			Real reflectanceBound{ 1.0 };				// Upper bound on the reflectance of the path (used to prune inaudible branches)
 			CTransform transform;						// 3DTI transform of the image source
 
 			bool valid{ false };					// True if the image source is valid, false otherwise
@@ -0,0 +1,137 @@
+/*
+* @class ImageSourceCache
+*
+* @brief Declaration of ImageSourceCache class
+*
+*/
+
+#ifndef RoomAcoustiCpp_ImageSourceCache_h
+#define RoomAcoustiCpp_ImageSourceCache_h
+
+// C++ headers
+#include <vector>
+#include <memory>
+#include <string>
+
+// Common headers
+#include "Common/Types.h"
+#include "Common/Vec3.h"
+
+// Spatialiser headers
+#include "Spatialiser/Types.h"
+#include "Spatialiser/ImageSource.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		/**
+		* @brief Class that stores baked image source trees for static sources
+		*
+		* @details Each entry holds the source side of the image source tree of a source position (the valid image sources of every order).
+		* The trees are built for a listener region (a sphere around the room) rather than a single listener position, so
+		* any listener inside the region only requires the receiver checks of the image edge model.
+		* A cache only applies to the room geometry and IEM configuration with the stored hashes.
+		*/
+		class ImageSourceCache
+		{
+		public:
+			/**
+			* @brief Struct that stores the baked image source tree of a source position
+			*/
+			struct Entry
+			{
+				Vec3 sourcePosition;			// Source position the tree was baked for
+				int numOrders{ 0 };				// Number of orders of the tree
+				ImageSourceDataStore sp;		// Valid image sources of each order
+			};
+
+			/**
+			* @brief Constructor that initialises an empty cache
+			*
+			* @param geometryHash The hash of the room geometry and materials the trees are baked for
+			* @param configHash The hash of the IEM configuration the trees are baked for
+			* @param listenerPosition The centre of the listener region
+			* @param listenerRadius The radius of the listener region
+			* @param numFrequencyBands The number of frequency bands of the image source absorption
+			*/
+			ImageSourceCache(const uint64_t geometryHash, const uint64_t configHash, const Vec3& listenerPosition, const Real listenerRadius, const int numFrequencyBands) :
+				geometryHash(geometryHash), configHash(configHash), listenerPosition(listenerPosition), listenerRadius(listenerRadius), numFrequencyBands(numFrequencyBands) {}
+
+			/**
+			* @brief Default deconstructor
+			*/
+			~ImageSourceCache() {}
+
+			/**
+			* @brief Adds a copy of the valid image sources of an image source tree
+			*
+			* @param sourcePosition The source position the tree was built for
+			* @param numOrders The number of orders of the tree to add
+			* @param sp The image sources of the tree
+			*/
+			void Add(const Vec3& sourcePosition, const int numOrders, const ImageSourceDataStore& sp);
+
+			/**
+			* @brief Finds the baked tree of a source position
+			*
+			* @param sourcePosition The source position
+			* @return The baked tree or nullptr if the position has not been baked
+			*/
+			const Entry* Find(const Vec3& sourcePosition) const;
+
+			/**
+			* @brief Writes the cache to a binary file
+			*
+			* @param filePath The path of the file to write
+			* @return True if the file was written, false otherwise
+			*/
+			bool Write(const std::string& filePath) const;
+
+			/**
+			* @brief Reads a cache written by Write
+			*
+			* @param filePath The path of the file to read
+			* @return The cache or nullptr if the file could not be read or was written by an incompatible version
+			*/
+			static std::shared_ptr<ImageSourceCache> Read(const std::string& filePath);
+
+			/**
+			* @return The hash of the room geometry and materials the trees are baked for
+			*/
+			inline uint64_t GetGeometryHash() const { return geometryHash; }
+
+			/**
+			* @return The hash of the IEM configuration the trees are baked for
+			*/
+			inline uint64_t GetConfigHash() const { return configHash; }
+
+			/**
+			* @return The centre of the listener region
+			*/
+			inline const Vec3& GetListenerPosition() const { return listenerPosition; }
+
+			/**
+			* @return The radius of the listener region
+			*/
+			inline Real GetListenerRadius() const { return listenerRadius; }
+
+			/**
+			* @return The number of baked source positions
+			*/
+			inline size_t NumEntries() const { return entries.size(); }
+
+		private:
+			uint64_t geometryHash;			// Hash of the room geometry and materials
+			uint64_t configHash;			// Hash of the IEM configuration
+			Vec3 listenerPosition;			// Centre of the listener region
+			Real listenerRadius;			// Radius of the listener region
+			int numFrequencyBands;			// Number of frequency bands of the image source absorption
+
+			std::vector<Entry> entries;		// Baked image source trees
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+* @class ImageSourceDataPool
+*
+* @brief Declaration of ImageSourceDataPool class
+*
+*/
+
+#ifndef RoomAcoustiCpp_ImageSourceDataPool_h
+#define RoomAcoustiCpp_ImageSourceDataPool_h
+
+// C++ headers
+#include <vector>
+#include <memory>
+
+// Spatialiser headers
+#include "Spatialiser/ImageSource.h"
+
+namespace RAC
+{
+	namespace Spatialiser
+	{
+		/**
+		* @brief Class that recycles image source data between image edge model passes
+		*
+		* @details The pool keeps a reference to every image source it has created. An image source is free once the pool
+		* holds the only reference, at which point it is overwritten by the next Acquire instead of allocating a new one.
+		* Free image sources are searched from a cursor that only moves forward within a pass, so a pass costs at most one sweep
+		* of the pool. Not thread safe: each pool must only be used by one thread at a time.
+		*/
+		class ImageSourceDataPool
+		{
+		public:
+			/**
+			* @brief Default constructor that initialises an empty pool
+			*/
+			ImageSourceDataPool() : cursor(0), numAllocations(0) {}
+
+			/**
+			* @brief Starts a new pass, so image sources released since the last pass can be reused
+			*/
+			inline void BeginPass() { cursor = 0; }
+
+			/**
+			* @brief Returns a copy of an image source, reusing a free image source if available
+			*
+			* @param imageSource The image source to copy
+			* @return The copy of the image source
+			*/
+			inline std::shared_ptr<ImageSourceData> Acquire(const ImageSourceData& imageSource)
+			{
+				for (; cursor < items.size(); ++cursor)
+				{
+					// Only the pool can create new references to an image source it holds the only reference to
+					if (items[cursor].use_count() == 1)
+					{
+						items[cursor]->Copy(imageSource);
+						return items[cursor++];
+					}
+				}
+				++numAllocations;
+				cursor = items.size() + 1;
+				return items.emplace_back(std::make_shared<ImageSourceData>(imageSource));
+			}
+
+			/**
+			* @return The number of image sources allocated by the pool
+			*/
+			inline size_t NumAllocations() const { return numAllocations; }
+
+			/**
+			* @return The number of image sources held by the pool
+			*/
+			inline size_t Size() const { return items.size(); }
+
+			/**
+			* @brief Releases the pool references to all image sources
+			*/
+			inline void Clear() { items.clear(); cursor = 0; }
+
+		private:
+			std::vector<std::shared_ptr<ImageSourceData>> items;	// Image sources created by the pool
+			size_t cursor;											// Index to continue searching for free image sources from
+			size_t numAllocations;									// Number of image sources allocated by the pool
+		};
+	}
+}
+
+#endif
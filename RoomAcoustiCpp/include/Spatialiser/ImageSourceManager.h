@@ -10,6 +10,10 @@
 
 // C++ headers
 #include <array>
+#include <mutex>
+
+// Common headers
+#include "Common/ActiveIndexList.h"
 
 // Spatialiser headers
 #include "Spatialiser/ImageSource.h"
@@ -24,6 +28,8 @@ namespace RAC
 	{
 		/**
 		* @brief Class that manages a fixed number of image sources
+		*
+		* @details Image sources between Init and Reset are tracked in a list of active indices, so the audio thread only visits those
 		*/
 		class ImageSourceManager
 		{
@@ -35,7 +41,7 @@ namespace RAC
 			* @params core The 3DTI processing core
 			* @params dspConfig The spatialiser configuration
 			*/
-			ImageSourceManager(Binaural::CCore* core, const std::shared_ptr<DSPConfig> dspConfig)
+			ImageSourceManager(Binaural::CCore* core, const std::shared_ptr<DSPConfig> dspConfig) : activeImageSources(MAX_IMAGESOURCES)
 			{
 				for (auto& imageSource : mImageSources)
 					imageSource.emplace(core, dspConfig);
@@ -47,21 +53,29 @@ namespace RAC
 			~ImageSourceManager() {}
 
 			/**
-			* @brief Process audio for all image sources
+			* @brief Process audio for all active image sources
 			* 
 			* @param outputBuffer The output audio buffer to write to
 			* @param lerpFactor The lerp factor for interpolation
 			*/
 			inline void ProcessAudio(Buffer<>& outputBuffer, const AudioData& audioData)
 			{
-				for (auto& imageSource : mImageSources)
-					imageSource->ProcessAudio(outputBuffer, audioData);
+				const std::shared_ptr<const std::vector<int>> active = activeImageSources.Get();
+				for (int i : *active)
+					mImageSources[i]->ProcessAudio(outputBuffer, audioData);
 			}
 
+			/**
+			* @brief Process the FDN send for all active image sources
+			*
+			* @param reverbInput The reverb input matrix to write to
+			* @param lerpFactor The lerp factor for interpolation
+			*/
 			inline void ProcessSingleFDNSend(Matrix<>& reverbInput, const Real lerpFactor)
 			{
-				for (auto& imageSource : mImageSources)
-					imageSource->ProcessSingleFDNSend(reverbInput, lerpFactor);
+				const std::shared_ptr<const std::vector<int>> active = activeImageSources.Get();
+				for (int i : *active)
+					mImageSources[i]->ProcessSingleFDNSend(reverbInput, lerpFactor);
 			}
 
 			/**
@@ -91,15 +105,52 @@ namespace RAC
 				return -1;
 			}
 
+			/**
+			* @brief Initialises an image source and marks it as active. The audio thread visits it after the next PublishActive
+			*
+			* @param id The ID of the image source, from NextID
+			* @param sourceBuffer The input buffer of the parent source
+			* @param dspConfig The spatialiser configuration
+			* @param data The image source data
+			* @param fdnChannel The FDN channel the image source feeds, or -1
+			*/
+			inline void Init(const size_t id, const Buffer<>* sourceBuffer, const std::shared_ptr<DSPConfig>& dspConfig, const std::shared_ptr<ImageSourceData>& data, int fdnChannel)
+			{
+				std::lock_guard<std::mutex> lock(activeImageSourcesMutex);
+				activeImageSources.Add(id);
+				mImageSources[id]->Init(sourceBuffer, dspConfig, data, fdnChannel);
+			}
+
+			/**
+			* @brief Publishes any image sources initialised since the last call to the audio thread
+			*/
+			inline void PublishActive()
+			{
+				std::lock_guard<std::mutex> lock(activeImageSourcesMutex);
+				activeImageSources.Publish();
+			}
+
 			/**
 			* @brief Reset any unused image sources
 			*/
 			inline void Reset()
 			{
-				for (auto& imageSource : mImageSources)
-					imageSource->Reset();
+				std::lock_guard<std::mutex> lock(activeImageSourcesMutex);
+				const std::shared_ptr<const std::vector<int>> active = activeImageSources.Get();
+				for (int i : *active)
+				{
+					mImageSources[i]->Reset();
+					if (mImageSources[i]->IsReset())
+						activeImageSources.Remove(i);
+				}
+				activeImageSources.Publish();
 			}
 
+			/**
+			* @return The indices of the active image sources, in ascending order
+			*/
+			inline std::shared_ptr<const std::vector<int>> GetActive() const { return activeImageSources.Get(); }
+
 			/**
 			* @brief Access a specific image source by index
 			* 
@@ -118,6 +169,9 @@ namespace RAC
 
 		private:
 			std::array<std::optional<ImageSource>, MAX_IMAGESOURCES> mImageSources;		// Image sources for the audio thread
+
+			ActiveIndexList activeImageSources;		// Image sources between Init and Reset
+			std::mutex activeImageSourcesMutex;		// Protects changes to activeImageSources
 		};
 	}
 }
@@ -262,6 +262,24 @@ namespace RAC
 		*/
 		void UpdatePlanesAndEdges();
 
+		/**
+		* @brief Bakes the image source trees of the current sources for a listener anywhere in the room.
+		* @details Blocks until the file has been written. Should be called after UpdatePlanesAndEdges once all static sources are placed.
+		*
+		* @param filePath The path of the file to write.
+		* @return True if the file was written, false otherwise.
+		*/
+		bool BakeImageSources(const std::string& filePath);
+
+		/**
+		* @brief Loads image source trees baked with BakeImageSources.
+		* @details The baked trees are only used while the room geometry and IEM configuration match those of the bake.
+		*
+		* @param filePath The path of the baked file.
+		* @return True if the file was loaded, false otherwise.
+		*/
+		bool LoadImageSourceCache(const std::string& filePath);
+
 		/**
 		* @brief Updates the late reverberation gain.
 		* 
@@ -0,0 +1,83 @@
+/*
+* @class ReflectionBatch
+*
+* @brief Declaration of ReflectionBatch class
+*
+*/
+
+#ifndef RoomAcoustiCpp_ReflectionBatch_h
+#define RoomAcoustiCpp_ReflectionBatch_h
+
+// C++ headers
+#include <vector>
+#include <cstdint>
+
+// Common headers
+#include "Common/Types.h"
+#include "Common/Vec3.h"
+
+// Spatialiser headers
+#include "Spatialiser/Wall.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		/**
+		* @brief Class that stores a block of image source positions in structure of arrays layout
+		*
+		* @details Used by the image edge model to reflect all image sources of an order that share a candidate plane at once.
+		* The culls are evaluated with AVX (or SSE2) lanes when available and with a scalar loop otherwise.
+		* Results are conservative: an image source that passes Plane::ReflectPointInPlane and the path length cull always passes,
+		* so the exact checks of the image edge model must still be run for the image sources that pass.
+		*/
+		class ReflectionBatch
+		{
+		public:
+			/**
+			* @brief Default constructor that initialises an empty batch
+			*/
+			ReflectionBatch() {}
+
+			/**
+			* @brief Default deconstructor
+			*/
+			~ReflectionBatch() {}
+
+			/**
+			* @brief Removes all positions from the batch. The storage is kept for reuse
+			*/
+			inline void Clear() { x.clear(); y.clear(); z.clear(); }
+
+			/**
+			* @brief Adds a position to the end of the batch
+			*
+			* @param position The image source position
+			*/
+			inline void Add(const Vec3& position) { x.push_back(position.x()); y.push_back(position.y()); z.push_back(position.z()); }
+
+			/**
+			* @return The number of positions in the batch
+			*/
+			inline size_t Size() const { return x.size(); }
+
+			/**
+			* @brief Reflects every position in the batch in a plane and evaluates the validity and path length culls
+			*
+			* @param plane The plane to reflect the positions in
+			* @param listenerPosition The listener position
+			* @param maxDistance The maximum distance between a reflected position and the listener
+			* @param mask Output with one entry per position. 1 if the position is in front of the plane and its reflection lies within maxDistance of the listener, 0 otherwise
+			*/
+			void Cull(const Plane& plane, const Vec3& listenerPosition, const Real maxDistance, uint8_t* mask) const;
+
+		private:
+			std::vector<Real> x;	// x coordinates of the positions
+			std::vector<Real> y;	// y coordinates of the positions
+			std::vector<Real> z;	// z coordinates of the positions
+		};
+	}
+}
+
+#endif
@@ -10,7 +10,10 @@
 
 // C++ headers
 #include <vector>
+#include <algorithm>
 #include <mutex>
+#include <memory>
+#include <atomic>
 
 // Common headers
 #include "Common/Definitions.h"
@@ -23,6 +26,7 @@
 #include "Spatialiser/Wall.h"
 #include "Spatialiser/Edge.h"
 #include "Spatialiser/TracingTypes.h"
+#include "Spatialiser/RoomSnapshot.h"
 
 namespace RAC
 {
@@ -44,7 +48,7 @@ namespace RAC
 			* 
 			* @params numFrequencyBands The number of frequency bands to use
 			*/
-			Room(const int numFrequencyBands) : roomData(numFrequencyBands), numFrequencyBands(numFrequencyBands), hasChanged(true) {}
+			Room(const int numFrequencyBands) : version(1), roomData(numFrequencyBands), numFrequencyBands(numFrequencyBands) {}
 			
 			/**
 			* @brief Default deconstructor
@@ -164,12 +168,20 @@ namespace RAC
 			inline Vec<> GetDimensions() { std::lock_guard<std::mutex> lock(roomDataMutex); return roomData.dimensions; }
 
 			/**
-			* @return True if the room geometry has changed since last check, false otherwise
+			* @return The current version of the room geometry (incremented on every change)
 			*/
-			bool HasChanged()
-			{
-				return hasChanged.exchange(false, std::memory_order_acq_rel);
-			}
+			inline uint64_t GetVersion() const { return version.load(std::memory_order_acquire); }
+
+			/**
+			* @brief Returns an immutable snapshot of the current room geometry
+			*
+			* @details A new snapshot is created and published by the first call after the geometry changes.
+			* Later calls share the published snapshot until the next change, so the geometry is only copied once per change.
+			* Thread safe.
+			*
+			* @return The snapshot of the room geometry
+			*/
+			std::shared_ptr<const RoomSnapshot> GetSnapshot();
 
 			/**
 			* @return The planes of the room
@@ -196,10 +208,6 @@ namespace RAC
 			*/
 			EdgeMap GetEdges() { std::lock_guard<std::mutex> lock(mEdgeMutex); return mEdges; }
 
-			void CreateTriangleMeshSoA();
-
-			inline const TriangleMeshSoA& GetTriangleMeshSoA() const { return mTriangleMeshSoA; }
-
 		private:
 			/**
 			* @brief Assign a wall to a plane
@@ -298,12 +306,12 @@ namespace RAC
 			inline std::vector<size_t> UpdateEdges(const std::vector<size_t>& IDs, const std::vector<Edge>& edges)
 			{
 				std::vector<size_t> removeIDs;
-				int i = 0;
-				for (const Edge& edge : edges)
+				// More edges than IDs can be found between two walls (e.g. both sides of a two sided wall)
+				const size_t numEdges = std::min(IDs.size(), edges.size());
+				for (size_t i = 0; i < numEdges; ++i)
 				{
-					if (UpdateEdge(IDs[i], edge))
+					if (UpdateEdge(IDs[i], edges[i]))
 						removeIDs.push_back(IDs[i]);
-					i++;
 				}
 				return removeIDs;
 			}
@@ -347,7 +355,7 @@ namespace RAC
 			/**
 			* @brief Record a change in the room geometry
 			*/
-			void RecordChange() { hasChanged.store(true, std::memory_order_release); }
+			void RecordChange() { version.fetch_add(1, std::memory_order_acq_rel); }
 
 			/**
 			* @brief Calculate the reverb time of the room using the Sabine formula
@@ -368,7 +376,8 @@ namespace RAC
 			*/
 			Coefficients<> Eyring(const Coefficients<>& absorption, const Real& surfaceArea) const;
 
-			std::atomic<bool> hasChanged;		// True if the room geometry has changed since last check
+			std::atomic<uint64_t> version;						// Version of the room geometry. Incremented on every change
+			std::shared_ptr<const RoomSnapshot> mSnapshot;		// Latest published snapshot (accessed with std::atomic_load/std::atomic_store)
 
 			RoomData roomData;					// Data about the room
 			int numFrequencyBands;				// Number of frequency bands for wall absorption
@@ -377,7 +386,6 @@ namespace RAC
 			std::vector<size_t> mEmptyWallSlots;		// Available wall IDs
 			std::vector<TimerPair> mWallTimers;			// Wall IDs waiting to be made available
 			size_t nextWall{ 0 };							// Next wall ID if none are available
-			TriangleMeshSoA mTriangleMeshSoA;			// Triangle mesh for ray tracing
 
 			PlaneMap mPlanes;							// Stored planes
 			std::vector<size_t> mEmptyPlaneSlots;		// Available plane IDs
@@ -398,6 +406,7 @@ namespace RAC
 			std::mutex mMaterialMutex;		// Protects mMaterials
 			std::mutex mEdgeMutex;		// Protects mEdges. Cannot be locked after Plane
 			std::mutex roomDataMutex;	// Protects roomData
+			std::mutex mSnapshotMutex;	// Serialises snapshot creation
 		};
 	}
 }
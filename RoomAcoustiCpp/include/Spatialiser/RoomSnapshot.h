@@ -0,0 +1,286 @@
+/*
+* @class RoomSnapshot
+*
+* @brief Declaration of RoomSnapshot class
+*
+*/
+
+#ifndef RoomAcoustiCpp_RoomSnapshot_h
+#define RoomAcoustiCpp_RoomSnapshot_h
+
+// C++ headers
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+// Common headers
+#include "Common/Definitions.h"
+#include "Common/Types.h"
+#include "Common/Coefficients.h"
+
+// Spatialiser headers
+#include "Spatialiser/Types.h"
+#include "Spatialiser/Wall.h"
+#include "Spatialiser/Edge.h"
+#include "Spatialiser/WallBVH.h"
+#include "Spatialiser/EdgeBVH.h"
+#include "Spatialiser/TracingTypes.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		/**
+		* @brief Class that stores an immutable copy of the room geometry
+		*
+		* @details Planes, walls, materials and edges are stored in dense arrays sorted by ID with an ID to index table for lookups.
+		* The wall and edge BVHs, ray tracing triangle mesh and plane and edge visibility tables are built once per snapshot.
+		* Snapshots are created and published by Room and shared read only (through std::shared_ptr<const RoomSnapshot>)
+		* by the image edge model and ray tracing threads, so no consumer copies the geometry.
+		*/
+		class RoomSnapshot
+		{
+		public:
+			/**
+			* @brief Constructor that copies the given room geometry into dense arrays
+			*
+			* @param version The room version the geometry belongs to
+			* @param planes The planes in the room
+			* @param walls The walls in the room
+			* @param materials The materials in the room (stores reflectance)
+			* @param edges The edges in the room
+			*/
+			RoomSnapshot(const uint64_t version, const PlaneMap& planes, const WallMap& walls, const MaterialMap& materials, const EdgeMap& edges);
+
+			/**
+			* @brief Default deconstructor
+			*/
+			~RoomSnapshot() {}
+
+			/**
+			* @return The room version the snapshot was created from
+			*/
+			inline uint64_t GetVersion() const { return version; }
+
+			/**
+			* @return A hash of the room geometry and materials. Unlike the version, equal rooms built separately share the same hash
+			*/
+			inline uint64_t GetGeometryHash() const { return geometryHash; }
+
+			/**
+			* @return The number of planes in the room
+			*/
+			inline size_t NumPlanes() const { return mPlanes.items.size(); }
+
+			/**
+			* @return The plane at the given dense index
+			*/
+			inline const Plane& GetPlane(const size_t idx) const { return mPlanes.items[idx]; }
+
+			/**
+			* @return The ID of the plane at the given dense index
+			*/
+			inline size_t GetPlaneID(const size_t idx) const { return mPlanes.ids[idx]; }
+
+			/**
+			* @return The plane with the given ID or nullptr if it does not exist
+			*/
+			inline const Plane* FindPlane(const size_t id) const { return mPlanes.Find(id); }
+
+			/**
+			* @return The dense index of the plane with the given ID or -1 if it does not exist
+			*/
+			inline int FindPlaneIndex(const size_t id) const { return mPlanes.FindIndex(id); }
+
+			/**
+			* @return The number of walls in the room
+			*/
+			inline size_t NumWalls() const { return mWalls.items.size(); }
+
+			/**
+			* @return The wall at the given dense index
+			*/
+			inline const Wall& GetWall(const size_t idx) const { return mWalls.items[idx]; }
+
+			/**
+			* @return The ID of the wall at the given dense index
+			*/
+			inline size_t GetWallID(const size_t idx) const { return mWalls.ids[idx]; }
+
+			/**
+			* @return The wall with the given ID or nullptr if it does not exist
+			*/
+			inline const Wall* FindWall(const size_t id) const { return mWalls.Find(id); }
+
+			/**
+			* @return The number of materials in the room
+			*/
+			inline size_t NumMaterials() const { return mMaterials.items.size(); }
+
+			/**
+			* @return The reflectance of the material with the given ID or nullptr if it does not exist
+			*/
+			inline const Coefficients<>* FindMaterial(const size_t id) const { return mMaterials.Find(id); }
+
+			/**
+			* @return The number of edges in the room
+			*/
+			inline size_t NumEdges() const { return mEdges.items.size(); }
+
+			/**
+			* @return The edge at the given dense index
+			*/
+			inline const Edge& GetEdge(const size_t idx) const { return mEdges.items[idx]; }
+
+			/**
+			* @return The ID of the edge at the given dense index
+			*/
+			inline size_t GetEdgeID(const size_t idx) const { return mEdges.ids[idx]; }
+
+			/**
+			* @return The edge with the given ID or nullptr if it does not exist
+			*/
+			inline const Edge* FindEdge(const size_t id) const { return mEdges.Find(id); }
+
+			/**
+			* @return The dense index of the edge with the given ID or -1 if it does not exist
+			*/
+			inline int FindEdgeIndex(const size_t id) const { return mEdges.FindIndex(id); }
+
+			/**
+			* @return The BVH over the walls of the room
+			*/
+			inline const WallBVH& GetWallBVH() const { return mWallBVH; }
+
+			/**
+			* @return The BVH over the edges of the room (stores dense edge indices)
+			*/
+			inline const EdgeBVH& GetEdgeBVH() const { return mEdgeBVH; }
+
+			/**
+			* @return The triangle mesh used for ray tracing (one triangle per wall in dense wall order)
+			*/
+			inline const TriangleMeshSoA& GetTriangleMeshSoA() const { return mTriangleMeshSoA; }
+
+			/**
+			* @return The dense indices of the planes that a path can reflect in after reflecting in the given plane
+			*/
+			inline const std::vector<size_t>& GetPlanesVisibleFromPlane(const size_t planeIdx) const { return mPlanePlanes[planeIdx]; }
+
+			/**
+			* @return The dense indices of the edges that a path can diffract around after reflecting in the given plane
+			*/
+			inline const std::vector<size_t>& GetEdgesVisibleFromPlane(const size_t planeIdx) const { return mPlaneEdges[planeIdx]; }
+
+			/**
+			* @return The dense indices of the planes that a path can reflect in after diffracting around the given edge
+			*/
+			inline const std::vector<size_t>& GetPlanesVisibleFromEdge(const size_t edgeIdx) const { return mEdgePlanes[edgeIdx]; }
+
+			/**
+			* @return The largest reflectance (over walls and frequency bands) of the plane at the given dense index
+			*/
+			inline Real GetMaxPlaneReflectance(const size_t planeIdx) const { return mMaxPlaneReflectances[planeIdx]; }
+
+		private:
+			/**
+			* @brief Stores items in a dense array sorted by ID with an ID to index table
+			*/
+			template <typename T>
+			struct DenseTable
+			{
+				std::vector<T> items;			// Items sorted by ID
+				std::vector<size_t> ids;		// ID of each item
+				std::vector<int> index;			// Index of each ID in items (-1 if the ID does not exist). Empty if the IDs are too sparse
+
+				/**
+				* @brief Copies the items of an ID keyed map into the table
+				*/
+				template <typename Map>
+				void Build(const Map& map)
+				{
+					ids.reserve(map.size());
+					for (const auto& [id, item] : map)
+						ids.push_back(id);
+					std::sort(ids.begin(), ids.end());
+
+					items.reserve(ids.size());
+					for (const size_t id : ids)
+						items.push_back(map.at(id));
+
+					// IDs are reused slots so are normally dense. Fall back to a binary search if set manually to large values
+					if (ids.empty() || ids.back() > 4 * ids.size() + 64)
+						return;
+					index.assign(ids.back() + 1, -1);
+					for (size_t i = 0; i < ids.size(); ++i)
+						index[ids[i]] = static_cast<int>(i);
+				}
+
+				/**
+				* @return The index of the item with the given ID or -1 if it does not exist
+				*/
+				inline int FindIndex(const size_t id) const
+				{
+					if (!index.empty())
+						return id < index.size() ? index[id] : -1;
+					auto it = std::lower_bound(ids.begin(), ids.end(), id);
+					if (it == ids.end() || *it != id)
+						return -1;
+					return static_cast<int>(it - ids.begin());
+				}
+
+				/**
+				* @return The item with the given ID or nullptr if it does not exist
+				*/
+				inline const T* Find(const size_t id) const
+				{
+					const int idx = FindIndex(id);
+					return idx < 0 ? nullptr : &items[idx];
+				}
+			};
+
+			/**
+			* @brief Creates the ray tracing triangle mesh from the walls
+			*/
+			void CreateTriangleMeshSoA();
+
+			/**
+			* @brief Creates the plane to plane, plane to edge and edge to plane visibility tables
+			*
+			* @details The tables are conservative. A pair is only removed if no path segment between them can pass the
+			* reflection and diffraction checks of the image edge model (front facing tests against the wall vertices).
+			*/
+			void CreateVisibilityTables();
+
+			/**
+			* @brief Creates the largest reflectance of each plane used to bound the energy of image source paths
+			*/
+			void CreateMaxPlaneReflectances();
+
+			/**
+			* @brief Creates the hash of the planes, walls, materials and edges
+			*/
+			void CreateGeometryHash();
+
+			uint64_t version;						// Room version the snapshot was created from
+			uint64_t geometryHash{ 0 };				// Hash of the room geometry and materials
+
+			DenseTable<Plane> mPlanes;				// Stored planes
+			DenseTable<Wall> mWalls;				// Stored walls
+			DenseTable<Coefficients<>> mMaterials;	// Stored materials (stores reflectance)
+			DenseTable<Edge> mEdges;				// Stored edges
+
+			WallBVH mWallBVH;						// BVH over walls for obstruction and intersection queries
+			EdgeBVH mEdgeBVH;						// BVH over edges for diffraction candidate queries
+			TriangleMeshSoA mTriangleMeshSoA;		// Triangle mesh for ray tracing
+
+			std::vector<std::vector<size_t>> mPlanePlanes;		// Planes visible from each plane (dense indices)
+			std::vector<std::vector<size_t>> mPlaneEdges;		// Edges visible from each plane (dense indices)
+			std::vector<std::vector<size_t>> mEdgePlanes;		// Planes visible from each edge (dense indices)
+			std::vector<Real> mMaxPlaneReflectances;			// Largest reflectance of each plane (dense indices)
+		};
+	}
+}
+
+#endif
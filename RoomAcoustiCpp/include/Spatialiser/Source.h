@@ -26,6 +26,7 @@
 #include "Spatialiser/Types.h"
 #include "Spatialiser/AirAbsorption.h"
 #include "Spatialiser/ImageSource.h"
+#include "Spatialiser/ImageSourceDataPool.h"
 #include "Spatialiser/ImageSourceManager.h"
 // RAVES headers
 #include "Spatialiser/RAVESResidue.h"
@@ -290,6 +291,11 @@ namespace RAC
 			*/
 			bool IsReset() const { return isReset.load(std::memory_order_acquire); }
 
+			/**
+			* @return True if the input buffer has been cleared since the source was removed, false otherwise
+			*/
+			bool IsInputBufferCleared() const { return !clearInputBuffer.load(std::memory_order_acquire); }
+
 		private:
 			/**
 			* @brief Flags all current image sources for removal
@@ -298,7 +304,10 @@ namespace RAC
 			{
 				lock_guard<std::mutex>lock(*imageSourcesMutex);
 				for (auto& [key, vSource] : currentImageSources)
-					imageSources.at(vSource.first).Remove();
+				{
+					if (vSource.first >= 0)		// Image sources are only assigned a slot once UpdateImageSources has run
+						imageSources.at(vSource.first).Remove();
+				}
 			}
 
 			/**
@@ -363,9 +372,19 @@ namespace RAC
 
 			/**
 			* @brief Updates the current image sources from the target image sources
+			*
+			* @details A target image source whose key matches a current image source with a different path (a key collision)
+			* replaces it as a new image source, so the audio of two different paths is never interpolated.
 			*/
 			void UpdateImageSourceDataMap(ImageSourceDataMap& imageSourceData);
 
+			/**
+			* @brief Removes an audio thread image source immediately and frees its FDN channel
+			*
+			* @param id The ID of the image source, or -1 if it has not been assigned a slot
+			*/
+			void RemoveImageSource(const int id);
+
 			/**
 			* @brief Updates the audio thread image sources from the current image sources
 			*/
@@ -414,6 +433,7 @@ namespace RAC
 			bool modartSendProcessed{ false };		// True if the MoDART reverb send has been processed this frame, false otherwise
 
 			ImageSourceDataAudioMap currentImageSources;	// Current image sources
+			ImageSourceDataPool imageSourceDataPool;		// Recycles the copies of new image sources in currentImageSources
 			std::vector<int> freeFDNChannels;				// Free FDN channels
 
 			Binaural::CCore* mCore;										// 3DTI core
@@ -15,6 +15,7 @@
 // Common headers
 #include "Common/Types.h"
 #include "Common/RACProfiler.h"
+#include "Common/ActiveIndexList.h"
 
 // Spatialiser headers
 #include "Spatialiser/Globals.h"
@@ -36,6 +37,8 @@ namespace RAC
 
 		/**
 		* @brief Class that stores, updates and process all sound sources and image sources
+		*
+		* @details Sources are tracked in a list of active indices from Init until they are reset, so the audio thread only visits those
 		*/
 		class SourceManager
 		{
@@ -48,7 +51,7 @@ namespace RAC
 			* @params dspConfig The spatialiser configuration
 			*/
 			SourceManager(Binaural::CCore* core, const std::shared_ptr<DSPConfig> dspConfig)
-				: mCore(core), dspConfig(dspConfig), mImageSources(core, dspConfig), frequencyIndexing(1)
+				: mCore(core), dspConfig(dspConfig), mImageSources(core, dspConfig), activeSources(MAX_SOURCES), frequencyIndexing(1)
 			{
 				for (auto& sources : mSources)
 					sources.emplace(core, mImageSources, dspConfig);
@@ -183,6 +186,7 @@ namespace RAC
 			{
 				PROFILE_UpdateAudioData
 				mSources[id]->UpdateData(source, vSources, dspConfig);
+				mImageSources.PublishActive();
 			}
 
 			/**
@@ -199,12 +203,7 @@ namespace RAC
 			/**
 			* @brief Resets any unused sources
 			*/
-			inline void ResetUnusedSources()
-			{
-				for (auto& source : mSources)
-					source->Reset();
-				mImageSources.Reset();
-			}
+			void ResetUnusedSources();
 
 			/**
 			* @brief Process a single audio frame for a given source
@@ -220,14 +219,17 @@ namespace RAC
 
 			inline void ResetInputBuffers()
 			{
-				for (auto& source : mSources)	// Zero any input buffers for sources that are not in use (but may still have image sources)
-					source->ResetInputBuffer();
+				const std::shared_ptr<const std::vector<int>> active = activeSources.Get();
+				for (int i : *active)	// Zero any input buffers for sources that are not in use (but may still have image sources)
+					mSources[i]->ResetInputBuffer();
 			}
 
 			inline void ProcessAudio(Buffer<>& outputBuffer, const AudioData& audioData)
 			{
 				PROFILE_EarlyReflections
-				audioThreadPool->ProcessAllSources(mSources, mImageSources, outputBuffer, audioData);
+				const std::shared_ptr<const std::vector<int>> active = activeSources.Get();
+				const std::shared_ptr<const std::vector<int>> activeImageSources = mImageSources.GetActive();
+				audioThreadPool->ProcessAllSources(mSources, *active, mImageSources, *activeImageSources, outputBuffer, audioData);
 				/*for (auto& source : mSources)
 					source->ProcessAudio(outputBuffer, audioData);
 				mImageSources.ProcessAudio(outputBuffer, audioData);*/
@@ -242,15 +244,21 @@ namespace RAC
 				case LateReverbModel::none:
 					return;
 				case LateReverbModel::raves:
-					for (auto& source : mSources)
-						source->ProcessMoDARTSend(reverbInput, audioData.lerpFactor);
+				{
+					const std::shared_ptr<const std::vector<int>> active = activeSources.Get();
+					for (int i : *active)
+						mSources[i]->ProcessMoDARTSend(reverbInput, audioData.lerpFactor);
 					break;
+				}
 				case LateReverbModel::fdn:
-					for (auto& source : mSources)
-						source->ProcessSingleFDNSend(reverbInput, audioData.lerpFactor);
+				{
+					const std::shared_ptr<const std::vector<int>> active = activeSources.Get();
+					for (int i : *active)
+						mSources[i]->ProcessSingleFDNSend(reverbInput, audioData.lerpFactor);
 					mImageSources.ProcessSingleFDNSend(reverbInput, audioData.lerpFactor);
 					break;
 				}
+				}
 			}
 
 		private:
@@ -258,8 +266,11 @@ namespace RAC
 
 			std::shared_ptr<DSPConfig> dspConfig;			// Spatialiser configuration
 
+			ImageSourceManager mImageSources;							// Image sources for the audio thread (declared first as the sources reference it)
 			std::array<std::optional<Source>, MAX_SOURCES> mSources;	// Sources for the audio thread
-			ImageSourceManager mImageSources;							// Image sources for the audio thread
+
+			ActiveIndexList activeSources;			// Sources from Init until reset (and their input buffer is cleared)
+			std::mutex activeSourcesMutex;			// Protects changes to activeSources
 
 			std::mutex frequencyIndexingMutex;		// Mutex to protect frequency indexing
 			Vec<int> frequencyIndexing;				// Frequency band indexing for MoDART source residues
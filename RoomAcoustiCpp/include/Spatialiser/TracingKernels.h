@@ -0,0 +1,60 @@
+/*
+* @brief Defines SIMD kernels for basic ray-tracing
+*/
+
+#ifndef Tracing_Kernels_h
+#define Tracing_Kernels_h
+
+// C++ headers
+#include <cstdint>
+
+#include "Common/Vec3.h"
+#include "Spatialiser/TracingTypes.h"
+
+namespace RAC
+{
+    using namespace Common;
+    namespace Spatialiser
+    {
+        /**
+         * @brief Check whether the AVX2 kernels can run on this CPU.
+         * The CPU is only queried on the first call.
+         *
+         * @return true if the CPU and operating system support AVX2 and FMA instructions; otherwise false.
+         */
+        bool cpu_supports_avx2();
+
+        /**
+         * @brief Reject triangles that cannot intersect one ray, TRIANGLE_BLOCK_SIZE triangles at a time.
+         * Uses AVX2 and FMA instructions in single precision, so must only be called if cpu_supports_avx2() returns true.
+         *
+         * The kernel evaluates the facing, parallel and edge tests of intersection_test with tolerances widened by a bound
+         * on the single precision rounding error. A triangle is only rejected if intersection_test would also reject it.
+         *
+         * @param blocks Single precision copy of the triangles.
+         * @param firstBlock Index of the first block to test.
+         * @param numBlocks Number of blocks to test.
+         * @param O Ray origin.
+         * @param D Ray direction.
+         * @param masks Output buffer with one entry per block. Bit j is set if triangle (block * TRIANGLE_BLOCK_SIZE + j) may intersect the ray.
+         */
+        void filter_triangles_avx2(const TriangleBlockSoA& blocks, int firstBlock, int numBlocks,
+            const Vec3& O, const Vec3& D, uint8_t* masks);
+
+        /**
+         * @brief Reject triangles from a list that cannot intersect one ray, TRIANGLE_BLOCK_SIZE triangles at a time.
+         * Same tests as filter_triangles_avx2, with the triangles gathered by index. Must only be called if cpu_supports_avx2() returns true.
+         *
+         * @param blocks Single precision copy of the triangles.
+         * @param candidates Indices of the triangles to test.
+         * @param numCandidates Number of triangles to test.
+         * @param O Ray origin.
+         * @param D Ray direction.
+         * @param masks Output buffer with one entry per TRIANGLE_BLOCK_SIZE candidates. Bit j is set if candidate (block * TRIANGLE_BLOCK_SIZE + j) may intersect the ray.
+         */
+        void filter_candidates_avx2(const TriangleBlockSoA& blocks, const int* candidates, int numCandidates,
+            const Vec3& O, const Vec3& D, uint8_t* masks);
+    }
+}
+
+#endif
@@ -5,8 +5,13 @@
 #ifndef Tracing_Thread_h
 #define Tracing_Thread_h
 
+// C++ headers
+#include <atomic>
+#include <random>
+
 // Common headers
 #include "Common/Vec3.h" 
+#include "Common/ThreadPool.h"
 
 // Spatialiser headers
 #include "Spatialiser/Types.h"
@@ -20,6 +25,74 @@ namespace RAC
 	using namespace Common;
 	namespace Spatialiser
 	{
+		/**
+		* @brief Class that stores the accumulation state of one position (listener or source) in progressive mode.
+		*
+		* @details Each update traces a randomly rotated subset of the rays. Updates are averaged until the target has
+		* accumulated all the rays, then old updates are forgotten exponentially. A reverb direction may receive no rays in
+		* an update, so each direction counts its own updates and its weight does not depend on the updates it missed.
+		*/
+		class ProgressiveTarget
+		{
+		public:
+			/**
+			* @brief Default constructor for a target without reverb directions (e.g. a source).
+			*/
+			ProgressiveTarget() {}
+
+			/**
+			* @brief Constructor for a target that accumulates each reverb direction separately (e.g. the listener).
+			*
+			* @param numDirections The number of reverb directions.
+			*/
+			ProgressiveTarget(int numDirections) : directionUpdates(std::max(numDirections, 0), 0) {}
+
+			/**
+			* @brief Forgets all updates, so the next update restarts the accumulation.
+			*/
+			void Reset();
+
+			/**
+			* @brief Records an update of the target, restarting the accumulation if it moved further than restartThreshold.
+			*
+			* @param position The position of the new update.
+			* @param restartThreshold Distance (in meters) from the position of the last restart which restarts the accumulation.
+			* @param smoothing Weight of each new update once the target has converged.
+			* @return The weight of the new update in the accumulated result (1 after a restart).
+			*/
+			Real BeginUpdate(const Vec3& position, Real restartThreshold, Real smoothing);
+
+			/**
+			* @brief Records that a reverb direction received rays in the current update.
+			*
+			* @param dir_idx The index of the reverb direction.
+			* @param smoothing Weight of each new update once the direction has converged.
+			* @return The weight of the new update in the accumulated result of the direction (1 for its first update).
+			*/
+			Real UpdateDirection(int dir_idx, Real smoothing);
+
+			/**
+			* @brief Check whether the target needs another update, i.e. it has had fewer than updatesToConverge updates or has moved since the latest update.
+			*/
+			bool NeedsRefinement(const Vec3& position, int updatesToConverge) const;
+
+			/**
+			* @return The number of updates accumulated since the last restart (0 if never traced).
+			*/
+			inline int GetNumUpdates() const { return numUpdates; }
+
+			/**
+			* @return The number of updates accumulated by a reverb direction since the last restart.
+			*/
+			inline int GetNumDirectionUpdates(int dir_idx) const { return directionUpdates[dir_idx]; }
+
+		private:
+			Vec3 anchor;						// Position when the accumulation last restarted
+			Vec3 position;						// Position of the latest update
+			int numUpdates{ 0 };				// Number of updates accumulated since the last restart (0 if never traced)
+			std::vector<int> directionUpdates;	// Number of updates accumulated by each reverb direction since the last restart
+		};
+
 		/**
 		* @brief Class that runs the ray-tracing.
 		*/
@@ -75,32 +148,70 @@ namespace RAC
 			*/
 			virtual void RunTracing() = 0;
 
-			inline void ResetEndFlag()
-			{
-				while (!tracingStartFlag.load(std::memory_order_acquire))
-					std::this_thread::yield();
-				tracingEndFlag.store(false, std::memory_order_release);
-			}
-
-			inline bool HasCompleted() { return tracingEndFlag.load(std::memory_order_acquire); }
+			/**
+			* @brief Check whether progressive tracing needs more updates to converge at the latest positions.
+			*
+			* @return True if another call to RunTracing() would refine the results, false otherwise.
+			*/
+			inline bool IsRefining() const { return mRefining.load(std::memory_order_acquire); }
 
 		protected:
+			/**
+			* @brief True if each update traces a subset of the rays (progressiveRays < numRays).
+			*/
+			inline bool IsProgressive() const { return numPencilRays < numRays; }
+
+			/**
+			* @brief Assigns each ray of hemispherePencil to its nearest reverb direction.
+			*/
+			void UpdateClusters();
+
+			/**
+			* @brief Applies a new random rotation to the directions of hemispherePencil and updates the clusters.
+			*/
+			void RotatePencil();
+
+			/**
+			* @brief Check whether a target needs another update, i.e. it has not accumulated numRays rays or has moved since the latest update.
+			*/
+			inline bool NeedsRefinement(const ProgressiveTarget& target, const Vec3& position) const { return target.NeedsRefinement(position, updatesToConverge); }
+
+			/**
+			* @brief Records an update of a target, restarting the accumulation if it moved further than restartThreshold.
+			*
+			* @return The weight of the new update in the accumulated result (1 after a restart).
+			*/
+			inline Real BeginUpdate(ProgressiveTarget& target, const Vec3& position, Real restartThreshold) const { return target.BeginUpdate(position, restartThreshold, smoothing); }
+
 			weak_ptr<Room> mRoom;							// Pointer to the room class
 			weak_ptr<SourceManager> mSourceManager;			// Pointer to the source manager class
 			weak_ptr<Reverb> mReverb;						// Pointer to the late reverb class
 			std::mutex rayPencilMutex;						// Protects hemispherePencil
+			std::unique_ptr<ThreadPool> mThreadPool;		// Threads that trace rays alongside the ray tracing thread (null if tracing on one thread)
 
 			// The number of reverb directions is assumed unchanging.
 			int numReverbDirections;
 			std::vector<Vec3> reverbDirections;
+			DirectionLookup reverbDirectionLookup;	// Finds the nearest reverb direction to each ray
 			// The indexing of ray directions to reverb directions may change because the number of rays may change.
-			Vec<int> rayClusters;			// This will have size `numRays`. For each ray, the index of the reverb direction that the ray falls into.
+			Vec<int> rayClusters;			// This will have size `numPencilRays`. For each ray, the index of the reverb direction that the ray falls into.
 			Vec<int> clustersSizes;			// This will have size `numReverbDirections`. For each reverb direction, the number of rays that fall into it.
 
 			// The number of rays may change at runtime.
 			int numRays;
 			RayPencil hemispherePencil;				// A set of ray directions (relative to the frame of reference) used for all tracing
 
+			// Progressive mode traces a randomly rotated pencil of `numPencilRays` rays on each update and smooths the results over time.
+			int progressiveRays;					// Rays traced on each update in progressive mode (0 to trace all numRays)
+			int numPencilRays;						// Rays traced on each update (numRays, or progressiveRays in progressive mode)
+			int updatesToConverge;					// Number of updates that trace numRays rays
+			Real smoothing;							// Weight of each new update once a target has converged
+			bool restartProgress = false;			// Set when the pencil changes, so every target restarts its accumulation
+			std::vector<Vec3> referenceDirections;	// Unrotated directions of hemispherePencil (excluding mirror copies)
+			std::vector<Vec3> rotatedDirections;	// Rotated directions of hemispherePencil (excluding mirror copies)
+			std::mt19937 rng;						// Random rotations of the pencil
+			std::atomic<bool> mRefining{ false };	// True if a target has not converged after the latest call to RunTracing()
+
 			// The number of sources may change at runtime.
 			std::vector<Source::Data> mSources;		// Stores information about each source (id, position, ...)
 
@@ -109,14 +220,11 @@ namespace RAC
 			Vec3 mListenerPositionIncoming;			// The listener position (Mutex must be locked to access)
 			std::mutex dataStoreMutex;				// Protects mListenerPositionStore
 
-			std::atomic<bool> tracingStartFlag{ false };	// True if the ray tracing is running, false otherwise
-			std::atomic<bool> tracingEndFlag{ false };		// True if the ray tracing has finished running, false otherwise
-
-			// These will be used exclusively inside `ComputeEnergyContributions`. All four will have size `numRays`.
-			Vec<Real> rayDistances;				// This will have size `numRays`
-			Vec<Real> rayCosines;				// This will have size `numRays`
-			Vec<int> frontIndices;		// This will have size `numRays`
-			Vec<int> backIndices;		// This will have size `numRays`
+			// These will be used exclusively inside the energy binning of the derived classes. All four will have size `numPencilRays`.
+			Vec<Real> rayDistances;				// This will have size `numPencilRays`
+			Vec<Real> rayCosines;				// This will have size `numPencilRays`
+			Vec<int> frontIndices;		// This will have size `numPencilRays`
+			Vec<int> backIndices;		// This will have size `numPencilRays`
 
 			// Distance thresholds (in meters) from the latest updated position which triggers an update.
 			Real sourceMovementThreshold = 0.5;
@@ -138,17 +246,22 @@ namespace RAC
 				sourceResidues(dspConfig->GetNumFDNs()),
 				listenerResidues(dspConfig->GetNumFDNs(), Coefficients<>(dspConfig->GetData().numReverbSources)),
 				numFDNs(dspConfig->GetNumFDNs()),
-				numPaths(ToInt(data.rightEigenvectors[0].Length()))
+				numPaths(ToInt(data.rightEigenvectors[0].Length())),
+				listenerProgress(dspConfig->GetData().numReverbSources),
+				sourceProgress(MAX_SOURCES, SourceProgress{ ProgressiveTarget(), Coefficients<>(dspConfig->GetNumFDNs()) })
 			{
-				InitRoom(data.indexing, data.energyDecay);
+				InitRoom(data.indexing, data.energyDecay, data.rightEigenvectors, data.leftEigenvectors);
 			}
 
 			~MoDARTTracing() {};
 
 			/**
-			* @brief Set the propagation path indexing and decay rates of each mode.
+			* @brief Set the propagation path indexing, decay rates and eigenvectors of each mode.
+			*
+			* @param rightEigenvectors Right eigenvector of each mode, used for the listener residues.
+			* @param leftEigenvectors Left eigenvector of each mode, used for the source residues.
 			*/
-			void InitRoom(const Matrix<int>& indexing, const Vec<>& decayRates);
+			void InitRoom(const Matrix<int>& indexing, const Vec<>& decayRates, const std::vector<Vec<>>& rightEigenvectors, const std::vector<Vec<>>& leftEigenvectors);
 
 			/**
 			* @brief Process the ray-tracing from every new position and update the related residues.
@@ -157,29 +270,79 @@ namespace RAC
 
 		private:
 			/**
-			* @brief Computes the energy constributions of the ray pencil to each ART propagation path and stores them in the attribute `energyContributions`.
+			* @brief Smoothed source residues of one source in progressive mode.
+			*/
+			struct SourceProgress
+			{
+				ProgressiveTarget target;
+				Coefficients<> residues;	// This will have size `numFDNs`
+			};
+
+			/**
+			* @brief Traces one randomly rotated subset of rays from the listener or one source, and updates its smoothed residues.
+			* Targets are visited in turn, skipping those that have converged.
+			*/
+			void RunProgressiveTracing(Room& room, Reverb& reverb, SourceManager& sourceManager);
+
+			/**
+			* @brief Traces the pencil from the listener position and blends the resulting listener residues into `listenerResidues`.
+			*
+			* @param weight Weight of the new residues (1 to replace the previous residues).
+			*/
+			void UpdateListenerResidues(Room& room, Reverb& reverb, Real weight);
+
+			/**
+			* @brief Traces the pencil from a source position and blends the resulting source residues into `residues`.
+			*
+			* @param weight Weight of the new residues (1 to replace the previous residues).
+			*/
+			void UpdateSourceResidues(Room& room, Reverb& reverb, const Source::Data& source, Coefficients<>& residues, Real weight);
+
+			/**
+			* @brief Computes the energy contributions of the ray pencil to each ART propagation path, in a single pass over the rays.
 			* Makes internal use of the latest tracing results stored in hemispherePencil in conjunction with pathIndexing.
+			* Only the paths hit by a ray are stored: row k of `hitEnergies` and `hitDelays` belongs to the path `hitPaths[k]`.
 			* N.B.: This method should only be called under `rayPencilMutex`, i.e., privately within `RunTracing()`.
 			*
-			* @param reverbDirectionIdx If `reverbDirectionIdx == -1` (default), take all rays' contributions into account (omnidirectional).
-			*						 Otherwise, only tally up the contributions of rays within the cluster with index `reverbDirectionIdx`.
+			* @param byDirection If false, take all rays' contributions into account (omnidirectional) in column 0.
+			*					 Otherwise, tally up the contributions of the rays within each reverb direction's cluster in its own column.
+			*/
+			void ComputeEnergyContributions(bool byDirection);
+
+			/**
+			* @brief Computes the residues of every mode from the latest energy contributions and stores them in `residueMatrix`.
+			* The residue of mode s in column j is the sum over paths of eigenvectors(s, path) * energy(path, j) * decay_s ^ -delay(path, j).
+			*
+			* @param eigenvectors Eigenvector of each mode (one row per mode).
+			* @param numColumns Number of columns of the energy contributions to use.
 			*/
-			void ComputeEnergyContributions(int reverbDirectionIdx = -1);
+			void ComputeResidues(const Matrix<>& eigenvectors, int numColumns);
 
 			// The geometry is assumed unchanging.
 			int numPaths;									// Number of ART propagation paths
 			Matrix<int> pathIndexing;						// Index of the ART propagation path from triangle A to triangle B
+			Matrix<> rightEigenvectorMatrix;				// This will have size `numFDNs, numPaths`
+			Matrix<> leftEigenvectorMatrix;					// This will have size `numFDNs, numPaths`
 
 			// The number of fdns is assumed unchanging.
 			int numFDNs;
 
-			// These will be used as temporary "buffers" in the hot loop; memory is only allocated once.
+			// These will be used as temporary "buffers" in the hot loop; memory is only allocated when the number of rays changes.
 			Vec<> decayPerSecond;						// This will have size `numFDNs`
-			Vec<> energyContributions;					// This will have size `numPaths`
-			Vec<> contributionDelays;					// This will have size `numPaths`
-			Vec<> contributionDelayScaling;				// This will have size `numPaths`
+			Vec<int> pathSlots;							// This will have size `numPaths`. Row of each path in the hit matrices, or -1 if no ray hit it.
+			std::vector<int> hitPaths;					// Paths hit by the latest rays, in order of their row in the hit matrices
+			Matrix<> hitEnergies;						// Energy contribution of each hit path (row) to each reverb direction (column)
+			Matrix<> hitDelays;							// Average propagation delay of each hit path (row) in each reverb direction (column)
+			Matrix<> scaledEnergies;					// Energy contributions of the hit paths scaled by the decay over their delays
+			Matrix<> hitEigenvectors;					// Eigenvector entries of the hit paths (one row per mode)
+			Matrix<> residueMatrix;						// This will have size `numFDNs, numReverbDirections`
 			Coefficients<> sourceResidues;					// This will have size `numFDNs`
 			std::vector<Coefficients<>> listenerResidues;	// This will have size `numFDNs, numReverbDirections`
+
+			// Progressive mode
+			ProgressiveTarget listenerProgress;
+			std::vector<SourceProgress> sourceProgress;		// This will have size `MAX_SOURCES`, indexed by source id
+			size_t nextTarget = 0;							// Target visited first by the next update (0 for the listener, id + 1 for a source)
 		};
 
 		class SingleFDNTracing : public TracingThread
@@ -188,7 +351,9 @@ namespace RAC
 
 			SingleFDNTracing(shared_ptr<Room> room, shared_ptr<SourceManager> sourceManager, shared_ptr<Reverb> reverb, const LateReverbData& data, const std::shared_ptr<DSPConfig>& dspConfig) :
 				TracingThread(room, sourceManager, reverb, data, dspConfig),
-				reflectionGains(dspConfig->GetData().numReverbSources, Coefficients<>(dspConfig->GetData().numFrequencyBands))
+				reflectionGains(dspConfig->GetData().numReverbSources, Coefficients<>(dspConfig->GetData().numFrequencyBands)),
+				listenerProgress(dspConfig->GetData().numReverbSources),
+				smoothedGains(dspConfig->GetData().numReverbSources, Coefficients<>(dspConfig->GetData().numFrequencyBands))
 			{}
 
 			~SingleFDNTracing() {}
@@ -196,10 +361,17 @@ namespace RAC
 			void RunTracing() override;
 
 		private:
-			void ComputeEnergyContributions(const MaterialMap& materials, int reverbDirectionIdx = -1);
+			/**
+			* @brief Tallies up the absorption of the surfaces hit by the rays of each reverb direction's cluster into `reflectionGains`, in a single pass over the rays.
+			*/
+			void ComputeEnergyContributions(const RoomSnapshot& room);
 
 			// TODO: Convert to matrix array with Eigen
 			std::vector<Coefficients<>> reflectionGains;	// This will have size `numReverbDirections`
+
+			// Progressive mode
+			ProgressiveTarget listenerProgress;
+			std::vector<Coefficients<>> smoothedGains;		// This will have size `numReverbDirections`
 		};
 	}
 }
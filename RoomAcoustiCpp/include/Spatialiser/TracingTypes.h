@@ -11,6 +11,9 @@
 #include "Common/Types.h"
 #include "Common/Definitions.h"
 
+// Spatialiser headers
+#include "Spatialiser/TriangleBVH.h"
+
 namespace RAC
 {
     using namespace Common;
@@ -104,6 +107,116 @@ namespace RAC
             void normalize_directions();
         };
 
+        /** @brief Maximum number of rays in a packet of pencil rays. */
+        constexpr int RAY_PACKET_SIZE = 16;
+
+        /**
+         * @brief Structure-of-Arrays (SoA) container grouping the directions of a pencil into packets of angularly adjacent rays.
+         *
+         * Each packet is bounded by a cone around its mean direction, used to cull BVH nodes for the whole packet at once.
+         */
+        struct RayPacketSoA {
+            std::vector<int> rayIndex; /**< ray indices ordered by packet. */
+            std::vector<int> packetStart; /**< first entry of rayIndex in each packet, followed by the total number of rays. */
+            std::vector<Vec3> axis; /**< unit axis of the bounding cone of each packet. */
+            std::vector<Real> cosSpread; /**< cosine of the half angle of the bounding cone of each packet. */
+
+            /**
+             * @brief Number of packets stored.
+             * @return Count of packets.
+             */
+            inline int num_packets() const { return ToInt( axis.size() ); }
+
+            /**
+             * @brief Number of rays in a packet.
+             * @param packet Index of the packet.
+             * @return Count of rays, at most RAY_PACKET_SIZE.
+             */
+            inline int packet_size(int packet) const { return packetStart[packet + 1] - packetStart[packet]; }
+
+            /**
+             * @brief Group the directions into packets of up to RAY_PACKET_SIZE rays.
+             * Directions are projected onto the faces of a cube and ordered along a Hilbert curve on each face.
+             * Packets do not span more than one face.
+             * @param directions Unit ray directions.
+             */
+            void build(const std::vector<Vec3>& directions);
+        };
+
+        /** @brief Number of cells along each edge of a cube face in DirectionLookup. */
+        constexpr int DIRECTION_LOOKUP_RESOLUTION = 32;
+
+        /** @brief Largest number of directions searched exhaustively by DirectionLookup (faster than the cube map for few directions). */
+        constexpr int DIRECTION_LOOKUP_MAX_EXHAUSTIVE = 16;
+
+        /**
+         * @brief Cube map lookup of the direction with the highest dot product, among a fixed set of directions.
+         *
+         * Each cell of the cube map stores the directions that can be the nearest somewhere in the cell, in increasing index order.
+         * Most cells store one direction. Otherwise the candidates are compared, so nearest() always matches the exhaustive search
+         * (ties go to the lowest index). No cube map is built for DIRECTION_LOOKUP_MAX_EXHAUSTIVE directions or fewer.
+         */
+        struct DirectionLookup {
+            std::vector<Vec3> directions; /**< directions to search, not necessarily unit (weighted clustering). */
+            std::vector<int> cellStart; /**< first entry of candidates in each cell, followed by the total number of candidates. Empty if not built. */
+            std::vector<int> candidates; /**< direction indices ordered by cell. */
+
+            /**
+             * @brief Build the cube map for a set of directions.
+             * @param newDirections Directions to search.
+             */
+            void build(const std::vector<Vec3>& newDirections);
+
+            /**
+             * @brief Index of the direction with the highest dot product with @p D.
+             * @param D Query direction.
+             * @return Index into directions, or -1 if there are no directions.
+             */
+            int nearest(const Vec3& D) const;
+
+            /**
+             * @brief Index of the direction with the highest dot product with @p D, comparing with every direction.
+             * @param D Query direction.
+             * @return Index into directions, or -1 if there are no directions.
+             */
+            int nearest_exhaustive(const Vec3& D) const;
+        };
+
+        /** @brief Number of triangles processed together by the SIMD intersection kernels. */
+        constexpr int TRIANGLE_BLOCK_SIZE = 8;
+
+        /**
+         * @brief Single precision Structure-of-Arrays (SoA) copy of a triangle mesh with separate x, y and z arrays.
+         *
+         * Padded to a multiple of TRIANGLE_BLOCK_SIZE triangles. Used by the SIMD kernels to reject triangles before the exact
+         * intersection test, so it also stores the magnitudes needed to bound the single precision rounding error.
+         * Padding triangles never pass.
+         */
+        struct TriangleBlockSoA {
+            std::vector<float> Ax, Ay, Az; /**< vertex A. */
+            std::vector<float> e1x, e1y, e1z; /**< edge1 = B - A. */
+            std::vector<float> e2x, e2y, e2z; /**< edge2 = C - A. */
+            std::vector<float> nx, ny, nz; /**< triangle normal. */
+            std::vector<float> d0PlusEPS; /**< plane constant plus EPS_FACING. */
+
+            std::vector<float> lengthA; /**< |A|. */
+            std::vector<float> lengthEdge1; /**< |edge1|. */
+            std::vector<float> lengthEdge2; /**< |edge2|. */
+            std::vector<float> absD0; /**< |d0PlusEPS|. */
+
+            /**
+             * @brief Number of blocks stored.
+             * @return Count of blocks of TRIANGLE_BLOCK_SIZE triangles.
+             */
+            inline int num_blocks() const { return ToInt( d0PlusEPS.size() ) / TRIANGLE_BLOCK_SIZE; }
+
+            /**
+             * @brief Resize all internal arrays to hold @p n triangles, rounded up to a whole number of blocks. Every triangle is reset to padding.
+             * @param n New number of triangles.
+             */
+            void resize(int n);
+        };
+
         /**
          * @brief Structure-of-Arrays (SoA) container for triangle data precomputed for Möller-Trumbore line-triangle intersection tests.
          */
@@ -129,6 +242,12 @@ namespace RAC
             /** @brief Plane constant d0 such that dot(n, X) + d0 = 0. plus EPS_FACING */
             std::vector<Real> d0PlusEPS;
 
+            /** @brief BVH over the triangles. Rays are traced against every triangle while empty. */
+            TriangleBVH bvh;
+
+            /** @brief Single precision copy of the triangles for the SIMD kernels. Not used while empty. */
+            TriangleBlockSoA blocks;
+
             /**
              * @brief Number of triangles stored.
              * @return Count of triangles.
@@ -136,10 +255,21 @@ namespace RAC
             inline int size() const { return ToInt( d0PlusEPS.size() ); }
 
             /**
-             * @brief Resize all internal arrays to hold @p n triangles.
+             * @brief Resize all internal arrays to hold @p n triangles. Clears the BVH and the SIMD blocks.
              * @param n New number of triangles.
              */
             void resize(int n);
+
+            /**
+             * @brief Build the BVH over the current triangles. Must be called again after the triangles change.
+             * Meshes with fewer than 64 triangles (512 if the AVX2 kernel is supported) are not given a BVH as tracing against every triangle is faster.
+             */
+            void build_bvh();
+
+            /**
+             * @brief Build the single precision blocks for the SIMD kernels. Must be called again after the triangles change.
+             */
+            void build_blocks();
         };
     }
 }
@@ -10,6 +10,11 @@
 
 namespace RAC
 {
+    namespace Common
+    {
+        class ThreadPool;
+    }
+
     using namespace Common;
 	namespace Spatialiser
 	{
@@ -84,6 +89,30 @@ namespace RAC
             int& patchIdBack, Real& distanceBack, Real& cosineBack,
             int ignoredTriangleIndex = -1);
 
+        /**
+         * @brief Intersect all triangles against a packet of pencil rays.
+         *
+         * The rays share one traversal of the mesh BVH, which gathers the triangles in every leaf crossed by one of the rays.
+         * Each ray is then tested against these triangles only, in increasing triangle index order, so the results match trace_ray.
+         * Rays are traced with trace_ray instead if the mesh has no BVH, the packet is too wide or gathers too many triangles,
+         * or the ray is close to parallel with a triangle.
+         *
+         * @param triangles Structure of Arrays containing the triangles.
+         * @param rays Structure of Arrays containing the rays.
+         * @param packets Packets of the rays.
+         * @param packetIndex Index of the packet to trace.
+         * @param patchIdFront Pointer to an output buffer of size RAY_PACKET_SIZE receiving the node ID of nearest t > 0 hit of each ray in the packet, or -1 for invalid hits.
+         * @param distanceFront Pointer to an output buffer receiving the line parameter |t| of nearest t > 0 hit, or NaN for invalid hits.
+         * @param cosineFront Pointer to an output buffer receiving the incidence cosine of nearest t > 0 hit, or NaN for invalid hits.
+         * @param patchIdBack Pointer to an output buffer receiving the node ID of nearest t < 0 hit, or -1 for invalid hits.
+         * @param distanceBack Pointer to an output buffer receiving the line parameter |t| of nearest t < 0 hit, or NaN for invalid hits.
+         * @param cosineBack Pointer to an output buffer receiving the incidence cosine of nearest t < 0 hit, or NaN for invalid hits.
+         */
+        void trace_packet(
+            const TriangleMeshSoA& triangles, const RayPencilSoA& rays, const RayPacketSoA& packets, int packetIndex,
+            int* patchIdFront, Real* distanceFront, Real* cosineFront,
+            int* patchIdBack, Real* distanceBack, Real* cosineBack);
+
         /* @brief Class for tracing a bundle of rays with different origins and directions. */
         class RayBundle {
         private:
@@ -107,8 +136,9 @@ namespace RAC
             RayBundle(const std::vector<Vec3>& origins, const std::vector<Vec3>& directions);
 
             /* @brief Find the next intersection point of each ray and update the intersected triangle indices, without advancing the rays.
+             * @param threadPool If not null, rays are traced in parallel by the calling thread and the pool threads.
              */
-            void traceAll(const TriangleMeshSoA& triangles);
+            void traceAll(const TriangleMeshSoA& triangles, ThreadPool* threadPool = nullptr);
 
             /* @brief Advance every ray to its next intersection point, updating all origin points and travel distances;
              *  update directions based on the previously intersected polygons' scattering coefficients,
@@ -164,6 +194,11 @@ namespace RAC
             int numRays;
             RayPencilSoA rays;
 
+            // Packets of angularly adjacent rays, traced together by traceAll() when `packetTracing` is true, the mesh has a BVH
+            //  and there are enough rays per triangle for packets to be faster.
+            RayPacketSoA packets;
+            bool packetTracing = true;
+
             // If this is true, `clusterDirections()` and all `get_()` methods behave as if this instance contained
             //  twice as many rays as it actually does. They will report the results related to the real "forward" rays,
             //  and then concatenate the results for their direct opposite directions. Tracing is performed only once.
@@ -193,9 +228,21 @@ namespace RAC
               */
             void moveOrigin(const Vec3& origin);
 
+            /* @brief Replace the ray directions, keeping the origin and number of rays. The packets of adjacent rays are rebuilt.
+              * N.B.: This resets all intersection data.
+              * @param directions One direction per traced ray (excluding mirror copies). Normalized internally.
+              */
+            void setDirections(const std::vector<Vec3>& directions);
+
             /* @brief Find the next intersection point of each ray, in the front and back.
+              * @param threadPool If not null, rays are traced in parallel by the calling thread and the pool threads.
+              */
+            void traceAll(const TriangleMeshSoA& triangles, ThreadPool* threadPool = nullptr);
+
+            /* @brief Enable or disable tracing packets of adjacent rays together. Enabled by default, but only used above a minimum number
+              *  of rays per triangle. The results are the same either way.
               */
-            void traceAll(const TriangleMeshSoA& triangles);
+            inline void setPacketTracing(bool enabled) { packetTracing = enabled; }
 
             /* @brief Cluster this pencil's directions based on their cosine similarity to a given set of directions. N.B.: assumes input directions are normalized.
              *
@@ -210,6 +257,14 @@ namespace RAC
              */
             void clusterDirections(const std::vector<Vec3>& directions, Vec<int>& clusters) const;
 
+            /* @brief Cluster this pencil's directions using a precomputed lookup of the reference directions.
+             * Gives the same result as clusterDirections(lookup.directions, clusters), in time independent of the number of reference directions for most rays.
+             *
+             * @param lookup Cube map lookup built from the reference directions.
+             * @param clusters Pointer to a pre-allocated integer buffer of size `numRays`, used for output values.
+             */
+            void clusterDirections(const DirectionLookup& lookup, Vec<int>& clusters) const;
+
             /* @brief Returns the number of rays in the pencil.
               */
             inline int getNumRays() const { return exposeMirrorCopies ? 2 * numRays : numRays; }
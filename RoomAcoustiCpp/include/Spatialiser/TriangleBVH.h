@@ -0,0 +1,377 @@
+/*
+* @class TriangleBVH
+*
+* @brief Declaration of TriangleBVH class
+*
+*/
+
+#ifndef RoomAcoustiCpp_TriangleBVH_h
+#define RoomAcoustiCpp_TriangleBVH_h
+
+// C++ headers
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+// Common headers
+#include "Common/Types.h"
+#include "Common/Vec3.h"
+#include "Common/Definitions.h"
+#include "Common/Debug.h"
+
+// Spatialiser headers
+#include "Spatialiser/BVHTypes.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		/**
+		* @brief Class that stores a bounding volume hierarchy over the triangles of a ray tracing mesh
+		*
+		* @details Built with the surface area heuristic and stored as a flattened node array.
+		* The intersection test accepts hits slightly outside each triangle (edge tolerance), and this margin grows as the ray becomes
+		* parallel to the triangle. The bounds are padded to cover the margin for rays at least GRAZING_COSINE away from parallel,
+		* and IsGrazing identifies the remaining rays so they can be traced against every triangle.
+		*/
+		class TriangleBVH
+		{
+		public:
+			/**
+			* @brief Default constructor that initialises an empty BVH
+			*/
+			TriangleBVH() {}
+
+			/**
+			* @brief Default deconstructor
+			*/
+			~TriangleBVH() {}
+
+			/**
+			* @brief Rebuilds the BVH from the given triangles
+			*
+			* @param A The anchor vertex of each triangle
+			* @param edge1 The first edge (B - A) of each triangle
+			* @param edge2 The second edge (C - A) of each triangle
+			*/
+			void Build(const std::vector<Vec3>& A, const std::vector<Vec3>& edge1, const std::vector<Vec3>& edge2);
+
+			/**
+			* @brief Clears the BVH
+			*/
+			inline void Clear() { mNodes.clear(); mTriangles.clear(); mGrazingNormals.clear(); }
+
+			/**
+			* @return True if the BVH contains no triangles, false otherwise
+			*/
+			inline bool Empty() const { return mTriangles.empty(); }
+
+			/**
+			* @return The number of triangles stored in the BVH
+			*/
+			inline size_t Size() const { return mTriangles.size(); }
+
+			/**
+			* @brief Checks if a ray is close enough to parallel with any triangle that the padded bounds may not contain its hits
+			*
+			* @param direction The ray direction
+			* @return True if the ray must be traced against every triangle, false otherwise
+			*/
+			bool IsGrazing(const Vec3& direction) const;
+
+			/**
+			* @brief Visits all triangles in leaves overlapped by the line origin + t * direction for t in [tLower, tUpper]
+			*
+			* @details Nodes closest to the origin are visited first. The limits are read before each node is visited,
+			* so the callback can narrow them as hits are found.
+			*
+			* @param origin The ray origin
+			* @param direction The ray direction
+			* @param tLower Reference to the lowest position along the line to consider
+			* @param tUpper Reference to the highest position along the line to consider
+			* @param visit Callback taking a triangle index and returning true to stop the traversal
+			*/
+			template <typename Visitor>
+			void Traverse(const Vec3& origin, const Vec3& direction, const Real& tLower, const Real& tUpper, Visitor&& visit) const;
+
+			/**
+			* @brief Visits all triangles in leaves overlapped by any of the lines origin + t * directions[i]
+			*
+			* @details Nodes outside the double cone around axis that bounds the directions are culled without testing each line.
+			* Every triangle is visited at most once, in no particular order.
+			*
+			* @param origin The shared ray origin
+			* @param directions The ray directions
+			* @param numRays The number of ray directions, at most MAX_PACKET_RAYS
+			* @param axis Unit axis of a cone containing all the directions
+			* @param cosSpread Cosine of the half angle of the cone
+			* @param visit Callback taking a triangle index and returning true to stop the traversal
+			*/
+			template <typename Visitor>
+			void TraversePacket(const Vec3& origin, const Vec3* directions, int numRays, const Vec3& axis, Real cosSpread, Visitor&& visit) const;
+
+			static constexpr int MAX_PACKET_RAYS = 64;		// Maximum number of lines traced together by TraversePacket
+
+		private:
+			/**
+			* @brief Struct that stores a single triangle during the build
+			*/
+			struct Primitive
+			{
+				int triangle{ 0 };		// Index of the triangle in the mesh
+				AABB bounds;			// Padded bounding box of the triangle
+				std::array<Real, 3> centroid{ 0.0, 0.0, 0.0 };	// Centre of the bounding box
+			};
+
+			/**
+			* @brief Struct that stores a group of similar triangle normals used to identify grazing rays
+			*/
+			struct GrazingNormal
+			{
+				Vec3 normal;				// Representative unit normal
+				Real deviation{ 0.0 };		// Largest distance from the representative normal of any normal in the group
+			};
+
+			/**
+			* @brief Recursively builds the BVH over the primitives in [first, last)
+			*
+			* @return The index of the created node
+			*/
+			int BuildRecursive(std::vector<Primitive>& primitives, int first, int last, int depth);
+
+			/**
+			* @brief Visits all triangles below a node without testing the bounds of its descendants
+			*
+			* @details Used by the traversals when their stack is full. Builds limit the depth of the tree so this does not
+			* happen, but the check keeps a deeper tree from writing past the stack in release builds.
+			*
+			* @param node The index of the node
+			* @param visit Callback taking a triangle index and returning true to stop the traversal
+			* @return True if the callback stopped the traversal, false otherwise
+			*/
+			template <typename Visitor>
+			inline bool VisitSubtree(const int node, Visitor&& visit) const
+			{
+				int first, last;
+				SubtreePrimitives(mNodes, node, first, last);
+				for (int i = first; i < last; ++i)
+				{
+					if (visit(mTriangles[i]))
+						return true;
+				}
+				return false;
+			}
+
+			/**
+			* @brief Adds a triangle normal to the grazing normals, merging it with a similar existing normal if possible
+			*
+			* @param normal The unit normal of the triangle
+			*/
+			void AddGrazingNormal(const Vec3& normal);
+
+			/**
+			* @brief Finds the part of the line origin + t * direction inside a bounding box
+			*
+			* @param origin The line origin
+			* @param invDir Reciprocal of the line direction
+			* @param box The bounding box to check
+			* @param tEnter Stores the lowest position along the line inside the box
+			* @param tExit Stores the highest position along the line inside the box
+			*
+			* @return True if the line overlaps the box, false otherwise
+			*/
+			static inline bool LineOverlaps(const std::array<Real, 3>& origin, const std::array<Real, 3>& invDir, const AABB& box, Real& tEnter, Real& tExit)
+			{
+				tEnter = -std::numeric_limits<Real>::infinity();
+				tExit = std::numeric_limits<Real>::infinity();
+				for (int i = 0; i < 3; ++i)
+				{
+					if (std::isinf(invDir[i])) // case: line parallel to slab
+					{
+						if (origin[i] < box.min[i] || origin[i] > box.max[i])
+							return false;
+						continue;
+					}
+
+					Real t0 = (box.min[i] - origin[i]) * invDir[i];
+					Real t1 = (box.max[i] - origin[i]) * invDir[i];
+					if (t0 > t1)
+						std::swap(t0, t1);
+
+					tEnter = std::max(tEnter, t0);
+					tExit = std::min(tExit, t1);
+					if (tEnter > tExit)
+						return false;
+				}
+				return true;
+			}
+
+			std::vector<BVHNode> mNodes;					// Flattened BVH nodes (root at index 0, leaves index mTriangles)
+			std::vector<int> mTriangles;					// Triangle indices ordered by leaf
+			std::vector<GrazingNormal> mGrazingNormals;		// Normals of the triangles that rely on the grazing check
+		};
+
+		////////////////////////////////////////
+
+		template <typename Visitor>
+		void TriangleBVH::Traverse(const Vec3& origin, const Vec3& direction, const Real& tLower, const Real& tUpper, Visitor&& visit) const
+		{
+			if (mNodes.empty())
+				return;
+
+			const std::array<Real, 3> o = { origin.x(), origin.y(), origin.z() };
+			const std::array<Real, 3> d = { direction.x(), direction.y(), direction.z() };
+			std::array<Real, 3> invDir;
+			for (int i = 0; i < 3; ++i)
+				invDir[i] = d[i] == 0.0 ? std::numeric_limits<Real>::infinity() : REAL_CONST(1.0) / d[i];
+
+			// Distance along the line from the origin to the nearest point of an interval
+			auto distanceFromOrigin = [](const Real tEnter, const Real tExit)
+				{
+					if (tEnter > 0.0)
+						return tEnter;
+					if (tExit < 0.0)
+						return -tExit;
+					return REAL_CONST(0.0);
+				};
+
+			struct Entry
+			{
+				int node;
+				Real tEnter;
+				Real tExit;
+			};
+			constexpr int MAX_STACK_DEPTH = 64;
+			std::array<Entry, MAX_STACK_DEPTH> stack;
+			int stackSize = 0;
+
+			Real tEnter, tExit;
+			if (!LineOverlaps(o, invDir, mNodes[0].bounds, tEnter, tExit))
+				return;
+			stack[stackSize++] = { 0, tEnter, tExit };
+
+			while (stackSize > 0)
+			{
+				const Entry entry = stack[--stackSize];
+				if (entry.tEnter > tUpper || entry.tExit < tLower)
+					continue;
+
+				const BVHNode& node = mNodes[entry.node];
+				if (node.count > 0)
+				{
+					for (int i = node.firstPrimitive; i < node.firstPrimitive + node.count; ++i)
+					{
+						if (visit(mTriangles[i]))
+							return;
+					}
+					continue;
+				}
+
+				Entry children[2];
+				int numChildren = 0;
+				for (const int child : { entry.node + 1, node.rightChild })
+				{
+					if (LineOverlaps(o, invDir, mNodes[child].bounds, tEnter, tExit) && tEnter <= tUpper && tExit >= tLower)
+						children[numChildren++] = { child, tEnter, tExit };
+				}
+
+				// Push the child furthest from the origin first so the nearest child is visited next
+				if (numChildren == 2 && distanceFromOrigin(children[0].tEnter, children[0].tExit) < distanceFromOrigin(children[1].tEnter, children[1].tExit))
+					std::swap(children[0], children[1]);
+				for (int i = 0; i < numChildren; ++i)
+				{
+					if (stackSize < MAX_STACK_DEPTH)
+						stack[stackSize++] = children[i];
+					else if (VisitSubtree(children[i].node, visit))
+						return;
+				}
+			}
+		}
+
+		////////////////////////////////////////
+
+		template <typename Visitor>
+		void TriangleBVH::TraversePacket(const Vec3& origin, const Vec3* directions, int numRays, const Vec3& axis, Real cosSpread, Visitor&& visit) const
+		{
+			RAC_DEBUG_ASSERT(numRays <= MAX_PACKET_RAYS, "Too many rays in packet: " + ToString(numRays));
+			if (mNodes.empty() || numRays <= 0)
+				return;
+
+			const std::array<Real, 3> o = { origin.x(), origin.y(), origin.z() };
+			std::array<std::array<Real, 3>, MAX_PACKET_RAYS> invDir;
+			for (int r = 0; r < numRays; ++r)
+			{
+				const std::array<Real, 3> d = { directions[r].x(), directions[r].y(), directions[r].z() };
+				for (int i = 0; i < 3; ++i)
+					invDir[r][i] = d[i] == 0.0 ? std::numeric_limits<Real>::infinity() : REAL_CONST(1.0) / d[i];
+			}
+			const Real sinSpread = std::sqrt(std::max(REAL_CONST(0.0), REAL_CONST(1.0) - cosSpread * cosSpread));
+
+			// Returns the first line from firstRay that overlaps the box, or numRays if none do
+			auto firstOverlap = [&](const AABB& box, int firstRay)
+				{
+					// The bounding sphere of the box must reach the double cone around the axis (the lines extend both ways)
+					const Vec3 halfSize(REAL_CONST(0.5) * (box.max[0] - box.min[0]), REAL_CONST(0.5) * (box.max[1] - box.min[1]), REAL_CONST(0.5) * (box.max[2] - box.min[2]));
+					const Vec3 offset = Vec3(box.min[0], box.min[1], box.min[2]) + halfSize - origin;
+					const Real along = offset.dot(axis);
+					const Real across = std::sqrt(std::max(REAL_CONST(0.0), offset.dot(offset) - along * along));
+					if (across * cosSpread - std::abs(along) * sinSpread > std::sqrt(halfSize.dot(halfSize)) + EPS_GENERAL)
+						return numRays;
+
+					Real tEnter, tExit;
+					for (int r = firstRay; r < numRays; ++r)
+					{
+						if (LineOverlaps(o, invDir[r], box, tEnter, tExit))
+							return r;
+					}
+					return numRays;
+				};
+
+			struct Entry
+			{
+				int node;
+				int firstRay;
+			};
+			constexpr int MAX_STACK_DEPTH = 64;
+			std::array<Entry, MAX_STACK_DEPTH> stack;
+			int stackSize = 0;
+
+			const int rootRay = firstOverlap(mNodes[0].bounds, 0);
+			if (rootRay == numRays)
+				return;
+			stack[stackSize++] = { 0, rootRay };
+
+			while (stackSize > 0)
+			{
+				const Entry entry = stack[--stackSize];
+				const BVHNode& node = mNodes[entry.node];
+				if (node.count > 0)
+				{
+					for (int i = node.firstPrimitive; i < node.firstPrimitive + node.count; ++i)
+					{
+						if (visit(mTriangles[i]))
+							return;
+					}
+					continue;
+				}
+
+				// Lines before firstRay miss the parent, so they also miss both children
+				for (const int child : { node.rightChild, entry.node + 1 })
+				{
+					const int ray = firstOverlap(mNodes[child].bounds, entry.firstRay);
+					if (ray == numRays)
+						continue;
+					if (stackSize < MAX_STACK_DEPTH)
+						stack[stackSize++] = { child, ray };
+					else if (VisitSubtree(child, visit))
+						return;
+				}
+			}
+		}
+	}
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <array>
 #include <variant>
+#include <cstdint>
 
 // Common headers
 #include "Common/Coefficients.h"
@@ -33,14 +34,37 @@ namespace RAC
 		class ImageSource;
 		class ImageSourceData;
 
+		/**
+		* @brief Integer key that identifies an image source path
+		*
+		* @details Two independent 64 bit hashes of the source ID and the ordered reflection and diffraction parts of the path.
+		* Replaces the previous string keys so that map lookups in the image edge model do not allocate or compare strings.
+		*/
+		struct ImageSourceKey
+		{
+			uint64_t hi{ 0 };	// First hash of the path
+			uint64_t lo{ 0 };	// Second hash of the path
+
+			inline bool operator==(const ImageSourceKey& other) const { return hi == other.hi && lo == other.lo; }
+			inline bool operator!=(const ImageSourceKey& other) const { return !(*this == other); }
+		};
+
+		/**
+		* @brief Hash functor for ImageSourceKey
+		*/
+		struct ImageSourceKeyHash
+		{
+			inline size_t operator()(const ImageSourceKey& key) const noexcept { return static_cast<size_t>(key.lo ^ (key.hi >> 1)); }
+		};
+
 		typedef std::unordered_map<size_t, Plane> PlaneMap;																	// Store planes
 		typedef std::unordered_map<size_t, Wall> WallMap;																	// Store walls
 		typedef std::unordered_map<size_t, Coefficients<>> MaterialMap;														// Store materials
 		typedef std::unordered_map<size_t, Edge> EdgeMap;																	// Store edges
 		typedef std::unordered_map<size_t, Source> SourceMap;																// Store sources
-		typedef std::unordered_map<std::string, ImageSource> ImageSourceMap;												// Store image sources
-		typedef std::unordered_map<std::string, std::shared_ptr<ImageSourceData>> ImageSourceDataMap;						// Store image source data
-		typedef std::unordered_map<std::string, std::pair<int, std::shared_ptr<ImageSourceData>>> ImageSourceDataAudioMap;	// Store image source data
+		typedef std::unordered_map<ImageSourceKey, ImageSource, ImageSourceKeyHash> ImageSourceMap;												// Store image sources
+		typedef std::unordered_map<ImageSourceKey, std::shared_ptr<ImageSourceData>, ImageSourceKeyHash> ImageSourceDataMap;						// Store image source data
+		typedef std::unordered_map<ImageSourceKey, std::pair<int, std::shared_ptr<ImageSourceData>>, ImageSourceKeyHash> ImageSourceDataAudioMap;	// Store image source data
 
 		typedef std::vector<std::vector<std::shared_ptr<ImageSourceData>>> ImageSourceDataStore;						// Store image source data
 
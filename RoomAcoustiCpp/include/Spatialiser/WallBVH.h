@@ -0,0 +1,196 @@
+/*
+* @class WallBVH
+*
+* @brief Declaration of WallBVH class
+*
+*/
+
+#ifndef RoomAcoustiCpp_WallBVH_h
+#define RoomAcoustiCpp_WallBVH_h
+
+// C++ headers
+#include <vector>
+#include <array>
+#include <initializer_list>
+#include <limits>
+
+// Common headers
+#include "Common/Types.h"
+#include "Common/Vec3.h"
+
+// Spatialiser headers
+#include "Spatialiser/Types.h"
+#include "Spatialiser/Wall.h"
+#include "Spatialiser/BVHTypes.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		/**
+		* @brief Class that stores a bounding volume hierarchy over the walls of a room
+		*
+		* @details Used by the image edge model to accelerate line obstruction and intersection queries.
+		* Each leaf stores a copy of the wall vertices and the parent plane normal and d value so that queries
+		* reproduce the results of Plane::LinePlaneObstruction/LinePlaneIntersection followed by the wall triangle test.
+		* The tree is rebuilt from the room copy held by the image edge model and is not thread safe during Build.
+		*/
+		class WallBVH
+		{
+		public:
+			/**
+			* @brief Struct that stores the result of a closest hit query
+			*/
+			struct Hit
+			{
+				size_t wallID{ 0 };		// ID of the intersected wall
+				size_t planeID{ 0 };	// ID of the plane the intersected wall is part of
+				Real t{ 0.0 };			// Position of the intersection along the line (0 at start, 1 at end)
+				Vec3 intersection;		// Intersection point
+			};
+
+			/**
+			* @brief Default constructor that initialises an empty BVH
+			*/
+			WallBVH() {}
+
+			/**
+			* @brief Default deconstructor
+			*/
+			~WallBVH() {}
+
+			/**
+			* @brief Rebuilds the BVH from the given planes and walls
+			*
+			* @param planes The planes in the room
+			* @param walls The walls in the room
+			*/
+			void Build(const PlaneMap& planes, const WallMap& walls);
+
+			/**
+			* @brief Clears the BVH
+			*/
+			inline void Clear() { mNodes.clear(); mPrimitives.clear(); mPlaneWalls.clear(); }
+
+			/**
+			* @return True if the BVH contains no walls, false otherwise
+			*/
+			inline bool Empty() const { return mPrimitives.empty(); }
+
+			/**
+			* @return The number of walls stored in the BVH
+			*/
+			inline size_t Size() const { return mPrimitives.size(); }
+
+			/**
+			* @brief Check for any wall obstructing a line
+			*
+			* @details A wall obstructs the line if the line crosses the plane of the wall (end points lying on the plane are not obstructed)
+			* and passes through the wall triangle. Matches Plane::LinePlaneObstruction followed by Wall::LineWallObstruction.
+			*
+			* @param start Start point of the line
+			* @param end End point of the line
+			* @param excludedPlaneIds Planes to ignore (a short list, so no set is allocated for each query)
+			*
+			* @return True if an obstruction is found, false otherwise
+			*/
+			bool AnyHit(const Vec3& start, const Vec3& end, std::initializer_list<size_t> excludedPlaneIds = {}) const;
+
+			/**
+			* @brief Find the wall intersection closest to the start of a line
+			*
+			* @details End points lying on the plane count as intersections. Matches Plane::LinePlaneIntersection followed by Wall::LineWallIntersection.
+			* Ties are resolved in favour of the wall added first to its plane.
+			*
+			* @param start Start point of the line
+			* @param end End point of the line
+			* @param excludedPlaneIds Planes to ignore
+			* @param hit Stores the closest intersection
+			*
+			* @return True if an intersection is found, false otherwise
+			*/
+			bool ClosestHit(const Vec3& start, const Vec3& end, std::initializer_list<size_t> excludedPlaneIds, Hit& hit) const;
+
+			/**
+			* @brief Find the wall intersection closest to the start of a line, only considering walls in the given plane
+			*
+			* @details Tests the walls of the plane directly rather than traversing the tree.
+			*
+			* @param start Start point of the line
+			* @param end End point of the line
+			* @param planeID The plane to check for intersection
+			* @param hit Stores the closest intersection
+			*
+			* @return True if an intersection is found, false otherwise
+			*/
+			bool ClosestHitInPlane(const Vec3& start, const Vec3& end, const size_t planeID, Hit& hit) const;
+
+		private:
+			/**
+			* @brief Struct that stores a single wall
+			*/
+			struct Primitive
+			{
+				Vertices vertices;		// Wall vertices
+				Vec3 planeNormal;		// Normal of the parent plane
+				Real planeD{ 0.0 };		// Distance of the parent plane from the origin along the normal direction
+				size_t wallID{ 0 };		// ID of the wall
+				size_t planeID{ 0 };	// ID of the parent plane
+				size_t order{ 0 };		// Build order (used to resolve ties deterministically)
+				AABB bounds;			// Bounding box of the wall
+				std::array<Real, 3> centroid{ 0.0, 0.0, 0.0 };	// Centre of the bounding box
+
+				/**
+				* @brief Determines the position of a point relative to the parent plane
+				*/
+				inline Real PointPlanePosition(const Vec3& point) const { return point.dot(planeNormal) - planeD; }
+			};
+
+			/**
+			* @brief Struct that stores the index of a wall in the primitives, sorted by plane
+			*/
+			struct PlaneWall
+			{
+				size_t planeID{ 0 };	// ID of the parent plane
+				int primitive{ 0 };		// Index of the wall in mPrimitives
+			};
+
+			/**
+			* @brief Checks if a line segment overlaps a bounding box
+			*
+			* @param start Start point of the line
+			* @param invDir Reciprocal of the line direction (end - start)
+			* @param box The bounding box to check
+			* @param tMax The furthest position along the line to consider (0 at start, 1 at end)
+			*
+			* @return True if the line segment overlaps the box, false otherwise
+			*/
+			static bool SegmentOverlaps(const std::array<Real, 3>& start, const std::array<Real, 3>& invDir, const AABB& box, const Real tMax);
+
+			/**
+			* @brief Visits all primitives in leaves overlapped by a line segment
+			*
+			* @param start Start point of the line
+			* @param end End point of the line
+			* @param tMax Reference to the furthest position along the line to consider (may be reduced by the callback)
+			* @param visit Callback taking a primitive and returning true to stop the traversal
+			*/
+			template <typename Visitor>
+			void Traverse(const Vec3& start, const Vec3& end, const Real& tMax, Visitor&& visit) const;
+
+			/**
+			* @brief Tests a line against a single primitive for a closest hit query
+			*
+			* @return True if the primitive is intersected and closer than the current hit, false otherwise
+			*/
+			static bool IntersectPrimitive(const Primitive& primitive, const Vec3& start, const Vec3& end, Hit& hit, size_t& hitOrder);
+
+			std::vector<BVHNode> mNodes;			// Flattened BVH nodes (root at index 0)
+			std::vector<Primitive> mPrimitives;		// Walls ordered by leaf
+			std::vector<PlaneWall> mPlaneWalls;		// Walls ordered by plane ID and build order
+		};
+	}
+}
+
+#endif
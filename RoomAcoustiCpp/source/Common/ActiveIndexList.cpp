@@ -0,0 +1,51 @@
+/*
+* @class ActiveIndexList
+*
+* @brief Definition of ActiveIndexList class
+*
+*/
+
+// Common headers
+#include "Common/ActiveIndexList.h"
+
+namespace RAC
+{
+	namespace Common
+	{
+		//////////////////// ActiveIndexList class ////////////////////
+
+		ReleasePool ActiveIndexList::releasePool;
+
+		////////////////////////////////////////
+
+		ActiveIndexList::ActiveIndexList(size_t capacity) : isActive(capacity, false), numActive(0), isChanged(true)
+		{
+			Publish();
+		}
+
+		////////////////////////////////////////
+
+		void ActiveIndexList::Publish()
+		{
+			if (!isChanged)
+				return;
+
+			std::shared_ptr<std::vector<int>> indicesCopy = std::make_shared<std::vector<int>>();
+			indicesCopy->reserve(numActive);
+			for (size_t i = 0; i < isActive.size(); i++)
+			{
+				if (isActive[i])
+					indicesCopy->push_back(static_cast<int>(i));
+			}
+			std::shared_ptr<const std::vector<int>> indices = indicesCopy;
+#ifdef __ANDROID__
+			std::atomic_store(&activeIndices, indices);
+#else
+			activeIndices.store(indices, std::memory_order_release);
+#endif
+			// The audio thread may hold the previous list, so it is released here rather than on the audio thread
+			releasePool.Add(indicesCopy);
+			isChanged = false;
+		}
+	}
+}
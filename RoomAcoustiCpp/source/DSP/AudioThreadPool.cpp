@@ -23,12 +23,22 @@ namespace RAC
 {
 	namespace DSP
 	{
+        namespace
+        {
+            // Chunk range [first, end) packed into one word
+            inline uint64_t PackRange(uint32_t first, uint32_t end) { return static_cast<uint64_t>(end) << 32 | first; }
+            inline uint32_t RangeFirst(uint64_t range) { return static_cast<uint32_t>(range); }
+            inline uint32_t RangeEnd(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+        }
+
         //////////////////// AudioThreadPool Class ////////////////////
 
         ////////////////////////////////////////
 
-        AudioThreadPool::AudioThreadPool(size_t numThreads, const std::shared_ptr<DSPConfig>& dspConfig)
-            : stop(false), threadCount(numThreads), tasks(MAX_IMAGESOURCES + MAX_SOURCES)
+        AudioThreadPool::AudioThreadPool(size_t numThreads, const std::shared_ptr<DSPConfig>& dspConfig, std::chrono::microseconds spinTime)
+            : taskDescriptors(MAX_IMAGESOURCES + MAX_SOURCES), taskCosts(MAX_IMAGESOURCES + MAX_SOURCES, 0.0), numBatchTasks(0),
+            schedule(numThreads, MAX_IMAGESOURCES + MAX_SOURCES), workerRanges(numThreads), batchTasksRemaining(nullptr),
+            sourceCosts(MAX_SOURCES + MAX_IMAGESOURCES, 0.0), stop(false), threadCount(numThreads)
         {
 			int numFrames = dspConfig->GetData().numFrames;
 
@@ -40,6 +50,8 @@ namespace RAC
 #if USE_BLOCKING_TASKS
             tasksAvailable = CreateEvent(NULL, FALSE, FALSE, NULL);
             stopRequested = CreateEvent(NULL, TRUE, FALSE, NULL);
+#else
+            this->spinTime = spinTime;
 #endif
 
 #ifdef _WIN32
@@ -63,19 +75,19 @@ namespace RAC
 #endif
 
                     //FlushDenormals();
-                    std::shared_ptr<AudioTaskBase> task;
+#if !USE_BLOCKING_TASKS
+                    uint32_t lastBatch = batchIndex.load(std::memory_order_acquire);
+#endif
                     while (!stop.load(std::memory_order_acquire))
                     {
-                        while (tasks.try_dequeue(task))
-                            task->Run(threadOutputBuffers[i], threadReverbOutputs[i]);
+                        while (RunNextChunk(i)) {}
 
 #if USE_BLOCKING_TASKS
                         // wait for either data to come in or the stop request (which doesn't reset so we will always catch it)
                         HANDLE handles[] = { tasksAvailable, stopRequested };
                         WaitForMultipleObjects(2, handles, FALSE, INFINITE);
 #else
-						// Once the queue is empty, often a large wait until next used. _mm_pause() or SpinLock cause performance issues here causes 
-						std::this_thread::yield();
+                        WaitForBatch(lastBatch);
 #endif
                     }
 #ifdef USE_UNITY_PROFILER
@@ -109,6 +121,10 @@ namespace RAC
 #if USE_BLOCKING_TASKS
             // release waiting tasks
             SetEvent(stopRequested);
+#else
+            // release parked workers
+            batchIndex.fetch_add(1, std::memory_order_seq_cst);
+            batchIndex.notify_all();
 #endif
 
 	        for (auto& worker : workers)
@@ -118,44 +134,150 @@ namespace RAC
 	        }
         }
 
-        void AudioThreadPool::ProcessAllSources(std::array<std::optional<Source>, MAX_SOURCES>& sources, ImageSourceManager& imageSources, Buffer<>& outputBuffer, const AudioData& audioData)
+        void AudioThreadPool::BeginBatch(size_t maxNumTasks)
+        {
+            // The previous batch has completed, so no worker refers to the descriptors
+            numBatchTasks = 0;
+            if (maxNumTasks > taskDescriptors.size()) [[unlikely]]
+            {
+                taskDescriptors.resize(maxNumTasks);
+                taskCosts.resize(maxNumTasks);
+                schedule.Reserve(maxNumTasks);
+            }
+        }
+
+        ////////////////////////////////////////
+
+        void AudioThreadPool::RunBatch()
+        {
+            if (numBatchTasks == 0)
+                return;
+
+            schedule.Plan(taskCosts, ToInt(numBatchTasks));
+            SpinLock tasksRemaining(numBatchTasks);
+            batchTasksRemaining = &tasksRemaining;
+
+            // Publishing a range releases the schedule and descriptors to the workers
+            for (size_t w = 0; w < workerRanges.size(); ++w)
+                workerRanges[w].range.store(PackRange(schedule.WorkerBegin(ToInt(w)), schedule.WorkerEnd(ToInt(w))), std::memory_order_release);
+#if USE_BLOCKING_TASKS
+            SetEvent(tasksAvailable);
+#else
+            // Sequentially consistent with numParkedWorkers, so either a parking worker sees the new batch or it is woken here
+            batchIndex.fetch_add(1, std::memory_order_seq_cst);
+            if (numParkedWorkers.load(std::memory_order_seq_cst) > 0)
+                batchIndex.notify_all();
+#endif
+
+            tasksRemaining.Lock();
+        }
+
+#if !USE_BLOCKING_TASKS
+        ////////////////////////////////////////
+
+        void AudioThreadPool::WaitForBatch(uint32_t& lastBatch)
+        {
+            const auto spinStart = std::chrono::steady_clock::now();
+            uint32_t batch = batchIndex.load(std::memory_order_acquire);
+            while (batch == lastBatch)
+            {
+                // Once the queue is empty, often a large wait until next used. _mm_pause() or SpinLock cause performance issues here causes 
+                if (std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - spinStart) < spinTime)
+                    std::this_thread::yield();
+                else
+                {
+                    numParkedWorkers.fetch_add(1, std::memory_order_seq_cst);
+                    batchIndex.wait(lastBatch, std::memory_order_seq_cst);
+                    numParkedWorkers.fetch_sub(1, std::memory_order_relaxed);
+                }
+                batch = batchIndex.load(std::memory_order_acquire);
+            }
+            lastBatch = batch;
+        }
+#endif
+
+        ////////////////////////////////////////
+
+        bool AudioThreadPool::RunNextChunk(size_t worker)
+        {
+            // Take the next (heaviest) chunk of our own range
+            std::atomic<uint64_t>& ownRange = workerRanges[worker].range;
+            uint64_t range = ownRange.load(std::memory_order_acquire);
+            while (RangeFirst(range) < RangeEnd(range))
+            {
+                if (ownRange.compare_exchange_weak(range, range + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    RunChunk(schedule.GetChunk(RangeFirst(range)), worker);
+                    return true;
+                }
+            }
+
+            // Steal the last (cheapest) chunk of another worker
+            for (size_t k = 1; k < workerRanges.size(); ++k)
+            {
+                std::atomic<uint64_t>& victimRange = workerRanges[(worker + k) % workerRanges.size()].range;
+                range = victimRange.load(std::memory_order_acquire);
+                while (RangeFirst(range) < RangeEnd(range))
+                {
+                    const uint32_t last = RangeEnd(range) - 1;
+                    if (victimRange.compare_exchange_weak(range, PackRange(RangeFirst(range), last), std::memory_order_acq_rel, std::memory_order_acquire))
+                    {
+                        RunChunk(schedule.GetChunk(last), worker);
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        ////////////////////////////////////////
+
+        void AudioThreadPool::RunChunk(const TaskSchedule::Chunk& chunk, size_t worker)
+        {
+            const std::vector<int>& order = schedule.Order();
+            for (int k = chunk.first; k < chunk.first + chunk.count; ++k)
+                taskDescriptors[order[k]].RunTimed(threadOutputBuffers[worker], threadReverbOutputs[worker]);
+
+            // The batch may complete (and the caller reuse the schedule) as soon as the counter is decremented
+            batchTasksRemaining->Subtract(chunk.count);
+        }
+
+        ////////////////////////////////////////
+
+        void AudioThreadPool::ProcessAllSources(std::array<std::optional<Source>, MAX_SOURCES>& sources, const std::vector<int>& activeSources,
+            ImageSourceManager& imageSources, const std::vector<int>& activeImageSources, Buffer<>& outputBuffer, const AudioData& audioData)
         {
             if (stop.load(std::memory_order_acquire))
                 return;
 
-			int maxNumTasks = audioData.earlyReverbEnabled ? MAX_SOURCES + MAX_IMAGESOURCES : MAX_SOURCES;
-            SpinLock tasksRemaining(maxNumTasks);
+			size_t maxNumTasks = audioData.earlyReverbEnabled ? activeSources.size() + activeImageSources.size() : activeSources.size();
+            BeginBatch(maxNumTasks);
 
-            for (size_t t = 0; t < threadCount; ++t)
+            for (size_t t = 0; t < threadOutputBuffers.size(); ++t)
                 threadOutputBuffers[t].Reset();
 
-            for (int i = 0; i < MAX_SOURCES; ++i)
+            // Active voices may have been removed since the lists were published
+            for (int i : activeSources)
             {
                 if (sources[i]->CanEdit())
-                {
-                    tasksRemaining.Subtract();
                     continue;
-                }
-                Enqueue(&sources[i].value(), &tasksRemaining, audioData);
+                Enqueue(&sources[i].value(), sourceCosts[i], audioData);
             }
 
             if (audioData.earlyReverbEnabled)
             {
-                for (int i = 0; i < MAX_IMAGESOURCES; ++i)
+                for (int i : activeImageSources)
                 {
                     if (imageSources.at(i).CanEdit())
-                    {
-                        tasksRemaining.Subtract();
                         continue;
-                    }
-                    Enqueue(&imageSources.at(i), &tasksRemaining, audioData);
+                    Enqueue(&imageSources.at(i), sourceCosts[MAX_SOURCES + i], audioData);
                 }
             }
 
-            tasksRemaining.Lock();
+            RunBatch();
 
             PROFILE_Diffraction
-            for (size_t t = 0; t < threadCount; ++t)
+            for (size_t t = 0; t < threadOutputBuffers.size(); ++t)
                 outputBuffer += threadOutputBuffers[t];
         }
 
@@ -166,18 +288,20 @@ namespace RAC
             if (stop.load(std::memory_order_acquire))
                 return;
 
-            SpinLock tasksRemaining(reverbSources.size());
+            BeginBatch(reverbSources.size());
+            if (reverbSources.size() > reverbSourceCosts.size()) [[unlikely]]
+                reverbSourceCosts.resize(reverbSources.size(), 0.0);
 
-            for (size_t t = 0; t < threadCount; ++t)
+            for (size_t t = 0; t < threadOutputBuffers.size(); ++t)
                 threadOutputBuffers[t].Reset();
 
             for (size_t i = 0; i < reverbSources.size(); ++i)
-                Enqueue(reverbSources[i].get(), &tasksRemaining, audioData);
+                Enqueue(reverbSources[i].get(), reverbSourceCosts[i], audioData);
 
-            tasksRemaining.Lock();
+            RunBatch();
 
             PROFILE_Diffraction
-            for (size_t t = 0; t < threadCount; ++t)
+            for (size_t t = 0; t < threadOutputBuffers.size(); ++t)
                 outputBuffer += threadOutputBuffers[t];
         }
 
@@ -186,21 +310,23 @@ namespace RAC
             if (stop.load(std::memory_order_acquire))
                 return;
 
-            SpinLock tasksRemaining(FDNs.size());
+            BeginBatch(FDNs.size());
+            if (FDNs.size() > fdnCosts.size()) [[unlikely]]
+                fdnCosts.resize(FDNs.size(), 0.0);
 
-            for (size_t t = 0; t < threadCount; ++t)
+            for (size_t t = 0; t < threadReverbOutputs.size(); ++t)
             {
                 for (size_t i = 0; i < outputBuffers.size(); ++i)
                     threadReverbOutputs[t][i].Reset();
             }
 
             for (size_t i = 0; i < FDNs.size(); ++i)
-                Enqueue(FDNs[i].get(), &tasksRemaining, audioData);
+                Enqueue(FDNs[i].get(), fdnCosts[i], audioData);
 
-            tasksRemaining.Lock();
+            RunBatch();
 
             PROFILE_Diffraction
-            for (size_t t = 0; t < threadCount; ++t)
+            for (size_t t = 0; t < threadReverbOutputs.size(); ++t)
             {
                 for (size_t i = 0; i < outputBuffers.size(); ++i)
                     outputBuffers[i] += threadReverbOutputs[t][i];
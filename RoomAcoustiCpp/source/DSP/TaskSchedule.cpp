@@ -0,0 +1,142 @@
+/*
+* @class TaskSchedule
+*
+* @brief Definition of TaskSchedule class
+*
+*/
+
+// C++ headers
+#include <algorithm>
+
+// DSP headers
+#include "DSP/TaskSchedule.h"
+
+namespace RAC
+{
+	namespace DSP
+	{
+		namespace
+		{
+			constexpr int CHUNKS_PER_WORKER = 4;		// Target number of chunks per worker, so idle workers have chunks to steal
+			constexpr int MAX_CHUNK_SIZE = 64;			// Maximum number of cheap tasks grouped into one chunk
+		}
+
+		//////////////////// TaskSchedule Class ////////////////////
+
+		////////////////////////////////////////
+
+		TaskSchedule::TaskSchedule(size_t numWorkers, size_t maxNumTasks)
+			: workerBegin(std::max(numWorkers, static_cast<size_t>(1)) + 1, 0), workerCosts(std::max(numWorkers, static_cast<size_t>(1)), 0.0), numChunks(0)
+		{
+			Reserve(maxNumTasks);
+		}
+
+		////////////////////////////////////////
+
+		void TaskSchedule::Reserve(size_t maxNumTasks)
+		{
+			if (order.size() >= maxNumTasks)
+				return;
+
+			// Every task may be a chunk
+			order.resize(maxNumTasks);
+			taskCosts.resize(maxNumTasks);
+			plannedChunks.resize(maxNumTasks);
+			chunkWorkers.resize(maxNumTasks);
+			chunks.resize(maxNumTasks);
+		}
+
+		////////////////////////////////////////
+
+		void TaskSchedule::Plan(const std::vector<Real>& costs, int numTasks)
+		{
+			Reserve(numTasks);
+			const int numWorkers = NumWorkers();
+
+			// Replace unknown costs with the mean known cost
+			Real knownCost = 0.0;
+			int numKnown = 0;
+			for (int i = 0; i < numTasks; ++i)
+			{
+				if (costs[i] > 0.0)
+				{
+					knownCost += costs[i];
+					++numKnown;
+				}
+			}
+			const Real defaultCost = numKnown > 0 ? knownCost / numKnown : 1.0;
+
+			Real totalCost = 0.0;
+			for (int i = 0; i < numTasks; ++i)
+			{
+				taskCosts[i] = costs[i] > 0.0 ? costs[i] : defaultCost;
+				totalCost += taskCosts[i];
+			}
+			const Real targetCost = totalCost / (numWorkers * CHUNKS_PER_WORKER);
+
+			// Heavy tasks first, most expensive first (ties in batch order)
+			int numHeavy = 0;
+			for (int i = 0; i < numTasks; ++i)
+			{
+				if (taskCosts[i] >= targetCost)
+					order[numHeavy++] = i;
+			}
+			std::sort(order.begin(), order.begin() + numHeavy, [this](int a, int b)
+				{
+					if (taskCosts[a] != taskCosts[b])
+						return taskCosts[a] > taskCosts[b];
+					return a < b;
+				});
+
+			numChunks = 0;
+			for (int k = 0; k < numHeavy; ++k)
+				plannedChunks[numChunks++] = { k, 1 };
+
+			// Group the cheap tasks in batch order
+			int next = numHeavy;
+			Real chunkCost = 0.0;
+			for (int i = 0; i < numTasks; ++i)
+			{
+				if (taskCosts[i] >= targetCost)
+					continue;
+
+				if (numChunks == numHeavy || chunkCost >= targetCost || plannedChunks[numChunks - 1].count >= MAX_CHUNK_SIZE)
+				{
+					plannedChunks[numChunks++] = { next, 0 };
+					chunkCost = 0.0;
+				}
+				order[next++] = i;
+				++plannedChunks[numChunks - 1].count;
+				chunkCost += taskCosts[i];
+			}
+
+			// Assign each chunk to the worker with the least assigned cost
+			std::fill(workerCosts.begin(), workerCosts.end(), 0.0);
+			std::fill(workerBegin.begin(), workerBegin.end(), 0);
+			for (int c = 0; c < numChunks; ++c)
+			{
+				int worker = 0;
+				for (int w = 1; w < numWorkers; ++w)
+				{
+					if (workerCosts[w] < workerCosts[worker])
+						worker = w;
+				}
+
+				const Chunk& chunk = plannedChunks[c];
+				for (int k = chunk.first; k < chunk.first + chunk.count; ++k)
+					workerCosts[worker] += taskCosts[order[k]];
+				chunkWorkers[c] = worker;
+				++workerBegin[worker + 1];
+			}
+
+			// Store the chunks of each worker contiguously, in the order they were assigned
+			for (int w = 0; w < numWorkers; ++w)
+				workerBegin[w + 1] += workerBegin[w];
+			for (int c = 0; c < numChunks; ++c)
+				chunks[workerBegin[chunkWorkers[c]]++] = plannedChunks[c];
+			for (int w = numWorkers; w > 0; --w)
+				workerBegin[w] = workerBegin[w - 1];
+			workerBegin[0] = 0;
+		}
+	}
+}
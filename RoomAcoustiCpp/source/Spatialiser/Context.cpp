@@ -45,11 +45,21 @@ namespace RAC
 #endif
 #endif
 
+		namespace
+		{
+			// Background update rates. Runs are triggered by updates, limited by the minimum interval
+			// and repeated after the maximum interval to pick up any changes that were not notified
+			constexpr std::chrono::milliseconds IEM_MIN_INTERVAL{ 10 };
+			constexpr std::chrono::milliseconds IEM_MAX_INTERVAL{ 500 };
+			constexpr std::chrono::milliseconds TRACING_MIN_INTERVAL{ 50 };
+			constexpr std::chrono::milliseconds TRACING_MAX_INTERVAL{ 1000 };
+		}
+
 		//////////////////// IEM Thread ////////////////////
 
 		////////////////////////////////////////
 
-		void IEMProcessor(Context* context)
+		void IEMProcessor(Context* context, BackgroundScheduler* scheduler, const size_t task)
 		{
 
 			RAC_DEBUG_LOG("Begin image edge model thread", DebugType::Init);
@@ -63,18 +73,15 @@ namespace RAC
 
 			std::shared_ptr<ImageEdge> imageEdgeModel = context->GetImageEdgeModel();
 
-			const int loopInterval_ms = 10;
-			while (context->IsRunning())
+			while (scheduler->WaitForWork(task))
 			{
-				auto startTime = std::chrono::steady_clock::now();
-
 				// Update IEM
 				imageEdgeModel->RunIEM();
+				scheduler->Finish(task);
 
-				auto endTime = std::chrono::steady_clock::now();
-				auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-				if (elapsedTime < loopInterval_ms)
-					std::this_thread::sleep_for(std::chrono::milliseconds(loopInterval_ms - elapsedTime));
+				// Continue with the remaining orders if the time budget ran out
+				if (imageEdgeModel->HasIncompleteOrders())
+					scheduler->Notify(task);
 			}
 
 #ifdef USE_UNITY_PROFILER
@@ -88,7 +95,7 @@ namespace RAC
 
 		////////////////////////////////////////
 
-		void RayTracerProcessor(Context* context)
+		void RayTracerProcessor(Context* context, BackgroundScheduler* scheduler, const size_t task)
 		{
 
 			RAC_DEBUG_LOG("Begin racy tracing thread", DebugType::Init);
@@ -98,18 +105,15 @@ namespace RAC
 #endif
 			std::shared_ptr<TracingThread> rayTracing = context->GetRayTracing();
 
-			const int loopInterval_ms = 50;
-			while (context->IsRunning())
+			while (scheduler->WaitForWork(task))
 			{
-				auto startTime = std::chrono::steady_clock::now();
-
 				// Update RTM
 				rayTracing->RunTracing();
+				scheduler->Finish(task);
 
-				auto endTime = std::chrono::steady_clock::now();
-				auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-				if (elapsedTime < loopInterval_ms)
-					std::this_thread::sleep_for(std::chrono::milliseconds(loopInterval_ms - elapsedTime));
+				// Continue refining the progressive results until they converge
+				if (rayTracing->IsRefining())
+					scheduler->Notify(task);
 			}
 
 #ifdef USE_UNITY_PROFILER
@@ -156,6 +160,12 @@ namespace RAC
 				numDesiredWorkerThreads = optionalArguments.desiredAudioThreads.value();
 			else
 				numDesiredWorkerThreads = std::min((unsigned int)8, std::thread::hardware_concurrency());
+			audioThreadSpinTime = optionalArguments.audioThreadSpinTime.value_or(DEFAULT_AUDIO_THREAD_SPIN_TIME);
+
+			numDesiredIEMThreads = std::max(optionalArguments.desiredIEMThreads.value_or(1), static_cast<size_t>(1));
+
+			iemTask = scheduler.AddTask(IEM_MIN_INTERVAL, IEM_MAX_INTERVAL);
+			tracingTask = scheduler.AddTask(TRACING_MIN_INTERVAL, TRACING_MAX_INTERVAL);
 
 			mSources = std::make_shared<SourceManager>(&mCore, dspConfig);
 			mRoom = std::make_shared<Room>(dspConfig->GetData().numFrequencyBands);
@@ -277,7 +287,10 @@ namespace RAC
 			mSources->UpdateDiffractionModel(model);
 
 			if (earlyReverbInitialised.load(std::memory_order_acquire))
+			{
 				mImageEdgeModel->UpdateDiffractionModel(model);
+				scheduler.Notify(iemTask);
+			}
 		}
 
 		////////////////////////////////////////
@@ -285,7 +298,7 @@ namespace RAC
 		void Context::CreateAudioThreadPool()
 		{
 			RAC_DEBUG_ASSERT(!audioThreadPool, "Audio thread pool already created");
-			audioThreadPool = std::make_unique<AudioThreadPool>(numDesiredWorkerThreads, dspConfig);
+			audioThreadPool = std::make_unique<AudioThreadPool>(numDesiredWorkerThreads, dspConfig, audioThreadSpinTime);
 		}
 
 
@@ -304,12 +317,15 @@ namespace RAC
 			RAC_DEBUG_ASSERT(data.specularDiffOrder >= 0, "Invalid specular diffraction order: " + ToString(data.specularDiffOrder));
 			RAC_DEBUG_ASSERT(data.minEdgeLength >= 0, "Invalid minimum edge length: " + ToString(data.minEdgeLength));
 			RAC_DEBUG_ASSERT(data.maxPathLength >= 0, "Invalid maximum path length: " + ToString(data.maxPathLength));
+			RAC_DEBUG_ASSERT(data.energyFloor >= 0, "Invalid energy floor: " + ToString(data.energyFloor));
+			RAC_DEBUG_ASSERT(data.maxImageSources >= 0, "Invalid maximum number of image sources: " + ToString(data.maxImageSources));
+			RAC_DEBUG_ASSERT(data.timeBudget >= 0, "Invalid time budget: " + ToString(data.timeBudget));
 
 			UpdateDiffractionModel(model);
-			mImageEdgeModel = std::make_shared<ImageEdge>(mRoom, mSources, data, dspConfig);
+			mImageEdgeModel = std::make_shared<ImageEdge>(mRoom, mSources, data, dspConfig, numDesiredIEMThreads);
 
 			// Start background thread after all systems are initialized
-			IEMThread = std::thread(IEMProcessor, this);
+			IEMThread = std::thread(IEMProcessor, this, &scheduler, iemTask);
 
 			EnableEarlyReverb(enabled);
 			earlyReverbInitialised.store(true, std::memory_order_release);
@@ -327,7 +343,7 @@ namespace RAC
 			mReverbInput = Matrix<>::Zero(dimensions.first, dimensions.second);
 
 			// Start background thread after all systems are initialized
-			rayTracingThread = std::thread(RayTracerProcessor, this);
+			rayTracingThread = std::thread(RayTracerProcessor, this, &scheduler, tracingTask);
 			EnableLateReverb(data.enabled);
 		}
 
@@ -356,8 +372,6 @@ namespace RAC
 
 			InitLateReverb(data);
 
-			mRoom->CreateTriangleMeshSoA();
-
 			lateReverbInitialised.store(true, std::memory_order_release);
 			return true;
 		}
@@ -387,7 +401,6 @@ namespace RAC
 			InitLateReverb(data);
 
 			mSources->UpdateMoDARTParameters(data.frequencyIndexing, dspConfig->GetData().numFrames);
-			mRoom->CreateTriangleMeshSoA();
 
 			lateReverbInitialised.store(true, std::memory_order_release);
 			return true;
@@ -422,6 +435,7 @@ namespace RAC
 				RAC_DEBUG_LOG("Early reverb not initialised when updating listener position", DebugType::Warning);
 
 			listenerInitialised = true;
+			NotifyBackgroundThreads();
 		}
 
 		////////////////////////////////////////
@@ -475,6 +489,7 @@ namespace RAC
 			else
 				// Update source position, orientation and virtual sources
 				mSources->Update(id, position, orientation, distance);
+			NotifyBackgroundThreads();
 		}
 
 		////////////////////////////////////////
@@ -488,6 +503,7 @@ namespace RAC
 				return;
 			}
 			mSources->Remove(id);
+			NotifyBackgroundThreads();
 		}
 
 		////////////////////////////////////////
@@ -500,6 +516,7 @@ namespace RAC
 			mRoom->UpdateMaterial(id, material);
 			if (lateReverbInitialised.load(std::memory_order_acquire))
 				mReverb->SetTargetT60(mRoom->GetReverbTime());
+			NotifyBackgroundThreads();
 		}
 
 		////////////////////////////////////////
@@ -512,6 +529,7 @@ namespace RAC
 			Wall wall = Wall(vData, materialID);
 			size_t id = mRoom->AddWall(wall);
 			mRoom->InitEdges(id);
+			NotifyBackgroundThreads();
 			return static_cast<int>(id);
 		}
 
@@ -521,6 +539,7 @@ namespace RAC
 		{
 			RAC_DEBUG_LOG("Remove Wall", DebugType::Remove);
 			mRoom->RemoveWall(id);
+			NotifyBackgroundThreads();
 		}
 
 		////////////////////////////////////////
@@ -529,6 +548,7 @@ namespace RAC
 		{
 			mRoom->UpdatePlanes();
 			mRoom->UpdateEdges();
+			NotifyBackgroundThreads();
 		}
 
 		////////////////////////////////////////
@@ -572,6 +592,24 @@ namespace RAC
 
 		////////////////////////////////////////
 
+		bool Context::BakeImageSources(const std::string& filePath)
+		{
+			if (!earlyReverbInitialised.load(std::memory_order_acquire))
+			{
+				RAC_DEBUG_LOG("Early reverberation has not been initialised", DebugType::Error);
+				return false;
+			}
+
+			mImageEdgeModel->RequestBake(filePath);
+
+			bool completed = scheduler.WaitForRun(iemTask);
+			while (completed && mImageEdgeModel->IsBakePending())
+				completed = scheduler.WaitForRun(iemTask);
+			return completed && mImageEdgeModel->BakeSucceeded();
+		}
+
+		////////////////////////////////////////
+
 		void Context::RecordImpulseResponse(const Vec3& position, const Vec4& orientation, Buffer<>& outputBuffer)
 		{
 			int id = InitSource();
@@ -585,8 +623,6 @@ namespace RAC
 			UpdateSourceDirectivity(static_cast<size_t>(id), SourceDirectivity::omni);
 			UpdateSource(static_cast<size_t>(id), position, orientation);
 
-			mImageEdgeModel->ResetEndFlag();
-			mRayTracing->ResetEndFlag();
 			UpdateImpulseResponseMode(true);
 			ResetLateReverb();
 
@@ -594,11 +630,20 @@ namespace RAC
 			Buffer<> input = Buffer<>::Zero(numFrames);
 			Buffer<> output = Buffer<>::Zero(2 * numFrames);
 
-			while (!mImageEdgeModel->HasCompleted())
-				std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-			while (!mRayTracing->HasCompleted())
-				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			// Wait for both models to complete a run that includes the new source (and all image edge model orders).
+			// A model that has not been initialised has no thread to complete the run
+			if (earlyReverbInitialised.load(std::memory_order_acquire))
+			{
+				bool completed = scheduler.WaitForRun(iemTask);
+				while (completed && mImageEdgeModel->HasIncompleteOrders())
+					completed = scheduler.WaitForRun(iemTask);
+			}
+			if (lateReverbInitialised.load(std::memory_order_acquire))
+			{
+				bool completed = scheduler.WaitForRun(tracingTask);
+				while (completed && mRayTracing && mRayTracing->IsRefining())
+					completed = scheduler.WaitForRun(tracingTask);
+			}
 
 			// Run once with empty input (ensures all interpolation is updated)
 			mSources->SetInputBuffer(static_cast<size_t>(id), input);
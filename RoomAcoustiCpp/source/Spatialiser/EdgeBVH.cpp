@@ -0,0 +1,112 @@
+/*
+* @class EdgeBVH
+*
+* @brief Definition of EdgeBVH class
+*
+*/
+
+// C++ headers
+#include <algorithm>
+
+// Common headers
+#include "Common/Debug.h"
+
+// Spatialiser headers
+#include "Spatialiser/EdgeBVH.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		namespace
+		{
+			constexpr int MAX_LEAF_SIZE = 4;		// Maximum number of edges stored in a leaf node
+			constexpr int MAX_STACK_DEPTH = 64;		// Maximum traversal stack depth
+		}
+
+		//////////////////// EdgeBVH Class ////////////////////
+
+		////////////////////////////////////////
+
+		void EdgeBVH::Build(const std::vector<Edge>& edges)
+		{
+			Clear();
+			if (edges.empty())
+				return;
+
+			mPrimitives.reserve(edges.size());
+			for (size_t i = 0; i < edges.size(); ++i)
+			{
+				Primitive primitive;
+				primitive.edgeIdx = i;
+				primitive.bounds.Grow(edges[i].GetBase());
+				primitive.bounds.Grow(edges[i].GetTop());
+
+				// Pad the bounds as edges are usually axis aligned and vertices are rounded
+				for (int j = 0; j < 3; ++j)
+				{
+					primitive.bounds.min[j] -= EPS_GENERAL;
+					primitive.bounds.max[j] += EPS_GENERAL;
+					primitive.centroid[j] = REAL_CONST(0.5) * (primitive.bounds.min[j] + primitive.bounds.max[j]);
+				}
+				mPrimitives.push_back(primitive);
+			}
+
+			mNodes.reserve(2 * mPrimitives.size());
+			BuildMedianBVH(mNodes, mPrimitives, 0, ToInt(mPrimitives.size()), MAX_LEAF_SIZE,
+				[](const Primitive& a, const Primitive& b) { return a.edgeIdx < b.edgeIdx; });
+		}
+
+		////////////////////////////////////////
+
+		void EdgeBVH::FindEdgesNear(const Vec3& point, const Real maxDistance, std::vector<size_t>& edgeIndices) const
+		{
+			edgeIndices.clear();
+			if (mNodes.empty())
+				return;
+
+			const std::array<Real, 3> p = { point.x(), point.y(), point.z() };
+			const Real maxDistanceSquared = maxDistance * maxDistance;
+
+			std::array<int, MAX_STACK_DEPTH> stack;
+			int stackSize = 0;
+			stack[stackSize++] = 0;
+
+			while (stackSize > 0)
+			{
+				const int nodeIdx = stack[--stackSize];
+				const BVHNode& node = mNodes[nodeIdx];
+				if (node.bounds.DistanceSquared(p) > maxDistanceSquared)
+					continue;
+
+				if (node.count > 0)
+				{
+					for (int i = node.firstPrimitive; i < node.firstPrimitive + node.count; ++i)
+					{
+						if (mPrimitives[i].bounds.DistanceSquared(p) <= maxDistanceSquared)
+							edgeIndices.push_back(mPrimitives[i].edgeIdx);
+					}
+					continue;
+				}
+
+				if (stackSize + 2 > MAX_STACK_DEPTH) // case: stack full (the median build keeps the depth well below this)
+				{
+					int first, last;
+					SubtreePrimitives(mNodes, nodeIdx, first, last);
+					for (int i = first; i < last; ++i)
+					{
+						if (mPrimitives[i].bounds.DistanceSquared(p) <= maxDistanceSquared)
+							edgeIndices.push_back(mPrimitives[i].edgeIdx);
+					}
+					continue;
+				}
+				stack[stackSize++] = node.rightChild;
+				stack[stackSize++] = nodeIdx + 1;
+			}
+
+			// Keep the room snapshot order so results do not depend on the tree layout
+			std::sort(edgeIndices.begin(), edgeIndices.end());
+		}
+	}
+}
@@ -9,11 +9,17 @@
 
 // C++ headers
 #include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
 
 // Common headers
 #include "Common/RACProfiler.h"
 #include "Common/Debug.h"
 
+// Common headers
+#include "Common/Hash.h"
+
 // Spatialiser headers
 #include "Spatialiser/ImageEdge.h"
 #include "Spatialiser/Directivity.h"
@@ -23,17 +29,32 @@ namespace RAC
 	using namespace Common;
 	namespace Spatialiser
 	{
+		namespace
+		{
+			constexpr size_t MIN_FRONTIER_SEGMENT_SIZE = 512;		// Minimum number of (plane or edge, image source) pairs per frontier segment
+			constexpr size_t FRONTIER_SEGMENTS_PER_THREAD = 4;		// Maximum number of frontier segments per thread (for load balancing)
+			constexpr Real BUDGET_HYSTERESIS = 2.0;					// Energy boost (3dB) of rendered image sources when ranking against the image source budget
+
+			const std::vector<size_t> NO_CANDIDATES;				// Candidate list for image sources that can not be extended
+		}
+
 		//////////////////// ImageEdge Class ////////////////////
 
 		////////////////////////////////////////
 
-		ImageEdge::ImageEdge(shared_ptr<Room> room, shared_ptr<SourceManager> sourceManager, const EarlyReverbData& data, const std::shared_ptr<DSPConfig>& dspConfig) :
+		ImageEdge::ImageEdge(shared_ptr<Room> room, shared_ptr<SourceManager> sourceManager, const EarlyReverbData& data, const std::shared_ptr<DSPConfig>& dspConfig, const size_t numThreads) :
 			mRoom(room), mSourceManager(sourceManager), frequencyBands(dspConfig->GetData().numFrequencyBands),
 			earlyReverbData(data, dspConfig->GetDiffractionModel()), earlyReverbDataIncoming(data, dspConfig->GetDiffractionModel()),
-			sourceAudioData(ToInt(frequencyBands.Length()), false)
+			mTreeMargin(std::max(earlyReverbData.listenerTreeMargin, REAL_CONST(0.0)))
 		{
-			sp = std::vector<std::vector<std::shared_ptr<ImageSourceData>>>();
-			sp.push_back(std::vector<std::shared_ptr<ImageSourceData>>());
+			const size_t numWorkspaces = std::max(numThreads, static_cast<size_t>(1));
+			mWorkspaces.reserve(numWorkspaces);
+			for (size_t i = 0; i < numWorkspaces; ++i)
+				mWorkspaces.emplace_back(ToInt(frequencyBands.Length()));
+
+			// The calling thread processes sources alongside the pool
+			if (numWorkspaces > 1)
+				mThreadPool = std::make_unique<ThreadPool>(numWorkspaces - 1);
 
 			// TODO: Move to ray tracing thread
 			// shared_ptr<Reverb> sharedReverb = mReverb.lock();
@@ -46,18 +67,20 @@ namespace RAC
 		void ImageEdge::RunIEM()
 		{
 			PROFILE_BackgroundThread
+			const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 			bool doIEM = false;
-
-			iemStartFlag.store(true, std::memory_order_release);
+			bool receiverMoved = false;
+			std::string bakePath;
 
 			shared_ptr<Room> sharedRoom = mRoom.lock();
-			if (sharedRoom->HasChanged())
+			std::shared_ptr<const RoomSnapshot> roomSnapshot = sharedRoom->GetSnapshot();
+			if (roomSnapshot != mRoomSnapshot)
 			{
-				// Recopy room data (planes, walls, edges)
-				mPlanes = sharedRoom->GetPlanes();
-				mWalls = sharedRoom->GetWalls();
-				mMaterials = sharedRoom->GetMaterials();
-				mEdges = sharedRoom->GetEdges();
+				// Share the latest room geometry (planes, walls, edges)
+				mRoomSnapshot = std::move(roomSnapshot);
+				mPlaneReceiverValid.assign(mRoomSnapshot->NumPlanes(), false);
+				mEdgeReceiverZones.assign(mRoomSnapshot->NumEdges(), EdgeZone::Invalid);
+				receiverMoved = true;
 				doIEM = true;
 			}
 
@@ -71,44 +94,546 @@ namespace RAC
 				{
 					mListenerPosition = mListenerPositionIncoming;
 					listenerMoved = false;
+					receiverMoved = true;
 					doIEM = true;
 				}
 				if (configChanged)
 				{
 					earlyReverbData = earlyReverbDataIncoming;
+					mTreeMargin = std::max(earlyReverbData.listenerTreeMargin, REAL_CONST(0.0));
 					configChanged = false;
+					mConfigVersion++;
 					doIEM = true;
 				}
+				if (imageSourceCacheLoaded)
+				{
+					mImageSourceCache = std::move(mImageSourceCacheIncoming);
+					imageSourceCacheLoaded = false;
+					doIEM = true;
+				}
+				if (bakeRequested)
+				{
+					bakePath = bakeFilePath;
+					bakeRequested = false;
+				}
+			}
+
+			// Receiver validity only changes when the listener moves or the room changes
+			if (receiverMoved)
 				UpdateRValid();
+
+			// Release the image source trees of sources that no longer exist
+			std::vector<bool> sourceExists(mSourceTrees.size(), false);
+			for (const Source::Data& source : mSources)
+			{
+				if (source.id >= mSourceTrees.size())
+				{
+					mSourceTrees.resize(source.id + 1);
+					sourceExists.resize(source.id + 1, false);
+				}
+				sourceExists[source.id] = true;
+			}
+			for (size_t i = 0; i < mSourceTrees.size(); ++i)
+			{
+				if (!sourceExists[i] && mSourceTrees[i].valid)
+					mSourceTrees[i] = SourceTree();
 			}
 
-			for (Source::Data& source : mSources)
+			// The baked trees replace the stored trees, so all sources are updated afterwards
+			if (!bakePath.empty())
 			{
-				if (doIEM || source.needsUpdate)
+				bakeSucceeded.store(BakeImageSources(bakePath), std::memory_order_release);
+				bakePending.store(false, std::memory_order_release);
+				doIEM = true;
+			}
+
+			// Room data is read only from here on
+			ProcessSourcesInParallel(mSources.size(), doIEM, false);
+
+			// The image source budget is shared by all sources, so results are handed over once every source has been processed
+			SubmitImageSources(*sharedSource);
+
+			// Progressive mode: extend the incomplete trees one order at a time, publishing each order for all sources
+			// before starting the next, until the trees are complete or the time budget has run out
+			size_t numIncomplete = 0;
+			if (earlyReverbData.timeBudget > 0.0)
+			{
+				const auto deadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<Real>(earlyReverbData.timeBudget));
+				numIncomplete = NumIncompleteTrees();
+				while (numIncomplete > 0 && std::chrono::steady_clock::now() < deadline)
 				{
-					ReflectPointInRoom(source, sourceAudioData, imageSources);
-					sharedSource->UpdateSourceData(source.id, sourceAudioData, imageSources);
+					ProcessSourcesInParallel(numIncomplete, false, true);
+					SubmitImageSources(*sharedSource);
+					numIncomplete = NumIncompleteTrees();
 				}
 			}
+			incompleteOrders.store(numIncomplete > 0, std::memory_order_release);
+		}
+
+		////////////////////////////////////////
 
-			iemEndFlag.store(true, std::memory_order_release);
-			iemStartFlag.store(false, std::memory_order_release);
+		void ImageEdge::ProcessSourcesInParallel(const size_t numSources, const bool doIEM, const bool extend)
+		{
+			// Sources are claimed one at a time by each thread
+			nextSource.store(0, std::memory_order_relaxed);
+			const size_t numWorkers = std::min(mWorkspaces.size(), numSources);
+			numFrontierHelpers = mWorkspaces.size() - std::max(numWorkers, static_cast<size_t>(1));
+			if (numWorkers > 1)
+			{
+				{
+					lock_guard<std::mutex> lock(workerMutex);
+					activeWorkers = numWorkers - 1;
+				}
+				for (size_t i = 1; i < numWorkers; ++i)
+				{
+					mThreadPool->Enqueue([this, i, doIEM, extend]()
+						{
+							ProcessSources(mWorkspaces[i], doIEM, extend);
+							{
+								lock_guard<std::mutex> lock(workerMutex);
+								--activeWorkers;
+							}
+							workerCondition.notify_one();
+						});
+				}
+			}
+
+			ProcessSources(mWorkspaces[0], doIEM, extend);
+
+			if (numWorkers > 1)
+			{
+				std::unique_lock<std::mutex> lock(workerMutex);
+				workerCondition.wait(lock, [this] { return activeWorkers == 0; });
+			}
 		}
 
-		void ImageEdge::ResetImageSources()
+		////////////////////////////////////////
+
+		void ImageEdge::ProcessSources(IEMWorkspace& workspace, const bool doIEM, const bool extend)
 		{
-			for (auto& reflOrder : sp)
+			size_t idx = nextSource.fetch_add(1, std::memory_order_relaxed);
+			while (idx < mSources.size())
 			{
-				for (auto& vS : reflOrder)
+				const Source::Data& source = mSources[idx];
+				if (extend ? !IsComplete(mSourceTrees[source.id]) : doIEM || source.needsUpdate)
+					ProcessSource(source, workspace, extend);
+				idx = nextSource.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::ProcessSource(const Source::Data& source, IEMWorkspace& workspace, const bool extend)
+		{
+			// Each source is processed by a single thread, so its tree can be moved into the workspace
+			SourceTree& tree = mSourceTrees[source.id];
+			if (mImageSourceCache && !CanReuseTree(source, tree))
+				SeedTree(source, tree);
+			SwapTree(workspace, tree);
+
+			const bool progressive = earlyReverbData.timeBudget > 0.0;
+			if (CanReuseTree(source, tree))
+			{
+				// The listener has not moved since the found orders were checked, so only the next order needs receiver checks
+				if (extend)
+					RestoreImageSources(workspace.sp, workspace.imageSources);
+				else
+					UpdateReceiverPaths(source, workspace, tree.numOrders);
+			}
+			else
+			{
+				// In progressive mode the rendered higher orders are kept until they are recomputed
+				if (progressive)
+					RetainImageSources(workspace, tree);
+				else
+					tree.retained.clear();
+
+				tree.numOrders = ReflectPointInRoom(source, workspace, progressive ? 1 : earlyReverbData.maxOrder);
+				tree.sourcePosition = source.position;
+				tree.listenerPosition = mListenerPosition;
+				tree.listenerMargin = mTreeMargin;
+				tree.roomVersion = mRoomSnapshot->GetVersion();
+				tree.configVersion = mConfigVersion;
+				tree.valid = true;
+			}
+
+			if (extend && !IsComplete(tree))
+				tree.numOrders = HigherOrderPaths(source, workspace, tree.numOrders, tree.numOrders + 1);
+
+			SwapTree(workspace, tree);
+
+			// Retained image sources are handed over alongside the recomputed orders until their own order is recomputed
+			for (size_t refIdx = 0; refIdx < tree.retained.size(); ++refIdx)
+			{
+				if (ToInt(refIdx) < tree.numOrders)
+					tree.retained[refIdx].clear();
+				else
+					tree.imageSources.insert(tree.retained[refIdx].begin(), tree.retained[refIdx].end());
+			}
+
+			tree.energies.clear();
+			for (const auto& [key, imageSource] : tree.imageSources)
+				tree.energies.emplace_back(key, EstimateEnergy(*imageSource));
+			tree.pendingUpdate = true;
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::SubmitImageSources(SourceManager& sourceManager)
+		{
+			const size_t budget = std::min(static_cast<size_t>(std::max(earlyReverbData.maxImageSources, 0)), MAX_IMAGESOURCES);
+			auto score = [](const SourceTree& tree, const ImageSourceKey& key, const Real energy)
+				{
+					return tree.rendered.find(key) != tree.rendered.end() ? BUDGET_HYSTERESIS * energy : energy;
+				};
+
+			// Find the score of the last image source within the budget
+			mBudgetScores.clear();
+			for (const Source::Data& source : mSources)
+			{
+				const SourceTree& tree = mSourceTrees[source.id];
+				for (const auto& [key, energy] : tree.energies)
+					mBudgetScores.push_back(score(tree, key, energy));
+			}
+
+			Real threshold = 0.0;
+			size_t numTies = mBudgetScores.size();		// Number of image sources scoring exactly the threshold that can be admitted
+			if (mBudgetScores.size() > budget)
+			{
+				if (budget == 0)
+				{
+					threshold = std::numeric_limits<Real>::max();
+					numTies = 0;
+				}
+				else
+				{
+					auto last = mBudgetScores.begin() + (budget - 1);
+					std::nth_element(mBudgetScores.begin(), last, mBudgetScores.end(), std::greater<Real>());
+					threshold = *last;
+					numTies = budget - static_cast<size_t>(std::count_if(mBudgetScores.begin(), last, [threshold](const Real x) { return x > threshold; }));
+				}
+			}
+
+			for (const Source::Data& source : mSources)
+			{
+				SourceTree& tree = mSourceTrees[source.id];
+				mAdmitted.clear();
+				for (const auto& [key, energy] : tree.energies)
 				{
-					if (vS.use_count() > 1)
+					const Real x = score(tree, key, energy);
+					if (x > threshold)
+						mAdmitted.insert(key);
+					else if (x == threshold && numTies > 0)
 					{
-						auto it = imageSources.find(vS->GetKey());
-						vS.swap(it->second);
+						mAdmitted.insert(key);
+						numTies--;
+					}
+				}
+
+				if (tree.pendingUpdate)
+				{
+					for (auto it = tree.imageSources.begin(); it != tree.imageSources.end();)
+					{
+						if (mAdmitted.find(it->first) == mAdmitted.end())
+							it = tree.imageSources.erase(it);
+						else
+							++it;
 					}
 				}
+				else
+				{
+					if (mAdmitted == tree.rendered)
+						continue;
+
+					// The tree is unchanged, so its stored image sources only need to be filtered again
+					FilterImageSources(tree, mAdmitted);
+				}
+
+				sourceManager.UpdateSourceData(source.id, tree.sourceAudioData, tree.imageSources);
+				tree.rendered.swap(mAdmitted);
+				tree.pendingUpdate = false;
+			}
+		}
+
+		////////////////////////////////////////
+
+		std::unordered_set<ImageSourceKey, ImageSourceKeyHash> ImageEdge::GetImageSourceKeys(const size_t id) const
+		{
+			if (id >= mSourceTrees.size())
+				return {};
+			return mSourceTrees[id].rendered;
+		}
+
+		////////////////////////////////////////
+
+		bool ImageEdge::LoadImageSourceCache(const std::string& filePath)
+		{
+			std::shared_ptr<const ImageSourceCache> cache = ImageSourceCache::Read(filePath);
+			if (!cache)
+			{
+				RAC_DEBUG_LOG("Failed to load image source cache: " + filePath, DebugType::Error);
+				return false;
+			}
+
+			lock_guard<std::mutex> lock(dataStoreMutex);
+			mImageSourceCacheIncoming = std::move(cache);
+			imageSourceCacheLoaded = true;
+			return true;
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::SeedTree(const Source::Data& source, SourceTree& tree) const
+		{
+			if (mImageSourceCache->GetGeometryHash() != mRoomSnapshot->GetGeometryHash() || mImageSourceCache->GetConfigHash() != GetConfigHash())
+				return;
+			if ((mListenerPosition - mImageSourceCache->GetListenerPosition()).Normal() > mImageSourceCache->GetListenerRadius())
+				return;
+
+			const ImageSourceCache::Entry* entry = mImageSourceCache->Find(source.position);
+			if (!entry)
+				return;
+
+			// The stored image sources may still be rendered, so the baked image sources are copied into a new store
+			tree.sp.clear();
+			tree.sp.resize(std::max(entry->sp.size(), static_cast<size_t>(1)));
+			for (size_t refIdx = 0; refIdx < entry->sp.size(); ++refIdx)
+			{
+				tree.sp[refIdx].reserve(entry->sp[refIdx].size());
+				for (const std::shared_ptr<ImageSourceData>& imageSource : entry->sp[refIdx])
+					tree.sp[refIdx].push_back(std::make_shared<ImageSourceData>(*imageSource));
+			}
+
+			tree.retained.clear();
+			tree.numOrders = entry->numOrders;
+			tree.sourcePosition = source.position;
+			tree.listenerPosition = mImageSourceCache->GetListenerPosition();
+			tree.listenerMargin = mImageSourceCache->GetListenerRadius();
+			tree.roomVersion = mRoomSnapshot->GetVersion();
+			tree.configVersion = mConfigVersion;
+			tree.valid = true;
+		}
+
+		////////////////////////////////////////
+
+		bool ImageEdge::BakeImageSources(const std::string& filePath)
+		{
+			if (!mRoomSnapshot || mRoomSnapshot->NumWalls() == 0)
+			{
+				RAC_DEBUG_LOG("Failed to bake image sources: no room geometry", DebugType::Error);
+				return false;
+			}
+
+			// The trees are built for a listener anywhere in the sphere bounding the room
+			Vec3 minCorner = mRoomSnapshot->GetWall(0).GetVertices()[0];
+			Vec3 maxCorner = minCorner;
+			for (size_t i = 0; i < mRoomSnapshot->NumWalls(); ++i)
+			{
+				for (const Vec3& vertex : mRoomSnapshot->GetWall(i).GetVertices())
+				{
+					minCorner = Vec3(std::min(minCorner.x(), vertex.x()), std::min(minCorner.y(), vertex.y()), std::min(minCorner.z(), vertex.z()));
+					maxCorner = Vec3(std::max(maxCorner.x(), vertex.x()), std::max(maxCorner.y(), vertex.y()), std::max(maxCorner.z(), vertex.z()));
+				}
+			}
+			const Vec3 centre = REAL_CONST(0.5) * (minCorner + maxCorner);
+			const Real treeMargin = mTreeMargin;
+			const Real radius = REAL_CONST(0.5) * (maxCorner - minCorner).Normal() + treeMargin;
+
+			const Vec3 listenerPosition = mListenerPosition;
+			mListenerPosition = centre;
+			mTreeMargin = radius;
+			UpdateRValid();
+
+			ImageSourceCache cache(mRoomSnapshot->GetGeometryHash(), GetConfigHash(), centre, radius, frequencyBands.Length());
+			IEMWorkspace& workspace = mWorkspaces[0];
+			numFrontierHelpers = mWorkspaces.size() - 1;
+			for (const Source::Data& source : mSources)
+			{
+				SourceTree& tree = mSourceTrees[source.id];
+				SwapTree(workspace, tree);
+
+				tree.retained.clear();
+				tree.numOrders = ReflectPointInRoom(source, workspace, earlyReverbData.maxOrder);
+				tree.sourcePosition = source.position;
+				tree.listenerPosition = centre;
+				tree.listenerMargin = radius;
+				tree.roomVersion = mRoomSnapshot->GetVersion();
+				tree.configVersion = mConfigVersion;
+				tree.valid = true;
+				cache.Add(source.position, tree.numOrders, workspace.sp);
+
+				SwapTree(workspace, tree);
+			}
+
+			mListenerPosition = listenerPosition;
+			mTreeMargin = treeMargin;
+			UpdateRValid();
+
+			if (!cache.Write(filePath))
+			{
+				RAC_DEBUG_LOG("Failed to write image source cache: " + filePath, DebugType::Error);
+				return false;
+			}
+			return true;
+		}
+
+		////////////////////////////////////////
+
+		uint64_t ImageEdge::GetConfigHash() const
+		{
+			uint64_t hash = HASH_OFFSET_BASIS;
+			HashValue(hash, earlyReverbData.reflOrder);
+			HashValue(hash, earlyReverbData.shadowDiffOrder);
+			HashValue(hash, earlyReverbData.specularDiffOrder);
+			HashValue(hash, earlyReverbData.minEdgeLength);
+			HashValue(hash, earlyReverbData.maxPathLength);
+			HashValue(hash, earlyReverbData.energyFloor);
+			HashValue(hash, frequencyBands.Length());
+			return hash;
+		}
+
+		////////////////////////////////////////
+
+		bool ImageEdge::CanReuseTree(const Source::Data& source, const SourceTree& tree) const
+		{
+			if (!tree.valid)
+				return false;
+			if (tree.roomVersion != mRoomSnapshot->GetVersion() || tree.configVersion != mConfigVersion)
+				return false;
+			if (tree.sourcePosition != source.position)
+				return false;
+			return (mListenerPosition - tree.listenerPosition).Normal() <= tree.listenerMargin;
+		}
+
+		////////////////////////////////////////
+
+		size_t ImageEdge::NumIncompleteTrees() const
+		{
+			size_t numIncomplete = 0;
+			for (const Source::Data& source : mSources)
+			{
+				if (!IsComplete(mSourceTrees[source.id]))
+					numIncomplete++;
+			}
+			return numIncomplete;
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::RetainImageSources(const IEMWorkspace& workspace, SourceTree& tree) const
+		{
+			tree.retained.resize(static_cast<size_t>(std::max(earlyReverbData.maxOrder, 0)));
+			tree.retainedPool.BeginPass();
+
+			// Image sources retained from earlier trees are dropped once they are no longer rendered
+			for (ImageSourceDataMap& retained : tree.retained)
+			{
+				for (auto it = retained.begin(); it != retained.end();)
+				{
+					if (tree.rendered.find(it->first) == tree.rendered.end())
+						it = retained.erase(it);
+					else
+						++it;
+				}
+			}
+
+			// Copy the rendered image sources of the completed higher orders, as the tree is about to be overwritten
+			const size_t numOrders = std::min({ static_cast<size_t>(std::max(tree.numOrders, 0)), workspace.sp.size(), tree.retained.size() });
+			for (size_t refIdx = 1; refIdx < numOrders; ++refIdx)
+			{
+				// Orders after an empty order were not expanded and hold stale image sources
+				if (workspace.sp[refIdx - 1].empty())
+					break;
+
+				tree.retained[refIdx].clear();
+				for (const std::shared_ptr<ImageSourceData>& imageSource : workspace.sp[refIdx])
+				{
+					if (imageSource->IsVisible() && tree.rendered.find(imageSource->GetKey()) != tree.rendered.end())
+						tree.retained[refIdx].insert_or_assign(imageSource->GetKey(), tree.retainedPool.Acquire(*imageSource));
+				}
+			}
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::RestoreImageSources(ImageSourceDataStore& sp, ImageSourceDataMap& imageSources)
+		{
+			for (auto& reflOrder : sp)
+			{
+				for (auto& vS : reflOrder)
+				{
+					if (vS->IsVisible())
+						ReclaimImageSource(vS, imageSources, true);
+				}
 			}
 			imageSources.clear();
+
+			// The visible image sources are those found by the last receiver checks
+			for (const auto& reflOrder : sp)
+			{
+				for (const auto& vS : reflOrder)
+				{
+					if (vS->IsVisible())
+						imageSources.insert_or_assign(vS->GetKey(), vS);
+				}
+			}
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::FilterImageSources(SourceTree& tree, const std::unordered_set<ImageSourceKey, ImageSourceKeyHash>& admitted)
+		{
+			RestoreImageSources(tree.sp, tree.imageSources);
+			for (auto it = tree.imageSources.begin(); it != tree.imageSources.end();)
+			{
+				if (admitted.find(it->first) == admitted.end())
+					it = tree.imageSources.erase(it);
+				else
+					++it;
+			}
+
+			for (const ImageSourceDataMap& retained : tree.retained)
+			{
+				for (const auto& [key, imageSource] : retained)
+				{
+					if (admitted.find(key) != admitted.end())
+						tree.imageSources.emplace(key, imageSource);
+				}
+			}
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::ReclaimImageSource(std::shared_ptr<ImageSourceData>& vS, ImageSourceDataMap& imageSources, const bool keepTree)
+		{
+			auto it = imageSources.find(vS->GetKey());
+			if (it != imageSources.end() && it->second != vS)
+			{
+				// The source manager keeps vS and returned its previous image source with the same path
+				if (keepTree)
+					it->second->Copy(*vS); // The tree continues with a copy
+				vS.swap(it->second);
+			}
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::ResetImageSources(IEMWorkspace& workspace, const bool keepTree)
+		{
+			for (auto& reflOrder : workspace.sp)
+			{
+				for (auto& vS : reflOrder)
+				{
+					// Only image sources made visible by the last run were added to the map (the image source pools also
+					// hold references to their image sources, so the use count does not show which ones were handed over)
+					if (vS->IsVisible())
+						ReclaimImageSource(vS, workspace.imageSources, keepTree);
+
+					// Image sources left over from earlier runs must not be mistaken for ones added to the map by the next run
+					vS->Invisible();
+				}
+			}
+			workspace.imageSources.clear();
 		}
 
 		////////////////////////////////////////
@@ -116,12 +641,12 @@ namespace RAC
 		void ImageEdge::UpdateRValid()
 		{
 			// Determine if receiver is in front or behind plane face
-			for (auto& [planeID, plane] : mPlanes)
-				plane.SetReceiverValid(mListenerPosition);
+			for (size_t i = 0; i < mRoomSnapshot->NumPlanes(); ++i)
+				mPlaneReceiverValid[i] = mRoomSnapshot->GetPlane(i).ReflectPointInPlane(mListenerPosition);
 
 			// Determine where receiver lies around an edge
-			for (auto& [edgeID, edge] : mEdges)
-				edge.SetReceiverZone(mListenerPosition);
+			for (size_t i = 0; i < mRoomSnapshot->NumEdges(); ++i)
+				mEdgeReceiverZones[i] = mRoomSnapshot->GetEdge(i).FindEdgeZone(mListenerPosition);
 		}
 
 		////////////////////////////////////////
@@ -134,9 +659,10 @@ namespace RAC
 			bool valid = false;
 			if (imageSource.IsReflection(bounceIdx))
 			{
-				auto it = mPlanes.find(imageSource.GetID(bounceIdx));
-				if (it != mPlanes.end()) // case: plane exists
-					valid = LinePlaneIntersection(mListenerPosition, imageSource.GetPosition(bounceIdx), it->second, absorption, intersections[bounceIdx]);
+				const size_t planeID = imageSource.GetID(bounceIdx);
+				const Plane* plane = mRoomSnapshot->FindPlane(planeID);
+				if (plane) // case: plane exists
+					valid = LinePlaneIntersection(mListenerPosition, imageSource.GetPosition(bounceIdx), planeID, *plane, absorption, intersections[bounceIdx]);
 				else
 					return false;
 			}
@@ -152,9 +678,10 @@ namespace RAC
 				// (bounceIdxTakeOne) Reflection intersection being found (bounceIdx) Previous reflection intersection in code and next intersection in path
 				if (imageSource.IsReflection(bounceIdxTakeOne))
 				{
-					auto it = mPlanes.find(imageSource.GetID(bounceIdxTakeOne));
-					if (it != mPlanes.end()) // case: plane exists
-						valid = LinePlaneIntersection(intersections[bounceIdx], imageSource.GetPosition(bounceIdxTakeOne), it->second, absorption, intersections[bounceIdxTakeOne]);
+					const size_t planeID = imageSource.GetID(bounceIdxTakeOne);
+					const Plane* plane = mRoomSnapshot->FindPlane(planeID);
+					if (plane) // case: plane exists
+						valid = LinePlaneIntersection(intersections[bounceIdx], imageSource.GetPosition(bounceIdxTakeOne), planeID, *plane, absorption, intersections[bounceIdxTakeOne]);
 					else
 						return false;
 				}
@@ -191,11 +718,11 @@ namespace RAC
 
 		////////////////////////////////////////
 
-		bool ImageEdge::LinePlaneIntersection(const Vec3& start, const Vec3& end, const Plane& plane, Coefficients<>& absorption, Vec3& intersection) const
+		bool ImageEdge::LinePlaneIntersection(const Vec3& start, const Vec3& end, const size_t planeID, const Plane& plane, Coefficients<>& absorption, Vec3& intersection) const
 		{
 			if (plane.LinePlaneIntersection(start, end))
 			{
-				if (LineWallIntersection(start, end, plane.GetWalls(), absorption, intersection))
+				if (LineWallIntersection(start, end, planeID, absorption, intersection))
 					return true;
 			}
 			return false;
@@ -203,32 +730,30 @@ namespace RAC
 
 		////////////////////////////////////////
 
-		bool ImageEdge::LineWallIntersection(const Vec3& start, const Vec3& end, const std::vector<size_t>& wallIDs, Coefficients<>& absorption, Vec3& intersection) const
+		bool ImageEdge::LineWallIntersection(const Vec3& start, const Vec3& end, const size_t planeID, Coefficients<>& absorption, Vec3& intersection) const
 		{
-			for (const size_t wallID : wallIDs)
-			{
-				auto itW = mWalls.find(wallID);
-				if (itW == mWalls.end()) // case: wall doesn't exist
-					continue;
+			WallBVH::Hit hit;
+			if (!mRoomSnapshot->GetWallBVH().ClosestHitInPlane(start, end, planeID, hit))
+				return false;
 
-				if (itW->second.LineWallIntersection(start, end, intersection))
-				{
-					auto itM = mMaterials.find(itW->second.GetMaterialID());
-					if (itM == mMaterials.end()) // case: material doesn't exist
-						return false;
+			const Wall* wall = mRoomSnapshot->FindWall(hit.wallID);
+			if (!wall) // case: wall doesn't exist
+				return false;
 
-					absorption *= itM->second;
-					if (start != intersection) // case: point on edge (consecutive intersections are identical)
-						return true;
+			const Coefficients<>* material = mRoomSnapshot->FindMaterial(wall->GetMaterialID());
+			if (!material) // case: material doesn't exist
+				return false;
 
-					if (itW->second.VertexMatch(intersection))  // case: point on corner (will be triggered twice)
-						absorption *= INV_SQRT_6;
-					else
-						absorption *= 0.5;
-					return true;
-				}
-			}
-			return false;
+			intersection = hit.intersection;
+			absorption *= *material;
+			if (start != intersection) // case: point on edge (consecutive intersections are identical)
+				return true;
+
+			if (wall->VertexMatch(intersection))  // case: point on corner (will be triggered twice)
+				absorption *= INV_SQRT_6;
+			else
+				absorption *= 0.5;
+			return true;
 		}
 
 		////////////////////////////////////////
@@ -266,51 +791,14 @@ namespace RAC
 					obstruction = LineRoomObstruction(intersections[p], intersections[p + 1], { edgePlaneIDs.first, edgePlaneIDs.second, imageSource.GetID(p + 1) });
 				p++;
 			}
-			return obstruction;
-		}
-
-		////////////////////////////////////////
-
-		bool ImageEdge::LineRoomObstruction(const Vec3& start, const Vec3& end, const std::unordered_set<size_t>& excludedPlaneIds) const
-		{
-			for (const auto& [planeID, plane] : mPlanes)
-			{
-				// Skip excluded planes
-				if (excludedPlaneIds.find(planeID) != excludedPlaneIds.end())
-					continue;
-
-				if (LinePlaneObstruction(start, end, plane))
-					return true;
-			}
-			return false;
-		}
-
-		////////////////////////////////////////
-
-		bool ImageEdge::LinePlaneObstruction(const Vec3& start, const Vec3 end, const Plane& plane) const
-		{
-			if (plane.LinePlaneObstruction(start, end))
-			{
-				if (LineWallObstruction(start, end, plane.GetWalls()))
-					return true;
-			}
-			return false;
+			return obstruction;
 		}
 
 		////////////////////////////////////////
 
-		bool ImageEdge::LineWallObstruction(const Vec3& start, const Vec3& end, const std::vector<size_t>& wallIDs) const
+		bool ImageEdge::LineRoomObstruction(const Vec3& start, const Vec3& end, std::initializer_list<size_t> excludedPlaneIds) const
 		{
-			for (const size_t wallID : wallIDs)
-			{
-				auto itW = mWalls.find(wallID);
-				if (itW == mWalls.end()) // case: wall doesn't exist
-					continue;
-
-				if (itW->second.LineWallObstruction(start, end))
-					return true;
-			}
-			return false;
+			return mRoomSnapshot->GetWallBVH().AnyHit(start, end, excludedPlaneIds);
 		}
 
 		////////////////////////////////////////
@@ -359,7 +847,7 @@ namespace RAC
 				Vec3 direction = (point - source.position).Normalised();
 				Vec3 localDirection = RotateVector(direction, source.orientation);
 
-				directivity = GENELEC.Response(frequencyBands, localDirection);
+				directivity = GENELEC.InterpolatedResponse(frequencyBands, localDirection);
 				break;
 			}
 			case SourceDirectivity::genelec8020cDTF:
@@ -367,7 +855,7 @@ namespace RAC
 				Vec3 direction = (point - source.position).Normalised();
 				Vec3 localDirection = RotateVector(direction, source.orientation);
 
-				directivity = GENELEC_DTF.Response(frequencyBands, localDirection);
+				directivity = GENELEC_DTF.InterpolatedResponse(frequencyBands, localDirection);
 				break;
 			}
 			case SourceDirectivity::qscK8:
@@ -377,7 +865,7 @@ namespace RAC
 				// Vec3 localDirection = RotateVector(direction, source.orientation);
 				Vec3 localDirection = RotateVector(direction, source.orientation);
 
-				directivity = QSC_K8.Response(frequencyBands, localDirection);
+				directivity = QSC_K8.InterpolatedResponse(frequencyBands, localDirection);
 				break;
 			}
 			}
@@ -389,7 +877,7 @@ namespace RAC
 
 		////////////////////////////////////////
 
-		Coefficients<> ImageEdge::Direct(const Source::Data& source, bool lineOfSight)
+		Coefficients<> ImageEdge::Direct(const Source::Data& source, bool lineOfSight) const
 		{
 			PROFILE_Direct
 			
@@ -423,37 +911,59 @@ namespace RAC
 			}
 		}
 
-		void ImageEdge::ReflectPointInRoom(const Source::Data& source, Source::DSPParameters& direct, ImageSourceDataMap& imageSources)
+		////////////////////////////////////////
+
+		Real ImageEdge::EstimateEnergy(const ImageSourceData& imageSource)
+		{
+			const Coefficients<>& absorption = imageSource.GetAbsorption();
+			Real energy = 0.0;
+			for (int i = 0; i < absorption.Length(); ++i)
+				energy += absorption[i] * absorption[i];
+
+			// 1 / r spreading relative to the source at 1m
+			const Real distance = std::max(imageSource.GetDistance(), REAL_CONST(1.0));
+			return energy / (static_cast<Real>(absorption.Length()) * distance * distance);
+		}
+
+		////////////////////////////////////////
+
+		bool ImageEdge::BelowEnergyFloor(const Real reflectanceBound, const Real distance) const
+		{
+			if (earlyReverbData.energyFloor <= 0.0)
+				return false;
+
+			// The listener can move by up to the tree margin before the tree is rebuilt
+			const Real minDistance = std::max(distance - mTreeMargin, REAL_CONST(1.0));
+			return reflectanceBound * reflectanceBound < earlyReverbData.energyFloor * minDistance * minDistance;
+		}
+
+		////////////////////////////////////////
+
+		int ImageEdge::ReflectPointInRoom(const Source::Data& source, IEMWorkspace& workspace, const int numOrders) const
 		{
 			PROFILE_ImageEdgeModel
-			ResetImageSources();
+			ResetImageSources(workspace, false);
 
-			bool lineOfSight = !LineRoomObstruction(mListenerPosition, source.position);
-			direct.directivity = Direct(source, lineOfSight);
+			ImageSourceDataStore& sp = workspace.sp;
+			UpdateDirect(source, workspace.sourceAudioData);
 
 			if (earlyReverbData.maxOrder < 1)
 			{
-				direct.feedsFDN = true;
 				sp.clear();
-				return;
+				return earlyReverbData.maxOrder;
 			}
 
-			if (lineOfSight && earlyReverbData.reflOrder < 1)
-				direct.feedsFDN = true;
-			else
-				direct.feedsFDN = false;
-
 			if (sp.size() != earlyReverbData.maxOrder)
 				sp.resize(earlyReverbData.maxOrder, std::vector<std::shared_ptr<ImageSourceData>>());
 
 			size_t counter = 0;
 
-			if ((earlyReverbData.shadowDiffOrder > 0 || earlyReverbData.specularDiffOrder > 0) && mEdges.size() > 0)
-				counter = FirstOrderDiffraction(source, imageSources);
+			if ((earlyReverbData.shadowDiffOrder > 0 || earlyReverbData.specularDiffOrder > 0) && mRoomSnapshot->NumEdges() > 0)
+				counter = FirstOrderDiffraction(source, workspace);
 
-			if (mWalls.size() > 0)
+			if (mRoomSnapshot->NumWalls() > 0)
 			{
-				counter = FirstOrderReflections(source, imageSources, counter);
+				counter = FirstOrderReflections(source, workspace, counter);
 
 				const size_t currentSize = sp[0].size();
 				sp[0].resize(counter);
@@ -461,9 +971,9 @@ namespace RAC
 					sp[0][initializeIndex] = CreateEmptyImageSource();
 
 				if (earlyReverbData.maxOrder < 2)
-					return;
+					return earlyReverbData.maxOrder;
 
-				HigherOrderPaths(source, imageSources);
+				return HigherOrderPaths(source, workspace, 1, numOrders);
 			}
 			else
 			{
@@ -474,31 +984,109 @@ namespace RAC
 			}
 
 			// TODO: Update how old image sources are erased in debug mode
-			return;
+			return earlyReverbData.maxOrder;
 		}
 
 		////////////////////////////////////////
 
-		size_t ImageEdge::FirstOrderDiffraction(const Source::Data& source, ImageSourceDataMap& imageSources)
+		void ImageEdge::UpdateReceiverPaths(const Source::Data& source, IEMWorkspace& workspace, const int numOrders) const
 		{
-			PROFILE_FirstOrderDiffraction
-			size_t size = sp[0].size();
-			size_t counter = 0;
-			int order;
-			bool feedsFDN = earlyReverbData.FeedsFDN(1);
+			PROFILE_ImageEdgeModel
+			ResetImageSources(workspace, true);
+			UpdateDirect(source, workspace.sourceAudioData);
+
+			// The source side of the tree is unchanged, so only the receiver checks are repeated
+			std::vector<Vec3> intersections;
+			const int numStored = std::min(numOrders, static_cast<int>(workspace.sp.size()));
+			for (int refIdx = 0; refIdx < numStored; ++refIdx)
+			{
+				// Orders after an empty order were not expanded and hold stale image sources
+				if (workspace.sp[refIdx].empty())
+					return;
+
+				intersections.resize(refIdx + 1, Vec3());
+				for (std::shared_ptr<ImageSourceData>& imageSource : workspace.sp[refIdx])
+				{
+					if (!imageSource->IsValid())
+						continue;
+
+					imageSource->Invisible();
+					if (imageSource->IsDiffraction())
+						imageSource->UpdateDiffractionPath(mListenerPosition);
+					FindReceiverPath(source, imageSource, refIdx, intersections, workspace.imageSources);
+				}
+			}
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::UpdateDirect(const Source::Data& source, Source::DSPParameters& direct) const
+		{
+			bool lineOfSight = !LineRoomObstruction(mListenerPosition, source.position);
+			direct.directivity = Direct(source, lineOfSight);
+
+			if (earlyReverbData.maxOrder < 1)
+				direct.feedsFDN = true;
+			else if (lineOfSight && earlyReverbData.reflOrder < 1)
+				direct.feedsFDN = true;
+			else
+				direct.feedsFDN = false;
+		}
+
+		////////////////////////////////////////
+
+		void ImageEdge::UpdateSourceEdgeZones(const Source::Data& source, SourceEdgeZones& cache) const
+		{
+			// A diffraction path is at least as long as the distance from the source to the edge
+			const Real maxDistance = earlyReverbData.maxPathLength + mTreeMargin;
+			if (cache.valid && cache.sourcePosition == source.position && cache.maxDistance == maxDistance && cache.roomVersion == mRoomSnapshot->GetVersion() && cache.configVersion == mConfigVersion)
+				return;
 
-			for (const auto& [edgeID, edge] : mEdges)
+			mRoomSnapshot->GetEdgeBVH().FindEdgesNear(source.position, maxDistance, cache.edges);
+
+			cache.zones.clear();
+			size_t numEdges = 0;
+			for (const size_t edgeIdx : cache.edges)
 			{
+				const Edge& edge = mRoomSnapshot->GetEdge(edgeIdx);
 				if (edge.GetLength() < earlyReverbData.minEdgeLength)
 					continue;
 
-				// Source checks
-				EdgeZone zone = edge.FindEdgeZone(source.position);
-
+				const EdgeZone zone = edge.FindEdgeZone(source.position);
 				if (zone == EdgeZone::Invalid)
 					continue;
 
-				if (earlyReverbData.specularDiffOrder < 1 && zone == EdgeZone::NonShadowed)
+				cache.edges[numEdges++] = edgeIdx;
+				cache.zones.push_back(zone);
+			}
+			cache.edges.resize(numEdges);
+
+			cache.sourcePosition = source.position;
+			cache.maxDistance = maxDistance;
+			cache.roomVersion = mRoomSnapshot->GetVersion();
+			cache.configVersion = mConfigVersion;
+			cache.valid = true;
+		}
+
+		////////////////////////////////////////
+
+		size_t ImageEdge::FirstOrderDiffraction(const Source::Data& source, IEMWorkspace& workspace) const
+		{
+			PROFILE_FirstOrderDiffraction
+			ImageSourceDataStore& sp = workspace.sp;
+			size_t size = sp[0].size();
+			size_t counter = 0;
+			std::vector<Vec3> intersections = std::vector<Vec3>(1, Vec3());
+
+			// Source checks
+			SourceEdgeZones& cache = workspace.sourceEdgeZones;
+			UpdateSourceEdgeZones(source, cache);
+
+			for (size_t i = 0; i < cache.edges.size(); ++i)
+			{
+				const size_t edgeIdx = cache.edges[i];
+				const Edge& edge = mRoomSnapshot->GetEdge(edgeIdx);
+				if (earlyReverbData.specularDiffOrder < 1 && cache.zones[i] == EdgeZone::NonShadowed)
 					continue;
 
 				std::shared_ptr<ImageSourceData>& imageSource = counter < size ? sp[0][counter] : sp[0].emplace_back(CreateEmptyImageSource());
@@ -508,59 +1096,45 @@ namespace RAC
 				counter++;
 
 				imageSource->UpdateDiffractionPath(source.position, mListenerPosition, edge);
-				if (imageSource->GetDistance() > earlyReverbData.maxPathLength)
+				if (imageSource->GetDistance() > earlyReverbData.maxPathLength + mTreeMargin)
+					continue;
+
+				if (BelowEnergyFloor(imageSource->GetReflectanceBound(), imageSource->GetDistance()))
 					continue;
 
 				imageSource->Valid();
-				imageSource->AddEdgeID(edgeID);
+				imageSource->AddEdgeID(mRoomSnapshot->GetEdgeID(edgeIdx));
 
 				/*if (mIEMConfig.diffraction == DiffractionSound::none)
 					continue;*/
 
-				// Receiver checks
-				if (edge.GetReceiverZone() == EdgeZone::Invalid)
-					continue;
-
-				if (earlyReverbData.specularDiffOrder < 1 && edge.GetReceiverZone() == EdgeZone::NonShadowed)
-					continue;
-
-				if (!imageSource->GetDiffractionPath().valid)
-					continue;
-
-				if (imageSource->GetDiffractionPath().inShadowZone)
-					order = earlyReverbData.shadowDiffOrder;
-				else
-					order = earlyReverbData.specularDiffOrder;
-
-				if (order < 1)
-					continue;
-
-				if (CheckObstructions(source.position, *imageSource, { imageSource->GetApex() }))
-					continue;
-
-				InitImageSource(source, imageSource->GetApex(), imageSource, imageSources, feedsFDN);
-
-				RAC_DEBUG_SENDPATH(imageSource->GetKey(), imageSource->GetApex(), imageSource->GetTransform().GetPosition());
+				FindReceiverPath(source, imageSource, 0, intersections, workspace.imageSources);
 			}
 			return counter;
 		}
 
 		////////////////////////////////////////
 
-		size_t ImageEdge::FirstOrderReflections(const Source::Data& source, ImageSourceDataMap& imageSources, size_t counter)
+		size_t ImageEdge::FirstOrderReflections(const Source::Data& source, IEMWorkspace& workspace, size_t counter) const
 		{
 			PROFILE_FirstOrderReflections
+			ImageSourceDataStore& sp = workspace.sp;
 			size_t size = sp[0].size();
 
-			bool feedsFDN = earlyReverbData.FeedsFDN(1);
 			Vec3 position;
 			std::vector<Vec3> intersections = std::vector<Vec3>(1, Vec3());
-			for (const auto& [planeID, plane] : mPlanes)
+			for (size_t planeIdx = 0; planeIdx < mRoomSnapshot->NumPlanes(); ++planeIdx)
 			{
+				const Plane& plane = mRoomSnapshot->GetPlane(planeIdx);
 				if (!plane.ReflectPointInPlane(position, source.position))
 					continue;
 
-				if ((position - mListenerPosition).Normal() > earlyReverbData.maxPathLength)
+				const Real distance = (position - mListenerPosition).Normal();
+				if (distance > earlyReverbData.maxPathLength + mTreeMargin)
+					continue;
+
+				const Real reflectanceBound = mRoomSnapshot->GetMaxPlaneReflectance(planeIdx);
+				if (BelowEnergyFloor(reflectanceBound, distance))
 					continue;
 
 				std::shared_ptr<ImageSourceData>& imageSource = counter < size ? sp[0][counter] : sp[0].emplace_back(CreateEmptyImageSource());
@@ -573,340 +1147,457 @@ namespace RAC
 				counter++;
 
 				imageSource->Valid();
-				imageSource->AddPlaneID(planeID);
+				imageSource->AddPlaneID(mRoomSnapshot->GetPlaneID(planeIdx));
+				imageSource->SetReflectanceBound(reflectanceBound);
 				imageSource->SetTransform(position);
 
-				if (earlyReverbData.reflOrder < 1)
-					continue;
-
-				if (!plane.GetReceiverValid())
-					continue;
-
-				if (!FindIntersections(*imageSource, intersections))
-					continue;
-
-				if (CheckObstructions(source.position, *imageSource, intersections))
-					continue;
-
-				InitImageSource(source, intersections[0], imageSource, imageSources, feedsFDN);
-
-				RAC_DEBUG_SENDPATH(imageSource->GetKey(), intersections, imageSource->GetTransform().GetPosition());
+				FindReceiverPath(source, imageSource, 0, intersections, workspace.imageSources);
 			}
 			return counter;
 		}
 
 		////////////////////////////////////////
 
-		void ImageEdge::HigherOrderPaths(const Source::Data& source, ImageSourceDataMap& imageSources)
+		int ImageEdge::HigherOrderPaths(const Source::Data& source, IEMWorkspace& workspace, const int firstRefIdx, const int endRefIdx) const
 		{
-			// Check for first order reflections in sp
-			if (sp[0].size() == 0)
-				return;
+			ImageSourceDataStore& sp = workspace.sp;
 
-			int order;
-			Vec3 position;
-			std::vector<Vec3> intersections = { Vec3() };
-			for (int refIdx = 1; refIdx < earlyReverbData.maxOrder; refIdx++)
+			for (int refIdx = firstRefIdx; refIdx < endRefIdx; refIdx++)
 			{
 				int refOrder = refIdx + 1;
 				int prevRefIdx = refIdx - 1;
-				const bool feedsFDN = earlyReverbData.FeedsFDN(refOrder);
 
-				intersections.emplace_back(Vec3());
-				// Check m is not null
+				// Check m is not null (no higher order paths exist)
 				if (sp[prevRefIdx].size() == 0)
-					return;
-
-				size_t size = sp[refIdx].size();
-				size_t counter = 0;
+					return earlyReverbData.maxOrder;
+
+				// Flattened (image source, visible plane) pairs followed by (image source, visible edge) pairs, in the serial loop order
+				const size_t numPrevious = sp[prevRefIdx].size();
+				const bool doDiffraction = earlyReverbData.specularDiffOrder >= refOrder || earlyReverbData.shadowDiffOrder >= refOrder;
+				std::vector<size_t>& reflectionOffsets = workspace.reflectionOffsets;
+				std::vector<size_t>& diffractionOffsets = workspace.diffractionOffsets;
+				reflectionOffsets.assign(1, 0);
+				diffractionOffsets.assign(1, 0);
+				for (const std::shared_ptr<ImageSourceData>& vS : sp[prevRefIdx])
 				{
-#ifdef PROFILE_BACKGROUND_THREAD_DETAILED
+					reflectionOffsets.push_back(reflectionOffsets.back() + ReflectionCandidates(*vS, prevRefIdx).size());
+					diffractionOffsets.push_back(diffractionOffsets.back() + (doDiffraction ? DiffractionCandidates(*vS).size() : 0));
+				}
+				const size_t numReflectionPairs = reflectionOffsets.back();
+				const size_t numPairs = numReflectionPairs + diffractionOffsets.back();
+				CullReflections(workspace, prevRefIdx);
+
+				size_t numSegments = 1;
+				if (mThreadPool && numFrontierHelpers > 0)
+					numSegments = std::clamp(numPairs / MIN_FRONTIER_SEGMENT_SIZE, static_cast<size_t>(1), FRONTIER_SEGMENTS_PER_THREAD * (numFrontierHelpers + 1));
+
+				// Hand the image sources from the last run to the segments for reuse
+				if (workspace.segments.size() < numSegments)
+					workspace.segments.resize(numSegments);
+				const size_t numStored = sp[refIdx].size();
+				for (size_t i = 0; i < numSegments; ++i)
+				{
+					FrontierSegment& segment = workspace.segments[i];
+					segment.counter = 0;
+					segment.intersections.resize(refOrder, Vec3());
+					for (size_t j = i * numStored / numSegments; j < (i + 1) * numStored / numSegments; ++j)
+						segment.store.push_back(std::move(sp[refIdx][j]));
+				}
+				sp[refIdx].clear();
 
-					ProfilerCategories category;
-					switch (refOrder)
+				// Calls expand(image source, candidate) for the flattened pairs in [begin, end)
+				auto forEachPair = [&](const std::vector<size_t>& offsets, const size_t begin, const size_t end, auto&& candidates, auto&& expand)
 					{
-					case 2:
-						category = ProfilerCategories::SecondOrderReflections;
-						break;
-					case 3:
-						category = ProfilerCategories::ThirdOrderReflections;
-						break;
-					default:
-						category = ProfilerCategories::HigherOrderReflection;
-					}
-					ProfileSection section(category);
-#endif
-					bool skipReflections = refOrder == earlyReverbData.maxOrder && earlyReverbData.reflOrder < refOrder;
-					for (const auto& [planeID, plane] : mPlanes)
+						size_t i = std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin() - 1;
+						for (; i < numPrevious && offsets[i] < end; ++i)
+						{
+							const ImageSourceData& vS = *sp[prevRefIdx][i];
+							const std::vector<size_t>& indices = candidates(vS);
+							for (size_t k = std::max(begin, offsets[i]) - offsets[i]; k < std::min(end, offsets[i + 1]) - offsets[i]; ++k)
+								expand(vS, indices[k], offsets[i] + k);
+						}
+					};
+
+				auto expandSegment = [&](size_t segmentIdx)
 					{
-						bool rValid = plane.GetReceiverValid();
-						for (std::shared_ptr<ImageSourceData>& vSPtr : sp[prevRefIdx])
+						FrontierSegment& segment = workspace.segments[segmentIdx];
+						segment.pool.BeginPass();
+						const size_t begin = segmentIdx * numPairs / numSegments;
+						const size_t end = (segmentIdx + 1) * numPairs / numSegments;
+						if (begin < numReflectionPairs)
 						{
-							ImageSourceData& vS = *vSPtr;
+#ifdef PROFILE_BACKGROUND_THREAD_DETAILED
+							ProfileSection section(refOrder == 2 ? ProfilerCategories::SecondOrderReflections : refOrder == 3 ? ProfilerCategories::ThirdOrderReflections : ProfilerCategories::HigherOrderReflection);
+#endif
+							forEachPair(reflectionOffsets, begin, std::min(end, numReflectionPairs),
+								[&](const ImageSourceData& vS) -> const std::vector<size_t>& { return ReflectionCandidates(vS, prevRefIdx); },
+								[&](const ImageSourceData& vS, const size_t planeIdx, const size_t pair)
+								{
+									if (workspace.reflectionMask[pair])
+										ReflectImageSource(source, planeIdx, vS, refIdx, segment);
+								});
+						}
+						if (end > numReflectionPairs)
+						{
+#ifdef PROFILE_BACKGROUND_THREAD_DETAILED
+							ProfileSection section(refOrder == 2 ? ProfilerCategories::SecondOrderDiffraction : refOrder == 3 ? ProfilerCategories::ThirdOrderDiffraction : ProfilerCategories::HigherOrderDiffraction);
+#endif
+							forEachPair(diffractionOffsets, std::max(begin, numReflectionPairs) - numReflectionPairs, end - numReflectionPairs,
+								[&](const ImageSourceData& vS) -> const std::vector<size_t>& { return DiffractionCandidates(vS); },
+								[&](const ImageSourceData& vS, const size_t edgeIdx, const size_t) { DiffractImageSource(source, edgeIdx, vS, refIdx, segment); });
+						}
+					};
 
-							if (!vS.IsValid())
-								continue;
+				if (numSegments > 1)
+					mThreadPool->ParallelFor(numSegments, numFrontierHelpers, expandSegment);
+				else
+					expandSegment(0);
 
-							// HOD reflections
-							if (!vS.IsDiffraction())
-							{
-								if (skipReflections)
-									continue;
+				// Merge the segments in order so the result matches the serial expansion
+				for (size_t i = 0; i < numSegments; ++i)
+				{
+					FrontierSegment& segment = workspace.segments[i];
+					for (size_t j = 0; j < segment.counter; ++j)
+						sp[refIdx].push_back(std::move(segment.store[j]));
+					segment.store.clear();
+					workspace.imageSources.merge(segment.imageSources);
+					segment.imageSources.clear();
+				}
+			}
+			return endRefIdx;
+		}
 
-								// Can't reflect in same plane twice
-								if (planeID == vS.GetID())
-									continue;
+		////////////////////////////////////////
 
-								Vec4 previousPlaneData = vS.GetPreviousPlane();
-								Vec4 planeData(plane.GetD(), MakeCompatible(plane.GetNormal()));
+		void ImageEdge::CullReflections(IEMWorkspace& workspace, const int prevRefIdx) const
+		{
+			const std::vector<std::shared_ptr<ImageSourceData>>& previous = workspace.sp[prevRefIdx];
+			const size_t numPlanes = mRoomSnapshot->NumPlanes();
+			std::vector<uint8_t>& reflectionMask = workspace.reflectionMask;
+			std::vector<size_t>& planeGroupOffsets = workspace.planeGroupOffsets;
+			std::vector<size_t>& planeGroups = workspace.planeGroups;
+			reflectionMask.assign(workspace.reflectionOffsets.back(), 1);
+
+			// Group the reflection only image sources by their last plane (counting sort keeps the image source order in each group)
+			planeGroupOffsets.assign(numPlanes + 1, 0);
+			for (const std::shared_ptr<ImageSourceData>& vS : previous)
+			{
+				if (!vS->IsValid() || vS->IsDiffraction())
+					continue;
+				const int planeIdx = mRoomSnapshot->FindPlaneIndex(vS->GetID());
+				if (planeIdx >= 0)
+					++planeGroupOffsets[planeIdx + 1];
+			}
+			for (size_t i = 0; i < numPlanes; ++i)
+				planeGroupOffsets[i + 1] += planeGroupOffsets[i];
 
-								// Can't reflect in parallel plane
-								if (planeData.x() == previousPlaneData.x() && planeData.y() == previousPlaneData.y() && planeData.z() == previousPlaneData.z())
-									continue;
+			planeGroups.resize(planeGroupOffsets.back());
+			for (size_t i = 0; i < previous.size(); ++i)
+			{
+				const ImageSourceData& vS = *previous[i];
+				if (!vS.IsValid() || vS.IsDiffraction())
+					continue;
+				const int planeIdx = mRoomSnapshot->FindPlaneIndex(vS.GetID());
+				if (planeIdx >= 0)
+					planeGroups[planeGroupOffsets[planeIdx]++] = i;
+			}
+			// The fill advanced each offset to the start of the next group, so shift them back
+			for (size_t i = numPlanes; i > 0; --i)
+				planeGroupOffsets[i] = planeGroupOffsets[i - 1];
+			planeGroupOffsets[0] = 0;
 
-								// Can't reflect in coplanar plane
-								// if (planeData.coeffs() == -previousPlaneData.coeffs())
-								if (planeData == -previousPlaneData)
-									continue;
+			const Real maxDistance = earlyReverbData.maxPathLength + mTreeMargin;
+			for (size_t planeIdx = 0; planeIdx < numPlanes; ++planeIdx)
+			{
+				const size_t groupBegin = planeGroupOffsets[planeIdx];
+				const size_t groupEnd = planeGroupOffsets[planeIdx + 1];
+				if (groupBegin == groupEnd)
+					continue;
 
-								if (!plane.ReflectPointInPlane(position, vS.GetPosition()))
-									continue;
+				workspace.batch.Clear();
+				for (size_t j = groupBegin; j < groupEnd; ++j)
+					workspace.batch.Add(previous[planeGroups[j]]->GetPosition());
+				workspace.batchMask.resize(groupEnd - groupBegin);
 
-								if ((position - mListenerPosition).Normal() > earlyReverbData.maxPathLength)
-									continue;
+				const std::vector<size_t>& candidates = mRoomSnapshot->GetPlanesVisibleFromPlane(planeIdx);
+				for (size_t k = 0; k < candidates.size(); ++k)
+				{
+					workspace.batch.Cull(mRoomSnapshot->GetPlane(candidates[k]), mListenerPosition, maxDistance, workspace.batchMask.data());
+					for (size_t j = groupBegin; j < groupEnd; ++j)
+						reflectionMask[workspace.reflectionOffsets[planeGroups[j]] + k] = workspace.batchMask[j - groupBegin];
+				}
+			}
+		}
 
-								std::shared_ptr<ImageSourceData>& imageSource = counter < size ? sp[refIdx][counter] : sp[refIdx].emplace_back(vS.CreateShallowCopy());
+		////////////////////////////////////////
 
-								imageSource->SetPreviousPlane(planeData);
-								if (counter < size)
-									imageSource->Update(vS);
-								else
-									imageSource->IncreaseImageSourceOrder();
-								counter++;
+		const std::vector<size_t>& ImageEdge::ReflectionCandidates(const ImageSourceData& vS, const int prevRefIdx) const
+		{
+			if (!vS.IsValid())
+				return NO_CANDIDATES;
 
-								imageSource->Reset();
-								imageSource->Valid();
-								imageSource->AddPlaneID(planeID);
-								imageSource->SetTransform(position);
+			if (vS.IsReflection(prevRefIdx))
+			{
+				const int planeIdx = mRoomSnapshot->FindPlaneIndex(vS.GetID());
+				return planeIdx < 0 ? NO_CANDIDATES : mRoomSnapshot->GetPlanesVisibleFromPlane(planeIdx);
+			}
 
-								if (earlyReverbData.reflOrder < refOrder)
-									continue;
+			const int edgeIdx = mRoomSnapshot->FindEdgeIndex(vS.GetID());
+			return edgeIdx < 0 ? NO_CANDIDATES : mRoomSnapshot->GetPlanesVisibleFromEdge(edgeIdx);
+		}
 
-								if (!rValid)
-									continue;
+		////////////////////////////////////////
 
-								if (!FindIntersections(*imageSource, intersections))
-									continue;
+		const std::vector<size_t>& ImageEdge::DiffractionCandidates(const ImageSourceData& vS) const
+		{
+			if (!vS.IsValid() || vS.IsDiffraction())
+				return NO_CANDIDATES;
 
-								if (CheckObstructions(source.position, *imageSource, intersections))
-									continue;
+			const int planeIdx = mRoomSnapshot->FindPlaneIndex(vS.GetID());
+			return planeIdx < 0 ? NO_CANDIDATES : mRoomSnapshot->GetEdgesVisibleFromPlane(planeIdx);
+		}
 
-								InitImageSource(source, intersections[0], imageSource, imageSources, feedsFDN);
+		////////////////////////////////////////
 
-								RAC_DEBUG_SENDPATH(imageSource->GetKey(), intersections, imageSource->GetTransform().GetPosition());
-							}
-							// HOD reflections (post diffraction)
-							else if (refIdx < earlyReverbData.shadowDiffOrder || refIdx < earlyReverbData.specularDiffOrder)
-							{
-								const Edge& edge = vS.GetEdge();
+		void ImageEdge::ReflectImageSource(const Source::Data& source, const size_t planeIdx, const ImageSourceData& vS, const int refIdx, FrontierSegment& segment) const
+		{
+			if (!vS.IsValid())
+				return;
 
-								Vec4 planeData(plane.GetD(), MakeCompatible(plane.GetNormal()));
+			const Plane& plane = mRoomSnapshot->GetPlane(planeIdx);
+			const size_t planeID = mRoomSnapshot->GetPlaneID(planeIdx);
 
-								if (vS.IsReflection(prevRefIdx))
-								{
-									// Can't reflect in same plane twice
-									if (planeID == vS.GetID())
-										continue;
+			const int refOrder = refIdx + 1;
+			const int prevRefIdx = refIdx - 1;
+			Vec3 position;
 
-									Vec4 previousPlaneData = vS.GetPreviousPlane();
+			// HOD reflections
+			if (!vS.IsDiffraction())
+			{
+				if (refOrder == earlyReverbData.maxOrder && earlyReverbData.reflOrder < refOrder)
+					return;
 
-									// Can't reflect in parallel plane
-									if (planeData.x() == previousPlaneData.x() && planeData.y() == previousPlaneData.y() && planeData.z() == previousPlaneData.z())
-										continue;
+				// Can't reflect in same plane twice
+				if (planeID == vS.GetID())
+					return;
 
-									// Can't reflect in coplanar plane
-									if (planeData == -previousPlaneData)
-										continue;
-								}
-								else
-								{
-									// Can't reflect in plane attached to edge
-									if (edge.IncludesPlane(planeID))
-										continue;
-								}
+				Vec4 previousPlaneData = vS.GetPreviousPlane();
+				Vec4 planeData(plane.GetD(), MakeCompatible(plane.GetNormal()));
 
-								// Check edge in front of plane
-								if (!plane.EdgePlanePosition(edge))
-									continue;
+				// Can't reflect in parallel plane
+				if (planeData.x() == previousPlaneData.x() && planeData.y() == previousPlaneData.y() && planeData.z() == previousPlaneData.z())
+					return;
 
-								std::shared_ptr<ImageSourceData>& imageSource = counter < size ? sp[refIdx][counter] : sp[refIdx].emplace_back(vS.CreateShallowCopy());
+				// Can't reflect in coplanar plane
+				if (planeData == -previousPlaneData)
+					return;
 
-								imageSource->SetPreviousPlane(planeData);
-								if (counter < size)
-									imageSource->Update(vS);
-								else
-									imageSource->IncreaseImageSourceOrder();
-								counter++;
+				if (!plane.ReflectPointInPlane(position, vS.GetPosition()))
+					return;
 
-								imageSource->Reset();
+				const Real distance = (position - mListenerPosition).Normal();
+				if (distance > earlyReverbData.maxPathLength + mTreeMargin)
+					return;
 
-								// position = imageSource->GetPosition(prevRefIdx);
-								position = imageSource->GetDiffractionPath().sData.point;
-								plane.ReflectPointInPlaneNoCheck(position);
-								imageSource->UpdateDiffractionPath(position, mListenerPosition, plane);
-								if (imageSource->GetDistance() > earlyReverbData.maxPathLength)
-									continue;
+				const Real reflectanceBound = vS.GetReflectanceBound() * mRoomSnapshot->GetMaxPlaneReflectance(planeIdx);
+				if (BelowEnergyFloor(reflectanceBound, distance))
+					return;
 
-								imageSource->Valid();
-								imageSource->AddPlaneID(planeID);
+				std::shared_ptr<ImageSourceData>& imageSource = segment.Next(vS);
 
-								if (!rValid)
-									continue;
+				imageSource->SetPreviousPlane(planeData);
+				imageSource->Reset();
+				imageSource->Valid();
+				imageSource->AddPlaneID(planeID);
+				imageSource->SetReflectanceBound(reflectanceBound);
+				imageSource->SetTransform(position);
 
-								EdgeZone zone = imageSource->GetEdge().FindEdgeZone(mListenerPosition);
+				FindReceiverPath(source, imageSource, refIdx, segment.intersections, segment.imageSources);
+			}
+			// HOD reflections (post diffraction)
+			else if (refIdx < earlyReverbData.shadowDiffOrder || refIdx < earlyReverbData.specularDiffOrder)
+			{
+				const Edge& edge = vS.GetEdge();
 
-								// Receiver checks
-								if (zone == EdgeZone::Invalid)
-									continue;
+				Vec4 planeData(plane.GetD(), MakeCompatible(plane.GetNormal()));
 
-								if (earlyReverbData.specularDiffOrder < refOrder && zone == EdgeZone::NonShadowed)
-									continue;
+				if (vS.IsReflection(prevRefIdx))
+				{
+					// Can't reflect in same plane twice
+					if (planeID == vS.GetID())
+						return;
 
-								if (!imageSource->GetDiffractionPath().valid)
-									continue;
+					Vec4 previousPlaneData = vS.GetPreviousPlane();
 
-								order = imageSource->GetDiffractionPath().inShadowZone ? earlyReverbData.shadowDiffOrder : earlyReverbData.specularDiffOrder;
+					// Can't reflect in parallel plane
+					if (planeData.x() == previousPlaneData.x() && planeData.y() == previousPlaneData.y() && planeData.z() == previousPlaneData.z())
+						return;
 
-								if (order < refOrder)
-									continue;
+					// Can't reflect in coplanar plane
+					if (planeData == -previousPlaneData)
+						return;
+				}
+				else
+				{
+					// Can't reflect in plane attached to edge
+					if (edge.IncludesPlane(planeID))
+						return;
+				}
 
-								if (!FindIntersections(*imageSource, intersections))
-									continue;
+				// Check edge in front of plane
+				if (!plane.EdgePlanePosition(edge))
+					return;
 
-								if (CheckObstructions(source.position, *imageSource, intersections))
-									continue;
+				std::shared_ptr<ImageSourceData>& imageSource = segment.Next(vS);
 
-								InitImageSource(source, intersections[0], imageSource, imageSources, feedsFDN);
+				imageSource->SetPreviousPlane(planeData);
+				imageSource->Reset();
 
-								RAC_DEBUG_SENDPATH(imageSource->GetKey(), intersections, imageSource->GetTransform().GetPosition());
-							}
-						}
-					}
-				}
+				position = imageSource->GetDiffractionPath().sData.point;
+				plane.ReflectPointInPlaneNoCheck(position);
+				imageSource->UpdateDiffractionPath(position, mListenerPosition, plane);
+				if (imageSource->GetDistance() > earlyReverbData.maxPathLength + mTreeMargin)
+					return;
 
-				if (earlyReverbData.specularDiffOrder < refOrder && earlyReverbData.shadowDiffOrder < refOrder)
-				{
-					const size_t currentIndex = sp[refIdx].size();
-					sp[refIdx].resize(counter);
-					for (size_t initializeIndex = currentIndex; initializeIndex < sp[refIdx].size(); ++initializeIndex)
-						sp[refIdx][initializeIndex] = CreateEmptyImageSource();
-					continue;
-				}
-#ifdef PROFILE_BACKGROUND_THREAD_DETAILED
-				ProfilerCategories category;
-				switch (refOrder)
-				{
-				case 2:
-					category = ProfilerCategories::SecondOrderDiffraction;
-					break;
-				case 3:
-					category = ProfilerCategories::ThirdOrderDiffraction;
-					break;
-				default:
-					category = ProfilerCategories::HigherOrderDiffraction;
-				}
-				ProfileSection section = ProfileSection(category);
-#endif
-				for (const auto& [edgeID, edge] : mEdges)
-				{
-					if (edge.GetLength() < earlyReverbData.minEdgeLength)
-						continue;
+				imageSource->SetReflectanceBound(vS.GetReflectanceBound() * mRoomSnapshot->GetMaxPlaneReflectance(planeIdx));
+				if (BelowEnergyFloor(imageSource->GetReflectanceBound(), imageSource->GetDistance()))
+					return;
 
-					EdgeZone rZone = edge.GetReceiverZone();
-					for (std::shared_ptr<ImageSourceData>& vSPtr : sp[prevRefIdx])
-					{
-						ImageSourceData& vS = *vSPtr;
+				imageSource->Valid();
+				imageSource->AddPlaneID(planeID);
 
-						if (!vS.IsValid())
-							continue;
+				FindReceiverPath(source, imageSource, refIdx, segment.intersections, segment.imageSources);
+			}
+		}
 
-						if (vS.IsDiffraction())
-							continue;
+		////////////////////////////////////////
 
-						// Can't diffract in edge attached to plane
-						if (edge.IncludesPlane(vS.GetID()))
-							continue;
+		void ImageEdge::DiffractImageSource(const Source::Data& source, const size_t edgeIdx, const ImageSourceData& vS, const int refIdx, FrontierSegment& segment) const
+		{
+			const Edge& edge = mRoomSnapshot->GetEdge(edgeIdx);
+			if (edge.GetLength() < earlyReverbData.minEdgeLength)
+				return;
 
-						// Source checks
-						EdgeZone zone = edge.FindEdgeZone(vS.GetPosition());
+			if (!vS.IsValid())
+				return;
 
-						if (zone == EdgeZone::Invalid)
-							continue;
+			if (vS.IsDiffraction())
+				return;
 
-						if (earlyReverbData.specularDiffOrder < refOrder && zone == EdgeZone::NonShadowed)
-							continue;
+			// Can't diffract in edge attached to plane
+			if (edge.IncludesPlane(vS.GetID()))
+				return;
 
-						std::shared_ptr<ImageSourceData>& imageSource = counter < size ? sp[refIdx][counter] : sp[refIdx].emplace_back(vS.CreateShallowCopy());
+			const int refOrder = refIdx + 1;
+			const int prevRefIdx = refIdx - 1;
 
-						if (counter < size)
-							imageSource->Update(vS);
-						else
-							imageSource->IncreaseImageSourceOrder();
-						counter++;
+			// Source checks
+			EdgeZone zone = edge.FindEdgeZone(vS.GetPosition());
 
-						imageSource->Reset();
-						imageSource->UpdateDiffractionPath(imageSource->GetPosition(prevRefIdx), mListenerPosition, edge);
-						if (imageSource->GetDistance() > earlyReverbData.maxPathLength)
-							continue;
+			if (zone == EdgeZone::Invalid)
+				return;
 
-						imageSource->Valid();
-						imageSource->AddEdgeID(edgeID);
+			if (earlyReverbData.specularDiffOrder < refOrder && zone == EdgeZone::NonShadowed)
+				return;
 
-						// Receiver checks
-						if (rZone == EdgeZone::Invalid)
-							continue;
+			std::shared_ptr<ImageSourceData>& imageSource = segment.Next(vS);
 
-						if (earlyReverbData.specularDiffOrder < refOrder && edge.GetReceiverZone() == EdgeZone::NonShadowed)
-							continue;
+			imageSource->Reset();
+			imageSource->UpdateDiffractionPath(imageSource->GetPosition(prevRefIdx), mListenerPosition, edge);
+			if (imageSource->GetDistance() > earlyReverbData.maxPathLength + mTreeMargin)
+				return;
 
-						if (!imageSource->GetDiffractionPath().valid)
-							continue;
+			if (BelowEnergyFloor(imageSource->GetReflectanceBound(), imageSource->GetDistance()))
+				return;
 
-						order = imageSource->GetDiffractionPath().inShadowZone ? earlyReverbData.shadowDiffOrder : earlyReverbData.specularDiffOrder;
+			imageSource->Valid();
+			imageSource->AddEdgeID(mRoomSnapshot->GetEdgeID(edgeIdx));
 
-						if (order < refOrder)
-							continue;
+			FindReceiverPath(source, imageSource, refIdx, segment.intersections, segment.imageSources);
+		}
 
-						if (!FindIntersections(*imageSource, intersections))
-							continue;
+		////////////////////////////////////////
 
-						if (CheckObstructions(source.position, *imageSource, intersections))
-							continue;
+		void ImageEdge::FindReceiverPath(const Source::Data& source, std::shared_ptr<ImageSourceData>& imageSource, const int refIdx, std::vector<Vec3>& intersections, ImageSourceDataMap& imageSources) const
+		{
+			const int refOrder = refIdx + 1;
 
-						InitImageSource(source, intersections[0], imageSource, imageSources, feedsFDN);
+			// Receiver checks
+			if (imageSource->IsDiffraction())
+			{
+				if (imageSource->GetDistance() > earlyReverbData.maxPathLength)
+					return;
 
-						RAC_DEBUG_SENDPATH(imageSource->GetKey(), intersections, imageSource->GetTransform().GetPosition());
-					}
+				EdgeZone zone;
+				if (imageSource->IsReflection(refIdx))
+				{
+					// Reflection post diffraction (the stored edge has been reflected in the plane)
+					const int planeIdx = mRoomSnapshot->FindPlaneIndex(imageSource->GetID());
+					if (planeIdx < 0 || !mPlaneReceiverValid[planeIdx])
+						return;
+					zone = imageSource->GetEdge().FindEdgeZone(mListenerPosition);
 				}
-				const size_t currentSize = sp[refIdx].size();
-				sp[refIdx].resize(counter);
-				for (size_t initializeIndex = currentSize; initializeIndex < sp[refIdx].size(); ++initializeIndex)
-					sp[refIdx][initializeIndex] = CreateEmptyImageSource();
+				else
+				{
+					const int edgeIdx = mRoomSnapshot->FindEdgeIndex(imageSource->GetID());
+					if (edgeIdx < 0)
+						return;
+					zone = mEdgeReceiverZones[edgeIdx];
+				}
+
+				if (zone == EdgeZone::Invalid)
+					return;
+
+				if (earlyReverbData.specularDiffOrder < refOrder && zone == EdgeZone::NonShadowed)
+					return;
+
+				if (!imageSource->GetDiffractionPath().valid)
+					return;
+
+				int order = imageSource->GetDiffractionPath().inShadowZone ? earlyReverbData.shadowDiffOrder : earlyReverbData.specularDiffOrder;
+
+				if (order < refOrder)
+					return;
+			}
+			else
+			{
+				if ((imageSource->GetPosition() - mListenerPosition).Normal() > earlyReverbData.maxPathLength)
+					return;
+
+				if (earlyReverbData.reflOrder < refOrder)
+					return;
+
+				const int planeIdx = mRoomSnapshot->FindPlaneIndex(imageSource->GetID());
+				if (planeIdx < 0 || !mPlaneReceiverValid[planeIdx])
+					return;
 			}
+
+			if (!FindIntersections(*imageSource, intersections))
+				return;
+
+			if (CheckObstructions(source.position, *imageSource, intersections))
+				return;
+
+			if (!InitImageSource(source, intersections[0], imageSource, imageSources, earlyReverbData.FeedsFDN(refOrder)))
+				return;
+
+			RAC_DEBUG_SENDPATH(imageSource->GetKeyString(), intersections, imageSource->GetTransform().GetPosition());
 		}
 
 		////////////////////////////////////////
 
-		void ImageEdge::InitImageSource(const Source::Data& source, const Vec3& intersection, std::shared_ptr<ImageSourceData>& imageSource, ImageSourceDataMap& imageSources, bool feedsFDN)
+		bool ImageEdge::InitImageSource(const Source::Data& source, const Vec3& intersection, std::shared_ptr<ImageSourceData>& imageSource, ImageSourceDataMap& imageSources, bool feedsFDN) const
 		{
-			Coefficients<> directivity(frequencyBands.Length());
-			directivity = CalculateDirectivity(source, intersection);
-			imageSource->AddAbsorption(directivity);
+			imageSource->AddAbsorption(CalculateDirectivity(source, intersection));
 
 			imageSource->SetDistance(mListenerPosition);
+			if (EstimateEnergy(*imageSource) < earlyReverbData.energyFloor)
+				return false;
+
 			imageSource->Visible(feedsFDN);
 			imageSource->CreateKey(ToInt(source.id));
 			imageSources.insert_or_assign(imageSource->GetKey(), imageSource);
+			return true;
 		}
 
 		////////////////////////////////////////
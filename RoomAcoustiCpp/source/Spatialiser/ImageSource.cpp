@@ -10,6 +10,7 @@
 //Common headers
 #include "Common/RACProfiler.h"
 #include "Common/Debug.h"
+#include "Common/BinaryStream.h"
 
 // Spatialiser headers
 #include "Spatialiser/ImageSource.h"
@@ -25,6 +26,24 @@ namespace RAC
 	using namespace DSP;
 	namespace Spatialiser
 	{
+		namespace
+		{
+			constexpr uint64_t HASH_SEED_HI = 0x9E3779B97F4A7C15ull;	// Seed of the first image source key hash
+			constexpr uint64_t HASH_SEED_LO = 0xC2B2AE3D27D4EB4Full;	// Seed of the second image source key hash
+
+			/**
+			* @brief SplitMix64 finaliser used to mix each part of an image source path into its key
+			*/
+			inline uint64_t MixKey(uint64_t x)
+			{
+				x ^= x >> 30;
+				x *= 0xBF58476D1CE4E5B9ull;
+				x ^= x >> 27;
+				x *= 0x94D049BB133111EBull;
+				x ^= x >> 31;
+				return x;
+			}
+		}
 
 		//////////////////// ImageSourceData class ////////////////////
 
@@ -41,75 +60,66 @@ namespace RAC
 
 		void ImageSourceData::CreateKey(int sourceID)
 		{
-			AddSourceIDToKey(sourceID);
-			for (const auto& part : pathParts)
-			{
-				if (part.isReflection)
-					AddPlaneIDToKey(part.id);
-				else
-					AddEdgeIDToKey(part.id);
-			}
-		}
+			keySourceID = sourceID;
+			uint64_t hi = HASH_SEED_HI;
+			uint64_t lo = HASH_SEED_LO;
+			auto addToKey = [&](const uint64_t value)
+				{
+					hi = MixKey(hi ^ value);
+					lo = MixKey(lo + (value ^ HASH_SEED_HI));
+				};
 
-		////////////////////////////////////////
+			addToKey(static_cast<uint64_t>(static_cast<uint32_t>(sourceID)));
+			for (const auto& part : pathParts)
+				addToKey((static_cast<uint64_t>(part.id) << 1) | (part.isReflection ? 1 : 0));
+			addToKey(static_cast<uint64_t>(pathParts.size()));
 
-		void ImageSourceData::AddEdgeID(size_t id)
-		{
-			pathParts.back().id = static_cast<partid_t>(id);
-			pathParts.back().isReflection = false;
-			diffraction = true;
-			diffractionIndex = static_cast<int>(pathParts.size()) - 1;
+			key.hi = hi;
+			key.lo = lo;
 		}
 
 		////////////////////////////////////////
 
-		void ImageSourceData::AddSourceIDToKey(int sourceID)
+		std::string ImageSourceData::GetKeyString() const
 		{
-			key = "";
-			auto [ptr, ec] = std::to_chars(idKey.data(), idKey.data() + idKey.size(), sourceID);
-			if (ec == std::errc()) // Null-terminate manually if conversion is successful
-				*ptr = '\0';
-			else// Failed to convert id to char array
-			{
-				key += sourceKey[0];
-				return;
-			}
+			std::string keyString;
+			std::array<char, 21> idKey;
+			auto addToKeyString = [&](const auto id, const char type)
+				{
+					auto [ptr, ec] = std::to_chars(idKey.data(), idKey.data() + idKey.size(), id);
+					if (ec == std::errc())
+						keyString.append(idKey.data(), ptr);
+					keyString += type;
+				};
 
-			key += idKey.data();
-			key += sourceKey[0];
+			addToKeyString(keySourceID, 's');
+			for (const auto& part : pathParts)
+				addToKeyString(part.id, part.isReflection ? 'r' : 'd');
+			return keyString;
 		}
 
 		////////////////////////////////////////
 
-		void ImageSourceData::AddPlaneIDToKey(const size_t id)
+		bool ImageSourceData::SamePath(const ImageSourceData& imageSource) const
 		{
-			auto [ptr, ec] = std::to_chars(idKey.data(), idKey.data() + idKey.size(), id);
-			if (ec == std::errc()) // Null-terminate manually if conversion is successful
-				*ptr = '\0';
-			else// Failed to convert id to char array
+			if (pathParts.size() != imageSource.pathParts.size())
+				return false;
+			for (size_t i = 0; i < pathParts.size(); ++i)
 			{
-				key += reflectionKey[0];
-				return;
+				if (pathParts[i].id != imageSource.pathParts[i].id || pathParts[i].isReflection != imageSource.pathParts[i].isReflection)
+					return false;
 			}
-
-			key += idKey.data();
-			key += reflectionKey[0];
+			return true;
 		}
 
 		////////////////////////////////////////
 
-		void ImageSourceData::AddEdgeIDToKey(const size_t id)
+		void ImageSourceData::AddEdgeID(size_t id)
 		{
-			auto [ptr, ec] = std::to_chars(idKey.data(), idKey.data() + idKey.size(), id);
-			if (ec == std::errc()) // Null-terminate manually if conversion is successful
-				*ptr = '\0';
-			else// Failed to convert id to char array
-			{
-				key += diffractionKey[0];
-				return;
-			}
-			key += idKey.data();
-			key += diffractionKey[0];
+			pathParts.back().id = static_cast<partid_t>(id);
+			pathParts.back().isReflection = false;
+			diffraction = true;
+			diffractionIndex = static_cast<int>(pathParts.size()) - 1;
 		}
 
 		////////////////////////////////////////
@@ -145,7 +155,8 @@ namespace RAC
 			Reset();
 			reflection = false;
 			diffraction = false;
-			key.clear();
+			reflectanceBound = 1.0;
+			key = ImageSourceKey();
 		}
 
 		////////////////////////////////////////
@@ -170,6 +181,7 @@ namespace RAC
 
 			reflection = imageSource.reflection;
 			diffraction = imageSource.diffraction;
+			reflectanceBound = imageSource.reflectanceBound;
 			if (diffraction)
 			{
 				RAC_DEBUG_ASSERT(mEdges.size() >= imageSource.mEdges.size(), "Current edges are smaller than the incoming data");
@@ -179,7 +191,146 @@ namespace RAC
 				diffractionIndex = imageSource.diffractionIndex;
 				mDiffractionPath = imageSource.mDiffractionPath;
 			}
-			key.clear();
+			key = ImageSourceKey();
+		}
+
+		////////////////////////////////////////
+
+		void ImageSourceData::Copy(const ImageSourceData& imageSource)
+		{
+			arrayID = imageSource.arrayID;
+			key = imageSource.key;
+			keySourceID = imageSource.keySourceID;
+
+			pathParts = imageSource.pathParts;
+			mPositions = imageSource.mPositions;
+			mEdges = imageSource.mEdges;
+			diffractionIndex = imageSource.diffractionIndex;
+			previousPlane = imageSource.previousPlane;
+
+			mDiffractionPath = imageSource.mDiffractionPath;
+			mAbsorption = imageSource.mAbsorption;
+			distance = imageSource.distance;
+			reflectanceBound = imageSource.reflectanceBound;
+			transform = imageSource.transform;
+
+			valid = imageSource.valid;
+			visible = imageSource.visible;
+			feedsFDN = imageSource.feedsFDN;
+			reflection = imageSource.reflection;
+			diffraction = imageSource.diffraction;
+		}
+
+		////////////////////////////////////////
+
+		void ImageSourceData::Write(std::ostream& stream) const
+		{
+			WriteBinary(stream, static_cast<uint32_t>(pathParts.size()));
+			for (size_t i = 0; i < pathParts.size(); ++i)
+			{
+				WriteBinary(stream, pathParts[i].id);
+				WriteBinary(stream, static_cast<uint8_t>(pathParts[i].isReflection));
+				WriteBinary(stream, mPositions[i]);
+				WriteBinary(stream, mEdges[i].base);
+				WriteBinary(stream, mEdges[i].edgeVector);
+			}
+
+			WriteBinary(stream, static_cast<Real>(previousPlane.w()));
+			WriteBinary(stream, static_cast<Real>(previousPlane.x()));
+			WriteBinary(stream, static_cast<Real>(previousPlane.y()));
+			WriteBinary(stream, static_cast<Real>(previousPlane.z()));
+			WriteBinary(stream, reflectanceBound);
+			WriteBinary(stream, static_cast<uint8_t>(reflection));
+			WriteBinary(stream, static_cast<uint8_t>(diffraction));
+
+			WriteBinary(stream, static_cast<uint32_t>(mAbsorption.Length()));
+			for (int i = 0; i < mAbsorption.Length(); ++i)
+				WriteBinary(stream, mAbsorption[i]);
+
+			if (!diffraction)
+				return;
+
+			// The image edge is rebuilt from its end points and face normals, which reproduces any reflections applied to it
+			const Edge& edge = mDiffractionPath.GetEdge();
+			WriteBinary(stream, static_cast<int32_t>(diffractionIndex));
+			WriteBinary(stream, edge.GetBase());
+			WriteBinary(stream, edge.GetTop());
+			WriteBinary(stream, edge.GetFaceNormals().first);
+			WriteBinary(stream, edge.GetFaceNormals().second);
+			WriteBinary(stream, static_cast<uint64_t>(edge.GetWallIDs().first));
+			WriteBinary(stream, static_cast<uint64_t>(edge.GetWallIDs().second));
+			WriteBinary(stream, static_cast<uint64_t>(edge.GetPlaneIDs().first));
+			WriteBinary(stream, static_cast<uint64_t>(edge.GetPlaneIDs().second));
+			WriteBinary(stream, mDiffractionPath.sData.point);
+		}
+
+		////////////////////////////////////////
+
+		bool ImageSourceData::Read(std::istream& stream)
+		{
+			Clear();
+
+			uint32_t numParts = 0;
+			if (!ReadBinary(stream, numParts) || numParts == 0 || numParts > MAX_CACHED_IMAGE_SOURCE_ORDER)
+				return false;
+
+			pathParts.clear();
+			mPositions.clear();
+			mEdges.clear();
+			for (uint32_t i = 0; i < numParts; ++i)
+			{
+				partid_t id = 0;
+				uint8_t isReflection = 0;
+				Vec3 position, base, edgeVector;
+				if (!ReadBinary(stream, id) || !ReadBinary(stream, isReflection) || !ReadBinary(stream, position) || !ReadBinary(stream, base) || !ReadBinary(stream, edgeVector))
+					return false;
+				pathParts.emplace_back(id, isReflection != 0);
+				mPositions.emplace_back(position);
+				mEdges.emplace_back(base, edgeVector);
+			}
+
+			Real w = 0.0, x = 0.0, y = 0.0, z = 0.0;
+			uint8_t isReflection = 0, isDiffraction = 0;
+			if (!ReadBinary(stream, w) || !ReadBinary(stream, x) || !ReadBinary(stream, y) || !ReadBinary(stream, z))
+				return false;
+			if (!ReadBinary(stream, reflectanceBound) || !ReadBinary(stream, isReflection) || !ReadBinary(stream, isDiffraction))
+				return false;
+			previousPlane = Vec4(w, x, y, z);
+			reflection = isReflection != 0;
+			diffraction = isDiffraction != 0;
+
+			uint32_t numBands = 0;
+			if (!ReadBinary(stream, numBands) || static_cast<int>(numBands) != mAbsorption.Length())
+				return false;
+			for (int i = 0; i < mAbsorption.Length(); ++i)
+			{
+				if (!ReadBinary(stream, mAbsorption[i]))
+					return false;
+			}
+
+			if (!diffraction)
+			{
+				SetTransform(mPositions.back());
+				Valid();
+				return true;
+			}
+
+			int32_t index = 0;
+			Vec3 base, top, normal1, normal2, sourcePosition;
+			uint64_t wallId1 = 0, wallId2 = 0, planeId1 = 0, planeId2 = 0;
+			if (!ReadBinary(stream, index) || !ReadBinary(stream, base) || !ReadBinary(stream, top) || !ReadBinary(stream, normal1) || !ReadBinary(stream, normal2))
+				return false;
+			if (!ReadBinary(stream, wallId1) || !ReadBinary(stream, wallId2) || !ReadBinary(stream, planeId1) || !ReadBinary(stream, planeId2) || !ReadBinary(stream, sourcePosition))
+				return false;
+			if (index < 0 || index >= static_cast<int32_t>(numParts))
+				return false;
+			diffractionIndex = index;
+
+			// The receiver side of the path is updated by the receiver checks, so any receiver outside the edge can be used here
+			const Edge edge(base, top, normal1, normal2, wallId1, wallId2, planeId1, planeId2);
+			mDiffractionPath.UpdateParameters(sourcePosition, edge.GetMidPoint() + edge.GetEdgeNormal(), edge);
+			Valid();
+			return true;
 		}
 
 		//////////////////// ImageSource class ////////////////////
@@ -0,0 +1,156 @@
+/*
+* @class ImageSourceCache
+*
+* @brief Definition of ImageSourceCache class
+*
+*/
+
+// C++ headers
+#include <fstream>
+#include <cstring>
+
+// Common headers
+#include "Common/BinaryStream.h"
+
+// Spatialiser headers
+#include "Spatialiser/ImageSourceCache.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		namespace
+		{
+			constexpr char FILE_MAGIC[8] = { 'R', 'A', 'C', 'I', 'S', 'C', 'H', 'E' };	// Identifies image source cache files
+			constexpr uint32_t FILE_VERSION = 1;										// Incremented whenever the file layout changes
+		}
+
+		//////////////////// ImageSourceCache Class ////////////////////
+
+		////////////////////////////////////////
+
+		void ImageSourceCache::Add(const Vec3& sourcePosition, const int numOrders, const ImageSourceDataStore& sp)
+		{
+			Entry& entry = entries.emplace_back();
+			entry.sourcePosition = sourcePosition;
+			entry.numOrders = numOrders;
+
+			const size_t numStored = std::min(static_cast<size_t>(std::max(numOrders, 0)), sp.size());
+			entry.sp.resize(numStored);
+			for (size_t refIdx = 0; refIdx < numStored; ++refIdx)
+			{
+				for (const std::shared_ptr<ImageSourceData>& imageSource : sp[refIdx])
+				{
+					if (imageSource->IsValid())
+						entry.sp[refIdx].push_back(std::make_shared<ImageSourceData>(*imageSource));
+				}
+			}
+		}
+
+		////////////////////////////////////////
+
+		const ImageSourceCache::Entry* ImageSourceCache::Find(const Vec3& sourcePosition) const
+		{
+			for (const Entry& entry : entries)
+			{
+				if (entry.sourcePosition == sourcePosition)
+					return &entry;
+			}
+			return nullptr;
+		}
+
+		////////////////////////////////////////
+
+		bool ImageSourceCache::Write(const std::string& filePath) const
+		{
+			std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+			WriteBinary(file, FILE_VERSION);
+			WriteBinary(file, static_cast<uint32_t>(sizeof(Real)));
+			WriteBinary(file, geometryHash);
+			WriteBinary(file, configHash);
+			WriteBinary(file, listenerPosition);
+			WriteBinary(file, listenerRadius);
+			WriteBinary(file, static_cast<int32_t>(numFrequencyBands));
+
+			WriteBinary(file, static_cast<uint64_t>(entries.size()));
+			for (const Entry& entry : entries)
+			{
+				WriteBinary(file, entry.sourcePosition);
+				WriteBinary(file, static_cast<int32_t>(entry.numOrders));
+				WriteBinary(file, static_cast<uint64_t>(entry.sp.size()));
+				for (const std::vector<std::shared_ptr<ImageSourceData>>& order : entry.sp)
+				{
+					WriteBinary(file, static_cast<uint64_t>(order.size()));
+					for (const std::shared_ptr<ImageSourceData>& imageSource : order)
+						imageSource->Write(file);
+				}
+			}
+			return file.good();
+		}
+
+		////////////////////////////////////////
+
+		std::shared_ptr<ImageSourceCache> ImageSourceCache::Read(const std::string& filePath)
+		{
+			std::ifstream file(filePath, std::ios::binary);
+			if (!file.is_open())
+				return nullptr;
+
+			char magic[sizeof(FILE_MAGIC)];
+			file.read(magic, sizeof(magic));
+			if (!file.good() || std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+				return nullptr;
+
+			uint32_t version = 0, realSize = 0;
+			if (!ReadBinary(file, version) || version != FILE_VERSION || !ReadBinary(file, realSize) || realSize != sizeof(Real))
+				return nullptr;
+
+			uint64_t geometryHash = 0, configHash = 0;
+			Vec3 listenerPosition;
+			Real listenerRadius = 0.0;
+			int32_t numFrequencyBands = 0;
+			if (!ReadBinary(file, geometryHash) || !ReadBinary(file, configHash) || !ReadBinary(file, listenerPosition) || !ReadBinary(file, listenerRadius) || !ReadBinary(file, numFrequencyBands))
+				return nullptr;
+			if (numFrequencyBands <= 0)
+				return nullptr;
+
+			std::shared_ptr<ImageSourceCache> cache = std::make_shared<ImageSourceCache>(geometryHash, configHash, listenerPosition, listenerRadius, numFrequencyBands);
+
+			uint64_t numEntries = 0;
+			if (!ReadBinary(file, numEntries))
+				return nullptr;
+			for (uint64_t i = 0; i < numEntries; ++i)
+			{
+				Entry& entry = cache->entries.emplace_back();
+				int32_t numOrders = 0;
+				uint64_t numStored = 0;
+				if (!ReadBinary(file, entry.sourcePosition) || !ReadBinary(file, numOrders) || !ReadBinary(file, numStored))
+					return nullptr;
+				if (numOrders < 0 || numStored > MAX_CACHED_IMAGE_SOURCE_ORDER)
+					return nullptr;
+				entry.numOrders = numOrders;
+
+				entry.sp.resize(numStored);
+				for (std::vector<std::shared_ptr<ImageSourceData>>& order : entry.sp)
+				{
+					uint64_t numImageSources = 0;
+					if (!ReadBinary(file, numImageSources))
+						return nullptr;
+					for (uint64_t j = 0; j < numImageSources; ++j)
+					{
+						std::shared_ptr<ImageSourceData> imageSource = std::make_shared<ImageSourceData>(numFrequencyBands);
+						if (!imageSource->Read(file))
+							return nullptr;
+						order.push_back(std::move(imageSource));
+					}
+				}
+			}
+			return cache;
+		}
+	}
+}
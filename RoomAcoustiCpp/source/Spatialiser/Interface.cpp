@@ -329,6 +329,26 @@ namespace RAC
 
 		////////////////////////////////////////
 
+		bool BakeImageSources(const std::string& filePath)
+		{
+			auto context = GetContext();
+			if (context)
+				return context->BakeImageSources(filePath);
+			return false;
+		}
+
+		////////////////////////////////////////
+
+		bool LoadImageSourceCache(const std::string& filePath)
+		{
+			auto context = GetContext();
+			if (context)
+				return context->LoadImageSourceCache(filePath);
+			return false;
+		}
+
+		////////////////////////////////////////
+
 		void UpdateLateReverbGain(const Real gain)
 		{
 			auto context = GetContext();
@@ -0,0 +1,136 @@
+/*
+* @class ReflectionBatch
+*
+* @brief Definition of ReflectionBatch class
+*
+*/
+
+// C++ headers
+#include <cstring>
+
+// Spatialiser headers
+#include "Spatialiser/ReflectionBatch.h"
+
+// SSE2 is part of x64, so use it when AVX is not enabled
+#if !USE_AVX && DATA_TYPE_DOUBLE && (defined(_M_X64) || defined(__SSE2__))
+#	define USE_SSE2		1
+#	include <emmintrin.h>
+#else
+#	define USE_SSE2		0
+#endif
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		namespace
+		{
+			// Tolerance that keeps the culls conservative with respect to the rounding of the scalar checks
+			constexpr Real CULL_TOLERANCE = EPS;
+
+			// Mask bytes of four lanes for each movemask result (x86 is little endian, so lane 0 is the first byte)
+			constexpr uint32_t LANE_MASKS[16] = {
+				0x00000000, 0x00000001, 0x00000100, 0x00000101, 0x00010000, 0x00010001, 0x00010100, 0x00010101,
+				0x01000000, 0x01000001, 0x01000100, 0x01000101, 0x01010000, 0x01010001, 0x01010100, 0x01010101
+			};
+		}
+
+		//////////////////// ReflectionBatch Class ////////////////////
+
+		////////////////////////////////////////
+
+		void ReflectionBatch::Cull(const Plane& plane, const Vec3& listenerPosition, const Real maxDistance, uint8_t* mask) const
+		{
+			const size_t numPositions = x.size();
+			const Vec3 normal = plane.GetNormal();
+			const Real nx = normal.x(), ny = normal.y(), nz = normal.z(), d = plane.GetD();
+			const Real lx = listenerPosition.x(), ly = listenerPosition.y(), lz = listenerPosition.z();
+			const Real minK = -CULL_TOLERANCE;
+			const Real maxDistanceSquared = (maxDistance + CULL_TOLERANCE) * (maxDistance + CULL_TOLERANCE);
+
+			size_t i = 0;
+
+#if USE_AVX
+
+#if DATA_TYPE_DOUBLE
+			const __m256d nxVec = _mm256_set1_pd(nx), nyVec = _mm256_set1_pd(ny), nzVec = _mm256_set1_pd(nz), dVec = _mm256_set1_pd(d);
+			const __m256d lxVec = _mm256_set1_pd(lx), lyVec = _mm256_set1_pd(ly), lzVec = _mm256_set1_pd(lz);
+			const __m256d minKVec = _mm256_set1_pd(minK), maxDistanceVec = _mm256_set1_pd(maxDistanceSquared);
+			for (; i + 4 <= numPositions; i += 4)
+			{
+				const __m256d px = _mm256_loadu_pd(x.data() + i);
+				const __m256d py = _mm256_loadu_pd(y.data() + i);
+				const __m256d pz = _mm256_loadu_pd(z.data() + i);
+
+				// Signed distance from the plane (k) and distance from the reflected position to the listener
+				const __m256d k = _mm256_sub_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(px, nxVec), _mm256_mul_pd(py, nyVec)), _mm256_mul_pd(pz, nzVec)), dVec);
+				const __m256d twoK = _mm256_add_pd(k, k);
+				const __m256d dx = _mm256_sub_pd(_mm256_sub_pd(px, _mm256_mul_pd(nxVec, twoK)), lxVec);
+				const __m256d dy = _mm256_sub_pd(_mm256_sub_pd(py, _mm256_mul_pd(nyVec, twoK)), lyVec);
+				const __m256d dz = _mm256_sub_pd(_mm256_sub_pd(pz, _mm256_mul_pd(nzVec, twoK)), lzVec);
+				const __m256d distanceSquared = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+
+				const __m256d valid = _mm256_and_pd(_mm256_cmp_pd(k, minKVec, _CMP_GT_OQ), _mm256_cmp_pd(distanceSquared, maxDistanceVec, _CMP_LE_OQ));
+				std::memcpy(mask + i, &LANE_MASKS[_mm256_movemask_pd(valid)], 4);
+			}
+#else
+			const __m256 nxVec = _mm256_set1_ps(nx), nyVec = _mm256_set1_ps(ny), nzVec = _mm256_set1_ps(nz), dVec = _mm256_set1_ps(d);
+			const __m256 lxVec = _mm256_set1_ps(lx), lyVec = _mm256_set1_ps(ly), lzVec = _mm256_set1_ps(lz);
+			const __m256 minKVec = _mm256_set1_ps(minK), maxDistanceVec = _mm256_set1_ps(maxDistanceSquared);
+			for (; i + 8 <= numPositions; i += 8)
+			{
+				const __m256 px = _mm256_loadu_ps(x.data() + i);
+				const __m256 py = _mm256_loadu_ps(y.data() + i);
+				const __m256 pz = _mm256_loadu_ps(z.data() + i);
+
+				// Signed distance from the plane (k) and distance from the reflected position to the listener
+				const __m256 k = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, nxVec), _mm256_mul_ps(py, nyVec)), _mm256_mul_ps(pz, nzVec)), dVec);
+				const __m256 twoK = _mm256_add_ps(k, k);
+				const __m256 dx = _mm256_sub_ps(_mm256_sub_ps(px, _mm256_mul_ps(nxVec, twoK)), lxVec);
+				const __m256 dy = _mm256_sub_ps(_mm256_sub_ps(py, _mm256_mul_ps(nyVec, twoK)), lyVec);
+				const __m256 dz = _mm256_sub_ps(_mm256_sub_ps(pz, _mm256_mul_ps(nzVec, twoK)), lzVec);
+				const __m256 distanceSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+
+				const __m256 valid = _mm256_and_ps(_mm256_cmp_ps(k, minKVec, _CMP_GT_OQ), _mm256_cmp_ps(distanceSquared, maxDistanceVec, _CMP_LE_OQ));
+				const int bits = _mm256_movemask_ps(valid);
+				std::memcpy(mask + i, &LANE_MASKS[bits & 0xF], 4);
+				std::memcpy(mask + i + 4, &LANE_MASKS[bits >> 4], 4);
+			}
+#endif
+
+#elif USE_SSE2
+			const __m128d nxVec = _mm_set1_pd(nx), nyVec = _mm_set1_pd(ny), nzVec = _mm_set1_pd(nz), dVec = _mm_set1_pd(d);
+			const __m128d lxVec = _mm_set1_pd(lx), lyVec = _mm_set1_pd(ly), lzVec = _mm_set1_pd(lz);
+			const __m128d minKVec = _mm_set1_pd(minK), maxDistanceVec = _mm_set1_pd(maxDistanceSquared);
+			for (; i + 2 <= numPositions; i += 2)
+			{
+				const __m128d px = _mm_loadu_pd(x.data() + i);
+				const __m128d py = _mm_loadu_pd(y.data() + i);
+				const __m128d pz = _mm_loadu_pd(z.data() + i);
+
+				// Signed distance from the plane (k) and distance from the reflected position to the listener
+				const __m128d k = _mm_sub_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(px, nxVec), _mm_mul_pd(py, nyVec)), _mm_mul_pd(pz, nzVec)), dVec);
+				const __m128d twoK = _mm_add_pd(k, k);
+				const __m128d dx = _mm_sub_pd(_mm_sub_pd(px, _mm_mul_pd(nxVec, twoK)), lxVec);
+				const __m128d dy = _mm_sub_pd(_mm_sub_pd(py, _mm_mul_pd(nyVec, twoK)), lyVec);
+				const __m128d dz = _mm_sub_pd(_mm_sub_pd(pz, _mm_mul_pd(nzVec, twoK)), lzVec);
+				const __m128d distanceSquared = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+
+				const __m128d valid = _mm_and_pd(_mm_cmpgt_pd(k, minKVec), _mm_cmple_pd(distanceSquared, maxDistanceVec));
+				std::memcpy(mask + i, &LANE_MASKS[_mm_movemask_pd(valid)], 2);
+			}
+#endif
+
+			// Remaining positions (or all positions if no SIMD instructions are available)
+			for (; i < numPositions; ++i)
+			{
+				const Real k = x[i] * nx + y[i] * ny + z[i] * nz - d;
+				const Real dx = x[i] - 2.0 * nx * k - lx;
+				const Real dy = y[i] - 2.0 * ny * k - ly;
+				const Real dz = z[i] - 2.0 * nz * k - lz;
+				mask[i] = static_cast<uint8_t>(k > minK && dx * dx + dy * dy + dz * dz <= maxDistanceSquared);
+			}
+		}
+	}
+}
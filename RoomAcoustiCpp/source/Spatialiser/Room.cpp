@@ -118,32 +118,28 @@ namespace RAC
 
 		////////////////////////////////////////
 
-		void Room::CreateTriangleMeshSoA()
+		std::shared_ptr<const RoomSnapshot> Room::GetSnapshot()
 		{
-			std::lock_guard<std::mutex> lock(mWallMutex);			
-			mTriangleMeshSoA.resize(ToInt(mWalls.size()));
+			std::shared_ptr<const RoomSnapshot> snapshot = std::atomic_load(&mSnapshot);
+			if (snapshot && snapshot->GetVersion() == GetVersion())
+				return snapshot;
 
-			for (const auto& [i, wall] : mWalls)
-			{
-				Vertices vertices = wall.GetVertices();
-				const Vec3 &A = vertices[0];
-				const Vec3 &B = vertices[1];
-				const Vec3 &C = vertices[2];
-
-				// ----- Anchor vertex A -----
-				mTriangleMeshSoA.A[i] = A;
-
-				// ----- Edges from A -----
-				mTriangleMeshSoA.edge1[i] = B - A;
-				mTriangleMeshSoA.edge2[i] = C - A;
+			std::lock_guard<std::mutex> snapshotLock(mSnapshotMutex);
+			snapshot = std::atomic_load(&mSnapshot);
+			// Read the version before copying. A change made during the copy triggers another snapshot on the next call
+			const uint64_t currentVersion = GetVersion();
+			if (snapshot && snapshot->GetVersion() == currentVersion) // case: published by another thread
+				return snapshot;
 
-
-				// ----- Plane parameters: normal n and plane constant d0 -----
-				mTriangleMeshSoA.n[i] = wall.GetNormal();
-				mTriangleMeshSoA.patchId[i] = static_cast<int>(wall.GetMaterialID());
-
-				mTriangleMeshSoA.d0PlusEPS[i] = wall.GetD() + EPS_FACING;
+			{
+				std::lock_guard<std::mutex> wallLock(mWallMutex);
+				std::lock_guard<std::mutex> edgeLock(mEdgeMutex);
+				std::lock_guard<std::mutex> planeLock(mPlaneMutex);
+				std::lock_guard<std::mutex> materialLock(mMaterialMutex);
+				snapshot = std::make_shared<const RoomSnapshot>(currentVersion, mPlanes, mWalls, mMaterials, mEdges);
 			}
+			std::atomic_store(&mSnapshot, snapshot);
+			return snapshot;
 		}
 
 		////////////////////////////////////////
@@ -0,0 +1,218 @@
+/*
+* @class RoomSnapshot
+*
+* @brief Definition of RoomSnapshot class
+*
+*/
+
+// Common headers
+#include "Common/Hash.h"
+
+// Spatialiser headers
+#include "Spatialiser/RoomSnapshot.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+
+		//////////////////// RoomSnapshot Class ////////////////////
+
+		////////////////////////////////////////
+
+		RoomSnapshot::RoomSnapshot(const uint64_t version, const PlaneMap& planes, const WallMap& walls, const MaterialMap& materials, const EdgeMap& edges) : version(version)
+		{
+			mPlanes.Build(planes);
+			mWalls.Build(walls);
+			mMaterials.Build(materials);
+			mEdges.Build(edges);
+
+			mWallBVH.Build(planes, walls);
+			mEdgeBVH.Build(mEdges.items);
+			CreateTriangleMeshSoA();
+			CreateVisibilityTables();
+			CreateMaxPlaneReflectances();
+			CreateGeometryHash();
+		}
+
+		////////////////////////////////////////
+
+		void RoomSnapshot::CreateTriangleMeshSoA()
+		{
+			mTriangleMeshSoA.resize(ToInt(mWalls.items.size()));
+
+			for (size_t i = 0; i < mWalls.items.size(); ++i)
+			{
+				const Wall& wall = mWalls.items[i];
+				Vertices vertices = wall.GetVertices();
+				const Vec3 &A = vertices[0];
+				const Vec3 &B = vertices[1];
+				const Vec3 &C = vertices[2];
+
+				// ----- Anchor vertex A -----
+				mTriangleMeshSoA.A[i] = A;
+
+				// ----- Edges from A -----
+				mTriangleMeshSoA.edge1[i] = B - A;
+				mTriangleMeshSoA.edge2[i] = C - A;
+
+				// ----- Plane parameters: normal n and plane constant d0 -----
+				mTriangleMeshSoA.n[i] = wall.GetNormal();
+				mTriangleMeshSoA.patchId[i] = static_cast<int>(wall.GetMaterialID());
+
+				mTriangleMeshSoA.d0PlusEPS[i] = wall.GetD() + EPS_FACING;
+			}
+			mTriangleMeshSoA.build_bvh();
+			mTriangleMeshSoA.build_blocks();
+		}
+
+		////////////////////////////////////////
+
+		void RoomSnapshot::CreateVisibilityTables()
+		{
+			const size_t numPlanes = mPlanes.items.size();
+			const size_t numEdges = mEdges.items.size();
+
+			// Wall vertices of each plane
+			std::vector<std::vector<Vec3>> planeVertices(numPlanes);
+			for (size_t i = 0; i < numPlanes; ++i)
+			{
+				for (const size_t wallID : mPlanes.items[i].GetWalls())
+				{
+					if (const Wall* wall = mWalls.Find(wallID))
+					{
+						for (const Vec3& vertex : wall->GetVertices())
+							planeVertices[i].push_back(vertex);
+					}
+				}
+			}
+
+			// True if any vertex lies in front of (or on) the plane with the given normal and d
+			auto anyInFront = [](const std::vector<Vec3>& vertices, const Vec3& normal, const Real d)
+				{
+					for (const Vec3& vertex : vertices)
+					{
+						if (vertex.dot(normal) - d > -EPS_GENERAL)
+							return true;
+					}
+					return false;
+				};
+
+			// True if any vertex lies outside the wedge of the edge (in front of either face)
+			auto anyOutsideWedge = [&](const std::vector<Vec3>& vertices, const Edge& edge)
+				{
+					const Vec3Pair normals = edge.GetFaceNormals();
+					return anyInFront(vertices, normals.first, normals.first.dot(edge.GetBase())) ||
+						anyInFront(vertices, normals.second, normals.second.dot(edge.GetBase()));
+				};
+
+			// Reflection in plane i then plane j: the path leaves the front of plane i and arrives at the front of plane j
+			mPlanePlanes.assign(numPlanes, std::vector<size_t>());
+			for (size_t i = 0; i < numPlanes; ++i)
+			{
+				const Plane& planeI = mPlanes.items[i];
+				for (size_t j = 0; j < numPlanes; ++j)
+				{
+					if (i == j)
+						continue;
+					const Plane& planeJ = mPlanes.items[j];
+					if (anyInFront(planeVertices[j], planeI.GetNormal(), planeI.GetD()) && anyInFront(planeVertices[i], planeJ.GetNormal(), planeJ.GetD()))
+						mPlanePlanes[i].push_back(j);
+				}
+			}
+
+			// Paths between plane i and edge j (in either order) need part of the edge in front of the plane and part of the plane outside the wedge.
+			// Reflections after a diffraction also require the whole edge to be in front of the plane
+			mPlaneEdges.assign(numPlanes, std::vector<size_t>());
+			mEdgePlanes.assign(numEdges, std::vector<size_t>());
+			for (size_t j = 0; j < numEdges; ++j)
+			{
+				const Edge& edge = mEdges.items[j];
+				for (size_t i = 0; i < numPlanes; ++i)
+				{
+					if (edge.IncludesPlane(mPlanes.ids[i]))
+						continue;
+
+					const Plane& plane = mPlanes.items[i];
+					if (!anyInFront({ edge.GetBase(), edge.GetTop() }, plane.GetNormal(), plane.GetD()))
+						continue;
+
+					if (!anyOutsideWedge(planeVertices[i], edge))
+						continue;
+
+					mPlaneEdges[i].push_back(j);
+					if (plane.EdgePlanePosition(edge))
+						mEdgePlanes[j].push_back(i);
+				}
+			}
+		}
+
+		////////////////////////////////////////
+
+		void RoomSnapshot::CreateMaxPlaneReflectances()
+		{
+			mMaxPlaneReflectances.assign(mPlanes.items.size(), 0.0);
+			for (size_t i = 0; i < mPlanes.items.size(); ++i)
+			{
+				for (const size_t wallID : mPlanes.items[i].GetWalls())
+				{
+					const Wall* wall = mWalls.Find(wallID);
+					if (!wall)
+						continue;
+					const Coefficients<>* material = mMaterials.Find(wall->GetMaterialID());
+					if (!material)
+						continue;
+					for (int j = 0; j < material->Length(); ++j)
+						mMaxPlaneReflectances[i] = std::max(mMaxPlaneReflectances[i], std::abs((*material)[j]));
+				}
+			}
+		}
+	
+		////////////////////////////////////////
+
+		void RoomSnapshot::CreateGeometryHash()
+		{
+			uint64_t hash = HASH_OFFSET_BASIS;
+			for (size_t i = 0; i < mPlanes.items.size(); ++i)
+			{
+				const Plane& plane = mPlanes.items[i];
+				HashValue(hash, static_cast<uint64_t>(mPlanes.ids[i]));
+				HashValue(hash, plane.GetNormal());
+				HashValue(hash, plane.GetD());
+				for (const size_t wallID : plane.GetWalls())
+					HashValue(hash, static_cast<uint64_t>(wallID));
+			}
+
+			for (size_t i = 0; i < mWalls.items.size(); ++i)
+			{
+				const Wall& wall = mWalls.items[i];
+				HashValue(hash, static_cast<uint64_t>(mWalls.ids[i]));
+				HashValue(hash, static_cast<uint64_t>(wall.GetMaterialID()));
+				for (const Vec3& vertex : wall.GetVertices())
+					HashValue(hash, vertex);
+			}
+
+			for (size_t i = 0; i < mMaterials.items.size(); ++i)
+			{
+				const Coefficients<>& material = mMaterials.items[i];
+				HashValue(hash, static_cast<uint64_t>(mMaterials.ids[i]));
+				for (int j = 0; j < material.Length(); ++j)
+					HashValue(hash, material[j]);
+			}
+
+			for (size_t i = 0; i < mEdges.items.size(); ++i)
+			{
+				const Edge& edge = mEdges.items[i];
+				HashValue(hash, static_cast<uint64_t>(mEdges.ids[i]));
+				HashValue(hash, edge.GetBase());
+				HashValue(hash, edge.GetTop());
+				HashValue(hash, edge.GetFaceNormals().first);
+				HashValue(hash, edge.GetFaceNormals().second);
+				HashValue(hash, static_cast<uint64_t>(edge.GetPlaneIDs().first));
+				HashValue(hash, static_cast<uint64_t>(edge.GetPlaneIDs().second));
+			}
+			geometryHash = hash;
+		}
+	}
+}
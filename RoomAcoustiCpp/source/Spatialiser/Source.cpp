@@ -535,6 +535,7 @@ namespace RAC
 
 		void Source::UpdateImageSourceDataMap(ImageSourceDataMap& imageSourceData)
 		{
+			imageSourceDataPool.BeginPass();
 			for (auto& [key, vSource] : currentImageSources)
 			{
 				auto it = imageSourceData.find(key);
@@ -550,7 +551,17 @@ namespace RAC
 					lock_guard<std::mutex>lock(*imageSourcesMutex);
 					if (!GetAccess())
 						return;
-					currentImageSources.emplace(key, std::pair<int, std::shared_ptr<ImageSourceData>>(-1, std::make_shared<ImageSourceData>(*vSource)));
+					currentImageSources.emplace(key, std::pair<int, std::shared_ptr<ImageSourceData>>(-1, imageSourceDataPool.Acquire(*vSource)));
+					FreeAccess();
+				}
+				else if (!it->second.second->SamePath(*vSource)) // case: key collision, replace the old vSource with the new one
+				{
+					RAC_DEBUG_LOG("Image source key collision: " + vSource->GetKeyString(), DebugType::Warning);
+					lock_guard<std::mutex>lock(*imageSourcesMutex);
+					if (!GetAccess())
+						return;
+					RemoveImageSource(it->second.first);
+					it->second = std::pair<int, std::shared_ptr<ImageSourceData>>(-1, imageSourceDataPool.Acquire(*vSource));
 					FreeAccess();
 				}
 				else // case: update exist vSource
@@ -560,9 +571,22 @@ namespace RAC
 
 		////////////////////////////////////////
 
+		void Source::RemoveImageSource(const int id)
+		{
+			if (id < 0)		// case: virtual source does not exist
+				return;
+
+			int fdnChannel = imageSources.at(id).GetFDNChannel();
+			if (fdnChannel >= 0)
+				freeFDNChannels.push_back(fdnChannel);
+			imageSources.at(id).Remove();
+		}
+
+		////////////////////////////////////////
+
 		void Source::UpdateImageSources(const std::shared_ptr<DSPConfig>& config)
 		{
-			std::vector<std::string> keys;
+			std::vector<ImageSourceKey> keys;
 			for (auto& [key, vSource] : currentImageSources)
 			{
 				if (UpdateImageSource(vSource.first, vSource.second, config))
@@ -572,10 +596,13 @@ namespace RAC
 			lock_guard<std::mutex>lock(*imageSourcesMutex);
 			if (!GetAccess())
 				return;
-			for (const std::string& key : keys)
+			for (const ImageSourceKey& key : keys)
 			{
-				currentImageSources.erase(key);
-				RAC_DEBUG_REMOVEPATH(key);
+				auto it = currentImageSources.find(key);
+				if (it == currentImageSources.end())
+					continue;
+				RAC_DEBUG_REMOVEPATH(it->second.second->GetKeyString());
+				currentImageSources.erase(it);
 			}
 			FreeAccess();
 		}
@@ -594,7 +621,7 @@ namespace RAC
 				if (id < 0)		// No free slots
 					return false;
 
-				imageSources.at(id).Init(&inputBuffer, dspConfig, data, fdnChannel);
+				imageSources.Init(id, &inputBuffer, dspConfig, data, fdnChannel);
 			}
 			else
 			{
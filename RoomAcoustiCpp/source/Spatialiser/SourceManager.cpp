@@ -19,9 +19,14 @@ namespace RAC
 
 		int SourceManager::Init()
 		{
+			std::lock_guard<std::mutex> activeLock(activeSourcesMutex);
 			int id = NextID();
 			if (id < 0)
 				return id;
+
+			// Publish before Init so the first audio block after Init processes the source
+			activeSources.Add(id);
+			activeSources.Publish();
 			std::lock_guard<std::mutex> lock(frequencyIndexingMutex);
 			mSources[id]->Init(dspConfig, frequencyIndexing);
 			return id;
@@ -29,6 +34,25 @@ namespace RAC
 
 		////////////////////////////////////////
 
+		void SourceManager::ResetUnusedSources()
+		{
+			{
+				std::lock_guard<std::mutex> lock(activeSourcesMutex);
+				const std::shared_ptr<const std::vector<int>> active = activeSources.Get();
+				for (int i : *active)
+				{
+					mSources[i]->Reset();
+					// Image sources may still read the input buffer, so keep the source until the audio thread has cleared it
+					if (mSources[i]->IsReset() && mSources[i]->IsInputBufferCleared())
+						activeSources.Remove(i);
+				}
+				activeSources.Publish();
+			}
+			mImageSources.Reset();
+		}
+
+		////////////////////////////////////////
+
 		std::vector<Source::Data> SourceManager::GetSourceData(ThreadID id)
 		{
 			std::vector<Source::Data> sourceData;
@@ -0,0 +1,270 @@
+// C++ headers
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Common headers
+#include "Common/Debug.h"
+
+// Spatialiser headers
+#include "Spatialiser/TracingKernels.h"
+
+// The AVX2 kernels are compiled on x64 regardless of the build's instruction set and selected at runtime
+#if defined(_M_X64) || defined(__x86_64__)
+#   define USE_AVX2_KERNELS                ( 1 )
+#   include <immintrin.h>
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#       define RAC_TARGET_AVX2
+#   else
+#       define RAC_TARGET_AVX2             __attribute__((target("avx2,fma")))
+#   endif
+#else
+#   define USE_AVX2_KERNELS                ( 0 )
+#endif
+
+namespace RAC
+{
+    using namespace Common;
+    namespace Spatialiser
+    {
+        namespace
+        {
+            // Bound on the relative rounding error of the single precision Möller–Trumbore terms (including the conversion from Real)
+            constexpr float FILTER_ERROR = 16.0f * FLT_EPSILON;
+
+#if USE_AVX2_KERNELS
+            bool query_avx2()
+            {
+#ifdef _MSC_VER
+                int info[4];
+                __cpuid(info, 0);
+                if (info[0] < 7)
+                    return false;
+
+                // FMA, OSXSAVE and AVX
+                __cpuid(info, 1);
+                constexpr int featureBits = (1 << 12) | (1 << 27) | (1 << 28);
+                if ((info[2] & featureBits) != featureBits)
+                    return false;
+
+                // The operating system saves the YMM registers
+                if ((_xgetbv(0) & 0x6) != 0x6)
+                    return false;
+
+                // AVX2
+                __cpuidex(info, 7, 0);
+                return (info[1] & (1 << 5)) != 0;
+#else
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+            }
+#endif
+        }
+
+        // ------------------------ CPU dispatch ------------------------
+
+        bool cpu_supports_avx2()
+        {
+#if USE_AVX2_KERNELS
+            static const bool supported = query_avx2();
+            return supported;
+#else
+            return false;
+#endif
+        }
+
+        // ------------------------ AVX2 kernels ------------------------
+
+#if USE_AVX2_KERNELS
+        namespace
+        {
+            /**
+             * @brief Ray data shared by every block of triangles.
+             */
+            struct RayLanes
+            {
+                __m256 Ox, Oy, Oz;
+                __m256 Dx, Dy, Dz;
+                __m256 lengthO;
+                __m256 errorD;
+            };
+
+            /**
+             * @brief Single precision data of TRIANGLE_BLOCK_SIZE triangles.
+             */
+            struct TriangleLanes
+            {
+                __m256 Ax, Ay, Az;
+                __m256 e1x, e1y, e1z;
+                __m256 e2x, e2y, e2z;
+                __m256 nx, ny, nz;
+                __m256 d0PlusEPS;
+                __m256 lengthA, lengthEdge1, lengthEdge2, absD0;
+            };
+
+            RAC_TARGET_AVX2
+            inline RayLanes load_ray(const Vec3& O, const Vec3& D)
+            {
+                RayLanes ray;
+                ray.Ox = _mm256_set1_ps(static_cast<float>(O.x()));
+                ray.Oy = _mm256_set1_ps(static_cast<float>(O.y()));
+                ray.Oz = _mm256_set1_ps(static_cast<float>(O.z()));
+                ray.Dx = _mm256_set1_ps(static_cast<float>(D.x()));
+                ray.Dy = _mm256_set1_ps(static_cast<float>(D.y()));
+                ray.Dz = _mm256_set1_ps(static_cast<float>(D.z()));
+                ray.lengthO = _mm256_set1_ps(static_cast<float>(O.Normal()));
+                ray.errorD = _mm256_set1_ps(FILTER_ERROR * static_cast<float>(D.Normal()));
+                return ray;
+            }
+
+            // Load the triangles starting at index i
+            RAC_TARGET_AVX2
+            inline TriangleLanes load_triangles(const TriangleBlockSoA& blocks, int i)
+            {
+                TriangleLanes t;
+                t.Ax = _mm256_loadu_ps(&blocks.Ax[i]); t.Ay = _mm256_loadu_ps(&blocks.Ay[i]); t.Az = _mm256_loadu_ps(&blocks.Az[i]);
+                t.e1x = _mm256_loadu_ps(&blocks.e1x[i]); t.e1y = _mm256_loadu_ps(&blocks.e1y[i]); t.e1z = _mm256_loadu_ps(&blocks.e1z[i]);
+                t.e2x = _mm256_loadu_ps(&blocks.e2x[i]); t.e2y = _mm256_loadu_ps(&blocks.e2y[i]); t.e2z = _mm256_loadu_ps(&blocks.e2z[i]);
+                t.nx = _mm256_loadu_ps(&blocks.nx[i]); t.ny = _mm256_loadu_ps(&blocks.ny[i]); t.nz = _mm256_loadu_ps(&blocks.nz[i]);
+                t.d0PlusEPS = _mm256_loadu_ps(&blocks.d0PlusEPS[i]);
+                t.lengthA = _mm256_loadu_ps(&blocks.lengthA[i]);
+                t.lengthEdge1 = _mm256_loadu_ps(&blocks.lengthEdge1[i]);
+                t.lengthEdge2 = _mm256_loadu_ps(&blocks.lengthEdge2[i]);
+                t.absD0 = _mm256_loadu_ps(&blocks.absD0[i]);
+                return t;
+            }
+
+            // Gather the triangles at the given indices
+            RAC_TARGET_AVX2
+            inline TriangleLanes gather_triangles(const TriangleBlockSoA& blocks, __m256i indices)
+            {
+                TriangleLanes t;
+                t.Ax = _mm256_i32gather_ps(blocks.Ax.data(), indices, 4); t.Ay = _mm256_i32gather_ps(blocks.Ay.data(), indices, 4); t.Az = _mm256_i32gather_ps(blocks.Az.data(), indices, 4);
+                t.e1x = _mm256_i32gather_ps(blocks.e1x.data(), indices, 4); t.e1y = _mm256_i32gather_ps(blocks.e1y.data(), indices, 4); t.e1z = _mm256_i32gather_ps(blocks.e1z.data(), indices, 4);
+                t.e2x = _mm256_i32gather_ps(blocks.e2x.data(), indices, 4); t.e2y = _mm256_i32gather_ps(blocks.e2y.data(), indices, 4); t.e2z = _mm256_i32gather_ps(blocks.e2z.data(), indices, 4);
+                t.nx = _mm256_i32gather_ps(blocks.nx.data(), indices, 4); t.ny = _mm256_i32gather_ps(blocks.ny.data(), indices, 4); t.nz = _mm256_i32gather_ps(blocks.nz.data(), indices, 4);
+                t.d0PlusEPS = _mm256_i32gather_ps(blocks.d0PlusEPS.data(), indices, 4);
+                t.lengthA = _mm256_i32gather_ps(blocks.lengthA.data(), indices, 4);
+                t.lengthEdge1 = _mm256_i32gather_ps(blocks.lengthEdge1.data(), indices, 4);
+                t.lengthEdge2 = _mm256_i32gather_ps(blocks.lengthEdge2.data(), indices, 4);
+                t.absD0 = _mm256_i32gather_ps(blocks.absD0.data(), indices, 4);
+                return t;
+            }
+
+            // Returns a mask with bit j set if triangle j may intersect the ray
+            RAC_TARGET_AVX2
+            inline uint8_t filter_lanes(const RayLanes& ray, const TriangleLanes& t)
+            {
+                const __m256 error = _mm256_set1_ps(FILTER_ERROR);
+                const __m256 epsEdge = _mm256_set1_ps(static_cast<float>(EPS_EDGE));
+                const __m256 epsParallel = _mm256_set1_ps(static_cast<float>(EPS_PARALLEL));
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+                // Facing test (rejected if n.O < d0PlusEPS by more than the rounding error).
+                // Each test computes the rejection with ordered comparisons, so NaN values are kept as in intersection_test.
+                const __m256 nO = _mm256_fmadd_ps(t.nx, ray.Ox, _mm256_fmadd_ps(t.ny, ray.Oy, _mm256_mul_ps(t.nz, ray.Oz)));
+                const __m256 toleranceFacing = _mm256_mul_ps(error, _mm256_add_ps(ray.lengthO, t.absD0));
+                const __m256 backFacing = _mm256_cmp_ps(nO, _mm256_sub_ps(t.d0PlusEPS, toleranceFacing), _CMP_LT_OQ);
+
+                // Möller–Trumbore barycentric numerators (unnormalized).
+                const __m256 px = _mm256_fmsub_ps(ray.Dy, t.e2z, _mm256_mul_ps(ray.Dz, t.e2y));
+                const __m256 py = _mm256_fmsub_ps(ray.Dz, t.e2x, _mm256_mul_ps(ray.Dx, t.e2z));
+                const __m256 pz = _mm256_fmsub_ps(ray.Dx, t.e2y, _mm256_mul_ps(ray.Dy, t.e2x));
+                const __m256 det = _mm256_fmadd_ps(t.e1x, px, _mm256_fmadd_ps(t.e1y, py, _mm256_mul_ps(t.e1z, pz)));
+
+                const __m256 tx = _mm256_sub_ps(ray.Ox, t.Ax);
+                const __m256 ty = _mm256_sub_ps(ray.Oy, t.Ay);
+                const __m256 tz = _mm256_sub_ps(ray.Oz, t.Az);
+                const __m256 u = _mm256_fmadd_ps(tx, px, _mm256_fmadd_ps(ty, py, _mm256_mul_ps(tz, pz)));
+
+                const __m256 qx = _mm256_fmsub_ps(ty, t.e1z, _mm256_mul_ps(tz, t.e1y));
+                const __m256 qy = _mm256_fmsub_ps(tz, t.e1x, _mm256_mul_ps(tx, t.e1z));
+                const __m256 qz = _mm256_fmsub_ps(tx, t.e1y, _mm256_mul_ps(ty, t.e1x));
+                const __m256 v = _mm256_fmadd_ps(ray.Dx, qx, _mm256_fmadd_ps(ray.Dy, qy, _mm256_mul_ps(ray.Dz, qz)));
+                const __m256 w = _mm256_sub_ps(det, _mm256_add_ps(u, v));
+
+                // Rounding error bounds, scaled by the magnitudes of the vectors in each term.
+                const __m256 scaleT = _mm256_mul_ps(ray.errorD, _mm256_add_ps(ray.lengthO, t.lengthA));
+                const __m256 errorU = _mm256_mul_ps(scaleT, t.lengthEdge2);
+                const __m256 errorV = _mm256_mul_ps(scaleT, t.lengthEdge1);
+                const __m256 errorDet = _mm256_mul_ps(ray.errorD, _mm256_mul_ps(t.lengthEdge1, t.lengthEdge2));
+                const __m256 toleranceU = _mm256_add_ps(errorU, epsEdge);
+                const __m256 toleranceV = _mm256_add_ps(errorV, epsEdge);
+                const __m256 toleranceW = _mm256_add_ps(_mm256_add_ps(toleranceU, toleranceV), errorDet);
+
+                // Edge test: rejected if two numerators are definitely of opposite sign.
+                const __m256 positive = _mm256_or_ps(_mm256_or_ps(
+                    _mm256_cmp_ps(u, toleranceU, _CMP_GT_OQ),
+                    _mm256_cmp_ps(v, toleranceV, _CMP_GT_OQ)),
+                    _mm256_cmp_ps(w, toleranceW, _CMP_GT_OQ));
+                const __m256 negative = _mm256_or_ps(_mm256_or_ps(
+                    _mm256_cmp_ps(u, _mm256_sub_ps(zero, toleranceU), _CMP_LT_OQ),
+                    _mm256_cmp_ps(v, _mm256_sub_ps(zero, toleranceV), _CMP_LT_OQ)),
+                    _mm256_cmp_ps(w, _mm256_sub_ps(zero, toleranceW), _CMP_LT_OQ));
+                const __m256 outside = _mm256_and_ps(positive, negative);
+
+                // Parallel test (rejected if |det| is below EPS_PARALLEL by more than the rounding error).
+                const __m256 absDet = _mm256_andnot_ps(signMask, det);
+                const __m256 parallel = _mm256_cmp_ps(_mm256_add_ps(absDet, errorDet), epsParallel, _CMP_LE_OQ);
+
+                const __m256 rejected = _mm256_or_ps(_mm256_or_ps(backFacing, outside), parallel);
+                return static_cast<uint8_t>(~_mm256_movemask_ps(rejected) & 0xFF);
+            }
+        }
+
+        RAC_TARGET_AVX2
+        void filter_triangles_avx2(const TriangleBlockSoA& blocks, int firstBlock, int numBlocks,
+            const Vec3& O, const Vec3& D, uint8_t* masks)
+        {
+            RAC_DEBUG_ASSERT(firstBlock >= 0 && firstBlock + numBlocks <= blocks.num_blocks(), "Block index out of bounds: " + ToString(firstBlock + numBlocks));
+
+            const RayLanes ray = load_ray(O, D);
+            for (int block = firstBlock; block < firstBlock + numBlocks; ++block)
+                masks[block - firstBlock] = filter_lanes(ray, load_triangles(blocks, block * TRIANGLE_BLOCK_SIZE));
+        }
+
+        RAC_TARGET_AVX2
+        void filter_candidates_avx2(const TriangleBlockSoA& blocks, const int* candidates, int numCandidates,
+            const Vec3& O, const Vec3& D, uint8_t* masks)
+        {
+            const RayLanes ray = load_ray(O, D);
+            const int numFull = numCandidates / TRIANGLE_BLOCK_SIZE;
+            for (int block = 0; block < numFull; ++block)
+            {
+                const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(candidates + block * TRIANGLE_BLOCK_SIZE));
+                masks[block] = filter_lanes(ray, gather_triangles(blocks, indices));
+            }
+
+            // Fill the last block with the first candidate and clear the extra bits
+            const int remainder = numCandidates - numFull * TRIANGLE_BLOCK_SIZE;
+            if (remainder > 0)
+            {
+                alignas(32) int32_t last[TRIANGLE_BLOCK_SIZE];
+                for (int j = 0; j < TRIANGLE_BLOCK_SIZE; ++j)
+                    last[j] = candidates[numFull * TRIANGLE_BLOCK_SIZE + std::min(j, remainder - 1)];
+                const __m256i indices = _mm256_load_si256(reinterpret_cast<const __m256i*>(last));
+                masks[numFull] = filter_lanes(ray, gather_triangles(blocks, indices)) & static_cast<uint8_t>((1 << remainder) - 1);
+            }
+        }
+#else
+        void filter_triangles_avx2(const TriangleBlockSoA& blocks, int firstBlock, int numBlocks,
+            const Vec3& O, const Vec3& D, uint8_t* masks)
+        {
+            RAC_DEBUG_ASSERT(false, "AVX2 kernels are not available on this platform");
+            for (int block = 0; block < numBlocks; ++block)
+                masks[block] = 0xFF;
+        }
+
+        void filter_candidates_avx2(const TriangleBlockSoA& blocks, const int* candidates, int numCandidates,
+            const Vec3& O, const Vec3& D, uint8_t* masks)
+        {
+            RAC_DEBUG_ASSERT(false, "AVX2 kernels are not available on this platform");
+            for (int block = 0; block < (numCandidates + TRIANGLE_BLOCK_SIZE - 1) / TRIANGLE_BLOCK_SIZE; ++block)
+                masks[block] = 0xFF;
+        }
+#endif
+    }
+}
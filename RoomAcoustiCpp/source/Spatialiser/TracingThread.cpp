@@ -3,6 +3,7 @@
 // Common headers
 #include "Common/RACProfiler.h"
 #include "Common/Debug.h"
+#include "Common/Vec4.h"
 
 // helpers
 #include <cassert>
@@ -12,13 +13,70 @@ namespace RAC
 	using namespace Common;
 	namespace Spatialiser
 	{
+		namespace
+		{
+			/**
+			* @brief Blends a new value into an accumulated one.
+			*
+			* @param weight Weight of the new value (1 to replace the accumulated value).
+			*/
+			inline Real Accumulate(Real accumulated, Real value, Real weight)
+			{
+				return weight >= 1.0 ? value : accumulated + weight * (value - accumulated);
+			}
+		}
+
+		//////////////////// ProgressiveTarget class ////////////////////
+
+		void ProgressiveTarget::Reset() {
+			numUpdates = 0;
+			std::fill(directionUpdates.begin(), directionUpdates.end(), 0);
+		}
+
+		Real ProgressiveTarget::BeginUpdate(const Vec3& newPosition, Real restartThreshold, Real smoothing) {
+			if (numUpdates == 0 || (newPosition - anchor).Normal() > restartThreshold)
+			{
+				Reset();
+				anchor = newPosition;
+			}
+			position = newPosition;
+			++numUpdates;
+
+			// Average every update until the target has accumulated numRays rays, then forget old updates exponentially
+			return std::max(smoothing, REAL_CONST(1.0) / static_cast<Real>(numUpdates));
+		}
+
+		Real ProgressiveTarget::UpdateDirection(int dir_idx, Real smoothing) {
+			RAC_DEBUG_ASSERT(dir_idx >= 0 && dir_idx < ToInt(directionUpdates.size()), "Reverb direction out of range: " + ToString(dir_idx));
+			const int updates = ++directionUpdates[dir_idx];
+			return std::max(smoothing, REAL_CONST(1.0) / static_cast<Real>(updates));
+		}
+
+		bool ProgressiveTarget::NeedsRefinement(const Vec3& newPosition, int updatesToConverge) const {
+			if (numUpdates < updatesToConverge)
+				return true;
+			return (newPosition - position).Normal() >= EPS_POSITION;
+		}
+
+		//////////////////// TracingThread class ////////////////////
+
 		TracingThread::TracingThread(shared_ptr<Room> room, shared_ptr<SourceManager> sourceManager, shared_ptr<Reverb> reverb, const LateReverbData& data, const std::shared_ptr<DSPConfig>& dspConfig) :
 			mRoom(room), mSourceManager(sourceManager), mReverb(reverb),
 			numReverbDirections(dspConfig->GetData().numReverbSources),
-			clustersSizes(dspConfig->GetData().numReverbSources)
+			clustersSizes(dspConfig->GetData().numReverbSources),
+			progressiveRays(std::max(data.progressiveRays, 0)),
+			rng(100)
 		{
 			shared_ptr<Reverb> sharedReverb = mReverb.lock();
 			sharedReverb->GetReverbSourceDirections(reverbDirections);
+			reverbDirectionLookup.build(reverbDirections);
+
+			RAC_DEBUG_ASSERT(data.numThreads >= 0, "Invalid number of ray tracing threads: " + ToString(data.numThreads));
+			const size_t numThreads = data.numThreads > 0 ? static_cast<size_t>(data.numThreads) : std::min(8u, std::max(std::thread::hardware_concurrency(), 1u));
+
+			// The ray tracing thread traces rays alongside the pool
+			if (numThreads > 1)
+				mThreadPool = std::make_unique<ThreadPool>(numThreads - 1);
 
 			// This initializes the pencil, clusters the reverb directions, and allocates buffers of size numRays.
 			SetNumberOfRays(data.numRays);
@@ -33,26 +91,70 @@ namespace RAC
 			else
 				numRays = newNumRays + 1;
 
-			hemispherePencil = RayPencil(numRays / 2, true);
+			// In progressive mode, each update traces an even number of rays below numRays
+			numPencilRays = numRays;
+			if (progressiveRays > 0 && progressiveRays < numRays)
+				numPencilRays = progressiveRays % 2 == 0 ? progressiveRays : progressiveRays + 1;
+			updatesToConverge = (numRays + numPencilRays - 1) / numPencilRays;
+			smoothing = static_cast<Real>(numPencilRays) / static_cast<Real>(numRays);
 
-			rayDistances = Vec<>::Zero(numRays);
-			rayCosines = Vec<>::Zero(numRays);
-			frontIndices = Vec<int>::Constant(numRays, -1);
-			backIndices = Vec<int>::Constant(numRays, -1);
-			rayClusters = Vec<int>::Constant(numRays, -1);
+			hemispherePencil = RayPencil(numPencilRays / 2, true);
 
-			hemispherePencil.clusterDirections(reverbDirections, rayClusters);
-			for (int dir_idx = 0; dir_idx < numReverbDirections; ++dir_idx)
+			rayDistances = Vec<>::Zero(numPencilRays);
+			rayCosines = Vec<>::Zero(numPencilRays);
+			frontIndices = Vec<int>::Constant(numPencilRays, -1);
+			backIndices = Vec<int>::Constant(numPencilRays, -1);
+			rayClusters = Vec<int>::Constant(numPencilRays, -1);
+
+			if (IsProgressive())
 			{
-				clustersSizes(dir_idx) = 0;
-				for (int ray_idx = 0; ray_idx < numRays; ++ray_idx)
-				{
-					if (rayClusters(ray_idx) == dir_idx)
-						++clustersSizes(dir_idx);
-				}
+				// Keep the unrotated directions of the forward rays (the pencil mirrors them)
+				referenceDirections.resize(numPencilRays);
+				hemispherePencil.getDirections(referenceDirections);
+				referenceDirections.resize(numPencilRays / 2);
+				rotatedDirections.resize(numPencilRays / 2);
+			}
+			else
+			{
+				referenceDirections.clear();
+				rotatedDirections.clear();
+			}
+
+			UpdateClusters();
+			restartProgress = true;
+			mRefining.store(IsProgressive(), std::memory_order_release);
+		}
+
+		void TracingThread::UpdateClusters() {
+			hemispherePencil.clusterDirections(reverbDirectionLookup, rayClusters);
+			clustersSizes.Reset();
+			for (int ray_idx = 0; ray_idx < numPencilRays; ++ray_idx)
+			{
+				if (rayClusters(ray_idx) >= 0)
+					++clustersSizes(rayClusters(ray_idx));
 			}
 		}
 
+		void TracingThread::RotatePencil() {
+			// Normalised Gaussian samples give a uniformly distributed rotation
+			std::normal_distribution<Real> normal(0.0, 1.0);
+			Real w, x, y, z, norm;
+			do
+			{
+				w = normal(rng);
+				x = normal(rng);
+				y = normal(rng);
+				z = normal(rng);
+				norm = std::sqrt(w * w + x * x + y * y + z * z);
+			} while (norm < EPS);
+			const Vec4 rotation(w / norm, x / norm, y / norm, z / norm);
+
+			for (size_t i = 0; i < referenceDirections.size(); ++i)
+				rotatedDirections[i] = RotateVector(referenceDirections[i], rotation);
+			hemispherePencil.setDirections(rotatedDirections);
+			UpdateClusters();
+		}
+
 		void TracingThread::SetUpdateThresholds(Real sourceThresh, Real listenerThresh) {
 			// The ray pencil is not actually being touched, but we can use the same mutex to lock the tracing thread.
 			lock_guard<std::mutex> lock(rayPencilMutex);
@@ -69,23 +171,38 @@ namespace RAC
 			selfShadowingRadius = radius;
 		}
 
-		void MoDARTTracing::InitRoom(const Matrix<int>& indexing, const Vec<>& decayRates) {
+		void MoDARTTracing::InitRoom(const Matrix<int>& indexing, const Vec<>& decayRates, const std::vector<Vec<>>& rightEigenvectors, const std::vector<Vec<>>& leftEigenvectors) {
 			lock_guard<std::mutex> lock(rayPencilMutex);
 
 			RAC_DEBUG_ASSERT(decayRates.Length() == numFDNs, "Decay rate length does not match numFDNs: " + ToString(decayRates.Length()));
+			RAC_DEBUG_ASSERT(ToInt(rightEigenvectors.size()) == numFDNs, "Number of right eigenvectors does not match numFDNs: " + ToString(rightEigenvectors.size()));
+			RAC_DEBUG_ASSERT(ToInt(leftEigenvectors.size()) == numFDNs, "Number of left eigenvectors does not match numFDNs: " + ToString(leftEigenvectors.size()));
 			pathIndexing = indexing;
 			decayPerSecond = decayRates;
 			sourceResidues = Coefficients<>(numFDNs);
 			listenerResidues.resize(numFDNs, Coefficients<>(numReverbDirections));
 
-			energyContributions = Vec<>(numPaths);
-			contributionDelays = Vec<>(numPaths);
-			contributionDelayScaling = Vec<>(numPaths);
+			// Store the eigenvectors as matrices, so the residues of every direction are computed by one product per mode
+			rightEigenvectorMatrix = Matrix<>(numFDNs, numPaths);
+			leftEigenvectorMatrix = Matrix<>(numFDNs, numPaths);
+			for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx)
+			{
+				RAC_DEBUG_ASSERT(rightEigenvectors[slope_idx].Length() == numPaths, "Right eigenvector length does not match numPaths: " + ToString(rightEigenvectors[slope_idx].Length()));
+				RAC_DEBUG_ASSERT(leftEigenvectors[slope_idx].Length() == numPaths, "Left eigenvector length does not match numPaths: " + ToString(leftEigenvectors[slope_idx].Length()));
+				for (int path_idx = 0; path_idx < numPaths; ++path_idx)
+				{
+					rightEigenvectorMatrix(slope_idx, path_idx) = rightEigenvectors[slope_idx](path_idx);
+					leftEigenvectorMatrix(slope_idx, path_idx) = leftEigenvectors[slope_idx](path_idx);
+				}
+			}
+
+			pathSlots = Vec<int>::Constant(numPaths, -1);
+			hitPaths.clear();
+			residueMatrix = Matrix<>(numFDNs, std::max(numReverbDirections, 1));
 		}
 
 		void MoDARTTracing::RunTracing() {
 			PROFILE_ReverbRayTracing
-			tracingStartFlag.store(true, std::memory_order_release);
 
 			// TODO: Should we only update residues relevant to currently active FDNs (i.e T60 > minimumT60)?
 			lock_guard<std::mutex> lock(rayPencilMutex);
@@ -96,6 +213,12 @@ namespace RAC
 			if (numPaths == 0)
 				return;
 
+			if (IsProgressive())
+			{
+				RunProgressiveTracing(*sharedRoom, *sharedReverb, *sharedSource);
+				return;
+			}
+
 			bool listenerMoved = false;
 			{
 				lock_guard<std::mutex> lock(dataStoreMutex);
@@ -109,151 +232,302 @@ namespace RAC
 					}
 				}
 			}
-			if (listenerMoved) {
-				hemispherePencil.moveOrigin(mListenerPosition);
-				hemispherePencil.traceAll(sharedRoom->GetTriangleMeshSoA());
+			if (listenerMoved)
+				UpdateListenerResidues(*sharedRoom, *sharedReverb, 1.0);
 
+			mSources = sharedSource->GetSourceData(ThreadID::rayTracing);
 
-				for (int dir_idx = 0; dir_idx < numReverbDirections; ++dir_idx) {
-					ComputeEnergyContributions(dir_idx);
-					RAC_DEBUG_ASSERT(contributionDelays.Length() == numPaths, "Contribution delays length does not match numPaths: " + ToString(contributionDelayScaling.Length()));
-					RAC_DEBUG_ASSERT(contributionDelayScaling.Length() == numPaths, "Contribution delay scaling length does not match numPaths: " + ToString(contributionDelayScaling.Length()));
-					RAC_DEBUG_SENDPATH(ToString(dir_idx) + "l", mListenerPosition, reverbDirections[dir_idx]);
+			for (Source::Data& source : mSources) {
+				if (source.needsUpdate) {
+					Real distanceSinceLastUpdate = (source.position - sharedSource->GetLastRTMSourcePosition(source.id)).Normal();
+					if (distanceSinceLastUpdate > sourceMovementThreshold)
+						sharedSource->SetLastRTMSourcePosition(source.id, source.position);
+					else
+						continue;
 
-					for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx) {
+					UpdateSourceResidues(*sharedRoom, *sharedReverb, source, sourceResidues, 1.0);
+					sharedSource->SetSourceTargetResidues(source.id, sourceResidues);
+				}
+			}
+		}
 
-						const Real decay = decayPerSecond(slope_idx);
+		void MoDARTTracing::RunProgressiveTracing(Room& room, Reverb& reverb, SourceManager& sourceManager) {
+			if (restartProgress)
+			{
+				listenerProgress.Reset();
+				for (SourceProgress& progress : sourceProgress)
+					progress.target.Reset();
+				restartProgress = false;
+			}
 
-#if MATRIX_LIBRARY == EIGEN_FLAG
-						// decay ^ -contributionDelays[path_index] => e^(-contributionDelays[path_index] * ln(contributionDelays))
-						const Real decayLn = std::log(decay);
+			Vec3 listenerPosition;
+			{
+				lock_guard<std::mutex> lock(dataStoreMutex);
+				listenerPosition = mListenerPositionIncoming;
+			}
 
-						contributionDelayScaling = (-contributionDelays * decayLn).array().exp();
-#else
-						for (int path_idx = 0; path_idx < numPaths; ++path_idx) {
-							contributionDelayScaling(path_idx) = std::pow(decay, -contributionDelays(path_idx));
-						}
-#endif
+			mSources = sourceManager.GetSourceData(ThreadID::rayTracing);
 
-						listenerResidues[slope_idx][dir_idx] =
-							ThreeWayDot(
-								energyContributions,
-								contributionDelayScaling,
-								sharedReverb->GetRightEigenvector(slope_idx));
+			// Sources that are missing (removed or being reset) restart when they return
+			std::array<bool, MAX_SOURCES> present{};
+			for (const Source::Data& source : mSources)
+				present[source.id] = true;
+			for (size_t id = 0; id < MAX_SOURCES; ++id)
+			{
+				if (!present[id])
+					sourceProgress[id].target.Reset();
+			}
 
-						RAC_DEBUG_SENDRESIDUE(static_cast<float>(listenerResidues[slope_idx][dir_idx]), false, dir_idx, slope_idx);
-					}
+			// Changed sources that have converged keep their residues (a source can be replaced between updates)
+			for (const Source::Data& source : mSources)
+			{
+				const SourceProgress& progress = sourceProgress[source.id];
+				if (source.needsUpdate && progress.target.GetNumUpdates() > 0)
+					sourceManager.SetSourceTargetResidues(source.id, progress.residues);
+			}
+
+			// Trace from the first target in turn that has not converged, so each update traces numPencilRays rays
+			const size_t numTargets = mSources.size() + 1;
+			nextTarget %= numTargets;
+			bool traced = false;
+			for (size_t i = 0; i < numTargets && !traced; ++i)
+			{
+				const size_t target = (nextTarget + i) % numTargets;
+				if (target == 0)
+				{
+					if (!NeedsRefinement(listenerProgress, listenerPosition))
+						continue;
+
+					mListenerPosition = listenerPosition;
+					const Real weight = BeginUpdate(listenerProgress, listenerPosition, listenerMovementThreshold);
+					UpdateListenerResidues(room, reverb, weight);
 				}
+				else
+				{
+					const Source::Data& source = mSources[target - 1];
+					SourceProgress& progress = sourceProgress[source.id];
+					if (!NeedsRefinement(progress.target, source.position))
+						continue;
 
-				for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx) {
-					sharedReverb->SetTargetListenerResidues(slope_idx, listenerResidues[slope_idx]);
+					const Real weight = BeginUpdate(progress.target, source.position, sourceMovementThreshold);
+					UpdateSourceResidues(room, reverb, source, progress.residues, weight);
+					sourceManager.SetSourceTargetResidues(source.id, progress.residues);
 				}
+				nextTarget = target + 1;
+				traced = true;
 			}
 
-			mSources = sharedSource->GetSourceData(ThreadID::rayTracing);
+			bool refining = NeedsRefinement(listenerProgress, listenerPosition);
+			for (const Source::Data& source : mSources)
+				refining = refining || NeedsRefinement(sourceProgress[source.id].target, source.position);
+			mRefining.store(refining, std::memory_order_release);
+		}
 
-			for (Source::Data& source : mSources) {
-				if (source.needsUpdate) {
-					Real distanceSinceLastUpdate = (source.position - sharedSource->GetLastRTMSourcePosition(source.id)).Normal();
-					if (distanceSinceLastUpdate > sourceMovementThreshold)
-						sharedSource->SetLastRTMSourcePosition(source.id, source.position);
-					else
+		void MoDARTTracing::UpdateListenerResidues(Room& room, Reverb& reverb, Real weight) {
+			if (IsProgressive())
+				RotatePencil();
+			hemispherePencil.moveOrigin(mListenerPosition);
+			hemispherePencil.traceAll(room.GetSnapshot()->GetTriangleMeshSoA(), mThreadPool.get());
+
+			ComputeEnergyContributions(true);
+			ComputeResidues(rightEigenvectorMatrix, numReverbDirections);
+
+			for (int dir_idx = 0; dir_idx < numReverbDirections; ++dir_idx) {
+				// A small rotated pencil may have no rays near a reverb direction, so each direction is weighted by its own updates
+				Real directionWeight = weight;
+				if (IsProgressive())
+				{
+					if (clustersSizes(dir_idx) == 0)
 						continue;
+					directionWeight = listenerProgress.UpdateDirection(dir_idx, smoothing);
+				}
 
-					hemispherePencil.moveOrigin(source.position);
-					hemispherePencil.traceAll(sharedRoom->GetTriangleMeshSoA());
+				RAC_DEBUG_SENDPATH(ToString(dir_idx) + "l", mListenerPosition, reverbDirections[dir_idx]);
 
-					ComputeEnergyContributions();
+				for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx) {
+					listenerResidues[slope_idx][dir_idx] = Accumulate(listenerResidues[slope_idx][dir_idx], residueMatrix(slope_idx, dir_idx), directionWeight);
 
-					for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx) {
-						for (int path_idx = 0; path_idx < numPaths; ++path_idx) {
-							contributionDelayScaling(path_idx) = std::pow(decayPerSecond(slope_idx), -contributionDelays(path_idx));
-						}
+					RAC_DEBUG_SENDRESIDUE(static_cast<float>(listenerResidues[slope_idx][dir_idx]), false, dir_idx, slope_idx);
+				}
+			}
 
-						sourceResidues[slope_idx] =
-							ThreeWayDot(
-								energyContributions,
-								contributionDelayScaling,
-								sharedReverb->GetLeftEigenvector(slope_idx));
+			for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx) {
+				reverb.SetTargetListenerResidues(slope_idx, listenerResidues[slope_idx]);
+			}
+		}
 
-						RAC_DEBUG_SENDRESIDUE(static_cast<float>(sourceResidues[slope_idx]), true, ToInt(source.id), slope_idx);
+		void MoDARTTracing::UpdateSourceResidues(Room& room, Reverb& reverb, const Source::Data& source, Coefficients<>& residues, Real weight) {
+			if (IsProgressive())
+				RotatePencil();
+			hemispherePencil.moveOrigin(source.position);
+			hemispherePencil.traceAll(room.GetSnapshot()->GetTriangleMeshSoA(), mThreadPool.get());
 
-						// Compensate gain based on preceding delay.
-						sourceResidues[slope_idx] *= std::pow(decayPerSecond(slope_idx), sharedReverb->GetPrecedingDelay());
-					}
-					sharedSource->SetSourceTargetResidues(source.id, sourceResidues);
-				}
+			ComputeEnergyContributions(false);
+			ComputeResidues(leftEigenvectorMatrix, 1);
+
+			for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx) {
+				Real residue = residueMatrix(slope_idx, 0);
+
+				RAC_DEBUG_SENDRESIDUE(static_cast<float>(residue), true, ToInt(source.id), slope_idx);
+
+				// Compensate gain based on preceding delay.
+				residue *= std::pow(decayPerSecond(slope_idx), reverb.GetPrecedingDelay());
+				residues[slope_idx] = Accumulate(residues[slope_idx], residue, weight);
 			}
-			tracingEndFlag.store(true, std::memory_order_release);
-			tracingStartFlag.store(false, std::memory_order_release);
 		}
 
-		void MoDARTTracing::ComputeEnergyContributions(int reverbDirectionIdx) {
-			int pathIdx;
-			Real distance;
+		void MoDARTTracing::ComputeEnergyContributions(bool byDirection) {
+			const int numColumns = byDirection ? numReverbDirections : 1;
 
-			// Assumes listener processes reverbDirectionIdx in order 0 to numReverbDirections-1
-			if (reverbDirectionIdx < 1)
+			// Each ray hits at most one path, so the hit buffers are only reallocated when the number of rays changes
+			const int maxHits = std::min(numPaths, numPencilRays);
+			if (hitEnergies.Rows() != maxHits)
 			{
-				hemispherePencil.getDistances(rayDistances);
-				hemispherePencil.getIndices(frontIndices, backIndices);
+				hitEnergies = Matrix<>(maxHits, std::max(numReverbDirections, 1));
+				hitDelays = Matrix<>(maxHits, std::max(numReverbDirections, 1));
+				scaledEnergies = Matrix<>(maxHits, std::max(numReverbDirections, 1));
+				hitEigenvectors = Matrix<>(numFDNs, maxHits);
+				hitPaths.reserve(maxHits);
 			}
+
+			// Clear the paths hit by the previous rays
+			for (const int pathIdx : hitPaths)
+				pathSlots(pathIdx) = -1;
+			hitPaths.clear();
+
+			hemispherePencil.getDistances(rayDistances);
+			hemispherePencil.getIndices(frontIndices, backIndices);
 			// If self-shadowing is enabled, get the incidence cosines as well.
 			if (selfShadowingRadius > 0.0)
 				hemispherePencil.getCosines(rayCosines);
 
-			// Reset contributions to 0
-			energyContributions.Reset();
-			contributionDelays.Reset();
-
-			for (int ray_idx = 0; ray_idx < numRays; ++ray_idx) {
+			for (int ray_idx = 0; ray_idx < numPencilRays; ++ray_idx) {
 				// Did the ray hit valid triangles on both sides?
 				if ((frontIndices(ray_idx) == -1) || (backIndices(ray_idx) == -1))
 					continue;
 
-				// Does the ray fall within the bundle specified by `reverbDirectionIdx`?
-				if ((reverbDirectionIdx == -1) || (reverbDirectionIdx == rayClusters(ray_idx))) {
-					// Is the ray self-shadowed?
-					if (selfShadowingRadius > 0.0)
-						if (rayCosines(ray_idx) < selfShadowingRadius / (2 * rayDistances(ray_idx)))
-							continue;
+				// Is the ray self-shadowed?
+				if (selfShadowingRadius > 0.0)
+					if (rayCosines(ray_idx) < selfShadowingRadius / (2 * rayDistances(ray_idx)))
+						continue;
+
+				// Add energy contribution of the ray (pathIndexing is from A to B; back to front)
+				const int pathIdx = pathIndexing(backIndices(ray_idx), frontIndices(ray_idx));
+				if (pathIdx < 0)
+					continue;
 
-					// Add energy contribution of the ray (pathIndexing is from A to B; back to front)
-					pathIdx = pathIndexing(backIndices(ray_idx), frontIndices(ray_idx));
-					if (pathIdx >= 0)
+				const int column = byDirection ? rayClusters(ray_idx) : 0;
+				if (column < 0)
+					continue;
+
+				int slot = pathSlots(pathIdx);
+				if (slot < 0)
+				{
+					slot = ToInt(hitPaths.size());
+					pathSlots(pathIdx) = slot;
+					hitPaths.push_back(pathIdx);
+					for (int col_idx = 0; col_idx < numColumns; ++col_idx)
 					{
-						distance = rayDistances(ray_idx);
-						energyContributions(pathIdx) += 1;
-						contributionDelays(pathIdx) += distance;
+						hitEnergies(slot, col_idx) = 0.0;
+						hitDelays(slot, col_idx) = 0.0;
 					}
 				}
+				hitEnergies(slot, column) += 1;
+				hitDelays(slot, column) += rayDistances(ray_idx);
 			}
 
 			// Normalize by number of rays
-			for (int path_idx = 0; path_idx < numPaths; ++path_idx) {
-				if (energyContributions(path_idx) == 0)
-					continue;
+			for (int col_idx = 0; col_idx < numColumns; ++col_idx) {
+				const int numColumnRays = byDirection ? numReverbDirections * clustersSizes(col_idx) : numPencilRays;
+				for (int slot = 0; slot < ToInt(hitPaths.size()); ++slot) {
+					const Real energy = hitEnergies(slot, col_idx);
+					if (energy == 0)
+						continue;
 
-				// Turn the propagation distance (meters) into a propagation delay (seconds), and also take its average within each path.
-				// N.B.: The distances are averaged using the number of hits, NOT the total number of rays.
-				contributionDelays(path_idx) /= energyContributions(path_idx) * SPEED_OF_SOUND;
-				// Normalize the portion of rays in the path, AFTER having used it to average their distances.
-				if (reverbDirectionIdx == -1)
-					energyContributions(path_idx) /= numRays;
-				else
-					energyContributions(path_idx) /= (numReverbDirections * clustersSizes(reverbDirectionIdx));
+					// Turn the propagation distance (meters) into a propagation delay (seconds), and also take its average within each path.
+					// N.B.: The distances are averaged using the number of hits, NOT the total number of rays.
+					hitDelays(slot, col_idx) /= energy * SPEED_OF_SOUND;
+					// Normalize the portion of rays in the path, AFTER having used it to average their distances.
+					hitEnergies(slot, col_idx) = energy / numColumnRays;
+				}
+			}
+		}
+
+		void MoDARTTracing::ComputeResidues(const Matrix<>& eigenvectors, int numColumns) {
+			const int numHits = ToInt(hitPaths.size());
+			for (int slot = 0; slot < numHits; ++slot) {
+				for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx)
+					hitEigenvectors(slope_idx, slot) = eigenvectors(slope_idx, hitPaths[slot]);
+			}
+
+			for (int slope_idx = 0; slope_idx < numFDNs; ++slope_idx) {
+				// decay ^ -delay => e^(-delay * ln(decay))
+				const Real decayLn = std::log(decayPerSecond(slope_idx));
+
+#if MATRIX_LIBRARY == EIGEN_FLAG
+				scaledEnergies.topLeftCorner(numHits, numColumns) = hitEnergies.topLeftCorner(numHits, numColumns).cwiseProduct(
+					(-decayLn * hitDelays.topLeftCorner(numHits, numColumns).array()).exp().matrix());
+				residueMatrix.row(slope_idx).head(numColumns).noalias() =
+					hitEigenvectors.row(slope_idx).head(numHits) * scaledEnergies.topLeftCorner(numHits, numColumns);
+#else
+				for (int col_idx = 0; col_idx < numColumns; ++col_idx) {
+					Real residue = 0.0;
+					for (int slot = 0; slot < numHits; ++slot)
+						residue += hitEigenvectors(slope_idx, slot) * hitEnergies(slot, col_idx) * std::exp(-decayLn * hitDelays(slot, col_idx));
+					residueMatrix(slope_idx, col_idx) = residue;
+				}
+#endif
 			}
 		}
 
 		void SingleFDNTracing::RunTracing() {
 			PROFILE_ReverbRayTracing
-			tracingStartFlag.store(true, std::memory_order_release);
 
 			// TODO: Should we only update residues relevant to currently active FDNs (i.e T60 > minimumT60)?
 			lock_guard<std::mutex> lock(rayPencilMutex);
 			shared_ptr<Room> sharedRoom = mRoom.lock();
 			shared_ptr<Reverb> sharedReverb = mReverb.lock();
 
+			if (IsProgressive())
+			{
+				if (restartProgress)
+				{
+					listenerProgress.Reset();
+					restartProgress = false;
+				}
+
+				{
+					lock_guard<std::mutex> lock(dataStoreMutex);
+					mListenerPosition = mListenerPositionIncoming;
+				}
+				if (NeedsRefinement(listenerProgress, mListenerPosition))
+				{
+					BeginUpdate(listenerProgress, mListenerPosition, listenerMovementThreshold);
+					RotatePencil();
+					hemispherePencil.moveOrigin(mListenerPosition);
+					std::shared_ptr<const RoomSnapshot> room = sharedRoom->GetSnapshot();
+					hemispherePencil.traceAll(room->GetTriangleMeshSoA(), mThreadPool.get());
+
+					ComputeEnergyContributions(*room);
+					for (int dir_idx = 0; dir_idx < numReverbDirections; ++dir_idx)
+					{
+						// A small rotated pencil may have no rays near a reverb direction, so each direction is weighted by its own updates
+						if (clustersSizes(dir_idx) == 0)
+							continue;
+
+						const Real weight = listenerProgress.UpdateDirection(dir_idx, smoothing);
+						if (weight >= 1.0)
+							smoothedGains[dir_idx] = reflectionGains[dir_idx];
+						else
+							smoothedGains[dir_idx] += weight * (reflectionGains[dir_idx] - smoothedGains[dir_idx]);
+						RAC_DEBUG_SENDPATH(ToString(dir_idx) + "l", mListenerPosition, reverbDirections[dir_idx]);
+					}
+					sharedReverb->SetTargetOutputFilters(smoothedGains);
+				}
+				mRefining.store(NeedsRefinement(listenerProgress, mListenerPosition), std::memory_order_release);
+				return;
+			}
+
 			bool listenerMoved = false;
 			{
 				lock_guard<std::mutex> lock(dataStoreMutex);
@@ -266,24 +540,22 @@ namespace RAC
 			if (listenerMoved)
 			{
 				hemispherePencil.moveOrigin(mListenerPosition);
-				hemispherePencil.traceAll(sharedRoom->GetTriangleMeshSoA());
+				std::shared_ptr<const RoomSnapshot> room = sharedRoom->GetSnapshot();
+				hemispherePencil.traceAll(room->GetTriangleMeshSoA(), mThreadPool.get());
 
-				MaterialMap materials = sharedRoom->GetMaterials();
+				ComputeEnergyContributions(*room);
 				for (int dir_idx = 0; dir_idx < numReverbDirections; ++dir_idx)
 				{
-					ComputeEnergyContributions(materials, dir_idx);
 					RAC_DEBUG_SENDPATH(ToString(dir_idx) + "l", mListenerPosition, reverbDirections[dir_idx]);
 				}
 				sharedReverb->SetTargetOutputFilters(reflectionGains);
 			}
-			tracingEndFlag.store(true, std::memory_order_release);
-			tracingStartFlag.store(false, std::memory_order_release);
 		}
 
-		void SingleFDNTracing::ComputeEnergyContributions(const MaterialMap& materials, int reverbDirectionIdx) {
+		void SingleFDNTracing::ComputeEnergyContributions(const RoomSnapshot& room) {
 			// Reset contributions to 0
 			for (int dir_idx = 0; dir_idx < numReverbDirections; ++dir_idx)
-				reflectionGains[reverbDirectionIdx].Reset();
+				reflectionGains[dir_idx].Reset();
 
 			hemispherePencil.getDistances(rayDistances);
 			hemispherePencil.getIndices(frontIndices, backIndices);
@@ -291,31 +563,29 @@ namespace RAC
 			if (selfShadowingRadius > 0.0)
 				hemispherePencil.getCosines(rayCosines);
 
-			for (int ray_idx = 0; ray_idx < numRays; ++ray_idx) {
+			for (int ray_idx = 0; ray_idx < numPencilRays; ++ray_idx) {
 				// Did the ray hit valid triangles on both sides?
-				if ((frontIndices(ray_idx) == -1))
+				if ((frontIndices(ray_idx) == -1) || (rayClusters(ray_idx) == -1))
 					continue;
 
-				// Does the ray fall within the bundle specified by `reverbDirectionIdx`?
-				if ((reverbDirectionIdx == -1) || (reverbDirectionIdx == rayClusters(ray_idx))) {
-					// Is the ray self-shadowed?
-					if (selfShadowingRadius > 0.0)
-						if (rayCosines(ray_idx) < selfShadowingRadius / (2 * rayDistances(ray_idx)))
-							continue;
-
-					// Add energy contribution of the ray
-					auto it = materials.find(frontIndices(ray_idx));
-					if (it == materials.end())
+				// Is the ray self-shadowed?
+				if (selfShadowingRadius > 0.0)
+					if (rayCosines(ray_idx) < selfShadowingRadius / (2 * rayDistances(ray_idx)))
 						continue;
-					reflectionGains[reverbDirectionIdx] += it->second;
-				}
+
+				// Add energy contribution of the ray to the bundle it falls within
+				const Coefficients<>* material = room.FindMaterial(frontIndices(ray_idx));
+				if (!material)
+					continue;
+				reflectionGains[rayClusters(ray_idx)] += *material;
 			}
 
-			// Normalize by number of rays
-			if (reverbDirectionIdx == -1)
-				reflectionGains[reverbDirectionIdx] /= static_cast<Real>(numRays);
-			else
-				reflectionGains[reverbDirectionIdx] /= static_cast<Real>(clustersSizes(reverbDirectionIdx));
+			// Normalize by number of rays in each bundle
+			for (int dir_idx = 0; dir_idx < numReverbDirections; ++dir_idx)
+			{
+				if (clustersSizes(dir_idx) > 0)
+					reflectionGains[dir_idx] /= static_cast<Real>(clustersSizes(dir_idx));
+			}
 		}
 	}
 }
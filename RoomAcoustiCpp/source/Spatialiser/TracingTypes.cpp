@@ -1,4 +1,13 @@
-﻿#include "Spatialiser/TracingTypes.h"
+﻿// C++ headers
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "Spatialiser/TracingTypes.h"
+#include "Spatialiser/TracingKernels.h"
 
 namespace RAC
 {
@@ -74,6 +83,208 @@ namespace RAC
             normalize_directions();
         }
 
+        void RayPacketSoA::build(const std::vector<Vec3>& directions)
+        {
+            constexpr uint32_t GRID_SIZE = 1 << 10;
+            constexpr Real GRID_SCALE = static_cast<Real>(GRID_SIZE - 1);
+
+            // Distance along the Hilbert curve through a GRID_SIZE x GRID_SIZE grid
+            auto hilbertIndex = [](uint32_t x, uint32_t y)
+                {
+                    uint32_t d = 0;
+                    for (uint32_t s = GRID_SIZE / 2; s > 0; s /= 2)
+                    {
+                        const uint32_t rx = (x & s) > 0 ? 1 : 0;
+                        const uint32_t ry = (y & s) > 0 ? 1 : 0;
+                        d += s * s * ((3 * rx) ^ ry);
+                        if (ry == 0)
+                        {
+                            if (rx == 1)
+                            {
+                                x = s - 1 - (x & (s - 1));
+                                y = s - 1 - (y & (s - 1));
+                            }
+                            std::swap(x, y);
+                        }
+                    }
+                    return d;
+                };
+
+            // Project each direction onto the face of the unit cube it points at and order by face, then along the curve on the face
+            const int numRays = ToInt(directions.size());
+            std::vector<std::pair<uint32_t, int>> keys(numRays);
+            for (int i = 0; i < numRays; ++i)
+            {
+                const std::array<Real, 3> d = { directions[i].x(), directions[i].y(), directions[i].z() };
+                int major = 0;
+                for (int j = 1; j < 3; ++j)
+                {
+                    if (std::abs(d[j]) > std::abs(d[major]))
+                        major = j;
+                }
+                const Real scale = d[major] == 0.0 ? REAL_CONST(0.0) : REAL_CONST(0.5) / std::abs(d[major]);
+                const uint32_t u = static_cast<uint32_t>((d[(major + 1) % 3] * scale + REAL_CONST(0.5)) * GRID_SCALE);
+                const uint32_t v = static_cast<uint32_t>((d[(major + 2) % 3] * scale + REAL_CONST(0.5)) * GRID_SCALE);
+                const uint32_t face = 2 * major + (d[major] < 0.0 ? 1 : 0);
+                keys[i] = { (face << 20) | hilbertIndex(u, v), i };
+            }
+            std::sort(keys.begin(), keys.end());
+
+            // Start a new packet when the current one is full or the face changes
+            rayIndex.resize(numRays);
+            packetStart.clear();
+            for (int i = 0; i < numRays; ++i)
+            {
+                rayIndex[i] = keys[i].second;
+                if (packetStart.empty() || i - packetStart.back() == RAY_PACKET_SIZE || (keys[i].first >> 20) != (keys[i - 1].first >> 20))
+                    packetStart.push_back(i);
+            }
+            const int numPackets = ToInt(packetStart.size());
+            packetStart.push_back(numRays);
+
+            axis.resize(numPackets);
+            cosSpread.resize(numPackets);
+            for (int packet = 0; packet < numPackets; ++packet)
+            {
+                const int first = packetStart[packet];
+                const int last = packetStart[packet + 1];
+
+                Vec3 sum(0.0, 0.0, 0.0);
+                for (int i = first; i < last; ++i)
+                    sum += directions[rayIndex[i]];
+                axis[packet] = sum.Normal() > 0.0 ? sum / sum.Normal() : directions[rayIndex[first]];
+
+                // Widen slightly so rounding cannot leave a direction outside the cone
+                Real minCosine = REAL_CONST(1.0);
+                for (int i = first; i < last; ++i)
+                    minCosine = std::min(minCosine, directions[rayIndex[i]].dot(axis[packet]));
+                cosSpread[packet] = std::max(REAL_CONST(-1.0), minCosine - EPS_GENERAL);
+            }
+        }
+
+        namespace
+        {
+            /**
+             * @brief Cell of the DirectionLookup cube map that a direction points at.
+             * @return Index of the cell, or -1 for the zero vector.
+             */
+            int direction_cell(const Vec3& D)
+            {
+                const std::array<Real, 3> d = { D.x(), D.y(), D.z() };
+                int major = 0;
+                for (int j = 1; j < 3; ++j)
+                {
+                    if (std::abs(d[j]) > std::abs(d[major]))
+                        major = j;
+                }
+                if (!(std::abs(d[major]) > 0.0))
+                    return -1;
+
+                const Real scale = REAL_CONST(0.5) * DIRECTION_LOOKUP_RESOLUTION / std::abs(d[major]);
+                const int u = std::clamp(static_cast<int>((d[(major + 1) % 3] + std::abs(d[major])) * scale), 0, DIRECTION_LOOKUP_RESOLUTION - 1);
+                const int v = std::clamp(static_cast<int>((d[(major + 2) % 3] + std::abs(d[major])) * scale), 0, DIRECTION_LOOKUP_RESOLUTION - 1);
+                const int face = 2 * major + (d[major] < 0.0 ? 1 : 0);
+                return (face * DIRECTION_LOOKUP_RESOLUTION + u) * DIRECTION_LOOKUP_RESOLUTION + v;
+            }
+        }
+
+        void DirectionLookup::build(const std::vector<Vec3>& newDirections)
+        {
+            directions = newDirections;
+            cellStart.clear();
+            candidates.clear();
+            if (ToInt(directions.size()) <= DIRECTION_LOOKUP_MAX_EXHAUSTIVE)
+                return;
+
+            constexpr int numCells = 6 * DIRECTION_LOOKUP_RESOLUTION * DIRECTION_LOOKUP_RESOLUTION;
+            cellStart.reserve(numCells + 1);
+            candidates.reserve(numCells);
+
+            Real maxLength = 0.0;
+            for (const Vec3& direction : directions)
+                maxLength = std::max(maxLength, direction.Normal());
+
+            // A unit vector in a cell is at most sqrt(2) / DIRECTION_LOOKUP_RESOLUTION from the cell centre
+            // (the projection from the cube face to the sphere does not stretch distances),
+            // so each dot product differs from its value at the centre by at most that times maxLength
+            const Real tolerance = (REAL_CONST(2.0) * std::sqrt(REAL_CONST(2.0)) / DIRECTION_LOOKUP_RESOLUTION + EPS) * maxLength;
+            const Real step = REAL_CONST(2.0) / DIRECTION_LOOKUP_RESOLUTION;
+            std::vector<Real> dots(directions.size());
+            for (int face = 0; face < 6; ++face)
+            {
+                const int major = face / 2;
+                const Real sign = face % 2 == 0 ? REAL_CONST(1.0) : REAL_CONST(-1.0);
+                for (int u = 0; u < DIRECTION_LOOKUP_RESOLUTION; ++u)
+                {
+                    for (int v = 0; v < DIRECTION_LOOKUP_RESOLUTION; ++v)
+                    {
+                        std::array<Real, 3> p;
+                        p[major] = sign;
+                        p[(major + 1) % 3] = -1.0 + (u + 0.5) * step;
+                        p[(major + 2) % 3] = -1.0 + (v + 0.5) * step;
+                        const Vec3 centre = Vec3(p[0], p[1], p[2]).Normalised();
+
+                        Real bestDot = -std::numeric_limits<Real>::max();
+                        for (size_t j = 0; j < directions.size(); ++j)
+                        {
+                            dots[j] = centre.dot(directions[j]);
+                            bestDot = std::max(bestDot, dots[j]);
+                        }
+
+                        // Directions further than tolerance below the best at the centre are below it everywhere in the cell
+                        cellStart.push_back(ToInt(candidates.size()));
+                        for (size_t j = 0; j < directions.size(); ++j)
+                        {
+                            if (dots[j] >= bestDot - tolerance)
+                                candidates.push_back(ToInt(j));
+                        }
+                    }
+                }
+            }
+            cellStart.push_back(ToInt(candidates.size()));
+        }
+
+        int DirectionLookup::nearest(const Vec3& D) const
+        {
+            const int cell = cellStart.empty() ? -1 : direction_cell(D);
+            if (cell < 0)
+                return nearest_exhaustive(D);
+
+            const int first = cellStart[cell];
+            const int last = cellStart[cell + 1];
+            int best = candidates[first];
+            if (last - first == 1)
+                return best;
+
+            Real bestDot = D.dot(directions[best]);
+            for (int k = first + 1; k < last; ++k)
+            {
+                const Real dot = D.dot(directions[candidates[k]]);
+                if (dot > bestDot)
+                {
+                    best = candidates[k];
+                    bestDot = dot;
+                }
+            }
+            return best;
+        }
+
+        int DirectionLookup::nearest_exhaustive(const Vec3& D) const
+        {
+            int best = -1;
+            Real bestDot = 0.0;
+            for (int j = 0; j < ToInt(directions.size()); ++j)
+            {
+                const Real dot = D.dot(directions[j]);
+                if (best < 0 || dot > bestDot)
+                {
+                    best = j;
+                    bestDot = dot;
+                }
+            }
+            return best;
+        }
+
         void RayBundleSoA::normalize_directions()
         {
             for (int i = 0; i < size(); ++i)
@@ -95,6 +306,54 @@ namespace RAC
             this->n.resize(n);
             patchId.resize(n);
             d0PlusEPS.resize(n);
+            bvh.Clear();
+            blocks.resize(0);
+        }
+
+        void TriangleMeshSoA::build_bvh()
+        {
+            // Small meshes are faster to trace against every triangle, more so with the AVX2 kernel
+            const int minTriangles = cpu_supports_avx2() ? 512 : 64;
+            if (size() < minTriangles)
+                bvh.Clear();
+            else
+                bvh.Build(A, edge1, edge2);
+        }
+
+        void TriangleBlockSoA::resize(int n)
+        {
+            const int padded = ((n + TRIANGLE_BLOCK_SIZE - 1) / TRIANGLE_BLOCK_SIZE) * TRIANGLE_BLOCK_SIZE;
+            for (std::vector<float>* values : { &Ax, &Ay, &Az, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z, &nx, &ny, &nz, &lengthA, &lengthEdge1, &lengthEdge2, &absD0 })
+                values->assign(padded, 0.0f);
+
+            // Padding triangles have a zero normal, so they always fail the facing test
+            d0PlusEPS.assign(padded, std::numeric_limits<float>::max());
+        }
+
+        void TriangleMeshSoA::build_blocks()
+        {
+            blocks.resize(size());
+            for (int i = 0; i < size(); ++i)
+            {
+                blocks.Ax[i] = static_cast<float>(A[i].x());
+                blocks.Ay[i] = static_cast<float>(A[i].y());
+                blocks.Az[i] = static_cast<float>(A[i].z());
+                blocks.e1x[i] = static_cast<float>(edge1[i].x());
+                blocks.e1y[i] = static_cast<float>(edge1[i].y());
+                blocks.e1z[i] = static_cast<float>(edge1[i].z());
+                blocks.e2x[i] = static_cast<float>(edge2[i].x());
+                blocks.e2y[i] = static_cast<float>(edge2[i].y());
+                blocks.e2z[i] = static_cast<float>(edge2[i].z());
+                blocks.nx[i] = static_cast<float>(n[i].x());
+                blocks.ny[i] = static_cast<float>(n[i].y());
+                blocks.nz[i] = static_cast<float>(n[i].z());
+                blocks.d0PlusEPS[i] = static_cast<float>(d0PlusEPS[i]);
+
+                blocks.lengthA[i] = static_cast<float>(A[i].Normal());
+                blocks.lengthEdge1[i] = static_cast<float>(edge1[i].Normal());
+                blocks.lengthEdge2[i] = static_cast<float>(edge2[i].Normal());
+                blocks.absD0[i] = static_cast<float>(std::abs(d0PlusEPS[i]));
+            }
         }
     }
 }
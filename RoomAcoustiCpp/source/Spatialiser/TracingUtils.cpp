@@ -3,20 +3,20 @@
 #include <cassert>
 #include <omp.h>
 #include <chrono>
+#include <array>
+#include <algorithm>
 
 // Common headers
 #include "Common/Debug.h"
+#include "Common/ThreadPool.h"
 
 // Spatialiser headers
 #include "Spatialiser/TracingUtils.h"
+#include "Spatialiser/TracingKernels.h"
 
-// Enable OMP at the triangle level. Using up to 4 threads can result in an improvement, but it is nowhere near as much as USE_OMP_RAYTRACE_ALL
+// Enable OMP at the triangle level. Using up to 4 threads can result in an improvement, but it is nowhere near as much as tracing rays in parallel with traceAll()
 #define USE_OMP_RAYTRACE_SINGLE            ( 0 )
 
-// Enable OMP at the traceAll() level. This has a significant improvement, even up to 8 or more threads. Note: it only optimizes one version of the traceAll() for now
-// since the other has data dependencies.
-#define USE_OMP_RAYTRACE_ALL               ( 1 )
-
 // Dumps some stats about the trace function time
 #define PROFILE_TRACE_ALL                  ( 0 )
 
@@ -155,8 +155,292 @@ namespace RAC
 			return intersection_test_internal(triangles, triangleIndex, O, D, distance, cosine);
         }
 
+        // ------------------------ Ray accessors ------------------------
+
+        static inline const Vec3& ray_origin(const RayBundleSoA& rays, int rayIndex) { return rays.O[rayIndex]; }
+        static inline const Vec3& ray_origin(const RayPencilSoA& rays, int rayIndexNotUsed) { return rays.O; }
+        static inline const Vec3& ray_origin(const SingleRay& ray, int rayIndexNotUsed) { return ray.rayOrigin; }
+
+        static inline const Vec3& ray_direction(const RayBundleSoA& rays, int rayIndex) { return rays.D[rayIndex]; }
+        static inline const Vec3& ray_direction(const RayPencilSoA& rays, int rayIndex) { return rays.D[rayIndex]; }
+        static inline const Vec3& ray_direction(const SingleRay& ray, int rayIndexNotUsed) { return ray.rayDirection; }
+
         // ------------------------ Tracing loop kernels ------------------------
 
+        /**
+         * @brief Best front and back hits of a single ray.
+         */
+        struct TraceState {
+            int patchIdFront = -1;
+            int patchIdBack = -1;
+            int triangleFront = -1;
+            int triangleBack = -1;
+            Real distanceFront = std::numeric_limits<Real>::infinity();
+            Real distanceBack = -std::numeric_limits<Real>::infinity();
+            Real cosineFront = std::numeric_limits<Real>::quiet_NaN();
+            Real cosineBack = std::numeric_limits<Real>::quiet_NaN();
+        };
+
+        /**
+         * @brief Update the best front/back hits with a new intersection.
+         *
+         * Hits must be accumulated in increasing triangle index order for z-fighting to resolve to the lowest triangle index.
+         */
+        static inline void accumulate_hit(const TriangleMeshSoA& triangles, TraceState& state, int i, Real currentDist, Real currentCos)
+        {
+            if ((currentDist + EPS_ZFIGHT < state.distanceBack) || (currentDist - EPS_ZFIGHT > state.distanceFront))
+                return; // Outside of current best range
+            if (std::abs(currentDist) < EPS_SELFHIT)
+                return; // Too close to origin
+
+            // Valid hit
+            if (currentDist > 0.0) {
+                if (std::abs(currentDist - state.distanceFront) < EPS_ZFIGHT) {
+                    // Z-fighting, lower triangle index wins.
+                    if (i >= state.triangleFront)
+                        return; // keep the previous best
+                }
+                state.patchIdFront = triangles.patchId[i];
+                state.triangleFront = i;
+                state.distanceFront = currentDist;
+                state.cosineFront = currentCos;
+            }
+            else {
+                if (std::abs(currentDist - state.distanceBack) < EPS_ZFIGHT) {
+                    // Z-fighting, lower triangle index wins
+                    if (i >= state.triangleBack)
+                        return; // keep the previous best
+                }
+                state.patchIdBack = triangles.patchId[i];
+                state.triangleBack = i;
+                state.distanceBack = currentDist;
+                state.cosineBack = currentCos;
+            }
+        }
+
+        /**
+         * @brief Accumulate the hits of every triangle in increasing triangle index order.
+         *
+         * Triangles are rejected 8 at a time by the AVX2 kernel when the CPU supports it and the mesh has SIMD blocks.
+         * Only the remaining triangles are passed to the exact intersection test, so the result does not depend on the path taken.
+         */
+        static void trace_all_triangles(const TriangleMeshSoA& triangles, const Vec3& O, const Vec3& D, int ignoredTriangleIndex, TraceState& state)
+        {
+            auto test_triangle = [&](int i)
+                {
+                    if (i == ignoredTriangleIndex) // Ignore this triangle
+                        return;
+
+                    // Buffers to retrieve individual check results.
+                    Real currentDist, currentCos;
+
+                    if (!intersection_test_internal(triangles, i, O, D, currentDist, currentCos))
+                        return;
+
+                    accumulate_hit(triangles, state, i, currentDist, currentCos);
+                };
+
+            const int numBlocks = triangles.blocks.num_blocks();
+            if (numBlocks != (triangles.size() + TRIANGLE_BLOCK_SIZE - 1) / TRIANGLE_BLOCK_SIZE || !cpu_supports_avx2())
+            {
+                // Scalar fallback (blocks missing or out of date, or no AVX2 support)
+                for (int i = 0; i < triangles.size(); ++i)
+                    test_triangle(i);
+                return;
+            }
+
+            constexpr int CHUNK_BLOCKS = 64;
+            uint8_t masks[CHUNK_BLOCKS];
+            for (int firstBlock = 0; firstBlock < numBlocks; firstBlock += CHUNK_BLOCKS) {
+                const int count = std::min(CHUNK_BLOCKS, numBlocks - firstBlock);
+                filter_triangles_avx2(triangles.blocks, firstBlock, count, O, D, masks);
+
+                for (int block = 0; block < count; ++block) {
+                    if (masks[block] == 0)
+                        continue;
+                    const int first = (firstBlock + block) * TRIANGLE_BLOCK_SIZE;
+                    const int last = std::min(first + TRIANGLE_BLOCK_SIZE, triangles.size());
+                    for (int i = first; i < last; ++i) {
+                        if (masks[block] & (1 << (i - first)))
+                            test_triangle(i);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Single intersection found during BVH traversal.
+         */
+        struct TraceHit {
+            int triangle;
+            Real distance;
+            Real cosine;
+        };
+
+        // Maximum number of hits within EPS_ZFIGHT of the nearest front (or back) hit before falling back to brute force.
+        constexpr int MAX_TRACE_CANDIDATES = 16;
+
+        /**
+         * @brief Fixed size buffer of hits that may decide the front (or back) result of a ray.
+         */
+        struct TraceCandidates {
+            std::array<TraceHit, MAX_TRACE_CANDIDATES> hits;
+            int count = 0;
+
+            inline bool add(const TraceHit& hit)
+            {
+                if (count == MAX_TRACE_CANDIDATES)
+                    return false;
+                hits[count++] = hit;
+                return true;
+            }
+
+            // Remove hits that can no longer z-fight with the nearest hit.
+            template <class TPredicate>
+            inline void remove_if(TPredicate&& predicate)
+            {
+                count = static_cast<int>(std::remove_if(hits.begin(), hits.begin() + count, predicate) - hits.begin());
+            }
+        };
+
+        /**
+         * @brief Collect every hit with distance in (0, frontLimit + EPS_ZFIGHT] or [backLimit - EPS_ZFIGHT, 0).
+         *
+         * If shrink is true, the limits follow the nearest front and back hits found so far.
+         * Returns false if a candidate buffer overflows.
+         */
+        static bool collect_hits(const TriangleMeshSoA& triangles, const Vec3& O, const Vec3& D, int ignoredTriangleIndex,
+            Real frontLimit, Real backLimit, bool shrink, TraceCandidates& front, TraceCandidates& back)
+        {
+            front.count = 0;
+            back.count = 0;
+            Real tLower = backLimit - EPS_ZFIGHT;
+            Real tUpper = frontLimit + EPS_ZFIGHT;
+            bool overflow = false;
+
+            triangles.bvh.Traverse(O, D, tLower, tUpper, [&](int i)
+                {
+                    Real currentDist, currentCos;
+                    if (i == ignoredTriangleIndex || !intersection_test_internal(triangles, i, O, D, currentDist, currentCos))
+                        return false;
+                    if (std::abs(currentDist) < EPS_SELFHIT)
+                        return false;
+
+                    if (currentDist > 0.0) {
+                        if (currentDist - EPS_ZFIGHT > frontLimit)
+                            return false;
+                        if (!front.add({ i, currentDist, currentCos })) {
+                            overflow = true;
+                            return true;
+                        }
+                        if (shrink && currentDist < frontLimit) {
+                            frontLimit = currentDist;
+                            tUpper = frontLimit + EPS_ZFIGHT;
+                            front.remove_if([frontLimit](const TraceHit& hit) { return hit.distance - EPS_ZFIGHT > frontLimit; });
+                        }
+                    }
+                    else {
+                        if (currentDist + EPS_ZFIGHT < backLimit)
+                            return false;
+                        if (!back.add({ i, currentDist, currentCos })) {
+                            overflow = true;
+                            return true;
+                        }
+                        if (shrink && currentDist > backLimit) {
+                            backLimit = currentDist;
+                            tLower = backLimit - EPS_ZFIGHT;
+                            back.remove_if([backLimit](const TraceHit& hit) { return hit.distance + EPS_ZFIGHT < backLimit; });
+                        }
+                    }
+                    return false;
+                });
+            return !overflow;
+        }
+
+        /**
+         * @brief Find the front and back hits of a ray using the mesh BVH.
+         *
+         * Collects the nearest hits and every hit chained to them through z-fighting, then accumulates them in
+         * triangle index order, so the result matches a trace against every triangle.
+         * Returns false if too many hits z-fight for the candidate buffers.
+         */
+        static bool trace_ray_bvh(const TriangleMeshSoA& triangles, const Vec3& O, const Vec3& D, int ignoredTriangleIndex, TraceState& state)
+        {
+            constexpr Real inf = std::numeric_limits<Real>::infinity();
+            TraceCandidates front, back, unused;
+            if (!collect_hits(triangles, O, D, ignoredTriangleIndex, inf, -inf, true, front, back))
+                return false;
+
+            // Hits within EPS_ZFIGHT of a farther candidate can still replace it, so extend each side until no new hits are chained
+            auto farthest = [](const TraceCandidates& candidates, Real initial, auto compare)
+                {
+                    Real result = initial;
+                    for (int i = 0; i < candidates.count; ++i)
+                        result = compare(candidates.hits[i].distance, result) ? candidates.hits[i].distance : result;
+                    return result;
+                };
+            auto greater = [](Real a, Real b) { return a > b; };
+            auto less = [](Real a, Real b) { return a < b; };
+
+            Real frontLimit = farthest(front, inf, less);
+            Real frontMax = farthest(front, -inf, greater);
+            while (front.count > 0 && frontMax > frontLimit) {
+                frontLimit = frontMax;
+                if (!collect_hits(triangles, O, D, ignoredTriangleIndex, frontLimit, REAL_CONST(0.0), false, front, unused))
+                    return false;
+                frontMax = farthest(front, -inf, greater);
+            }
+
+            Real backLimit = farthest(back, -inf, greater);
+            Real backMin = farthest(back, inf, less);
+            while (back.count > 0 && backMin < backLimit) {
+                backLimit = backMin;
+                if (!collect_hits(triangles, O, D, ignoredTriangleIndex, REAL_CONST(0.0), backLimit, false, unused, back))
+                    return false;
+                backMin = farthest(back, inf, less);
+            }
+
+            // Accumulate in triangle index order to match the brute force z-fighting rules
+            std::array<TraceHit, 2 * MAX_TRACE_CANDIDATES> hits;
+            const int numHits = front.count + back.count;
+            std::copy(front.hits.begin(), front.hits.begin() + front.count, hits.begin());
+            std::copy(back.hits.begin(), back.hits.begin() + back.count, hits.begin() + front.count);
+            std::sort(hits.begin(), hits.begin() + numHits, [](const TraceHit& a, const TraceHit& b) { return a.triangle < b.triangle; });
+            for (int i = 0; i < numHits; ++i)
+                accumulate_hit(triangles, state, hits[i].triangle, hits[i].distance, hits[i].cosine);
+            return true;
+        }
+
+        /**
+         * @brief Copy the best front and back hits to the outputs of trace_ray, replacing missing hits with -1 and NaN.
+         */
+        static inline void store_trace_state(const TraceState& state,
+            int& patchIdFront, Real& distanceFront, Real& cosineFront,
+            int& patchIdBack, Real& distanceBack, Real& cosineBack)
+        {
+            patchIdFront = state.patchIdFront;
+            distanceFront = state.distanceFront;
+            cosineFront = state.cosineFront;
+            patchIdBack = state.patchIdBack;
+            distanceBack = state.distanceBack;
+            cosineBack = state.cosineBack;
+
+			if (std::isinf(distanceFront)) {
+				// If it's still the initial INFINITY value, there was no valid hit at all.
+				patchIdFront = -1;
+				distanceFront = std::numeric_limits<Real>::quiet_NaN();
+				cosineFront = std::numeric_limits<Real>::quiet_NaN();
+			}
+			if (std::isinf(distanceBack)) {
+				// If it's still the initial -INFINITY value, there was no valid hit at all.
+				patchIdBack = -1;
+				distanceBack = std::numeric_limits<Real>::quiet_NaN();
+				cosineBack = std::numeric_limits<Real>::quiet_NaN();
+			}
+			else // If the distanceBack is valid, return its absolute value.
+				distanceBack = -distanceBack;
+        }
+
         template <class TRayType>
         void trace_ray_internal(const TriangleMeshSoA& triangles, const TRayType& rays, int rayIndex,
             int& patchIdFront, Real& distanceFront, Real& cosineFront,
@@ -175,34 +459,15 @@ namespace RAC
             constexpr int WorkerBlocks = 4;
             const int BlockSize = (triangles.size() + WorkerBlocks - 1) / WorkerBlocks;
 
-            struct Instance {
-                int patchIdFront = -1;
-                int patchIdBack = -1;
-                Real distanceFront = std::numeric_limits<Real>::infinity();
-                Real distanceBack = -std::numeric_limits<Real>::infinity();
-                Real cosineFront = std::numeric_limits<Real>::quiet_NaN();
-                Real cosineBack = std::numeric_limits<Real>::quiet_NaN();
-            };
-            Instance instances[WorkerBlocks];
+            TraceState instances[WorkerBlocks];
 
 			#pragma omp parallel for num_threads(WorkerBlocks) shared(instances)
             for (int workerIndex = 0; workerIndex < WorkerBlocks; ++workerIndex) {
-                Instance& instance = instances[workerIndex];
+                TraceState& instance = instances[workerIndex];
 
 				const int start = workerIndex * BlockSize;
 				const int end = std::min(start + BlockSize, triangles.size());
 
-#define TRACE_INSTANCE(n)       instance.n
-
-#else
-			{
-
-                constexpr int start = 00;
-                const int end = triangles.size();
-#define TRACE_INSTANCE(n)       n
-
-#endif
-
                 for (int i = start; i < end; ++i) {
                     if (i == ignoredTriangleIndex) // Ignore this triangle
                         continue;
@@ -213,50 +478,14 @@ namespace RAC
                     if (!intersection_test(triangles, i, rays, rayIndex, currentDist, currentCos))
                         continue;
 
-                    if ((currentDist + EPS_ZFIGHT < TRACE_INSTANCE(distanceBack)) || (currentDist - EPS_ZFIGHT > TRACE_INSTANCE(distanceFront)))
-                        continue; // Outside of current best range
-                    if (std::abs(currentDist) < EPS_SELFHIT)
-                        continue; // Too close to origin
-
-                    // Valid hit
-                    if (currentDist > 0.0) {
-                        if (std::abs(currentDist - TRACE_INSTANCE(distanceFront)) < EPS_ZFIGHT) {
-                            // Z-fighting, lower triangle index wins.
-                            if (i < TRACE_INSTANCE(patchIdFront)) {
-                                TRACE_INSTANCE(patchIdFront) = triangles.patchId[i];
-                                TRACE_INSTANCE(distanceFront) = currentDist;
-                                TRACE_INSTANCE(cosineFront) = currentCos;
-                            } // else {keep the previous best}
-                        }
-                        else {
-                            TRACE_INSTANCE(patchIdFront) = triangles.patchId[i];
-                            TRACE_INSTANCE(distanceFront) = currentDist;
-                            TRACE_INSTANCE(cosineFront) = currentCos;
-                        }
-                    }
-                    else {
-                        if (std::abs(currentDist - TRACE_INSTANCE(distanceBack)) < EPS_ZFIGHT) {
-                            // Z-fighting, lower triangle index wins
-                            if (i < TRACE_INSTANCE(patchIdFront)) {
-                                TRACE_INSTANCE(patchIdBack) = triangles.patchId[i];
-                                TRACE_INSTANCE(distanceBack) = currentDist;
-                                TRACE_INSTANCE(cosineBack) = currentCos;
-                            } // else {keep the previous best}
-                        }
-                        else {
-                            TRACE_INSTANCE(patchIdBack) = triangles.patchId[i];
-                            TRACE_INSTANCE(distanceBack) = currentDist;
-                            TRACE_INSTANCE(cosineBack) = currentCos;
-                        }
-                    }
+                    accumulate_hit(triangles, instance, i, currentDist, currentCos);
                 }
 			}
 
-#if USE_OMP_RAYTRACE_SINGLE
 			// Find the best candidate
 		   for (int workerIndex = 0; workerIndex < WorkerBlocks; ++workerIndex)
             {
-				const Instance& instance = instances[workerIndex];
+				const TraceState& instance = instances[workerIndex];
                 if (!std::isinf(instance.distanceFront)) 
                 {
                     if (std::isinf(distanceFront) || distanceFront > instance.distanceFront)
@@ -279,20 +508,19 @@ namespace RAC
 
             }
 #else
-			if (std::isinf(distanceFront)) {
-				// If it's still the initial INFINITY value, there was no valid hit at all.
-				patchIdFront = -1;
-				distanceFront = std::numeric_limits<Real>::quiet_NaN();
-				cosineFront = std::numeric_limits<Real>::quiet_NaN();
-			}
-			if (std::isinf(distanceBack)) {
-				// If it's still the initial -INFINITY value, there was no valid hit at all.
-				patchIdBack = -1;
-				distanceBack = std::numeric_limits<Real>::quiet_NaN();
-				cosineBack = std::numeric_limits<Real>::quiet_NaN();
-			}
-			else // If the distanceBack is valid, return its absolute value.
-				distanceBack = -distanceBack;
+            TraceState state;
+
+            // Use the BVH unless the ray is too close to parallel with a triangle for the padded bounds
+            const Vec3& O = ray_origin(rays, rayIndex);
+            const Vec3& D = ray_direction(rays, rayIndex);
+            const bool useBVH = !triangles.bvh.Empty() && !triangles.bvh.IsGrazing(D);
+            if (!useBVH || !trace_ray_bvh(triangles, O, D, ignoredTriangleIndex, state))
+            {
+                state = TraceState();
+                trace_all_triangles(triangles, O, D, ignoredTriangleIndex, state);
+            }
+
+            store_trace_state(state, patchIdFront, distanceFront, cosineFront, patchIdBack, distanceBack, cosineBack);
 #endif
         }
 
@@ -324,6 +552,114 @@ namespace RAC
             trace_ray_internal(triangles, SingleRay{ rayOrigin, rayDirection }, 0, patchIdFront, distanceFront, cosineFront, patchIdBack, distanceBack, cosineBack, ignoredTriangleIndex);
         }
 
+        // ------------------------ Packet tracing ------------------------
+
+        // Packets wider than this (cosine of the cone half angle) are traced one ray at a time.
+        constexpr Real MIN_PACKET_COSINE = 0.5;
+
+        // Maximum number of triangles gathered for a packet before it is traced one ray at a time.
+        constexpr int MAX_PACKET_CANDIDATES = 256;
+
+        // Pencils with fewer rays per triangle than this are traced one ray at a time. Measured single threaded with
+        //  500-8192 rays on 48-12288 triangles: packets were faster from 0.65 rays per triangle and slower or equal below 0.2.
+        constexpr Real MIN_PACKET_RAYS_PER_TRIANGLE = 0.5;
+
+        void trace_packet(
+            const TriangleMeshSoA& triangles, const RayPencilSoA& rays, const RayPacketSoA& packets, int packetIndex,
+            int* patchIdFront, Real* distanceFront, Real* cosineFront,
+            int* patchIdBack, Real* distanceBack, Real* cosineBack)
+        {
+            RAC_DEBUG_ASSERT(packetIndex >= 0 && packetIndex < packets.num_packets(), "Packet index out of bounds: " + ToString(packetIndex));
+
+            const int first = packets.packetStart[packetIndex];
+            const int numRays = packets.packet_size(packetIndex);
+
+            // Grazing rays may hit triangles outside the padded BVH bounds, so they are traced on their own
+            std::array<Vec3, RAY_PACKET_SIZE> directions;
+            std::array<bool, RAY_PACKET_SIZE> inPacket{};
+            int numPacketRays = 0;
+            bool coherent = !triangles.bvh.Empty() && packets.cosSpread[packetIndex] >= MIN_PACKET_COSINE;
+            if (coherent) {
+                for (int j = 0; j < numRays; ++j) {
+                    const Vec3& D = rays.D[packets.rayIndex[first + j]];
+                    if (triangles.bvh.IsGrazing(D))
+                        continue;
+                    directions[numPacketRays++] = D;
+                    inPacket[j] = true;
+                }
+            }
+
+            // Gather every triangle in a leaf crossed by one of the rays. These include all triangles any of the rays can hit
+            std::array<int, MAX_PACKET_CANDIDATES> candidates;
+            int numCandidates = 0;
+            if (coherent && numPacketRays > 0) {
+                triangles.bvh.TraversePacket(rays.O, directions.data(), numPacketRays, packets.axis[packetIndex], packets.cosSpread[packetIndex], [&](int i)
+                    {
+                        if (numCandidates == MAX_PACKET_CANDIDATES) {
+                            coherent = false; // The packet diverges
+                            return true;
+                        }
+                        candidates[numCandidates++] = i;
+                        return false;
+                    });
+                std::sort(candidates.begin(), candidates.begin() + numCandidates);
+            }
+
+            // Reject candidates 8 at a time before the exact test, as in trace_all_triangles
+            const bool useKernel = triangles.blocks.num_blocks() == (triangles.size() + TRIANGLE_BLOCK_SIZE - 1) / TRIANGLE_BLOCK_SIZE && cpu_supports_avx2();
+            uint8_t masks[MAX_PACKET_CANDIDATES / TRIANGLE_BLOCK_SIZE];
+
+            for (int j = 0; j < numRays; ++j) {
+                const int rayIndex = packets.rayIndex[first + j];
+                if (!coherent || !inPacket[j]) {
+                    trace_ray(triangles, rays, rayIndex,
+                        patchIdFront[j], distanceFront[j], cosineFront[j],
+                        patchIdBack[j], distanceBack[j], cosineBack[j]);
+                    continue;
+                }
+
+                // Accumulate in triangle index order to match the brute force z-fighting rules
+                TraceState state;
+                const Vec3& D = rays.D[rayIndex];
+                if (useKernel)
+                    filter_candidates_avx2(triangles.blocks, candidates.data(), numCandidates, rays.O, D, masks);
+                for (int k = 0; k < numCandidates; ++k) {
+                    if (useKernel && !(masks[k / TRIANGLE_BLOCK_SIZE] & (1 << (k % TRIANGLE_BLOCK_SIZE))))
+                        continue;
+                    Real currentDist, currentCos;
+                    if (intersection_test_internal(triangles, candidates[k], rays.O, D, currentDist, currentCos))
+                        accumulate_hit(triangles, state, candidates[k], currentDist, currentCos);
+                }
+                store_trace_state(state, patchIdFront[j], distanceFront[j], cosineFront[j], patchIdBack[j], distanceBack[j], cosineBack[j]);
+            }
+        }
+
+        // ------------------------ Parallel tracing ------------------------
+
+        // Number of rays traced by each pool task. Small enough to balance the load, large enough that claiming tasks is negligible.
+        constexpr int RAYS_PER_TASK = 64;
+
+        /**
+         * @brief Call traceRange(first, last) to cover items [0, numItems), in ranges of up to itemsPerTask items.
+         * If threadPool is not null, the ranges are split between the calling thread and the pool threads.
+         */
+        template <typename TraceRange>
+        void trace_in_parallel(int numItems, int itemsPerTask, ThreadPool* threadPool, const TraceRange& traceRange)
+        {
+            const int numTasks = (numItems + itemsPerTask - 1) / itemsPerTask;
+            if (!threadPool || numTasks < 2)
+            {
+                traceRange(0, numItems);
+                return;
+            }
+
+            threadPool->ParallelFor(numTasks, numTasks - 1, [&](size_t task)
+                {
+                    const int first = static_cast<int>(task) * itemsPerTask;
+                    traceRange(first, std::min(first + itemsPerTask, numItems));
+                });
+        }
+
         // ------------------------ RayBundle methods ------------------------
 
         RayBundle::RayBundle()
@@ -377,7 +713,7 @@ namespace RAC
             previousPatchId = Vec<int>::Constant(numRays, -1);
         }
 
-        void RayBundle::traceAll(const TriangleMeshSoA& triangles)
+        void RayBundle::traceAll(const TriangleMeshSoA& triangles, ThreadPool* threadPool)
         {
 #if PROFILE_TRACE_ALL
 			const auto startTime = std::chrono::high_resolution_clock::now();
@@ -386,32 +722,32 @@ namespace RAC
 			static int count = 0;
 #endif
 
-#if USE_OMP_RAYTRACE_ALL
-			constexpr int WorkerThreads = 8;
-			#pragma omp parallel for num_threads(WorkerThreads)
-#endif
-            for (int i = 0; i < numRays; ++i) {
-                // Skip rays that are already invalid.
-                if (std::isnan(radiance(i)))
-                    continue;
-
-				// Buffers for ray processing
-				int patchIdFront, patchIdBack;
-				Real distanceFront, distanceBack, cosineFront, cosineBack;
-
-                trace_ray(
-                    triangles, rays, i,
-                    patchIdFront, distanceFront, cosineFront,
-                    patchIdBack, distanceBack, cosineBack,
-                    latestPatchId(i));
-
-                // NB: Don't mess up the order of operations!
-                // Update previousPatchId before overwriting latestPatchId.
-                previousPatchId(i) = latestPatchId(i);
-                latestPatchId(i) = patchIdBack;
-                latestDistance(i) = distanceFront;
-                latestCosine(i) = cosineFront;
-            }
+            // Each ray only reads and writes its own entries, so ranges can be traced in any order
+            trace_in_parallel(numRays, RAYS_PER_TASK, threadPool, [&](int first, int last)
+                {
+                    for (int i = first; i < last; ++i) {
+                        // Skip rays that are already invalid.
+                        if (std::isnan(radiance(i)))
+                            continue;
+
+                        // Buffers for ray processing
+                        int patchIdFront, patchIdBack;
+                        Real distanceFront, distanceBack, cosineFront, cosineBack;
+
+                        trace_ray(
+                            triangles, rays, i,
+                            patchIdFront, distanceFront, cosineFront,
+                            patchIdBack, distanceBack, cosineBack,
+                            latestPatchId(i));
+
+                        // NB: Don't mess up the order of operations!
+                        // Update previousPatchId before overwriting latestPatchId.
+                        previousPatchId(i) = latestPatchId(i);
+                        latestPatchId(i) = patchIdBack;
+                        latestDistance(i) = distanceFront;
+                        latestCosine(i) = cosineFront;
+                    }
+                });
 
 #if PROFILE_TRACE_ALL
 			const auto endTime = std::chrono::high_resolution_clock::now();
@@ -503,6 +839,7 @@ namespace RAC
             rays.O = Vec3(0.0, 0.0, 0.0);
             // Note that this automatically normalizes the directions.
             rays.fill_uniform_sphere(hemisphereOnly);
+            packets.build(rays.D);
 
             frontDistance = Vec<>::Zero(numRays);
             backDistance = Vec<>::Zero(numRays);
@@ -522,6 +859,7 @@ namespace RAC
                 rays.D[i] = directions[i];
             }
             rays.normalize_directions();
+            packets.build(rays.D);
 
             frontDistance = Vec<>::Zero(numRays);
             backDistance = Vec<>::Zero(numRays);
@@ -543,7 +881,20 @@ namespace RAC
             backPatchId = Vec<int>::Constant(numRays, -1);
         }
 
-        void RayPencil::traceAll(const TriangleMeshSoA& triangles)
+        void RayPencil::setDirections(const std::vector<Vec3>& directions)
+        {
+            RAC_DEBUG_ASSERT(ToInt(directions.size()) == numRays, "Directions size must equal numRays" + ToString(ToInt(directions.size())));
+
+            for (int i = 0; i < numRays; ++i) {
+                rays.D[i] = directions[i];
+            }
+            rays.normalize_directions();
+            packets.build(rays.D);
+
+            moveOrigin(rays.O);
+        }
+
+        void RayPencil::traceAll(const TriangleMeshSoA& triangles, ThreadPool* threadPool)
         {
 #if PROFILE_TRACE_ALL
 			const auto startTime = std::chrono::high_resolution_clock::now();
@@ -551,27 +902,54 @@ namespace RAC
 			static double total = 0.0;
 			static int count = 0;
 #endif
-            
-#if USE_OMP_RAYTRACE_ALL
-            constexpr int WorkerThreads = 8;
-			#pragma omp parallel for num_threads(WorkerThreads)
-#endif
-            for (int i = 0; i < numRays; ++i) {
-				// Buffers for ray processing
-				int temp_frontpatchId, temp_backpatchId;
-				Real temp_frontDistance, temp_backDistance, temp_frontCosine, temp_backCosine;
-
-                trace_ray(
-                    triangles, rays, i,
-                    temp_frontpatchId, temp_frontDistance, temp_frontCosine,
-                    temp_backpatchId, temp_backDistance, temp_backCosine);
 
-                frontpatchId(i) = temp_frontpatchId;
-                frontDistance(i) = temp_frontDistance;
-                frontCosine(i) = temp_frontCosine;
-                backPatchId(i) = temp_backpatchId;
-                backDistance(i) = temp_backDistance;
-                backCosine(i) = temp_backCosine;
+            // Packets share the traversal of the BVH, so are only used if the mesh has one and the rays are dense enough to share it
+            if (packetTracing && !triangles.bvh.Empty() && packets.num_packets() > 0 && numRays >= MIN_PACKET_RAYS_PER_TRIANGLE * triangles.size()) {
+                trace_in_parallel(packets.num_packets(), RAYS_PER_TASK / RAY_PACKET_SIZE, threadPool, [&](int first, int last)
+                    {
+                        // Buffers for packet processing
+                        std::array<int, RAY_PACKET_SIZE> temp_frontpatchId, temp_backpatchId;
+                        std::array<Real, RAY_PACKET_SIZE> temp_frontDistance, temp_backDistance, temp_frontCosine, temp_backCosine;
+
+                        for (int packet = first; packet < last; ++packet) {
+                            trace_packet(
+                                triangles, rays, packets, packet,
+                                temp_frontpatchId.data(), temp_frontDistance.data(), temp_frontCosine.data(),
+                                temp_backpatchId.data(), temp_backDistance.data(), temp_backCosine.data());
+
+                            for (int j = 0; j < packets.packet_size(packet); ++j) {
+                                const int i = packets.rayIndex[packets.packetStart[packet] + j];
+                                frontpatchId(i) = temp_frontpatchId[j];
+                                frontDistance(i) = temp_frontDistance[j];
+                                frontCosine(i) = temp_frontCosine[j];
+                                backPatchId(i) = temp_backpatchId[j];
+                                backDistance(i) = temp_backDistance[j];
+                                backCosine(i) = temp_backCosine[j];
+                            }
+                        }
+                    });
+            }
+            else {
+                trace_in_parallel(numRays, RAYS_PER_TASK, threadPool, [&](int first, int last)
+                    {
+                        for (int i = first; i < last; ++i) {
+                            // Buffers for ray processing
+                            int temp_frontpatchId, temp_backpatchId;
+                            Real temp_frontDistance, temp_backDistance, temp_frontCosine, temp_backCosine;
+
+                            trace_ray(
+                                triangles, rays, i,
+                                temp_frontpatchId, temp_frontDistance, temp_frontCosine,
+                                temp_backpatchId, temp_backDistance, temp_backCosine);
+
+                            frontpatchId(i) = temp_frontpatchId;
+                            frontDistance(i) = temp_frontDistance;
+                            frontCosine(i) = temp_frontCosine;
+                            backPatchId(i) = temp_backpatchId;
+                            backDistance(i) = temp_backDistance;
+                            backCosine(i) = temp_backCosine;
+                        }
+                    });
             }
 
 #if PROFILE_TRACE_ALL
@@ -633,6 +1011,26 @@ namespace RAC
             }
         }
 
+        void RayPencil::clusterDirections(
+            const DirectionLookup& lookup,
+            Vec<int>& clusters) const
+        {
+            if (exposeMirrorCopies)
+                RAC_DEBUG_ASSERT(clusters.Length() == 2 * numRays, "Clusters length must equal 2 * numRays" + ToString(clusters.Length()));
+            else
+                RAC_DEBUG_ASSERT(clusters.Length() == numRays, "Clusters length must equal numRays" + ToString(clusters.Length()));
+
+            for (int i = 0; i < numRays; ++i)
+                clusters(i) = lookup.nearest(rays.D[i]);
+
+            if (exposeMirrorCopies)
+            {
+                // Append direct opposites
+                for (int i = 0; i < numRays; ++i)
+                    clusters(i + numRays) = lookup.nearest(-rays.D[i]);
+            }
+        }
+
         void RayPencil::getDirections(std::vector<Vec3>& directions) const
         {
             if (exposeMirrorCopies)
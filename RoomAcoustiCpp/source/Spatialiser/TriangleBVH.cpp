@@ -0,0 +1,219 @@
+/*
+* @class TriangleBVH
+*
+* @brief Definition of TriangleBVH class
+*
+*/
+
+// C++ headers
+#include <algorithm>
+#include <cmath>
+
+// Spatialiser headers
+#include "Spatialiser/TriangleBVH.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		namespace
+		{
+			constexpr int NUM_BINS = 16;						// Number of bins per axis evaluated by the surface area heuristic
+			constexpr int MIN_LEAF_SIZE = 2;					// Nodes with this many triangles or fewer are always leaves
+			constexpr int MAX_LEAF_SIZE = 8;					// Maximum number of triangles stored in a leaf node
+			constexpr int MAX_BUILD_DEPTH = 32;					// Depth beyond which nodes are split at the median to bound the traversal stack
+			constexpr Real TRAVERSAL_COST = 1.0;				// Cost of visiting a node relative to a triangle intersection test
+			constexpr Real GRAZING_COSINE = 1e-4;				// Rays closer than this to parallel with a triangle may hit outside its padded bounds
+			constexpr Real NORMAL_MERGE_TOLERANCE = 1e-6;		// Maximum distance between normals merged into one grazing normal
+		}
+
+		//////////////////// TriangleBVH Class ////////////////////
+
+		////////////////////////////////////////
+
+		void TriangleBVH::Build(const std::vector<Vec3>& A, const std::vector<Vec3>& edge1, const std::vector<Vec3>& edge2)
+		{
+			Clear();
+
+			const int numTriangles = ToInt(A.size());
+			if (numTriangles == 0)
+				return;
+
+			std::vector<Primitive> primitives(numTriangles);
+			for (int i = 0; i < numTriangles; ++i)
+			{
+				Primitive& primitive = primitives[i];
+				primitive.triangle = i;
+				primitive.bounds.Grow(A[i]);
+				primitive.bounds.Grow(A[i] + edge1[i]);
+				primitive.bounds.Grow(A[i] + edge2[i]);
+
+				Real extent = 0.0;
+				for (int j = 0; j < 3; ++j)
+					extent = std::max(extent, primitive.bounds.max[j] - primitive.bounds.min[j]);
+
+				// The edge tolerance admits barycentric coordinates down to -EPS_EDGE / |det|, where |det| = 2 * area * |D.n|.
+				// |det| > EPS_PARALLEL bounds this for all rays. For rays at least GRAZING_COSINE from parallel,
+				// a tighter bound applies if the other rays are traced against every triangle.
+				const Vec3 normal = edge1[i].cross(edge2[i]);
+				const Real twiceArea = std::sqrt(normal.dot(normal));
+				Real tolerance = EPS_EDGE / EPS_PARALLEL;
+				if (twiceArea > 0.0 && EPS_EDGE / (GRAZING_COSINE * twiceArea) < tolerance)
+				{
+					tolerance = EPS_EDGE / (GRAZING_COSINE * twiceArea);
+					AddGrazingNormal(normal / twiceArea);
+				}
+
+				// Negative barycentric coordinates move a hit at most 2 * tolerance * extent outside the triangle
+				const Real pad = REAL_CONST(2.0) * tolerance * extent + EPS_GENERAL;
+				for (int j = 0; j < 3; ++j)
+				{
+					primitive.bounds.min[j] -= pad;
+					primitive.bounds.max[j] += pad;
+					primitive.centroid[j] = REAL_CONST(0.5) * (primitive.bounds.min[j] + primitive.bounds.max[j]);
+				}
+			}
+
+			mTriangles.reserve(numTriangles);
+			mNodes.reserve(2 * numTriangles);
+			BuildRecursive(primitives, 0, numTriangles, 0);
+		}
+
+		////////////////////////////////////////
+
+		bool TriangleBVH::IsGrazing(const Vec3& direction) const
+		{
+			const Real length = std::sqrt(direction.dot(direction));
+			for (const GrazingNormal& grazing : mGrazingNormals)
+			{
+				if (std::abs(direction.dot(grazing.normal)) < GRAZING_COSINE + length * grazing.deviation)
+					return true;
+			}
+			return false;
+		}
+
+		////////////////////////////////////////
+
+		void TriangleBVH::AddGrazingNormal(const Vec3& normal)
+		{
+			for (GrazingNormal& grazing : mGrazingNormals)
+			{
+				const Vec3 difference = grazing.normal.dot(normal) < 0.0 ? normal + grazing.normal : normal - grazing.normal;
+				const Real deviation = std::sqrt(difference.dot(difference));
+				if (deviation <= NORMAL_MERGE_TOLERANCE)
+				{
+					grazing.deviation = std::max(grazing.deviation, deviation);
+					return;
+				}
+			}
+			mGrazingNormals.push_back({ normal, 0.0 });
+		}
+
+		////////////////////////////////////////
+
+		int TriangleBVH::BuildRecursive(std::vector<Primitive>& primitives, int first, int last, int depth)
+		{
+			const int nodeIdx = ToInt(mNodes.size());
+			mNodes.emplace_back();
+
+			AABB bounds, centroidBounds;
+			GrowBounds(primitives, first, last, bounds, centroidBounds);
+			mNodes[nodeIdx].bounds = bounds;
+
+			auto makeLeaf = [&]()
+				{
+					mNodes[nodeIdx].firstPrimitive = ToInt(mTriangles.size());
+					mNodes[nodeIdx].count = last - first;
+					for (int i = first; i < last; ++i)
+						mTriangles.push_back(primitives[i].triangle);
+					return nodeIdx;
+				};
+
+			const int count = last - first;
+			if (count <= MIN_LEAF_SIZE)
+				return makeLeaf();
+
+			// Find the cheapest binned split across all three axes
+			int bestAxis = -1;
+			int bestSplit = 0;
+			Real bestCost = std::numeric_limits<Real>::max();
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const Real extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+				if (extent <= 0.0)
+					continue;
+				const Real scale = NUM_BINS / extent;
+
+				std::array<AABB, NUM_BINS> binBounds;
+				std::array<int, NUM_BINS> binCounts{};
+				for (int i = first; i < last; ++i)
+				{
+					const int bin = std::min(NUM_BINS - 1, static_cast<int>((primitives[i].centroid[axis] - centroidBounds.min[axis]) * scale));
+					binBounds[bin].Grow(primitives[i].bounds);
+					++binCounts[bin];
+				}
+
+				// Sweep from the right to store the cost of everything right of each split
+				std::array<Real, NUM_BINS> rightCost{};
+				AABB rightBounds;
+				int rightCount = 0;
+				for (int bin = NUM_BINS - 1; bin > 0; --bin)
+				{
+					rightBounds.Grow(binBounds[bin]);
+					rightCount += binCounts[bin];
+					rightCost[bin] = rightBounds.HalfArea() * rightCount;
+				}
+
+				AABB leftBounds;
+				int leftCount = 0;
+				for (int split = 1; split < NUM_BINS; ++split)
+				{
+					leftBounds.Grow(binBounds[split - 1]);
+					leftCount += binCounts[split - 1];
+					if (leftCount == 0 || leftCount == count)
+						continue;
+
+					const Real cost = leftBounds.HalfArea() * leftCount + rightCost[split];
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+					}
+				}
+			}
+
+			int mid;
+			if (bestAxis >= 0 && depth < MAX_BUILD_DEPTH)
+			{
+				const Real parentArea = bounds.HalfArea();
+				const Real splitCost = parentArea > 0.0 ? TRAVERSAL_COST + bestCost / parentArea : std::numeric_limits<Real>::max();
+				if (count <= MAX_LEAF_SIZE && splitCost >= static_cast<Real>(count))
+					return makeLeaf();
+
+				const Real minCentroid = centroidBounds.min[bestAxis];
+				const Real scale = NUM_BINS / (centroidBounds.max[bestAxis] - minCentroid);
+				auto midIt = std::partition(primitives.begin() + first, primitives.begin() + last,
+					[&](const Primitive& primitive)
+					{
+						return std::min(NUM_BINS - 1, static_cast<int>((primitive.centroid[bestAxis] - minCentroid) * scale)) < bestSplit;
+					});
+				mid = static_cast<int>(midIt - primitives.begin());
+			}
+			else
+			{
+				if (count <= MAX_LEAF_SIZE)
+					return makeLeaf();
+
+				// Split at the median centroid along the largest axis (centroids coincide or the tree is too deep)
+				mid = MedianSplit(primitives, first, last, centroidBounds, [](const Primitive& a, const Primitive& b) { return a.triangle < b.triangle; });
+			}
+
+			BuildRecursive(primitives, first, mid, depth + 1);
+			const int right = BuildRecursive(primitives, mid, last, depth + 1);
+			mNodes[nodeIdx].rightChild = right;
+			return nodeIdx;
+		}
+	}
+}
@@ -0,0 +1,256 @@
+/*
+* @class WallBVH
+*
+* @brief Definition of WallBVH class
+*
+*/
+
+// C++ headers
+#include <algorithm>
+#include <cmath>
+
+// Common headers
+#include "Common/Debug.h"
+
+// Spatialiser headers
+#include "Spatialiser/WallBVH.h"
+
+namespace RAC
+{
+	using namespace Common;
+	namespace Spatialiser
+	{
+		namespace
+		{
+			constexpr int MAX_LEAF_SIZE = 4;		// Maximum number of walls stored in a leaf node
+			constexpr int MAX_STACK_DEPTH = 64;		// Maximum traversal stack depth
+		}
+
+		//////////////////// WallBVH Class ////////////////////
+
+		////////////////////////////////////////
+
+		void WallBVH::Build(const PlaneMap& planes, const WallMap& walls)
+		{
+			Clear();
+
+			// Sort plane IDs so the primitive build order does not depend on the unordered_map iteration order
+			std::vector<size_t> planeIDs;
+			planeIDs.reserve(planes.size());
+			for (const auto& [planeID, plane] : planes)
+				planeIDs.push_back(planeID);
+			std::sort(planeIDs.begin(), planeIDs.end());
+
+			mPrimitives.reserve(walls.size());
+			for (const size_t planeID : planeIDs)
+			{
+				const Plane& plane = planes.at(planeID);
+				for (const size_t wallID : plane.GetWalls())
+				{
+					auto itW = walls.find(wallID);
+					if (itW == walls.end()) // case: wall doesn't exist
+						continue;
+
+					Primitive primitive;
+					primitive.vertices = itW->second.GetVertices();
+					primitive.planeNormal = plane.GetNormal();
+					primitive.planeD = plane.GetD();
+					primitive.wallID = wallID;
+					primitive.planeID = planeID;
+					primitive.order = mPrimitives.size();
+					for (const Vec3& vertex : primitive.vertices)
+						primitive.bounds.Grow(vertex);
+
+					// Pad the bounds as walls are flat and vertices are rounded
+					for (int i = 0; i < 3; ++i)
+					{
+						primitive.bounds.min[i] -= EPS_GENERAL;
+						primitive.bounds.max[i] += EPS_GENERAL;
+						primitive.centroid[i] = REAL_CONST(0.5) * (primitive.bounds.min[i] + primitive.bounds.max[i]);
+					}
+					mPrimitives.push_back(primitive);
+				}
+			}
+
+			if (mPrimitives.empty())
+				return;
+
+			mNodes.reserve(2 * mPrimitives.size());
+			BuildMedianBVH(mNodes, mPrimitives, 0, ToInt(mPrimitives.size()), MAX_LEAF_SIZE,
+				[](const Primitive& a, const Primitive& b) { return a.order < b.order; });
+
+			// Index the walls of each plane (primitives were added in plane ID order, so sorting by build order groups them)
+			mPlaneWalls.resize(mPrimitives.size());
+			for (int i = 0; i < ToInt(mPrimitives.size()); ++i)
+				mPlaneWalls[mPrimitives[i].order] = { mPrimitives[i].planeID, i };
+		}
+
+		////////////////////////////////////////
+
+		bool WallBVH::SegmentOverlaps(const std::array<Real, 3>& start, const std::array<Real, 3>& invDir, const AABB& box, const Real tMax)
+		{
+			Real tEnter = 0.0;
+			Real tExit = tMax;
+			for (int i = 0; i < 3; ++i)
+			{
+				if (std::isinf(invDir[i])) // case: line parallel to slab
+				{
+					if (start[i] < box.min[i] || start[i] > box.max[i])
+						return false;
+					continue;
+				}
+
+				Real t0 = (box.min[i] - start[i]) * invDir[i];
+				Real t1 = (box.max[i] - start[i]) * invDir[i];
+				if (t0 > t1)
+					std::swap(t0, t1);
+
+				tEnter = std::max(tEnter, t0);
+				tExit = std::min(tExit, t1);
+				if (tEnter > tExit)
+					return false;
+			}
+			return true;
+		}
+
+		////////////////////////////////////////
+
+		template <typename Visitor>
+		void WallBVH::Traverse(const Vec3& start, const Vec3& end, const Real& tMax, Visitor&& visit) const
+		{
+			if (mNodes.empty())
+				return;
+
+			const Vec3 dir = end - start;
+			const std::array<Real, 3> origin = { start.x(), start.y(), start.z() };
+			const std::array<Real, 3> d = { dir.x(), dir.y(), dir.z() };
+			std::array<Real, 3> invDir;
+			for (int i = 0; i < 3; ++i)
+				invDir[i] = d[i] == 0.0 ? std::numeric_limits<Real>::infinity() : REAL_CONST(1.0) / d[i];
+
+			std::array<int, MAX_STACK_DEPTH> stack;
+			int stackSize = 0;
+			stack[stackSize++] = 0;
+
+			while (stackSize > 0)
+			{
+				const BVHNode& node = mNodes[stack[--stackSize]];
+				if (!SegmentOverlaps(origin, invDir, node.bounds, tMax))
+					continue;
+
+				if (node.count > 0)
+				{
+					for (int i = node.firstPrimitive; i < node.firstPrimitive + node.count; ++i)
+					{
+						if (visit(mPrimitives[i]))
+							return;
+					}
+					continue;
+				}
+
+				const int nodeIdx = static_cast<int>(&node - mNodes.data());
+				if (stackSize + 2 > MAX_STACK_DEPTH) // case: stack full (the median build keeps the depth well below this)
+				{
+					int first, last;
+					SubtreePrimitives(mNodes, nodeIdx, first, last);
+					for (int i = first; i < last; ++i)
+					{
+						if (visit(mPrimitives[i]))
+							return;
+					}
+					continue;
+				}
+				stack[stackSize++] = node.rightChild;
+				stack[stackSize++] = nodeIdx + 1;
+			}
+		}
+
+		////////////////////////////////////////
+
+		bool WallBVH::IntersectPrimitive(const Primitive& primitive, const Vec3& start, const Vec3& end, Hit& hit, size_t& hitOrder)
+		{
+			Real kS = primitive.PointPlanePosition(start);
+			Real kE = primitive.PointPlanePosition(end);
+			if (kS * kE > 0) // point lies on plane when kS || kE == 0. Therefore, counts as an intersection
+				return false;
+
+			auto [valid, intersection] = IntersectTriangle(primitive.vertices[0], primitive.vertices[1], primitive.vertices[2], start, start - end, true);
+			if (!valid)
+				return false;
+
+			Real t = kS == kE ? REAL_CONST(0.0) : std::clamp(kS / (kS - kE), REAL_CONST(0.0), REAL_CONST(1.0));
+			if (t > hit.t || (t == hit.t && primitive.order > hitOrder))
+				return false;
+
+			hit.wallID = primitive.wallID;
+			hit.planeID = primitive.planeID;
+			hit.t = t;
+			hit.intersection = intersection;
+			hitOrder = primitive.order;
+			return true;
+		}
+
+		////////////////////////////////////////
+
+		bool WallBVH::AnyHit(const Vec3& start, const Vec3& end, std::initializer_list<size_t> excludedPlaneIds) const
+		{
+			bool obstruction = false;
+			const Real tMax = 1.0;
+			Traverse(start, end, tMax, [&](const Primitive& primitive)
+				{
+					// Skip excluded planes
+					if (std::find(excludedPlaneIds.begin(), excludedPlaneIds.end(), primitive.planeID) != excludedPlaneIds.end())
+						return false;
+
+					Real kS = primitive.PointPlanePosition(start);
+					Real kE = primitive.PointPlanePosition(end);
+					if (kS * kE >= 0) // point lies on plane when kS || kE == 0. Therefore, not obstructed
+						return false;
+
+					obstruction = IntersectTriangle(primitive.vertices[0], primitive.vertices[1], primitive.vertices[2], start, start - end, false).first;
+					return obstruction;
+				});
+			return obstruction;
+		}
+
+		////////////////////////////////////////
+
+		bool WallBVH::ClosestHit(const Vec3& start, const Vec3& end, std::initializer_list<size_t> excludedPlaneIds, Hit& hit) const
+		{
+			Hit best;
+			best.t = REAL_CONST(1.0);
+			size_t bestOrder = std::numeric_limits<size_t>::max();
+			const Real& tMax = best.t;
+			Traverse(start, end, tMax, [&](const Primitive& primitive)
+				{
+					// Skip excluded planes
+					if (std::find(excludedPlaneIds.begin(), excludedPlaneIds.end(), primitive.planeID) == excludedPlaneIds.end())
+						IntersectPrimitive(primitive, start, end, best, bestOrder);
+					return false;
+				});
+
+			if (bestOrder == std::numeric_limits<size_t>::max())
+				return false;
+			hit = best;
+			return true;
+		}
+
+		////////////////////////////////////////
+
+		bool WallBVH::ClosestHitInPlane(const Vec3& start, const Vec3& end, const size_t planeID, Hit& hit) const
+		{
+			Hit best;
+			best.t = REAL_CONST(1.0);
+			size_t bestOrder = std::numeric_limits<size_t>::max();
+			auto first = std::lower_bound(mPlaneWalls.begin(), mPlaneWalls.end(), planeID,
+				[](const PlaneWall& wall, const size_t id) { return wall.planeID < id; });
+			for (auto it = first; it != mPlaneWalls.end() && it->planeID == planeID; ++it)
+				IntersectPrimitive(mPrimitives[it->primitive], start, end, best, bestOrder);
+
+			if (bestOrder == std::numeric_limits<size_t>::max())
+				return false;
+			hit = best;
+			return true;
+		}
+	}
+}
@@ -116,6 +116,16 @@ bool CommandLineParser::Parse()
 			}
 			desiredAudioThreads = newDesiredAudioThreads;
 		}
+		else if (ParseStandardArgument(argument, "--iem-threads=", value))
+		{
+			const int newDesiredIEMThreads = std::stoi(value);
+			if (newDesiredIEMThreads <= 0)
+			{
+				std::cerr << "Invalid iem-threads: " << argument << std::endl;
+				return false;
+			}
+			desiredIEMThreads = newDesiredIEMThreads;
+		}
 		else if (ParseStandardArgument(argument, "--log-prefix=", value))
 		{
 			logPrefix = value;
@@ -166,6 +176,7 @@ Options:
     --debug                Enables certain memory debugging features
     --detailed-logs        Enables detailed logs
     --dynamic-scene        Moves the sources around a 1m^2 area
+    --iem-threads=##       Overrides the number of image edge model threads
     --inner-iterations=##  The number of times to run the inner loop
     --log-prefix=file      Specifies the log prefix
     --no-debug             Disables certain memory debugging features
@@ -28,6 +28,7 @@ public:
 	int GetShadowOrder() const { return shadowOrder; }
 	bool GetStaticSceneFlag() const { return staticScene; }
 	std::optional<size_t> GetDesiredAudioThreads() const { return desiredAudioThreads;  }
+	std::optional<size_t> GetDesiredIEMThreads() const { return desiredIEMThreads; }
 	bool GetUseQualityHRTFs() const { return useQualityHRTFs; }
 
 	const std::string &GetLogPrefix() const { return logPrefix; }
@@ -62,5 +63,6 @@ private:
 	bool staticScene = true;
 	bool useQualityHRTFs = true;
 	std::optional<size_t> desiredAudioThreads;
+	std::optional<size_t> desiredIEMThreads;
 
 };
@@ -475,5 +475,7 @@ bool LoadMoDARTScene(const std::string& modartPath, const Coefficients<>& target
     Real delay = 0.1;
     Real minT60 = 0.2;
     MoDARTData modartData(true, data.numRays, data.feedbackMatrix, delay, minT60, pathIndexing, newFreqBandIndexing, newT60s, resizedLeftEigenvectors, resizedRightEigenvectors);
+    modartData.numThreads = data.numThreads;
+    modartData.progressiveRays = data.progressiveRays;
     return InitMoDART(modartData);
 }
\ No newline at end of file
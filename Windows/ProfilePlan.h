@@ -46,6 +46,7 @@ struct ProfileExecutionContext
 	bool staticScene = true;
 	bool useQualityHrtfs = true;
 	std::optional<size_t> desiredAudioThreads;
+	std::optional<size_t> desiredIEMThreads;
 
 	SimpleTimer stageTimers[(int)ProfileExecutionStage::COUNT];
 
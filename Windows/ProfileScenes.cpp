@@ -6,7 +6,14 @@
 
 #include "Spatialiser/Interface.h"
 #include "Spatialiser/ContextOptionalArguments.h"
+#include "Spatialiser/ImageEdge.h"
+#include "Spatialiser/ReflectionBatch.h"
+#include "Spatialiser/TracingUtils.h"
+#include "Spatialiser/TracingKernels.h"
+#include "Spatialiser/FDN.h"
+#include "DSP/AudioThreadPool.h"
 #include "Common/Debug.h"
+#include "Common/ThreadPool.h"
 
 #include "MoDARTLoader.h"
 
@@ -17,6 +24,10 @@
 
 #include <random>
 
+#ifndef _WIN32
+#include <time.h>
+#endif
+
 #include "CommandLineParser.h"
 
 using namespace RAC::Spatialiser;
@@ -242,7 +253,8 @@ bool BaseTest::Init()
 	ContextOptionalArguments optionalArguments =
 	{
 		.logPrefix = executionContext.logPrefix,
-		.desiredAudioThreads = executionContext.desiredAudioThreads
+		.desiredAudioThreads = executionContext.desiredAudioThreads,
+		.desiredIEMThreads = executionContext.desiredIEMThreads
 	};
 	::Init(configData, optionalArguments);
 
@@ -629,6 +641,713 @@ void ProfileMoDARTManySources(ProfileExecutionContext& executionContext)
 	test.Run();
 }
 
+// Runs the image edge model directly (no audio or late reverb) and reports the time per run
+// for an increasing number of IEM threads. A single source scene measures parallel frontier expansion
+// within a source and a many source scene measures parallelism across sources. Each is run for
+// reflection orders 2 up to the requested reflection order
+class ProfileIEMThreadScalingTest
+{
+public:
+	explicit ProfileIEMThreadScalingTest(ProfileExecutionContext& executionContext) : executionContext(executionContext) {}
+
+	void Run();
+
+private:
+	double TimeImageEdgeModel(size_t numThreads, int numSources, int reflectionOrder, Real listenerStep);
+
+	ProfileExecutionContext& executionContext;
+
+	int fs{ 48000 };
+	int numFrames{ 512 };
+	Coefficients<> frequencyBands = Coefficients<>(std::vector<Real>({ 125.0, 250.0, 500.0, 1e3, 2e3, 4e3, 8e3 }));
+
+	Vec3 roomSize = Vec3((Real)7.0, (Real)3.0, (Real)4.0);
+	Vec3 listenerPos = Vec3((Real)3.2, (Real)1.5, (Real)2.1);
+	Vec4 sourceOri = Vec4((Real)1.0, (Real)0.0, (Real)0.0, (Real)0.0);
+	std::vector<int> sourceCounts = { 1, 16 };
+	Real fullUpdateStep = 1.0;			// Listener step that forces the image source trees to be rebuilt
+	Real listenerUpdateStep = 0.01;		// Listener step that only updates the receiver side of the image source trees
+	std::string allocationsPerRun;		// Heap allocations per run of the last timed configuration (requires DEBUG_MEMORY)
+};
+
+void ProfileIEMThreadScalingTest::Run()
+{
+	std::vector<size_t> threadCounts = { 1 };
+	const size_t maxThreads = std::max(executionContext.desiredIEMThreads.value_or(std::thread::hardware_concurrency()), static_cast<size_t>(1));
+	for (size_t numThreads = 2; numThreads < maxThreads; numThreads *= 2)
+		threadCounts.push_back(numThreads);
+	if (maxThreads > 1)
+		threadCounts.push_back(maxThreads);
+
+	// Scene setup is included in each timed run, so only the main stage is used
+	executionContext.SetExecutionStage(ProfileExecutionStage::Init);
+	executionContext.SetExecutionStage(ProfileExecutionStage::Main);
+
+	std::vector<std::string> results;
+	for (int numSources : sourceCounts)
+	{
+		for (int reflectionOrder = 2; reflectionOrder <= std::max(executionContext.reflectionOrder, 2); ++reflectionOrder)
+		{
+			for (Real listenerStep : { fullUpdateStep, listenerUpdateStep })
+			{
+				double serialTime = 0.0;
+				for (size_t numThreads : threadCounts)
+				{
+					double time = TimeImageEdgeModel(numThreads, numSources, reflectionOrder, listenerStep);
+					if (numThreads == 1)
+						serialTime = time;
+					results.push_back(std::format("{}, {}, {}, {}, {:.3f}, {:.2f}, {}", numSources, reflectionOrder, listenerStep == fullUpdateStep ? "full" : "listener", numThreads, time, serialTime / time, allocationsPerRun));
+				}
+			}
+		}
+	}
+
+	executionContext.SetExecutionStage(ProfileExecutionStage::Exit);
+
+	std::cout << "Sources, Reflection order, Update, IEM threads, Time per run (ms), Speedup, Allocations per run" << std::endl;
+	for (const std::string& result : results)
+		std::cout << result << std::endl;
+}
+
+double ProfileIEMThreadScalingTest::TimeImageEdgeModel(size_t numThreads, int numSources, int reflectionOrder, Real listenerStep)
+{
+	DSPData configData = DSPData(fs, numFrames, 12, 12, 2.0, 0.98, frequencyBands);
+	std::shared_ptr<DSPConfig> dspConfig = std::make_shared<DSPConfig>(configData);
+	dspConfig->UpdateDiffractionModel(DiffractionModel::attenuate);
+
+	Binaural::CCore core;
+	core.SetAudioState({ fs, numFrames });
+	std::shared_ptr<Binaural::CListener> listener = core.CreateListener();
+
+	std::shared_ptr<SourceManager> sourceManager = std::make_shared<SourceManager>(&core, dspConfig);
+	sourceManager->UpdateDiffractionModel(DiffractionModel::attenuate);
+	std::shared_ptr<Room> room = std::make_shared<Room>(ToInt(frequencyBands.Length()));
+
+	// Shoebox (walls facing inwards) with a free standing two sided partition to add diffraction paths and obstructions
+	size_t materialID = room->InitMaterial(Coefficients<>(std::vector<Real>({ 0.03, 0.03, 0.04, 0.06, 0.09, 0.1, 0.12 })));
+	const Real x = roomSize.x(), y = roomSize.y(), z = roomSize.z();
+	std::vector<Vertices> faces = {
+		{ Vec3(0.0, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(0.0, y, 0.0) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, 0.0), Vec3(x, y, 0.0) },
+		{ Vec3(0.0, 0.0, z), Vec3(0.0, y, z), Vec3(x, y, z) }, { Vec3(0.0, 0.0, z), Vec3(x, y, z), Vec3(x, 0.0, z) },
+		{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, z), Vec3(0.0, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, 0.0), Vec3(0.0, y, z) },
+		{ Vec3(x, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, y, z) }, { Vec3(x, 0.0, 0.0), Vec3(x, y, z), Vec3(x, y, 0.0) },
+		{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, z), Vec3(x, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, 0.0, 0.0) },
+		{ Vec3(0.0, y, 0.0), Vec3(x, y, z), Vec3(0.0, y, z) }, { Vec3(0.0, y, 0.0), Vec3(x, y, 0.0), Vec3(x, y, z) },
+		{ Vec3(4.5, 0.0, 1.0), Vec3(4.5, 2.0, 3.0), Vec3(4.5, 0.0, 3.0) }, { Vec3(4.5, 0.0, 1.0), Vec3(4.5, 2.0, 1.0), Vec3(4.5, 2.0, 3.0) },
+		{ Vec3(4.5, 0.0, 1.0), Vec3(4.5, 0.0, 3.0), Vec3(4.5, 2.0, 3.0) }, { Vec3(4.5, 0.0, 1.0), Vec3(4.5, 2.0, 3.0), Vec3(4.5, 2.0, 1.0) }
+	};
+	for (const Vertices& face : faces)
+	{
+		Wall wall(face, materialID);
+		size_t id = room->AddWall(wall);
+		room->InitEdges(id);
+	}
+	room->UpdatePlanes();
+	room->UpdateEdges();
+
+	// Sources spread over a grid in the room
+	for (int i = 0; i < numSources; ++i)
+	{
+		int id = sourceManager->Init();
+		if (id < 0)
+			break;
+		Vec3 position((Real)(0.5 + 6.0 * (i % 4) / 3.0), (Real)(0.8 + 0.4 * (i % 3)), (Real)(0.5 + 3.0 * (i / 4) / 3.0));
+		Real distance = (position - listenerPos).Normal();
+		sourceManager->UpdateSourceDirectivity(static_cast<size_t>(id), SourceDirectivity::omni);
+		sourceManager->Update(static_cast<size_t>(id), position, sourceOri, distance);
+	}
+
+	EarlyReverbData earlyReverbData(DirectSound::check, reflectionOrder, std::min(executionContext.shadowOrder, reflectionOrder), 1, (Real)0.0, (Real)1e4);
+	ImageEdge imageEdge(room, sourceManager, earlyReverbData, dspConfig, numThreads);
+
+	// Warm up (allocates image source stores)
+	imageEdge.SetListenerPosition(listenerPos);
+	imageEdge.RunIEM();
+
+	// Move the listener every run so that every source is recomputed.
+	// Large steps rebuild the image source trees, small steps only update the receiver side
+#if DEBUG_MEMORY
+	const LONG startAllocations = g_MemoryAllocationData.AllocCount + g_MemoryAllocationData.ReallocCount;
+#endif
+	StartMemoryMonitor();
+	const auto startTime = SimpleTimer::GetCurrentTime();
+	for (int innerIteration = 0; innerIteration < executionContext.innerIterations; ++innerIteration)
+	{
+		Vec3 position = listenerPos;
+		position.x() += (innerIteration % 2 == 0) ? listenerStep : -listenerStep;
+		imageEdge.SetListenerPosition(position);
+		imageEdge.RunIEM();
+	}
+	const auto endTime = SimpleTimer::GetCurrentTime();
+	StopMemoryMonitor();
+#if DEBUG_MEMORY
+	const LONG numAllocations = g_MemoryAllocationData.AllocCount + g_MemoryAllocationData.ReallocCount - startAllocations;
+	allocationsPerRun = std::format("{:.1f}", static_cast<double>(numAllocations) / std::max(executionContext.innerIterations, 1));
+#else
+	allocationsPerRun = "-";
+#endif
+	return SimpleTimer::GetMilliseconds(startTime, endTime) / std::max(executionContext.innerIterations, 1);
+}
+
+void ProfileIEMThreadScaling(ProfileExecutionContext& executionContext)
+{
+	ProfileIEMThreadScalingTest test(executionContext);
+	test.Run();
+}
+
+// Compares the reflection and path length culls of the image edge model expansion when run one (image source, plane)
+// pair at a time with Plane::ReflectPointInPlane against ReflectionBatch, for a range of image source block sizes
+class ProfileReflectionKernelTest
+{
+public:
+	explicit ProfileReflectionKernelTest(ProfileExecutionContext& executionContext) : executionContext(executionContext) {}
+
+	void Run();
+
+private:
+	ProfileExecutionContext& executionContext;
+
+	std::vector<size_t> blockSizes = { 4, 16, 64, 256, 1024 };
+	int numPlanes{ 64 };
+	int numRepeats{ 1000 };				// Repeats of each block per inner iteration so the run time is measurable
+	Real maxDistance{ 30.0 };
+	Vec3 listenerPos = Vec3((Real)3.2, (Real)1.5, (Real)2.1);
+};
+
+void ProfileReflectionKernelTest::Run()
+{
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<Real> coordinate(-20.0, 20.0);
+
+	std::vector<Plane> planes;
+	for (int i = 0; i < numPlanes; ++i)
+	{
+		Vertices vertices = { Vec3(coordinate(rng), coordinate(rng), coordinate(rng)), Vec3(coordinate(rng), coordinate(rng), coordinate(rng)), Vec3(coordinate(rng), coordinate(rng), coordinate(rng)) };
+		planes.emplace_back(i, Wall(vertices, 0));
+	}
+
+	executionContext.SetExecutionStage(ProfileExecutionStage::Init);
+	executionContext.SetExecutionStage(ProfileExecutionStage::Main);
+
+	std::vector<std::string> results;
+	for (size_t blockSize : blockSizes)
+	{
+		std::vector<Vec3> positions;
+		ReflectionBatch batch;
+		for (size_t i = 0; i < blockSize; ++i)
+		{
+			positions.emplace_back(coordinate(rng), coordinate(rng), coordinate(rng));
+			batch.Add(positions.back());
+		}
+		std::vector<uint8_t> mask(blockSize);
+
+		// Current path
+		size_t scalarCount = 0;
+		auto startTime = SimpleTimer::GetCurrentTime();
+		for (int iteration = 0; iteration < executionContext.innerIterations * numRepeats; ++iteration)
+		{
+			for (const Plane& plane : planes)
+			{
+				for (const Vec3& position : positions)
+				{
+					Vec3 reflected;
+					if (plane.ReflectPointInPlane(reflected, position) && (reflected - listenerPos).Normal() <= maxDistance)
+						++scalarCount;
+				}
+			}
+		}
+		auto endTime = SimpleTimer::GetCurrentTime();
+		const double scalarTime = SimpleTimer::GetMilliseconds(startTime, endTime);
+
+		// Batched path
+		size_t batchCount = 0;
+		startTime = SimpleTimer::GetCurrentTime();
+		for (int iteration = 0; iteration < executionContext.innerIterations * numRepeats; ++iteration)
+		{
+			for (const Plane& plane : planes)
+			{
+				batch.Cull(plane, listenerPos, maxDistance, mask.data());
+				for (uint8_t valid : mask)
+					batchCount += valid;
+			}
+		}
+		endTime = SimpleTimer::GetCurrentTime();
+		const double batchTime = SimpleTimer::GetMilliseconds(startTime, endTime);
+
+		results.push_back(std::format("{}, {}, {:.3f}, {:.3f}, {:.2f}, {}", blockSize, numPlanes, scalarTime, batchTime, scalarTime / batchTime, scalarCount == batchCount ? "match" : "mismatch"));
+	}
+
+	executionContext.SetExecutionStage(ProfileExecutionStage::Exit);
+
+	std::cout << "Block size, Planes, Scalar time (ms), Batch time (ms), Speedup, Result" << std::endl;
+	for (const std::string& result : results)
+		std::cout << result << std::endl;
+}
+
+void ProfileReflectionKernel(ProfileExecutionContext& executionContext)
+{
+	ProfileReflectionKernelTest test(executionContext);
+	test.Run();
+}
+
+// Compares the ray throughput of trace_ray against every triangle (scalar and with the AVX2 kernel if supported)
+// with the triangle mesh BVH, for shoebox rooms with each face split into a grid of triangles.
+// Then measures how RayPencil::traceAll scales with the number of threads on the largest mesh, with and without ray packets
+class ProfileRayTracingTest
+{
+public:
+	explicit ProfileRayTracingTest(ProfileExecutionContext& executionContext) : executionContext(executionContext) {}
+
+	void Run();
+
+private:
+	TriangleMeshSoA CreateMesh(int gridSize) const;
+
+	ProfileExecutionContext& executionContext;
+
+	std::vector<int> gridSizes = { 1, 2, 4, 8, 16, 32 };	// Mesh sizes of 12 * gridSize^2 triangles
+	std::vector<int> threadCounts = { 1, 2, 4, 8, 16 };		// Counts above the hardware concurrency are skipped
+	int numRays{ 4096 };
+	int numPencilRays{ 32768 };
+	Vec3 roomSize = Vec3((Real)6.0, (Real)4.0, (Real)3.0);
+	Vec3 listenerPos = Vec3((Real)3.2, (Real)1.5, (Real)2.1);
+};
+
+TriangleMeshSoA ProfileRayTracingTest::CreateMesh(int gridSize) const
+{
+	const std::array<Real, 3> size = { roomSize.x(), roomSize.y(), roomSize.z() };
+	const Vec3 centre = 0.5 * roomSize;
+
+	TriangleMeshSoA mesh;
+	auto addTriangle = [&](const Vec3& a, const Vec3& b, const Vec3& c)
+		{
+			Vec3 normal = (b - a).cross(c - a);
+			normal.Normalise();
+			if (normal.dot(centre - a) < 0.0)
+				normal = -normal;
+
+			mesh.A.push_back(a);
+			mesh.edge1.push_back(b - a);
+			mesh.edge2.push_back(c - a);
+			mesh.n.push_back(normal);
+			mesh.patchId.push_back(mesh.size());
+			mesh.d0PlusEPS.push_back(normal.dot(a) + EPS_FACING);
+		};
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+		for (int side = 0; side < 2; ++side)
+		{
+			for (int i = 0; i < gridSize; ++i)
+			{
+				for (int j = 0; j < gridSize; ++j)
+				{
+					std::array<Vec3, 4> corners;
+					for (int k = 0; k < 4; ++k)
+					{
+						std::array<Real, 3> p;
+						p[axis] = side * size[axis];
+						p[u] = (i + (k & 1)) * size[u] / gridSize;
+						p[v] = (j + (k >> 1)) * size[v] / gridSize;
+						corners[k] = Vec3(p[0], p[1], p[2]);
+					}
+					addTriangle(corners[0], corners[1], corners[3]);
+					addTriangle(corners[0], corners[3], corners[2]);
+				}
+			}
+		}
+	}
+	// Always build the BVH so it can be compared with brute force at every size
+	mesh.bvh.Build(mesh.A, mesh.edge1, mesh.edge2);
+	mesh.build_blocks();
+	return mesh;
+}
+
+void ProfileRayTracingTest::Run()
+{
+	RayPencilSoA rays;
+	rays.O = listenerPos;
+	rays.resize(numRays);
+	rays.fill_uniform_sphere(false);
+
+	executionContext.SetExecutionStage(ProfileExecutionStage::Init);
+	executionContext.SetExecutionStage(ProfileExecutionStage::Main);
+
+	std::vector<std::string> results;
+	for (int gridSize : gridSizes)
+	{
+		const TriangleMeshSoA mesh = CreateMesh(gridSize);
+		TriangleMeshSoA simdMesh = mesh;
+		simdMesh.bvh.Clear();
+		TriangleMeshSoA bruteForceMesh = simdMesh;
+		bruteForceMesh.blocks.resize(0);
+
+		auto traceAll = [&](const TriangleMeshSoA& triangles, std::vector<int>& patchIds)
+			{
+				int patchIdFront, patchIdBack;
+				Real distanceFront, distanceBack, cosineFront, cosineBack;
+				for (int iteration = 0; iteration < executionContext.innerIterations; ++iteration)
+				{
+					for (int i = 0; i < numRays; ++i)
+					{
+						trace_ray(triangles, rays, i, patchIdFront, distanceFront, cosineFront, patchIdBack, distanceBack, cosineBack);
+						patchIds[i] = patchIdFront;
+					}
+				}
+			};
+
+		std::vector<int> bruteForcePatchIds(numRays), simdPatchIds(numRays), bvhPatchIds(numRays);
+		auto startTime = SimpleTimer::GetCurrentTime();
+		traceAll(bruteForceMesh, bruteForcePatchIds);
+		auto endTime = SimpleTimer::GetCurrentTime();
+		const double bruteForceTime = SimpleTimer::GetMilliseconds(startTime, endTime);
+
+		startTime = SimpleTimer::GetCurrentTime();
+		traceAll(simdMesh, simdPatchIds);
+		endTime = SimpleTimer::GetCurrentTime();
+		const double simdTime = SimpleTimer::GetMilliseconds(startTime, endTime);
+
+		startTime = SimpleTimer::GetCurrentTime();
+		traceAll(mesh, bvhPatchIds);
+		endTime = SimpleTimer::GetCurrentTime();
+		const double bvhTime = SimpleTimer::GetMilliseconds(startTime, endTime);
+
+		const double numTraced = static_cast<double>(numRays) * executionContext.innerIterations;
+		const bool match = bruteForcePatchIds == simdPatchIds && bruteForcePatchIds == bvhPatchIds;
+		results.push_back(std::format("{}, {}, {:.3f}, {:.3f}, {:.3f}, {:.0f}, {:.0f}, {:.0f}, {}", mesh.size(), numRays, bruteForceTime, simdTime, bvhTime,
+			1000.0 * numTraced / bruteForceTime, 1000.0 * numTraced / simdTime, 1000.0 * numTraced / bvhTime, match ? "match" : "mismatch"));
+	}
+
+	std::vector<std::string> threadResults;
+	{
+		const TriangleMeshSoA mesh = CreateMesh(gridSizes.back());
+		RayPencil pencil(numPencilRays, false);
+		pencil.moveOrigin(listenerPos);
+
+		double singleThreadTime = 0.0;
+		for (int numThreads : threadCounts)
+		{
+			if (numThreads > 1 && numThreads > static_cast<int>(std::thread::hardware_concurrency()))
+				continue;
+
+			std::unique_ptr<ThreadPool> threadPool = numThreads > 1 ? std::make_unique<ThreadPool>(numThreads - 1) : nullptr;
+
+			for (const bool packetTracing : { false, true })
+			{
+				pencil.setPacketTracing(packetTracing);
+
+				const auto startTime = SimpleTimer::GetCurrentTime();
+				for (int iteration = 0; iteration < executionContext.innerIterations; ++iteration)
+					pencil.traceAll(mesh, threadPool.get());
+				const auto endTime = SimpleTimer::GetCurrentTime();
+				const double time = SimpleTimer::GetMilliseconds(startTime, endTime);
+				if (numThreads == 1 && !packetTracing)
+					singleThreadTime = time;
+
+				const double numTraced = static_cast<double>(numPencilRays) * executionContext.innerIterations;
+				threadResults.push_back(std::format("{}, {}, {}, {}, {:.3f}, {:.0f}, {:.2f}", numThreads, packetTracing ? "yes" : "no", mesh.size(), numPencilRays, time,
+					1000.0 * numTraced / time, singleThreadTime / time));
+			}
+		}
+	}
+
+	executionContext.SetExecutionStage(ProfileExecutionStage::Exit);
+
+	std::cout << "AVX2 kernel: " << (cpu_supports_avx2() ? "yes" : "no") << std::endl;
+	std::cout << "Triangles, Rays, Brute force time (ms), SIMD time (ms), BVH time (ms), Brute force rays/s, SIMD rays/s, BVH rays/s, Result" << std::endl;
+	for (const std::string& result : results)
+		std::cout << result << std::endl;
+
+	std::cout << "Threads, Packets, Triangles, Rays, Time (ms), Rays/s, Speedup" << std::endl;
+	for (const std::string& result : threadResults)
+		std::cout << result << std::endl;
+}
+
+void ProfileRayTracing(ProfileExecutionContext& executionContext)
+{
+	ProfileRayTracingTest test(executionContext);
+	test.Run();
+}
+
+// Processes FDNs on an AudioThreadPool at the audio callback rate, sleeping between blocks, for a range of worker spin times.
+// Reports the time to process each block (which includes the time to wake parked workers) and the CPU used by the process
+// relative to the wall clock time. A spin time of "never" keeps workers spinning between blocks (the default on Windows)
+class ProfileAudioThreadWakeTest
+{
+public:
+	explicit ProfileAudioThreadWakeTest(ProfileExecutionContext& executionContext) : executionContext(executionContext) {}
+
+	void Run();
+
+private:
+	std::string TimeBlocks(size_t numThreads, std::chrono::microseconds spinTime);
+	static double GetProcessCpuMilliseconds();
+
+	ProfileExecutionContext& executionContext;
+
+	int fs{ 48000 };
+	int numFrames{ 512 };
+	int numReverbSources{ 12 };
+	int fdnSize{ 12 };
+	int numFDNs{ 16 };
+	std::vector<std::chrono::microseconds> spinTimes = { std::chrono::microseconds::max(), std::chrono::microseconds(1000),
+		std::chrono::microseconds(200), std::chrono::microseconds(50), std::chrono::microseconds(0) };
+};
+
+void ProfileAudioThreadWakeTest::Run()
+{
+	const size_t numThreads = std::max(executionContext.desiredAudioThreads.value_or(std::min(8u, std::thread::hardware_concurrency())), static_cast<size_t>(1));
+
+	executionContext.SetExecutionStage(ProfileExecutionStage::Init);
+	executionContext.SetExecutionStage(ProfileExecutionStage::Main);
+
+	std::vector<std::string> results;
+	results.push_back(TimeBlocks(0, std::chrono::microseconds::max()));
+	for (std::chrono::microseconds spinTime : spinTimes)
+		results.push_back(TimeBlocks(numThreads, spinTime));
+
+	executionContext.SetExecutionStage(ProfileExecutionStage::Exit);
+
+	std::cout << "Audio threads, Spin time (us), Mean block time (ms), Max block time (ms), CPU usage (cores)" << std::endl;
+	for (const std::string& result : results)
+		std::cout << result << std::endl;
+}
+
+std::string ProfileAudioThreadWakeTest::TimeBlocks(size_t numThreads, std::chrono::microseconds spinTime)
+{
+	DSPData configData = DSPData(fs, numFrames, numReverbSources, fdnSize, 2.0, 0.98, Coefficients<>(std::vector<Real>({ 125.0, 250.0, 500.0, 1e3, 2e3, 4e3, 8e3 })));
+	std::shared_ptr<DSPConfig> dspConfig = std::make_shared<DSPConfig>(configData);
+	AudioData audioData(dspConfig);
+
+	std::vector<std::unique_ptr<FDN<Complex>>> fdns(numFDNs);
+	for (int i = 0; i < numFDNs; ++i)
+	{
+		Vec<int> delayLengths(fdnSize);
+		for (int j = 0; j < fdnSize; ++j)
+			delayLengths(j) = 1009 + 97 * j + 13 * i;
+		fdns[i] = std::make_unique<FDN<Complex>>(1.0, delayLengths, dspConfig);
+		fdns[i]->SetTargetResidues(Coefficients<>::Constant(numReverbSources, 0.5));
+	}
+
+	AudioThreadPool pool(numThreads, dspConfig, spinTime);
+	Matrix<> input(numFDNs, 2 * numFrames);
+	std::vector<Buffer<>> output(numReverbSources, Buffer<>(numFrames));
+
+	const auto blockPeriod = std::chrono::microseconds(1000000 * numFrames / fs);
+	auto nextBlock = std::chrono::steady_clock::now();
+	double totalBlockTime = 0.0, maxBlockTime = 0.0;
+	const double startCpuTime = GetProcessCpuMilliseconds();
+	const auto startTime = SimpleTimer::GetCurrentTime();
+	for (int innerIteration = 0; innerIteration < executionContext.innerIterations; ++innerIteration)
+	{
+		nextBlock += blockPeriod;
+		std::this_thread::sleep_until(nextBlock);
+
+		input.RandomUniformDistribution();
+		const auto blockStart = SimpleTimer::GetCurrentTime();
+		for (int i = 0; i < numFDNs; ++i)
+#if MATRIX_LIBRARY == EIGEN_FLAG
+			fdns[i]->SubmitAudio(input.Row(i));
+#else
+			fdns[i]->SubmitAudio(input, i);
+#endif
+		for (Buffer<>& buffer : output)
+			buffer.Reset();
+		pool.ProcessFDNs(fdns, output, audioData);
+		const double blockTime = SimpleTimer::GetMilliseconds(blockStart, SimpleTimer::GetCurrentTime());
+
+		totalBlockTime += blockTime;
+		maxBlockTime = std::max(maxBlockTime, blockTime);
+	}
+	const double wallTime = SimpleTimer::GetMilliseconds(startTime, SimpleTimer::GetCurrentTime());
+	const double cpuTime = GetProcessCpuMilliseconds() - startCpuTime;
+
+	const std::string spinTimeName = spinTime == std::chrono::microseconds::max() ? "never" : std::to_string(spinTime.count());
+	return std::format("{}, {}, {:.3f}, {:.3f}, {:.2f}", numThreads, numThreads == 0 ? "-" : spinTimeName,
+		totalBlockTime / std::max(executionContext.innerIterations, 1), maxBlockTime, cpuTime / wallTime);
+}
+
+double ProfileAudioThreadWakeTest::GetProcessCpuMilliseconds()
+{
+#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0.0;
+
+	// FILETIME counts 100 ns intervals
+	const ULONGLONG kernel = (static_cast<ULONGLONG>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+	const ULONGLONG user = (static_cast<ULONGLONG>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+	return static_cast<double>(kernel + user) / 1e4;
+#else
+	// User and system time of every thread in the process
+	timespec time;
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+		return 0.0;
+	return static_cast<double>(time.tv_sec) * 1e3 + static_cast<double>(time.tv_nsec) / 1e6;
+#endif
+}
+
+void ProfileAudioThreadWake(ProfileExecutionContext& executionContext)
+{
+	ProfileAudioThreadWakeTest test(executionContext);
+	test.Run();
+}
+
+// Processes sources and their image sources (up to second order) on the AudioThreadPool at the audio callback rate for an
+// increasing number of sources, inline and with the requested number of audio threads. Reports the median, 99th percentile and
+// maximum time to process a block, as the tail decides whether the audio callback meets its deadline
+class ProfileAudioSchedulingTest
+{
+public:
+	explicit ProfileAudioSchedulingTest(ProfileExecutionContext& executionContext) : executionContext(executionContext) {}
+
+	void Run();
+
+private:
+	std::string TimeBlocks(size_t numThreads, int numSources);
+	static double Percentile(std::vector<double>& times, double percentile);
+
+	ProfileExecutionContext& executionContext;
+
+	int fs{ 48000 };
+	int numFrames{ 512 };
+	Coefficients<> frequencyBands = Coefficients<>(std::vector<Real>({ 125.0, 250.0, 500.0, 1e3, 2e3, 4e3, 8e3 }));
+
+	Vec3 roomSize = Vec3((Real)7.0, (Real)3.0, (Real)4.0);
+	Vec3 listenerPos = Vec3((Real)3.2, (Real)1.5, (Real)2.1);
+	Vec4 sourceOri = Vec4((Real)1.0, (Real)0.0, (Real)0.0, (Real)0.0);
+	std::vector<int> sourceCounts = { 1, 4, 16, 64 };
+};
+
+void ProfileAudioSchedulingTest::Run()
+{
+	const size_t numThreads = std::max(executionContext.desiredAudioThreads.value_or(std::min(8u, std::thread::hardware_concurrency())), static_cast<size_t>(1));
+
+	// Scene setup is included in each timed configuration, so only the main stage is used
+	executionContext.SetExecutionStage(ProfileExecutionStage::Init);
+	executionContext.SetExecutionStage(ProfileExecutionStage::Main);
+
+	std::vector<std::string> results;
+	for (int numSources : sourceCounts)
+	{
+		results.push_back(TimeBlocks(0, numSources));
+		results.push_back(TimeBlocks(numThreads, numSources));
+	}
+
+	executionContext.SetExecutionStage(ProfileExecutionStage::Exit);
+
+	std::cout << "Sources, Image sources, Audio threads, p50 block time (ms), p99 block time (ms), Max block time (ms)" << std::endl;
+	for (const std::string& result : results)
+		std::cout << result << std::endl;
+}
+
+std::string ProfileAudioSchedulingTest::TimeBlocks(size_t numThreads, int numSources)
+{
+	DSPData configData = DSPData(fs, numFrames, 12, 12, 2.0, 0.98, frequencyBands);
+	std::shared_ptr<DSPConfig> dspConfig = std::make_shared<DSPConfig>(configData);
+	dspConfig->UpdateDiffractionModel(DiffractionModel::attenuate);
+	dspConfig->EnableEarlyReverb(true);
+	AudioData audioData(dspConfig);
+
+	Binaural::CCore core;
+	core.SetAudioState({ fs, numFrames });
+	std::shared_ptr<Binaural::CListener> listener = core.CreateListener();
+
+	std::shared_ptr<SourceManager> sourceManager = std::make_shared<SourceManager>(&core, dspConfig);
+	sourceManager->UpdateDiffractionModel(DiffractionModel::attenuate);
+	std::shared_ptr<Room> room = std::make_shared<Room>(ToInt(frequencyBands.Length()));
+
+	size_t materialID = room->InitMaterial(Coefficients<>(std::vector<Real>({ 0.03, 0.03, 0.04, 0.06, 0.09, 0.1, 0.12 })));
+	const Real x = roomSize.x(), y = roomSize.y(), z = roomSize.z();
+	std::vector<Vertices> faces = {
+		{ Vec3(0.0, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(0.0, y, 0.0) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, 0.0), Vec3(x, y, 0.0) },
+		{ Vec3(0.0, 0.0, z), Vec3(0.0, y, z), Vec3(x, y, z) }, { Vec3(0.0, 0.0, z), Vec3(x, y, z), Vec3(x, 0.0, z) },
+		{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, z), Vec3(0.0, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, 0.0), Vec3(0.0, y, z) },
+		{ Vec3(x, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, y, z) }, { Vec3(x, 0.0, 0.0), Vec3(x, y, z), Vec3(x, y, 0.0) },
+		{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, z), Vec3(x, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, 0.0, 0.0) },
+		{ Vec3(0.0, y, 0.0), Vec3(x, y, z), Vec3(0.0, y, z) }, { Vec3(0.0, y, 0.0), Vec3(x, y, 0.0), Vec3(x, y, z) }
+	};
+	for (const Vertices& face : faces)
+	{
+		Wall wall(face, materialID);
+		size_t id = room->AddWall(wall);
+		room->InitEdges(id);
+	}
+	room->UpdatePlanes();
+	room->UpdateEdges();
+
+	// Sources spread over a grid in the room
+	std::vector<size_t> sourceIDs;
+	for (int i = 0; i < numSources; ++i)
+	{
+		int id = sourceManager->Init();
+		if (id < 0)
+			break;
+		Vec3 position((Real)(0.5 + 6.0 * (i % 4) / 3.0), (Real)(0.8 + 0.4 * (i % 3)), (Real)(0.5 + 3.0 * (i / 4) / 15.0));
+		Real distance = (position - listenerPos).Normal();
+		sourceManager->UpdateSourceDirectivity(static_cast<size_t>(id), SourceDirectivity::omni);
+		sourceManager->Update(static_cast<size_t>(id), position, sourceOri, distance);
+		sourceIDs.push_back(static_cast<size_t>(id));
+	}
+
+	// Initialises the image sources of every source (limited to MAX_IMAGESOURCES by the image source budget)
+	ImageEdge imageEdge(room, sourceManager, EarlyReverbData(DirectSound::check, 2, 0, 0, (Real)0.0, (Real)1e4), dspConfig, 1);
+	imageEdge.SetListenerPosition(listenerPos);
+	imageEdge.RunIEM();
+	size_t numImageSources = 0;
+	for (size_t id : sourceIDs)
+		numImageSources += imageEdge.GetImageSourceKeys(id).size();
+
+	audioThreadPool = std::make_unique<AudioThreadPool>(numThreads, dspConfig);
+	Buffer<> input(numFrames);
+	Buffer<> output(2 * numFrames);
+	std::vector<double> blockTimes;
+	blockTimes.reserve(executionContext.innerIterations);
+
+	std::mt19937 rng(numSources);
+	std::uniform_real_distribution<Real> distribution(-1.0, 1.0);
+	const auto blockPeriod = std::chrono::microseconds(1000000 * numFrames / fs);
+	auto nextBlock = std::chrono::steady_clock::now();
+	for (int innerIteration = 0; innerIteration < executionContext.innerIterations; ++innerIteration)
+	{
+		nextBlock += blockPeriod;
+		std::this_thread::sleep_until(nextBlock);
+
+		for (int i = 0; i < numFrames; ++i)
+			input[i] = distribution(rng);
+		const auto blockStart = SimpleTimer::GetCurrentTime();
+		for (size_t id : sourceIDs)
+			sourceManager->SetInputBuffer(id, input);
+		output.Reset();
+		sourceManager->ProcessAudio(output, audioData);
+		blockTimes.push_back(SimpleTimer::GetMilliseconds(blockStart, SimpleTimer::GetCurrentTime()));
+	}
+	audioThreadPool->Stop();
+	audioThreadPool.reset();
+
+	return std::format("{}, {}, {}, {:.3f}, {:.3f}, {:.3f}", sourceIDs.size(), numImageSources, numThreads,
+		Percentile(blockTimes, 50.0), Percentile(blockTimes, 99.0), Percentile(blockTimes, 100.0));
+}
+
+double ProfileAudioSchedulingTest::Percentile(std::vector<double>& times, double percentile)
+{
+	if (times.empty())
+		return 0.0;
+
+	// Nearest rank
+	const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * times.size()));
+	const size_t index = std::min(std::max(rank, static_cast<size_t>(1)), times.size()) - 1;
+	std::nth_element(times.begin(), times.begin() + index, times.end());
+	return times[index];
+}
+
+void ProfileAudioScheduling(ProfileExecutionContext& executionContext)
+{
+	ProfileAudioSchedulingTest test(executionContext);
+	test.Run();
+}
+
 // Common::CTimeMeasure requires using the whole profile to properly work, so just
 // create a simple class to manage the time that we want
 
@@ -682,6 +1401,11 @@ int main(int argc, const char* argv[])
 	commandLineParser.RegisterProfileTest("Shoebox", ProfileShoebox);
 	commandLineParser.RegisterProfileTest("MoDART", ProfileMoDART);
 	commandLineParser.RegisterProfileTest("MoDARTManySources", ProfileMoDARTManySources);
+	commandLineParser.RegisterProfileTest("IEMThreadScaling", ProfileIEMThreadScaling);
+	commandLineParser.RegisterProfileTest("ReflectionKernel", ProfileReflectionKernel);
+	commandLineParser.RegisterProfileTest("RayTracing", ProfileRayTracing);
+	commandLineParser.RegisterProfileTest("AudioThreadWake", ProfileAudioThreadWake);
+	commandLineParser.RegisterProfileTest("AudioScheduling", ProfileAudioScheduling);
 	if (!commandLineParser.Parse())
 		return -1;
 
@@ -717,7 +1441,8 @@ int main(int argc, const char* argv[])
 			.shadowOrder = commandLineParser.GetShadowOrder(),
 			.staticScene = commandLineParser.GetStaticSceneFlag(),
 			.useQualityHrtfs = commandLineParser.GetUseQualityHRTFs(),
-			.desiredAudioThreads = commandLineParser.GetDesiredAudioThreads()
+			.desiredAudioThreads = commandLineParser.GetDesiredAudioThreads(),
+			.desiredIEMThreads = commandLineParser.GetDesiredIEMThreads()
 		};
 
 		std::cout << "Profiling: " << executionContext.name << std::endl;
@@ -0,0 +1,63 @@
+#include "CppUnitTest.h"
+#define NOMINMAX
+// #include <windows.h>
+
+#include <vector>
+
+#include "Common/ActiveIndexList.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Common;
+
+#pragma optimize("", off)
+
+	TEST_CLASS(ActiveIndexList_Class)
+	{
+	public:
+
+		TEST_METHOD(Publish)
+		{
+			ActiveIndexList list(16);
+			Assert::IsTrue(list.Get()->empty(), L"Error: New list not empty");
+
+			// Changes are not visible until published
+			list.Add(9);
+			list.Add(2);
+			list.Add(14);
+			list.Add(2);
+			Assert::IsTrue(list.Get()->empty(), L"Error: Changes visible before Publish");
+
+			list.Publish();
+			const std::shared_ptr<const std::vector<int>> first = list.Get();
+			Assert::IsTrue(*first == std::vector<int>({ 2, 9, 14 }), L"Error: Incorrect active indices");
+
+			list.Remove(9);
+			list.Remove(3);
+			list.Add(0);
+			list.Publish();
+			Assert::IsTrue(*list.Get() == std::vector<int>({ 0, 2, 14 }), L"Error: Incorrect active indices");
+
+			// A list held by a reader is not changed by later updates
+			Assert::IsTrue(*first == std::vector<int>({ 2, 9, 14 }), L"Error: Published list changed");
+		}
+
+		TEST_METHOD(PublishUnchanged)
+		{
+			ActiveIndexList list(4);
+			list.Add(1);
+			list.Publish();
+			const std::shared_ptr<const std::vector<int>> published = list.Get();
+
+			// Publishing without changes keeps the current list
+			list.Publish();
+			Assert::IsTrue(published == list.Get(), L"Error: Unchanged list republished");
+
+			list.Add(1);
+			list.Remove(3);
+			list.Publish();
+			Assert::IsTrue(published == list.Get(), L"Error: Unchanged list republished");
+		}
+	};
+}
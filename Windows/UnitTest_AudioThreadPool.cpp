@@ -0,0 +1,462 @@
+#include "CppUnitTest.h"
+#define NOMINMAX
+// #include <windows.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+#include "UtilityFunctions.h"
+
+#include "DSP/AudioThreadPool.h"
+#include "DSP/TaskSchedule.h"
+#include "Spatialiser/FDN.h"
+#include "Spatialiser/ImageEdge.h"
+#include "Spatialiser/SourceManager.h"
+
+namespace RAC
+{
+	std::atomic<long> numHeapAllocations{ 0 };
+	std::atomic<bool> countHeapAllocations{ false };
+}
+
+#ifndef _DEBUG
+// Release CRTs have no allocation hook, so count operator new instead (direct malloc calls are missed)
+void* operator new(size_t size)
+{
+	if (RAC::countHeapAllocations.load(std::memory_order_relaxed))
+		RAC::numHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size > 0 ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+	using namespace DSP;
+
+#pragma optimize("", off)
+
+#ifdef _DEBUG
+	// Counts heap allocations on every thread while installed with _CrtSetAllocHook (debug CRT only)
+	int CountHeapAllocations(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* fileName, int lineNumber)
+	{
+		if (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC)
+			numHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+		return TRUE;
+	}
+#endif
+
+	// Counts heap allocations on every thread until StopCountingHeapAllocations is called
+	void StartCountingHeapAllocations()
+	{
+		numHeapAllocations.store(0);
+#ifdef _DEBUG
+		_CrtSetAllocHook(CountHeapAllocations);
+#else
+		countHeapAllocations.store(true);
+#endif
+	}
+
+	// Returns the number of heap allocations since StartCountingHeapAllocations was called
+	long StopCountingHeapAllocations()
+	{
+#ifdef _DEBUG
+		_CrtSetAllocHook(nullptr);
+#else
+		countHeapAllocations.store(false);
+#endif
+		return numHeapAllocations.load();
+	}
+
+	TEST_CLASS(TaskSchedule_Class)
+	{
+		// Checks every task is planned exactly once and returns the largest chunk cost
+		Real CheckSchedule(const TaskSchedule& schedule, const std::vector<Real>& costs, int numTasks)
+		{
+			std::vector<int> numRuns(numTasks, 0);
+			Real maxChunkCost = 0.0;
+			Assert::AreEqual(0, schedule.WorkerBegin(0), L"Error: First worker does not start at the first chunk");
+			for (int w = 0; w < schedule.NumWorkers(); w++)
+			{
+				Assert::IsTrue(schedule.WorkerBegin(w) <= schedule.WorkerEnd(w), L"Error: Invalid worker range");
+				Real workerCost = 0.0;
+				for (int c = schedule.WorkerBegin(w); c < schedule.WorkerEnd(w); c++)
+				{
+					const TaskSchedule::Chunk& chunk = schedule.GetChunk(c);
+					Assert::IsTrue(chunk.count > 0, L"Error: Empty chunk");
+					Real chunkCost = 0.0;
+					for (int k = chunk.first; k < chunk.first + chunk.count; k++)
+					{
+						numRuns[schedule.Order()[k]]++;
+						chunkCost += costs[schedule.Order()[k]];
+					}
+					maxChunkCost = std::max(maxChunkCost, chunkCost);
+					workerCost += chunkCost;
+				}
+				Assert::AreEqual(workerCost, schedule.WorkerCost(w), 1e-9, L"Error: Incorrect worker cost");
+			}
+			Assert::AreEqual(schedule.NumChunks(), schedule.WorkerEnd(schedule.NumWorkers() - 1), L"Error: Last worker does not end at the last chunk");
+			for (int i = 0; i < numTasks; i++)
+				Assert::AreEqual(1, numRuns[i], L"Error: Task not planned exactly once");
+			return maxChunkCost;
+		}
+
+	public:
+
+		TEST_METHOD(PlansEveryTask)
+		{
+			std::mt19937 rng(7);
+			std::uniform_real_distribution<Real> cost(0.1, 1.0);
+			TaskSchedule schedule(3, 16);
+			for (int numTasks : { 0, 1, 2, 5, 16, 100, 1000 })
+			{
+				std::vector<Real> costs(numTasks);
+				for (Real& c : costs)
+					c = cost(rng);
+				schedule.Plan(costs, numTasks);
+				CheckSchedule(schedule, costs, numTasks);
+			}
+		}
+
+		TEST_METHOD(HeavyTasksFirst)
+		{
+			// Two heavy tasks among many cheap tasks
+			std::vector<Real> costs(200, 1.0);
+			costs[150] = 500.0;
+			costs[20] = 800.0;
+			TaskSchedule schedule(4, costs.size());
+			schedule.Plan(costs, ToInt(costs.size()));
+			CheckSchedule(schedule, costs, ToInt(costs.size()));
+
+			// Each heavy task is alone in the first chunk of a worker, and the cheap tasks are grouped
+			Assert::AreEqual(1, schedule.GetChunk(schedule.WorkerBegin(0)).count, L"Error: Heavy task not alone");
+			Assert::AreEqual(20, schedule.Order()[schedule.GetChunk(schedule.WorkerBegin(0)).first], L"Error: Heaviest task not first");
+			Assert::AreEqual(1, schedule.GetChunk(schedule.WorkerBegin(1)).count, L"Error: Heavy task not alone");
+			Assert::AreEqual(150, schedule.Order()[schedule.GetChunk(schedule.WorkerBegin(1)).first], L"Error: Second heaviest task not first");
+			Assert::IsTrue(schedule.NumChunks() < 40, L"Error: Cheap tasks not grouped");
+		}
+
+		TEST_METHOD(BalancesLoad)
+		{
+			std::mt19937 rng(11);
+			std::exponential_distribution<Real> cost(1.0);
+			for (int numWorkers : { 1, 2, 3, 8 })
+			{
+				TaskSchedule schedule(numWorkers, 0);
+				for (int numTasks : { 7, 64, 300 })
+				{
+					std::vector<Real> costs(numTasks);
+					for (Real& c : costs)
+						c = cost(rng);
+					schedule.Plan(costs, numTasks);
+					const Real maxChunkCost = CheckSchedule(schedule, costs, numTasks);
+
+					// Greedy assignment: no worker exceeds another by more than one chunk
+					Real minCost = schedule.WorkerCost(0), maxCost = schedule.WorkerCost(0);
+					for (int w = 1; w < numWorkers; w++)
+					{
+						minCost = std::min(minCost, schedule.WorkerCost(w));
+						maxCost = std::max(maxCost, schedule.WorkerCost(w));
+					}
+					Assert::IsTrue(maxCost <= minCost + maxChunkCost + 1e-9, L"Error: Unbalanced schedule");
+				}
+			}
+		}
+
+		TEST_METHOD(UnknownCosts)
+		{
+			// Unknown costs are replaced by the mean known cost
+			std::vector<Real> costs(50, 0.0);
+			TaskSchedule schedule(2, costs.size());
+			schedule.Plan(costs, ToInt(costs.size()));
+			CheckSchedule(schedule, std::vector<Real>(costs.size(), 1.0), ToInt(costs.size()));
+			Assert::AreEqual(50.0, schedule.WorkerCost(0) + schedule.WorkerCost(1), 1e-9, L"Error: Incorrect cost of unknown tasks");
+
+			costs[0] = 4.0;
+			costs[1] = 2.0;
+			schedule.Plan(costs, ToInt(costs.size()));
+			Assert::AreEqual(150.0, schedule.WorkerCost(0) + schedule.WorkerCost(1), 1e-9, L"Error: Incorrect cost of unknown tasks");
+		}
+	};
+
+	TEST_CLASS(AudioThreadPool_Class)
+	{
+		// Enabled FDNs with non-zero residues, so every task writes to the reverb output
+		std::vector<std::unique_ptr<FDN<Complex>>> CreateFDNs(int numFDNs, const std::shared_ptr<DSPConfig>& config)
+		{
+			const int fdnSize = config->GetData().fdnSize;
+			const Coefficients<> residues = Coefficients<>::Constant(config->GetData().numReverbSources, REAL_CONST(0.5));
+
+			std::vector<std::unique_ptr<FDN<Complex>>> fdns(numFDNs);
+			for (int i = 0; i < numFDNs; i++)
+			{
+				Vec<int> delayLengths(fdnSize);
+				for (int j = 0; j < fdnSize; j++)
+					delayLengths(j) = 101 + 37 * j + 13 * i;
+
+				fdns[i] = std::make_unique<FDN<Complex>>(REAL_CONST(0.5) + REAL_CONST(0.1) * i, delayLengths, config);
+				fdns[i]->SetMinimumReverbTime(REAL_CONST(0.0));
+				fdns[i]->SetTargetResidues(residues);
+			}
+			return fdns;
+		}
+
+		void SubmitAudio(std::vector<std::unique_ptr<FDN<Complex>>>& fdns, const Matrix<>& input)
+		{
+			for (int i = 0; i < ToInt(fdns.size()); i++)
+#if MATRIX_LIBRARY == EIGEN_FLAG
+				fdns[i]->SubmitAudio(input.Row(i));
+#else
+				fdns[i]->SubmitAudio(input, i);
+#endif
+		}
+
+		void ResetBuffers(std::vector<Buffer<>>& buffers)
+		{
+			for (Buffer<>& buffer : buffers)
+				buffer.Reset();
+		}
+
+		// Sources and the image sources found by the image edge model. The core is referenced by the source manager, so a scene must not be moved
+		struct SourceScene
+		{
+			Binaural::CCore core;
+			std::shared_ptr<Binaural::CListener> listener;
+			std::shared_ptr<SourceManager> sourceManager;
+			std::shared_ptr<Room> room;
+			std::vector<size_t> sourceIDs;
+		};
+
+		// Shoebox room with sources spread over a grid and their image sources up to second order
+		std::unique_ptr<SourceScene> CreateSourceScene(int numSources, const std::shared_ptr<DSPConfig>& config)
+		{
+			const DSPData& data = config->GetData();
+			std::unique_ptr<SourceScene> scene = std::make_unique<SourceScene>();
+			scene->core.SetAudioState({ data.fs, data.numFrames });
+			scene->listener = scene->core.CreateListener();
+			scene->sourceManager = std::make_shared<SourceManager>(&scene->core, config);
+			scene->room = std::make_shared<Room>(data.numFrequencyBands);
+
+			size_t materialID = scene->room->InitMaterial(Coefficients<>::Constant(data.numFrequencyBands, REAL_CONST(0.2)));
+			const Real x = 7.0, y = 3.0, z = 4.0;
+			std::vector<Vertices> faces = {
+				{ Vec3(0.0, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(0.0, y, 0.0) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, 0.0), Vec3(x, y, 0.0) },
+				{ Vec3(0.0, 0.0, z), Vec3(0.0, y, z), Vec3(x, y, z) }, { Vec3(0.0, 0.0, z), Vec3(x, y, z), Vec3(x, 0.0, z) },
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, z), Vec3(0.0, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, 0.0), Vec3(0.0, y, z) },
+				{ Vec3(x, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, y, z) }, { Vec3(x, 0.0, 0.0), Vec3(x, y, z), Vec3(x, y, 0.0) },
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, z), Vec3(x, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, 0.0, 0.0) },
+				{ Vec3(0.0, y, 0.0), Vec3(x, y, z), Vec3(0.0, y, z) }, { Vec3(0.0, y, 0.0), Vec3(x, y, 0.0), Vec3(x, y, z) }
+			};
+			for (const Vertices& face : faces)
+			{
+				Wall wall(face, materialID);
+				size_t id = scene->room->AddWall(wall);
+				scene->room->InitEdges(id);
+			}
+			scene->room->UpdatePlanes();
+			scene->room->UpdateEdges();
+
+			const Vec3 listenerPosition(3.2, 1.5, 2.1);
+			for (int i = 0; i < numSources; i++)
+			{
+				int id = scene->sourceManager->Init();
+				Assert::IsTrue(id >= 0, L"Error: Failed to initialise source");
+				Vec3 position(0.5 + 6.0 * (i % 4) / 3.0, 0.8 + 0.4 * (i % 3), 0.5 + 3.0 * (i / 4) / 3.0);
+				Real distance = (position - listenerPosition).Normal();
+				scene->sourceManager->UpdateSourceDirectivity(static_cast<size_t>(id), SourceDirectivity::omni);
+				scene->sourceManager->Update(static_cast<size_t>(id), position, Vec4(1.0, 0.0, 0.0, 0.0), distance);
+				scene->sourceIDs.push_back(static_cast<size_t>(id));
+			}
+
+			// Initialises the image sources of every source in the source manager
+			ImageEdge imageEdge(scene->room, scene->sourceManager, EarlyReverbData(DirectSound::check, 2, 0, 0, 0.0, 1e4), config, 1);
+			imageEdge.SetListenerPosition(listenerPosition);
+			imageEdge.RunIEM();
+
+			size_t numImageSources = 0;
+			for (const size_t id : scene->sourceIDs)
+				numImageSources += imageEdge.GetImageSourceKeys(id).size();
+			Assert::IsTrue(numImageSources > 0, L"Error: No image sources");
+			return scene;
+		}
+
+	public:
+
+		TEST_METHOD(MatchesInline)
+		{
+			const std::shared_ptr<DSPConfig> config = std::make_shared<DSPConfig>();
+			AudioData audioData(config);
+			const int numFrames = config->GetData().numFrames;
+			const int numReverbSources = config->GetData().numReverbSources;
+			const int numFDNs = 7;
+
+			std::vector<std::unique_ptr<FDN<Complex>>> inlineFDNs = CreateFDNs(numFDNs, config);
+			std::vector<std::unique_ptr<FDN<Complex>>> pooledFDNs = CreateFDNs(numFDNs, config);
+			AudioThreadPool inlinePool(0, config);
+			AudioThreadPool pool(3, config);
+
+			Matrix<> input(numFDNs, 2 * numFrames);
+			std::vector<Buffer<>> inlineOutput(numReverbSources, Buffer<>(numFrames));
+			std::vector<Buffer<>> pooledOutput(numReverbSources, Buffer<>(numFrames));
+			Real energy = 0.0;
+			for (int block = 0; block < 10; block++)
+			{
+				input.RandomUniformDistribution();
+				SubmitAudio(inlineFDNs, input);
+				SubmitAudio(pooledFDNs, input);
+				ResetBuffers(inlineOutput);
+				ResetBuffers(pooledOutput);
+
+				inlinePool.ProcessFDNs(inlineFDNs, inlineOutput, audioData);
+				pool.ProcessFDNs(pooledFDNs, pooledOutput, audioData);
+
+				// Tasks are summed per thread, so the order of additions may differ
+				for (int i = 0; i < numReverbSources; i++)
+				{
+					for (int j = 0; j < numFrames; j++)
+					{
+						Assert::AreEqual(inlineOutput[i][j], pooledOutput[i][j], 1e-12, L"Error: Pooled output differs from inline output");
+						energy += inlineOutput[i][j] * inlineOutput[i][j];
+					}
+				}
+			}
+			Assert::AreNotEqual(0.0, energy, L"Error: Output is zero");
+		}
+
+		TEST_METHOD(WakesParkedWorkers)
+		{
+			const std::shared_ptr<DSPConfig> config = std::make_shared<DSPConfig>();
+			AudioData audioData(config);
+			const int numFrames = config->GetData().numFrames;
+			const int numReverbSources = config->GetData().numReverbSources;
+			const int numFDNs = 7;
+
+			std::vector<std::unique_ptr<FDN<Complex>>> inlineFDNs = CreateFDNs(numFDNs, config);
+			std::vector<std::unique_ptr<FDN<Complex>>> pooledFDNs = CreateFDNs(numFDNs, config);
+			AudioThreadPool inlinePool(0, config);
+			AudioThreadPool pool(3, config, std::chrono::microseconds(0));
+
+			Matrix<> input(numFDNs, 2 * numFrames);
+			std::vector<Buffer<>> inlineOutput(numReverbSources, Buffer<>(numFrames));
+			std::vector<Buffer<>> pooledOutput(numReverbSources, Buffer<>(numFrames));
+			for (int block = 0; block < 10; block++)
+			{
+				// Workers do not spin, so they are parked before every block
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+				input.RandomUniformDistribution();
+				SubmitAudio(inlineFDNs, input);
+				SubmitAudio(pooledFDNs, input);
+				ResetBuffers(inlineOutput);
+				ResetBuffers(pooledOutput);
+
+				inlinePool.ProcessFDNs(inlineFDNs, inlineOutput, audioData);
+				pool.ProcessFDNs(pooledFDNs, pooledOutput, audioData);
+
+				for (int i = 0; i < numReverbSources; i++)
+				{
+					for (int j = 0; j < numFrames; j++)
+						Assert::AreEqual(inlineOutput[i][j], pooledOutput[i][j], 1e-12, L"Error: Pooled output differs from inline output");
+				}
+			}
+			pool.Stop();
+		}
+
+		TEST_METHOD(NoAllocations)
+		{
+			const std::shared_ptr<DSPConfig> config = std::make_shared<DSPConfig>();
+			AudioData audioData(config);
+			const int numFrames = config->GetData().numFrames;
+			const int numReverbSources = config->GetData().numReverbSources;
+			const int numFDNs = 7;
+
+			for (const size_t numThreads : { 0, 1, 3 })
+			{
+				std::vector<std::unique_ptr<FDN<Complex>>> fdns = CreateFDNs(numFDNs, config);
+				AudioThreadPool pool(numThreads, config);
+
+				Matrix<> input(numFDNs, 2 * numFrames);
+				input.RandomUniformDistribution();
+				std::vector<Buffer<>> output(numReverbSources, Buffer<>(numFrames));
+
+				// Warm up: the first block may allocate (e.g. queue blocks requisitioned by the producer)
+				for (int block = 0; block < 2; block++)
+				{
+					SubmitAudio(fdns, input);
+					pool.ProcessFDNs(fdns, output, audioData);
+				}
+
+				StartCountingHeapAllocations();
+				for (int block = 0; block < 100; block++)
+				{
+					SubmitAudio(fdns, input);
+					ResetBuffers(output);
+					pool.ProcessFDNs(fdns, output, audioData);
+				}
+				const long numAllocations = StopCountingHeapAllocations();
+
+				Assert::AreEqual(0L, numAllocations, L"Error: Audio processing allocated memory");
+			}
+		}
+
+		TEST_METHOD(NoAllocationsAllSources)
+		{
+			const std::shared_ptr<DSPConfig> config = std::make_shared<DSPConfig>(DSPData(48000, 256, 12, 12, 2.0, 0.98, Coefficients<>(std::vector<Real>({ 250.0, 1e3, 4e3 }))));
+			config->EnableEarlyReverb(true);
+			AudioData audioData(config);
+			const int numFrames = config->GetData().numFrames;
+
+			for (const size_t numThreads : { 0, 1, 3 })
+			{
+				std::unique_ptr<SourceScene> scene = CreateSourceScene(8, config);
+
+				// Sources are processed by the global pool
+				audioThreadPool = std::make_unique<AudioThreadPool>(numThreads, config);
+
+				Buffer<> input(numFrames);
+				for (int i = 0; i < numFrames; i++)
+					input[i] = i % 2 == 0 ? REAL_CONST(0.5) : REAL_CONST(-0.5);
+				Buffer<> output(2 * numFrames);
+
+				// Warm up: the first blocks may allocate (e.g. queue blocks requisitioned by the producer)
+				for (int block = 0; block < 2; block++)
+				{
+					for (const size_t id : scene->sourceIDs)
+						scene->sourceManager->SetInputBuffer(id, input);
+					scene->sourceManager->ProcessAudio(output, audioData);
+				}
+
+				StartCountingHeapAllocations();
+				for (int block = 0; block < 100; block++)
+				{
+					for (const size_t id : scene->sourceIDs)
+						scene->sourceManager->SetInputBuffer(id, input);
+					output.Reset();
+					scene->sourceManager->ProcessAudio(output, audioData);
+				}
+				const long numAllocations = StopCountingHeapAllocations();
+
+				audioThreadPool->Stop();
+				audioThreadPool.reset();
+				Assert::AreEqual(0L, numAllocations, L"Error: Source processing allocated memory");
+
+				Real energy = 0.0;
+				for (int i = 0; i < output.Length(); i++)
+					energy += output[i] * output[i];
+				Assert::AreNotEqual(0.0, energy, L"Error: Output is zero");
+			}
+		}
+	};
+}
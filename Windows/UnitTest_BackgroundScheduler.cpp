@@ -0,0 +1,104 @@
+#include "CppUnitTest.h"
+#define NOMINMAX
+// #include <windows.h>
+
+#include <thread>
+#include <atomic>
+
+#include "Common/BackgroundScheduler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Common;
+
+#pragma optimize("", off)
+
+	TEST_CLASS(BackgroundScheduler_Class)
+	{
+	public:
+
+		TEST_METHOD(Coalesce)
+		{
+			BackgroundScheduler scheduler;
+			const size_t task = scheduler.AddTask(std::chrono::milliseconds(0), std::chrono::milliseconds(0));
+
+			// A new task runs once without being notified
+			Assert::IsTrue(scheduler.WaitForWork(task), L"Error: Initial run");
+			scheduler.Finish(task);
+
+			// Notifications before the next run are combined
+			scheduler.Notify(task);
+			scheduler.Notify(task);
+			scheduler.Notify(task);
+
+			std::atomic<int> numRuns{ 0 };
+			std::thread worker([&]()
+				{
+					while (scheduler.WaitForWork(task))
+					{
+						numRuns.fetch_add(1);
+						scheduler.Finish(task);
+					}
+				});
+
+			Assert::IsTrue(scheduler.WaitForRun(task), L"Error: Run not completed");
+			const int runs = numRuns.load();
+			Assert::IsTrue(runs >= 1 && runs <= 2, L"Error: Notifications not coalesced");
+
+			// No further runs without notifications
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			Assert::AreEqual(runs, numRuns.load(), L"Error: Task ran without notification");
+
+			scheduler.Stop();
+			worker.join();
+		}
+
+		TEST_METHOD(Intervals)
+		{
+			BackgroundScheduler scheduler;
+			const size_t task = scheduler.AddTask(std::chrono::milliseconds(20), std::chrono::milliseconds(40));
+
+			using Clock = BackgroundScheduler::Clock;
+			Assert::IsTrue(scheduler.WaitForWork(task), L"Error: Initial run");
+			Clock::time_point start = Clock::now();
+			scheduler.Finish(task);
+
+			// Notified runs wait for the minimum interval
+			scheduler.Notify(task);
+			Assert::IsTrue(scheduler.WaitForWork(task), L"Error: Notified run");
+			Clock::time_point end = Clock::now();
+			scheduler.Finish(task);
+			Assert::IsTrue(end - start >= std::chrono::milliseconds(20), L"Error: Minimum interval");
+
+			// Periodic runs happen after the maximum interval
+			start = end;
+			Assert::IsTrue(scheduler.WaitForWork(task), L"Error: Periodic run");
+			end = Clock::now();
+			scheduler.Finish(task);
+			Assert::IsTrue(end - start >= std::chrono::milliseconds(40), L"Error: Maximum interval");
+		}
+
+		TEST_METHOD(Stop)
+		{
+			BackgroundScheduler scheduler;
+			const size_t task = scheduler.AddTask(std::chrono::milliseconds(0), std::chrono::milliseconds(0));
+			Assert::IsTrue(scheduler.WaitForWork(task), L"Error: Initial run");
+			scheduler.Finish(task);
+
+			std::atomic<bool> exited{ false };
+			std::thread worker([&]()
+				{
+					while (scheduler.WaitForWork(task))
+						scheduler.Finish(task);
+					exited.store(true);
+				});
+
+			scheduler.Stop();
+			worker.join();
+			Assert::IsTrue(exited.load(), L"Error: Worker not stopped");
+			Assert::IsTrue(scheduler.IsStopped(), L"Error: Scheduler not stopped");
+			Assert::IsFalse(scheduler.WaitForRun(task), L"Error: Run completed after stop");
+		}
+	};
+}
@@ -73,6 +73,70 @@ namespace RAC
 				}
 			}
 		}
+
+		TEST_METHOD(GenelecInterpolatedDirectivity)
+		{
+			auto inputData = Parse2Dcsv<Real>(filePath + "genelecDirectivityInput.csv");
+			auto outputData = Parse2Dcsv<Real>(filePath + "genelecDirectivityOutput.csv");
+			auto inputFreq = Parse2Dcsv<Real>(filePath + "directivityFreq.csv");
+
+			TestInterpolatedResponse(GENELEC, inputData, outputData, inputFreq[0]);
+		}
+
+		TEST_METHOD(GenelecDTFInterpolatedDirectivity)
+		{
+			auto inputData = Parse2Dcsv<Real>(filePath + "genelecDirectivityInput.csv");
+			auto outputData = Parse2Dcsv<Real>(filePath + "genelecDTFDirectivityOutput.csv");
+			auto inputFreq = Parse2Dcsv<Real>(filePath + "directivityFreq.csv");
+
+			TestInterpolatedResponse(GENELEC_DTF, inputData, outputData, inputFreq[0]);
+		}
+
+		TEST_METHOD(QSCK8InterpolatedDirectivity)
+		{
+			// No reference data, so compare against the exact response over the sphere
+			std::vector<Real> freq = { 62.5, 125.0, 250.0, 500.0, 1e3, 2e3, 4e3, 8e3, 16e3 };
+			for (int i = 0; i <= 36; i++)
+			{
+				for (int j = 0; j < 72; j++)
+				{
+					Real theta = PI_1 * i / 36.0 + 0.01;
+					Real phi = PI_2 * j / 72.0 + 0.01;
+					Vec3 direction = Vec3(std::sin(theta) * std::sin(-phi), std::sin(theta) * std::cos(-phi), std::cos(theta));
+					Coefficients<> exact = QSC_K8.Response(freq, direction);
+					Coefficients<> interpolated = QSC_K8.InterpolatedResponse(freq, direction);
+
+					for (int k = 0; k < freq.size(); k++)
+						Assert::AreEqual(exact[k], interpolated[k], EPS_INTERPOLATED, L"Incorrect interpolated directivity");
+				}
+			}
+		}
+
+	private:
+
+		// Maximum error of the directivity lookup table
+		static constexpr Real EPS_INTERPOLATED = 5e-3;
+
+		void TestInterpolatedResponse(const Directivity& directivity, const std::vector<std::vector<Real>>& inputData, const std::vector<std::vector<Real>>& outputData, const std::vector<Real>& freq)
+		{
+			std::vector<Real> theta(inputData[0]);
+			std::vector<Real> phi(inputData[1]);
+
+			int numTests = ToInt(theta.size());
+			for (int i = 0; i < numTests; i++)
+			{
+				Vec3 direction = Vec3(std::sin(theta[i]) * std::sin(-phi[i]), std::sin(theta[i]) * std::cos(-phi[i]), std::cos(theta[i]));
+				Coefficients<> response = directivity.InterpolatedResponse(freq, direction);
+
+				for (int j = 0; j < freq.size(); j++)
+				{
+					std::string error = "Test: " + ToStr(i) + ", Incorrect Frequency : " + ToStr(freq[j]);
+					std::wstring werror = std::wstring(error.begin(), error.end());
+					const wchar_t* werrorchar = werror.c_str();
+					Assert::AreEqual(outputData[i][j], response[j], EPS_INTERPOLATED, werrorchar);
+				}
+			}
+		}
 	};
 #pragma optimize("", on)
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "CppUnitTest.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/Edge.h"
+#include "Spatialiser/EdgeBVH.h"
+
+#include <random>
+#include <algorithm>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(EdgeBVHTests)
+	{
+		// Distance from a point to the closest point on an edge
+		Real distanceToEdge(const Edge& edge, const Vec3& point)
+		{
+			const Real z = std::clamp(edge.GetAP(point).dot(edge.GetEdgeVector()), REAL_CONST(0.0), edge.GetLength());
+			return (point - edge.GetEdgeCoord(z)).Normal();
+		}
+
+	public:
+
+		TEST_METHOD(FindEdgesNear)
+		{
+			std::mt19937 rng(23);
+			std::uniform_real_distribution<Real> coordinate(-20.0, 20.0);
+			std::uniform_real_distribution<Real> distance(0.0, 15.0);
+
+			std::vector<Edge> edges;
+			for (int i = 0; i < 500; ++i)
+			{
+				const Vec3 base(coordinate(rng), coordinate(rng), coordinate(rng));
+				const Vec3 top = base + Vec3(0.1 * coordinate(rng), 0.1 * coordinate(rng), 0.1 * coordinate(rng));
+				edges.emplace_back(base, top, Vec3(1.0, 0.0, 0.0), Vec3(0.0, 1.0, 0.0), 2 * i, 2 * i + 1, 2 * i, 2 * i + 1);
+			}
+
+			EdgeBVH bvh;
+			bvh.Build(edges);
+			Assert::AreEqual(edges.size(), bvh.Size(), L"Incorrect number of edges");
+
+			std::vector<size_t> edgeIndices;
+			for (int test = 0; test < 200; ++test)
+			{
+				const Vec3 point(coordinate(rng), coordinate(rng), coordinate(rng));
+				const Real maxDistance = distance(rng);
+				bvh.FindEdgesNear(point, maxDistance, edgeIndices);
+
+				Assert::IsTrue(std::is_sorted(edgeIndices.begin(), edgeIndices.end()), L"Edge indices not sorted");
+				for (size_t i = 0; i < edges.size(); ++i)
+				{
+					const bool found = std::binary_search(edgeIndices.begin(), edgeIndices.end(), i);
+					if (distanceToEdge(edges[i], point) <= maxDistance)
+						Assert::IsTrue(found, L"Edge within distance not found");
+				}
+			}
+
+			// Empty tree
+			bvh.Build(std::vector<Edge>());
+			bvh.FindEdgesNear(Vec3(0.0, 0.0, 0.0), 1e10, edgeIndices);
+			Assert::IsTrue(edgeIndices.empty(), L"Empty BVH returned edges");
+		}
+	};
+}
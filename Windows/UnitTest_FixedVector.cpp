@@ -0,0 +1,120 @@
+#include "CppUnitTest.h"
+
+#include "Common/Definitions.h"
+#include "Common/FixedVector.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Common;
+
+	TEST_CLASS(FixedVectorTests)
+	{
+	public:
+
+		TEST_METHOD(EmplaceAndClear)
+		{
+			FixedVector<int, 4> vector;
+			Assert::IsTrue(vector.empty(), L"Default vector not empty");
+			Assert::AreEqual(static_cast<size_t>(4), vector.capacity(), L"Incorrect capacity");
+
+			for (int i = 0; i < 4; ++i)
+			{
+				Assert::AreEqual(i, vector.emplace_back(i), L"Incorrect emplaced element");
+				Assert::AreEqual(static_cast<size_t>(i + 1), vector.size(), L"Incorrect size");
+				Assert::AreEqual(i, vector.back(), L"Incorrect back element");
+			}
+
+			int expected = 0;
+			for (const int x : vector)
+				Assert::AreEqual(expected++, x, L"Incorrect iterated element");
+			Assert::AreEqual(4, expected, L"Incorrect number of iterated elements");
+
+			vector.clear();
+			Assert::IsTrue(vector.empty(), L"Cleared vector not empty");
+			Assert::IsTrue(vector.begin() == vector.end(), L"Cleared vector not empty range");
+
+			// The storage is reused after clearing
+			vector.emplace_back(7);
+			Assert::AreEqual(static_cast<size_t>(1), vector.size(), L"Incorrect size after clear");
+			Assert::AreEqual(7, vector[0], L"Incorrect element after clear");
+		}
+
+		TEST_METHOD(FillConstructor)
+		{
+			FixedVector<Real, 8> vector(3, 2.5);
+			Assert::AreEqual(static_cast<size_t>(3), vector.size(), L"Incorrect size");
+			for (const Real x : vector)
+				Assert::AreEqual(2.5, x, L"Incorrect element");
+		}
+
+		TEST_METHOD(CopyUsedElements)
+		{
+			FixedVector<std::vector<int>, 4> vector;
+			vector.emplace_back(std::vector<int>({ 1, 2 }));
+			vector.emplace_back(std::vector<int>({ 3 }));
+
+			FixedVector<std::vector<int>, 4> copy(vector);
+			Assert::AreEqual(static_cast<size_t>(2), copy.size(), L"Incorrect copied size");
+			Assert::IsTrue(copy[0] == vector[0] && copy[1] == vector[1], L"Incorrect copied elements");
+
+			// Copies are independent
+			copy[0].push_back(4);
+			Assert::AreEqual(static_cast<size_t>(2), vector[0].size(), L"Copy shares elements");
+
+			// Assigning a shorter vector only keeps its elements
+			FixedVector<std::vector<int>, 4> shorter;
+			shorter.emplace_back(std::vector<int>({ 5 }));
+			copy = shorter;
+			Assert::AreEqual(static_cast<size_t>(1), copy.size(), L"Incorrect assigned size");
+			Assert::IsTrue(copy[0] == shorter[0], L"Incorrect assigned element");
+
+			copy = vector;
+			Assert::AreEqual(static_cast<size_t>(2), copy.size(), L"Incorrect reassigned size");
+			Assert::IsTrue(copy[0] == vector[0] && copy[1] == vector[1], L"Incorrect reassigned elements");
+		}
+
+		TEST_METHOD(GrowBeyondCapacity)
+		{
+			FixedVector<int, 2> vector;
+			vector.emplace_back(0);
+			vector.emplace_back(1);
+
+			// Emplace a copy of an existing element while the elements move to the heap
+			Assert::AreEqual(1, vector.emplace_back(vector[1]), L"Incorrect element emplaced from the vector");
+			vector[2] = 2;
+			vector.emplace_back(3);
+			vector.emplace_back(4);
+			Assert::IsTrue(vector.OnHeap(), L"Vector not on the heap");
+			Assert::AreEqual(static_cast<size_t>(5), vector.size(), L"Incorrect size");
+			int expected = 0;
+			for (const int x : vector)
+				Assert::AreEqual(expected++, x, L"Incorrect iterated element");
+			Assert::AreEqual(4, vector.back(), L"Incorrect back element");
+
+			// Copies of a vector on the heap keep all elements
+			FixedVector<int, 2> copy(vector);
+			Assert::AreEqual(static_cast<size_t>(5), copy.size(), L"Incorrect copied size");
+			for (int i = 0; i < 5; ++i)
+				Assert::AreEqual(i, copy[i], L"Incorrect copied element");
+
+			// The vector returns to the inline storage once cleared
+			copy.clear();
+			copy.emplace_back(8);
+			Assert::IsFalse(copy.OnHeap(), L"Cleared vector on the heap");
+			Assert::AreEqual(8, copy[0], L"Incorrect element after clear");
+
+			FixedVector<int, 2> filled(3, 6);
+			Assert::IsTrue(filled.OnHeap(), L"Filled vector not on the heap");
+			for (const int x : filled)
+				Assert::AreEqual(6, x, L"Incorrect filled element");
+
+			vector = filled;
+			Assert::AreEqual(static_cast<size_t>(3), vector.size(), L"Incorrect assigned size");
+			for (const int x : vector)
+				Assert::AreEqual(6, x, L"Incorrect assigned element");
+		}
+	};
+}
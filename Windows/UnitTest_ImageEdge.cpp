@@ -0,0 +1,382 @@
+#include "CppUnitTest.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/ImageEdge.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(ImageEdgeTests)
+	{
+		typedef std::unordered_set<ImageSourceKey, ImageSourceKeyHash> KeySet;
+
+		const int fs = 48000;
+		const int numFrames = 256;
+		const Coefficients<> frequencyBands = Coefficients<>(std::vector<Real>({ 250.0, 1e3, 4e3 }));
+		const Vec3 listenerPosition = Vec3(3.2, 1.5, 2.1);
+
+		// Everything an image edge model needs. The core is referenced by the source manager, so a scene must not be moved
+		struct Scene
+		{
+			Binaural::CCore core;
+			std::shared_ptr<Binaural::CListener> listener;
+			std::shared_ptr<DSPConfig> dspConfig;
+			std::shared_ptr<SourceManager> sourceManager;
+			std::shared_ptr<Room> room;
+			std::vector<size_t> sourceIDs;
+		};
+
+		// Shoebox (walls facing inwards) with a free standing two sided partition to add diffraction paths and obstructions
+		std::unique_ptr<Scene> createScene(const int numSources, const DiffractionModel model = DiffractionModel::attenuate)
+		{
+			std::unique_ptr<Scene> scene = std::make_unique<Scene>();
+			scene->dspConfig = std::make_shared<DSPConfig>(DSPData(fs, numFrames, 12, 12, 2.0, 0.98, frequencyBands));
+			scene->dspConfig->UpdateDiffractionModel(model);
+
+			scene->core.SetAudioState({ fs, numFrames });
+			scene->listener = scene->core.CreateListener();
+
+			scene->sourceManager = std::make_shared<SourceManager>(&scene->core, scene->dspConfig);
+			scene->sourceManager->UpdateDiffractionModel(model);
+			scene->room = std::make_shared<Room>(ToInt(frequencyBands.Length()));
+
+			size_t materialID = scene->room->InitMaterial(Coefficients<>(std::vector<Real>({ 0.1, 0.2, 0.3 })));
+			const Real x = 7.0, y = 3.0, z = 4.0;
+			std::vector<Vertices> faces = {
+				{ Vec3(0.0, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(0.0, y, 0.0) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, 0.0), Vec3(x, y, 0.0) },
+				{ Vec3(0.0, 0.0, z), Vec3(0.0, y, z), Vec3(x, y, z) }, { Vec3(0.0, 0.0, z), Vec3(x, y, z), Vec3(x, 0.0, z) },
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, z), Vec3(0.0, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, 0.0), Vec3(0.0, y, z) },
+				{ Vec3(x, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, y, z) }, { Vec3(x, 0.0, 0.0), Vec3(x, y, z), Vec3(x, y, 0.0) },
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, z), Vec3(x, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, 0.0, 0.0) },
+				{ Vec3(0.0, y, 0.0), Vec3(x, y, z), Vec3(0.0, y, z) }, { Vec3(0.0, y, 0.0), Vec3(x, y, 0.0), Vec3(x, y, z) },
+				{ Vec3(4.5, 0.0, 1.0), Vec3(4.5, 2.0, 3.0), Vec3(4.5, 0.0, 3.0) }, { Vec3(4.5, 0.0, 1.0), Vec3(4.5, 2.0, 1.0), Vec3(4.5, 2.0, 3.0) },
+				{ Vec3(4.5, 0.0, 1.0), Vec3(4.5, 0.0, 3.0), Vec3(4.5, 2.0, 3.0) }, { Vec3(4.5, 0.0, 1.0), Vec3(4.5, 2.0, 3.0), Vec3(4.5, 2.0, 1.0) }
+			};
+			for (const Vertices& face : faces)
+			{
+				Wall wall(face, materialID);
+				size_t id = scene->room->AddWall(wall);
+				scene->room->InitEdges(id);
+			}
+			scene->room->UpdatePlanes();
+			scene->room->UpdateEdges();
+
+			// Sources spread over a grid in the room, some of them behind the partition
+			for (int i = 0; i < numSources; ++i)
+			{
+				int id = scene->sourceManager->Init();
+				Assert::IsTrue(id >= 0, L"Failed to initialise source");
+				Vec3 position(0.5 + 6.0 * (i % 4) / 3.0, 0.8 + 0.4 * (i % 3), 0.5 + 3.0 * (i / 4) / 3.0);
+				Real distance = (position - listenerPosition).Normal();
+				scene->sourceManager->UpdateSourceDirectivity(static_cast<size_t>(id), SourceDirectivity::omni);
+				scene->sourceManager->Update(static_cast<size_t>(id), position, Vec4(1.0, 0.0, 0.0, 0.0), distance);
+				scene->sourceIDs.push_back(static_cast<size_t>(id));
+			}
+			return scene;
+		}
+
+		// Keys handed to the source manager by the last run of a freshly created image edge model
+		std::vector<KeySet> referenceKeys(const EarlyReverbData& data, const int numSources, const Vec3& position, const size_t numThreads = 1)
+		{
+			std::unique_ptr<Scene> scene = createScene(numSources);
+			ImageEdge imageEdge(scene->room, scene->sourceManager, data, scene->dspConfig, numThreads);
+			imageEdge.SetListenerPosition(position);
+			imageEdge.RunIEM();
+
+			std::vector<KeySet> keys;
+			for (const size_t id : scene->sourceIDs)
+				keys.push_back(imageEdge.GetImageSourceKeys(id));
+			return keys;
+		}
+
+		void assertKeys(const std::vector<KeySet>& expected, const ImageEdge& imageEdge, const Scene& scene, const wchar_t* message)
+		{
+			Assert::AreEqual(expected.size(), scene.sourceIDs.size(), L"Incorrect number of sources");
+			for (size_t i = 0; i < expected.size(); ++i)
+				Assert::IsTrue(expected[i] == imageEdge.GetImageSourceKeys(scene.sourceIDs[i]), message);
+		}
+
+		std::vector<KeySet> getKeys(const ImageEdge& imageEdge, const Scene& scene)
+		{
+			std::vector<KeySet> keys;
+			for (const size_t id : scene.sourceIDs)
+				keys.push_back(imageEdge.GetImageSourceKeys(id));
+			return keys;
+		}
+
+		void moveSource(Scene& scene, const size_t idx, const Vec3& position)
+		{
+			Real distance = (position - listenerPosition).Normal();
+			scene.sourceManager->Update(scene.sourceIDs[idx], position, Vec4(1.0, 0.0, 0.0, 0.0), distance);
+		}
+
+		size_t countKeys(const std::vector<KeySet>& keys)
+		{
+			size_t numKeys = 0;
+			for (const KeySet& sourceKeys : keys)
+				numKeys += sourceKeys.size();
+			return numKeys;
+		}
+
+		bool isSubset(const std::vector<KeySet>& keys, const std::vector<KeySet>& superset)
+		{
+			Assert::AreEqual(superset.size(), keys.size(), L"Incorrect number of sources");
+			for (size_t i = 0; i < keys.size(); ++i)
+			{
+				for (const ImageSourceKey& key : keys[i])
+				{
+					if (superset[i].find(key) == superset[i].end())
+						return false;
+				}
+			}
+			return true;
+		}
+
+	public:
+
+		TEST_METHOD(RepeatedRuns)
+		{
+			const int numSources = 8;
+			EarlyReverbData data(DirectSound::check, 3, 2, 1, 0.0, 1e4);
+			std::unique_ptr<Scene> scene = createScene(numSources);
+			ImageEdge imageEdge(scene->room, scene->sourceManager, data, scene->dspConfig);
+
+			// Steps within the tree margin reuse the image source trees (and make paths appear and disappear), larger steps rebuild them.
+			// Each run must hand over the same image sources as a model that has only run once.
+			// The steps avoid paths that graze an edge, where the two can round differently
+			for (const Real step : { 0.0, 0.23, 0.41, 0.19, -0.07, -0.29, -0.43, 1.03, 1.17, 0.0 })
+			{
+				const Vec3 position = listenerPosition + Vec3(step, 0.37 * step, -0.23 * step);
+				imageEdge.SetListenerPosition(position);
+				imageEdge.RunIEM();
+
+				std::vector<KeySet> expected = referenceKeys(data, numSources, position);
+				size_t numImageSources = 0;
+				for (const KeySet& keys : expected)
+					numImageSources += keys.size();
+				Assert::IsTrue(numImageSources > 0, L"No image sources found");
+				assertKeys(expected, imageEdge, *scene, L"Incorrect image sources after repeated runs");
+			}
+		}
+
+		TEST_METHOD(ReusedTreeMatchesRebuild)
+		{
+			const int numSources = 8;
+
+			// Listener moves within the tree margin (0.5 m), so only the receiver side of the trees is updated.
+			// The shorter maximum path length cuts paths that are only found again because the trees are built with the margin
+			const std::vector<Vec3> moves = { Vec3(0.07, 0.02, -0.03), Vec3(0.19, -0.11, 0.05), Vec3(-0.31, 0.13, 0.17), Vec3(0.23, 0.29, -0.26) };
+			for (const Real maxPathLength : { 1e4, 12.0 })
+			{
+				EarlyReverbData data(DirectSound::check, 3, 2, 1, 0.0, maxPathLength);
+				for (const Vec3& move : moves)
+				{
+					std::unique_ptr<Scene> scene = createScene(numSources);
+					ImageEdge imageEdge(scene->room, scene->sourceManager, data, scene->dspConfig);
+					imageEdge.SetListenerPosition(listenerPosition);
+					imageEdge.RunIEM();
+
+					const Vec3 position = listenerPosition + move;
+					imageEdge.SetListenerPosition(position);
+					imageEdge.RunIEM();
+					assertKeys(referenceKeys(data, numSources, position), imageEdge, *scene, L"Reused tree image sources do not match rebuilt tree image sources");
+				}
+			}
+		}
+
+		TEST_METHOD(ParallelMatchesSerial)
+		{
+			// The higher order frontiers are large enough to be split into several segments
+			EarlyReverbData data(DirectSound::check, 5, 2, 1, 0.0, 1e4);
+
+			// Fewer sources than threads leaves idle threads to expand the frontiers of each source in parallel
+			for (const int numSources : { 1, 3 })
+			{
+				for (const Real step : { 0.0, 1.03 })
+				{
+					const Vec3 position = listenerPosition + Vec3(step, 0.37 * step, -0.23 * step);
+					std::vector<KeySet> serial = referenceKeys(data, numSources, position);
+					for (const size_t numThreads : { 2, 4 })
+					{
+						std::vector<KeySet> parallel = referenceKeys(data, numSources, position, numThreads);
+						Assert::AreEqual(serial.size(), parallel.size(), L"Incorrect number of sources");
+						for (size_t i = 0; i < serial.size(); ++i)
+							Assert::IsTrue(serial[i] == parallel[i], L"Parallel image sources do not match serial image sources");
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(ProgressiveMatchesComplete)
+		{
+			const int numSources = 8;
+			EarlyReverbData data(DirectSound::check, 3, 2, 1, 0.0, 1e4);
+
+			// The time budget is long enough to extend the trees to the maximum order in every run, one order at a time
+			EarlyReverbData progressiveData(DirectSound::check, 3, 2, 1, 0.0, 1e4, 0.0, MAX_IMAGESOURCES, 10.0);
+			std::unique_ptr<Scene> scene = createScene(numSources);
+			ImageEdge imageEdge(scene->room, scene->sourceManager, progressiveData, scene->dspConfig);
+
+			// Steps within the tree margin reuse the completed trees, larger steps rebuild them one order at a time
+			for (const Real step : { 0.0, 0.23, 1.03, 0.0 })
+			{
+				const Vec3 position = listenerPosition + Vec3(step, 0.37 * step, -0.23 * step);
+				imageEdge.SetListenerPosition(position);
+				imageEdge.RunIEM();
+				Assert::IsFalse(imageEdge.HasIncompleteOrders(), L"Progressive image source trees not completed");
+				assertKeys(referenceKeys(data, numSources, position), imageEdge, *scene, L"Progressive image sources do not match complete image sources");
+			}
+		}
+
+		TEST_METHOD(FirstOrderDiffractionPaths)
+		{
+			// Paths recorded with the receiver checks inlined in FirstOrderDiffraction (before they moved to FindReceiverPath)
+			struct Expected
+			{
+				DiffractionModel model;
+				int shadowDiffOrder;
+				int specularDiffOrder;
+				std::vector<size_t> sources;
+			};
+			const std::vector<Expected> expected = {
+				{ DiffractionModel::attenuate, 1, 1, { 3, 7, 11 } },				// Attenuate only supports shadowed paths
+				{ DiffractionModel::btm, 1, 1, { 0, 1, 3, 4, 5, 7, 8, 9, 11 } },
+				{ DiffractionModel::btm, 0, 1, { 0, 1, 4, 5, 8, 9 } },
+				{ DiffractionModel::btm, 1, 0, { 3, 7, 11 } }
+			};
+
+			const int numSources = 12;
+			const std::vector<size_t> edgeIDs = { 1, 3 };	// Bottom (z = 1) and top (z = 3) edges of the partition
+			for (const Expected& config : expected)
+			{
+				std::unique_ptr<Scene> scene = createScene(numSources, config.model);
+				ImageEdge imageEdge(scene->room, scene->sourceManager, EarlyReverbData(DirectSound::check, 0, config.shadowDiffOrder, config.specularDiffOrder, 0.0, 1e4), scene->dspConfig, 1);
+				imageEdge.SetListenerPosition(listenerPosition);
+				imageEdge.RunIEM();
+
+				for (size_t i = 0; i < scene->sourceIDs.size(); ++i)
+				{
+					KeySet expectedKeys;
+					if (std::find(config.sources.begin(), config.sources.end(), i) != config.sources.end())
+					{
+						for (const size_t edgeID : edgeIDs)
+						{
+							ImageSourceData imageSource(ToInt(frequencyBands.Length()));
+							imageSource.AddEdgeID(edgeID);
+							imageSource.CreateKey(ToInt(scene->sourceIDs[i]));
+							expectedKeys.insert(imageSource.GetKey());
+						}
+					}
+					Assert::IsTrue(expectedKeys == imageEdge.GetImageSourceKeys(scene->sourceIDs[i]), L"First order diffraction paths changed");
+				}
+			}
+		}
+
+		TEST_METHOD(EnergyFloor)
+		{
+			const int numSources = 4;
+			std::vector<KeySet> previous = referenceKeys(EarlyReverbData(DirectSound::check, 3, 2, 1, 0.0, 1e4), numSources, listenerPosition);
+
+			// Raising the floor only removes image sources
+			for (const Real energyFloor : { 3e-3, 1e-2, 3e-2 })
+			{
+				std::vector<KeySet> keys = referenceKeys(EarlyReverbData(DirectSound::check, 3, 2, 1, 0.0, 1e4, energyFloor), numSources, listenerPosition);
+				Assert::IsTrue(isSubset(keys, previous), L"Energy floor added image sources");
+				Assert::IsTrue(countKeys(keys) < countKeys(previous), L"Energy floor removed no image sources");
+				previous = keys;
+			}
+			Assert::IsTrue(countKeys(previous) > 0, L"Energy floor removed all image sources");
+		}
+
+		TEST_METHOD(ImageSourceBudget)
+		{
+			const int numSources = 4;
+			std::vector<KeySet> previous = referenceKeys(EarlyReverbData(DirectSound::check, 3, 2, 1, 0.0, 1e4), numSources, listenerPosition);
+			const size_t numImageSources = countKeys(previous);
+
+			// A smaller budget keeps the loudest image sources of a larger one
+			for (const size_t budget : { numImageSources / 2, numImageSources / 8, static_cast<size_t>(1), static_cast<size_t>(0) })
+			{
+				std::vector<KeySet> keys = referenceKeys(EarlyReverbData(DirectSound::check, 3, 2, 1, 0.0, 1e4, 0.0, ToInt(budget)), numSources, listenerPosition);
+				Assert::AreEqual(budget, countKeys(keys), L"Incorrect number of image sources within the budget");
+				Assert::IsTrue(isSubset(keys, previous), L"Budget admitted quieter image sources");
+				previous = keys;
+			}
+		}
+
+		TEST_METHOD(BudgetHysteresis)
+		{
+			const int numSources = 4;
+			const Vec3 sourcePosition = Vec3(3.0, 1.2, 1.8);
+			EarlyReverbData data(DirectSound::check, 3, 2, 1, 0.0, 1e4, 0.0, 100);
+
+			// Moving one source closer to the listener makes its image sources louder than some of the other sources' image sources.
+			// The other sources keep their trees, so their image sources are only filtered again
+			std::unique_ptr<Scene> scene = createScene(numSources);
+			ImageEdge imageEdge(scene->room, scene->sourceManager, data, scene->dspConfig);
+			imageEdge.SetListenerPosition(listenerPosition);
+			imageEdge.RunIEM();
+			std::vector<KeySet> rendered = getKeys(imageEdge, *scene);
+
+			moveSource(*scene, 0, sourcePosition);
+			imageEdge.RunIEM();
+			std::vector<KeySet> keys = getKeys(imageEdge, *scene);
+
+			std::unique_ptr<Scene> referenceScene = createScene(numSources);
+			moveSource(*referenceScene, 0, sourcePosition);
+			ImageEdge reference(referenceScene->room, referenceScene->sourceManager, data, referenceScene->dspConfig);
+			reference.SetListenerPosition(listenerPosition);
+			reference.RunIEM();
+			std::vector<KeySet> expected = getKeys(reference, *referenceScene);
+
+			// Only image sources rendered before the move can displace louder image sources
+			Assert::AreEqual(static_cast<size_t>(data.maxImageSources), countKeys(keys), L"Incorrect number of image sources within the budget");
+			bool boosted = false;
+			for (size_t i = 0; i < keys.size(); ++i)
+			{
+				for (const ImageSourceKey& key : keys[i])
+				{
+					if (expected[i].find(key) == expected[i].end())
+					{
+						Assert::IsTrue(rendered[i].find(key) != rendered[i].end(), L"Image source admitted without hysteresis");
+						boosted = true;
+					}
+				}
+				for (const ImageSourceKey& key : expected[i])
+				{
+					if (keys[i].find(key) == keys[i].end())
+						Assert::IsTrue(rendered[i].find(key) == rendered[i].end(), L"Rendered image source dropped despite hysteresis");
+				}
+			}
+			Assert::IsTrue(boosted, L"No image sources kept by hysteresis");
+
+			bool filtered = false;
+			for (size_t i = 1; i < keys.size(); ++i)
+				filtered |= keys[i] != rendered[i];
+			Assert::IsTrue(filtered, L"No unchanged source filtered again");
+
+			// The filtered trees are reused when the listener moves within the tree margin
+			const Vec3 position = listenerPosition + Vec3(0.07, 0.02, -0.03);
+			imageEdge.SetListenerPosition(position);
+			imageEdge.RunIEM();
+
+			std::unique_ptr<Scene> unlimitedScene = createScene(numSources);
+			moveSource(*unlimitedScene, 0, sourcePosition);
+			ImageEdge unlimited(unlimitedScene->room, unlimitedScene->sourceManager, EarlyReverbData(DirectSound::check, 3, 2, 1, 0.0, 1e4), unlimitedScene->dspConfig);
+			unlimited.SetListenerPosition(position);
+			unlimited.RunIEM();
+
+			keys = getKeys(imageEdge, *scene);
+			Assert::AreEqual(static_cast<size_t>(data.maxImageSources), countKeys(keys), L"Incorrect number of image sources after filtering");
+			Assert::IsTrue(isSubset(keys, getKeys(unlimited, *unlimitedScene)), L"Incorrect image sources after filtering");
+		}
+	};
+}
@@ -0,0 +1,137 @@
+#include "CppUnitTest.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/Edge.h"
+#include "Spatialiser/ImageSource.h"
+#include "Spatialiser/ImageSourceCache.h"
+
+#include <sstream>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(ImageSourceCacheTests)
+	{
+		const int numBands = 4;
+
+		// Second order reflection image source
+		std::shared_ptr<ImageSourceData> createReflection()
+		{
+			std::shared_ptr<ImageSourceData> imageSource = std::make_shared<ImageSourceData>(numBands);
+			imageSource->SetTransform(Vec3(-1.0, 2.0, 3.0));
+			imageSource->AddPlaneID(3);
+			imageSource->IncreaseImageSourceOrder();
+			imageSource->SetTransform(Vec3(-1.0, 2.0, -3.0));
+			imageSource->AddPlaneID(7);
+			imageSource->SetPreviousPlane(Vec4(0.0, 0.0, 0.0, 1.0));
+			imageSource->GetAbsorption() = Coefficients<>(std::vector<Real>({ 0.9, 0.8, 0.7, 0.6 }));
+			imageSource->Valid();
+			return imageSource;
+		}
+
+		// First order diffraction image source
+		std::shared_ptr<ImageSourceData> createDiffraction()
+		{
+			const Edge edge(Vec3(1.0, 0.0, 1.0), Vec3(1.0, 0.0, 2.0), Vec3(0.0, -1.0, 0.0), Vec3(1.0, 0.0, 0.0), 4, 5, 6, 7);
+			std::shared_ptr<ImageSourceData> imageSource = std::make_shared<ImageSourceData>(numBands);
+			imageSource->UpdateDiffractionPath(Vec3(0.0, -1.0, 1.5), Vec3(2.0, 1.0, 1.2), edge);
+			imageSource->AddEdgeID(11);
+			imageSource->Valid();
+			return imageSource;
+		}
+
+		std::shared_ptr<ImageSourceData> roundTrip(const ImageSourceData& imageSource)
+		{
+			std::stringstream stream;
+			imageSource.Write(stream);
+			std::shared_ptr<ImageSourceData> read = std::make_shared<ImageSourceData>(numBands);
+			Assert::IsTrue(read->Read(stream), L"Failed to read image source");
+			return read;
+		}
+
+	public:
+
+		TEST_METHOD(ReflectionRoundTrip)
+		{
+			std::shared_ptr<ImageSourceData> imageSource = createReflection();
+			std::shared_ptr<ImageSourceData> read = roundTrip(*imageSource);
+
+			Assert::IsTrue(read->IsValid(), L"Read image source not valid");
+			Assert::IsTrue(read->IsReflection(), L"Read image source not a reflection");
+			Assert::IsFalse(read->IsDiffraction(), L"Read image source is a diffraction");
+			Assert::IsTrue(read->SamePath(*imageSource), L"Incorrect path");
+			for (int i = 0; i < 2; ++i)
+				Assert::IsTrue(read->GetPosition(i) == imageSource->GetPosition(i), L"Incorrect position");
+			Assert::IsTrue(read->GetPreviousPlane().isApprox(imageSource->GetPreviousPlane()), L"Incorrect previous plane");
+			for (int i = 0; i < numBands; ++i)
+				Assert::AreEqual(imageSource->GetAbsorption()[i], read->GetAbsorption()[i], L"Incorrect absorption");
+
+			// Truncated stream
+			std::stringstream stream;
+			imageSource->Write(stream);
+			std::string data = stream.str();
+			std::stringstream truncated(data.substr(0, data.size() / 2));
+			Assert::IsFalse(read->Read(truncated), L"Read truncated image source");
+		}
+
+		TEST_METHOD(DiffractionRoundTrip)
+		{
+			std::shared_ptr<ImageSourceData> imageSource = createDiffraction();
+			std::shared_ptr<ImageSourceData> read = roundTrip(*imageSource);
+
+			Assert::IsTrue(read->IsValid(), L"Read image source not valid");
+			Assert::IsTrue(read->IsDiffraction(), L"Read image source not a diffraction");
+			Assert::IsTrue(read->SamePath(*imageSource), L"Incorrect path");
+			Assert::IsTrue(read->GetEdge().GetBase() == imageSource->GetEdge().GetBase(), L"Incorrect edge base");
+			Assert::IsTrue(read->GetEdge().GetTop() == imageSource->GetEdge().GetTop(), L"Incorrect edge top");
+			Assert::AreEqual(imageSource->GetEdge().GetPlaneIDs().second, read->GetEdge().GetPlaneIDs().second, L"Incorrect edge plane ID");
+
+			// The receiver side is updated at runtime
+			const Vec3 receiver(2.0, 1.0, 1.2);
+			read->UpdateDiffractionPath(receiver);
+			Assert::AreEqual(imageSource->GetDistance(), read->GetDistance(), 1e-9, L"Incorrect path length");
+			Assert::AreEqual(imageSource->GetDiffractionPath().GetApexZ(), read->GetDiffractionPath().GetApexZ(), 1e-9, L"Incorrect apex");
+		}
+
+		TEST_METHOD(WriteAndRead)
+		{
+			ImageSourceDataStore sp(2);
+			sp[0].push_back(createDiffraction());
+			sp[1].push_back(createReflection());
+			sp[1].push_back(std::make_shared<ImageSourceData>(numBands)); // Invalid image sources are not stored
+
+			const Vec3 sourcePosition(0.0, -1.0, 1.5);
+			ImageSourceCache cache(12345, 678, Vec3(1.0, 1.5, 1.25), 3.0, numBands);
+			cache.Add(sourcePosition, 2, sp);
+
+			const std::string filePath = "ImageSourceCacheTest.bin";
+			Assert::IsTrue(cache.Write(filePath), L"Failed to write cache");
+			std::shared_ptr<ImageSourceCache> read = ImageSourceCache::Read(filePath);
+			std::remove(filePath.c_str());
+			Assert::IsTrue(read != nullptr, L"Failed to read cache");
+
+			Assert::AreEqual(static_cast<uint64_t>(12345), read->GetGeometryHash(), L"Incorrect geometry hash");
+			Assert::AreEqual(static_cast<uint64_t>(678), read->GetConfigHash(), L"Incorrect config hash");
+			Assert::AreEqual(3.0, read->GetListenerRadius(), L"Incorrect listener radius");
+			Assert::AreEqual(static_cast<size_t>(1), read->NumEntries(), L"Incorrect number of entries");
+
+			Assert::IsTrue(read->Find(Vec3(0.0, 0.0, 0.0)) == nullptr, L"Found entry for position not baked");
+			const ImageSourceCache::Entry* entry = read->Find(sourcePosition);
+			Assert::IsTrue(entry != nullptr, L"Entry not found");
+			Assert::AreEqual(2, entry->numOrders, L"Incorrect number of orders");
+			Assert::AreEqual(static_cast<size_t>(1), entry->sp[0].size(), L"Incorrect number of first order image sources");
+			Assert::AreEqual(static_cast<size_t>(1), entry->sp[1].size(), L"Incorrect number of second order image sources");
+			Assert::IsTrue(entry->sp[0][0]->IsDiffraction(), L"Incorrect first order image source");
+			Assert::IsTrue(entry->sp[1][0]->SamePath(*sp[1][0]), L"Incorrect second order image source");
+
+			Assert::IsTrue(ImageSourceCache::Read("MissingImageSourceCache.bin") == nullptr, L"Read missing file");
+		}
+	};
+}
@@ -0,0 +1,110 @@
+#include "CppUnitTest.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/ImageSource.h"
+#include "Spatialiser/ImageSourceDataPool.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(ImageSourceDataPoolTests)
+	{
+		const int numBands = 4;
+
+		// First order reflection image source
+		ImageSourceData createReflection(const size_t planeID)
+		{
+			ImageSourceData imageSource(numBands);
+			imageSource.SetTransform(Vec3(1.0, 2.0, 3.0) * static_cast<Real>(planeID + 1));
+			imageSource.AddPlaneID(planeID);
+			imageSource.Valid();
+			return imageSource;
+		}
+
+	public:
+
+		TEST_METHOD(AcquireCopies)
+		{
+			ImageSourceDataPool pool;
+			ImageSourceData imageSource = createReflection(3);
+			std::shared_ptr<ImageSourceData> copy = pool.Acquire(imageSource);
+
+			Assert::IsTrue(copy->SamePath(imageSource), L"Incorrect path");
+			Assert::IsTrue(copy->GetPosition() == imageSource.GetPosition(), L"Incorrect position");
+			Assert::IsTrue(copy.get() != &imageSource, L"Image source not copied");
+			Assert::AreEqual(static_cast<size_t>(1), pool.Size(), L"Incorrect pool size");
+			Assert::AreEqual(static_cast<size_t>(1), pool.NumAllocations(), L"Incorrect number of allocations");
+		}
+
+		TEST_METHOD(ReuseReleased)
+		{
+			ImageSourceDataPool pool;
+			std::vector<std::shared_ptr<ImageSourceData>> held;
+			for (size_t i = 0; i < 4; ++i)
+				held.push_back(pool.Acquire(createReflection(i)));
+			Assert::AreEqual(static_cast<size_t>(4), pool.NumAllocations(), L"Incorrect number of allocations");
+
+			// Release the second and fourth image sources
+			ImageSourceData* released1 = held[1].get();
+			ImageSourceData* released3 = held[3].get();
+			held[1].reset();
+			held[3].reset();
+
+			pool.BeginPass();
+			std::shared_ptr<ImageSourceData> a = pool.Acquire(createReflection(5));
+			std::shared_ptr<ImageSourceData> b = pool.Acquire(createReflection(6));
+			Assert::IsTrue(a.get() == released1 && b.get() == released3, L"Released image sources not reused");
+			Assert::IsTrue(a->SamePath(createReflection(5)) && b->SamePath(createReflection(6)), L"Reused image source not overwritten");
+			Assert::AreEqual(static_cast<size_t>(4), pool.NumAllocations(), L"Reuse allocated");
+
+			// Held image sources are never overwritten
+			Assert::IsTrue(held[0]->SamePath(createReflection(0)) && held[2]->SamePath(createReflection(2)), L"Held image source overwritten");
+
+			// No free image sources left
+			std::shared_ptr<ImageSourceData> c = pool.Acquire(createReflection(7));
+			Assert::AreEqual(static_cast<size_t>(5), pool.NumAllocations(), L"Incorrect number of allocations");
+			Assert::AreEqual(static_cast<size_t>(5), pool.Size(), L"Incorrect pool size");
+		}
+
+		TEST_METHOD(ReleasedWithinPass)
+		{
+			ImageSourceDataPool pool;
+			std::shared_ptr<ImageSourceData> a = pool.Acquire(createReflection(0));
+			std::shared_ptr<ImageSourceData> b = pool.Acquire(createReflection(1));
+
+			// Image sources released behind the cursor are only reused in the next pass
+			a.reset();
+			std::shared_ptr<ImageSourceData> c = pool.Acquire(createReflection(2));
+			Assert::AreEqual(static_cast<size_t>(3), pool.NumAllocations(), L"Image source reused within pass");
+
+			c.reset();
+			pool.BeginPass();
+			std::shared_ptr<ImageSourceData> d = pool.Acquire(createReflection(3));
+			std::shared_ptr<ImageSourceData> e = pool.Acquire(createReflection(4));
+			std::shared_ptr<ImageSourceData> f = pool.Acquire(createReflection(5));
+			Assert::AreEqual(static_cast<size_t>(4), pool.NumAllocations(), L"Incorrect number of allocations");
+			Assert::IsTrue(b->SamePath(createReflection(1)), L"Held image source overwritten");
+		}
+
+		TEST_METHOD(ClearReleases)
+		{
+			ImageSourceDataPool pool;
+			std::shared_ptr<ImageSourceData> held = pool.Acquire(createReflection(0));
+			pool.Acquire(createReflection(1));
+			pool.Clear();
+
+			Assert::AreEqual(static_cast<size_t>(0), pool.Size(), L"Pool not empty");
+			Assert::AreEqual(1L, held.use_count(), L"Pool still references image source");
+			Assert::IsTrue(held->SamePath(createReflection(0)), L"Held image source changed");
+
+			pool.Acquire(createReflection(2));
+			Assert::AreEqual(static_cast<size_t>(3), pool.NumAllocations(), L"Incorrect number of allocations");
+		}
+	};
+}
@@ -0,0 +1,91 @@
+#include "CppUnitTest.h"
+
+#include "Common/Definitions.h"
+
+#include "Spatialiser/ImageSource.h"
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(ImageSourceKeyTests)
+	{
+		const int numBands = 4;
+
+		// Image source with the given path of (plane or edge ID, true if a reflection) parts
+		ImageSourceData createPath(const std::vector<std::pair<size_t, bool>>& parts, const int sourceID)
+		{
+			ImageSourceData imageSource(numBands);
+			for (size_t i = 0; i < parts.size(); ++i)
+			{
+				if (i > 0)
+					imageSource.IncreaseImageSourceOrder();
+				if (parts[i].second)
+					imageSource.AddPlaneID(parts[i].first);
+				else
+					imageSource.AddEdgeID(parts[i].first);
+			}
+			imageSource.CreateKey(sourceID);
+			return imageSource;
+		}
+
+	public:
+
+		TEST_METHOD(UniqueKeys)
+		{
+			// Every path of up to three parts over four IDs, each part a reflection or a diffraction
+			std::vector<std::vector<std::pair<size_t, bool>>> paths = { {} };
+			std::vector<std::vector<std::pair<size_t, bool>>> allPaths;
+			for (int order = 1; order <= 3; ++order)
+			{
+				std::vector<std::vector<std::pair<size_t, bool>>> nextPaths;
+				for (const auto& path : paths)
+				{
+					for (size_t id = 0; id < 4; ++id)
+					{
+						for (const bool isReflection : { true, false })
+						{
+							nextPaths.push_back(path);
+							nextPaths.back().emplace_back(id, isReflection);
+						}
+					}
+				}
+				paths = nextPaths;
+				allPaths.insert(allPaths.end(), paths.begin(), paths.end());
+			}
+
+			std::unordered_set<ImageSourceKey, ImageSourceKeyHash> keys;
+			std::unordered_set<std::string> keyStrings;
+			for (const int sourceID : { 0, 1, 7 })
+			{
+				for (const auto& path : allPaths)
+				{
+					ImageSourceData imageSource = createPath(path, sourceID);
+					keys.insert(imageSource.GetKey());
+					keyStrings.insert(imageSource.GetKeyString());
+					Assert::IsTrue(imageSource.GetKey() == createPath(path, sourceID).GetKey(), L"Key not deterministic");
+				}
+			}
+			Assert::AreEqual(3 * allPaths.size(), keys.size(), L"Image source keys not unique");
+			Assert::AreEqual(3 * allPaths.size(), keyStrings.size(), L"Image source key strings not unique");
+
+			// Path order and part type
+			Assert::IsTrue(createPath({ { 1, true }, { 2, true } }, 0).GetKey() != createPath({ { 2, true }, { 1, true } }, 0).GetKey(), L"Key ignores path order");
+			Assert::IsTrue(createPath({ { 1, true } }, 0).GetKey() != createPath({ { 1, false } }, 0).GetKey(), L"Key ignores part type");
+			Assert::IsTrue(createPath({ { 1, true }, { 2, false } }, 0).GetKey() != createPath({ { 1, false }, { 2, true } }, 0).GetKey(), L"Key ignores part type");
+		}
+
+		TEST_METHOD(KeyString)
+		{
+			Assert::AreEqual(std::string("3s5r"), createPath({ { 5, true } }, 3).GetKeyString(), L"Incorrect reflection key string");
+			Assert::AreEqual(std::string("0s12d"), createPath({ { 12, false } }, 0).GetKeyString(), L"Incorrect diffraction key string");
+			Assert::AreEqual(std::string("14s5r12d0r"), createPath({ { 5, true }, { 12, false }, { 0, true } }, 14).GetKeyString(), L"Incorrect key string");
+		}
+	};
+}
@@ -0,0 +1,74 @@
+#include "CppUnitTest.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/Wall.h"
+#include "Spatialiser/ReflectionBatch.h"
+
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(ReflectionBatchTests)
+	{
+		// Plane through three random points
+		Plane randomPlane(std::mt19937& rng)
+		{
+			std::uniform_real_distribution<Real> coordinate(-10.0, 10.0);
+			Vertices vertices = { Vec3(coordinate(rng), coordinate(rng), coordinate(rng)), Vec3(coordinate(rng), coordinate(rng), coordinate(rng)), Vec3(coordinate(rng), coordinate(rng), coordinate(rng)) };
+			return Plane(0, Wall(vertices, 0));
+		}
+
+	public:
+
+		TEST_METHOD(MatchesScalarReflection)
+		{
+			std::mt19937 rng(17);
+			std::uniform_real_distribution<Real> coordinate(-20.0, 20.0);
+			std::uniform_int_distribution<int> size(0, 19);
+
+			const Real maxDistance = 25.0;
+			ReflectionBatch batch;
+			std::vector<Vec3> positions;
+			std::vector<uint8_t> mask;
+			for (int test = 0; test < 200; ++test)
+			{
+				// Sizes that are not a multiple of the SIMD width test the scalar remainder
+				const int numPositions = size(rng);
+				batch.Clear();
+				positions.clear();
+				for (int i = 0; i < numPositions; ++i)
+				{
+					positions.emplace_back(coordinate(rng), coordinate(rng), coordinate(rng));
+					batch.Add(positions.back());
+				}
+				Assert::AreEqual(static_cast<size_t>(numPositions), batch.Size(), L"Wrong batch size");
+
+				const Plane plane = randomPlane(rng);
+				const Vec3 listenerPosition(coordinate(rng), coordinate(rng), coordinate(rng));
+				mask.assign(numPositions, 2);
+				batch.Cull(plane, listenerPosition, maxDistance, mask.data());
+
+				for (int i = 0; i < numPositions; ++i)
+				{
+					Vec3 reflected;
+					const bool valid = plane.ReflectPointInPlane(reflected, positions[i]) && (reflected - listenerPosition).Normal() <= maxDistance;
+					if (valid)
+						Assert::AreEqual(static_cast<uint8_t>(1), mask[i], L"Valid reflection culled");
+					else
+						Assert::IsTrue(mask[i] <= 1, L"Mask not written");
+
+					// Away from the tolerance of the culls the result is exact
+					const Real k = positions[i].dot(plane.GetNormal()) - plane.GetD();
+					reflected = positions[i] - 2.0 * plane.GetNormal() * k;
+					if (std::abs(k) > 1e-3 && std::abs((reflected - listenerPosition).Normal() - maxDistance) > 1e-3)
+						Assert::AreEqual(static_cast<uint8_t>(valid), mask[i], L"Mask does not match scalar reflection");
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,182 @@
+#include "CppUnitTest.h"
+#include "UtilityFunctions.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/Room.h"
+#include "Spatialiser/RoomSnapshot.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(RoomSnapshotTests)
+	{
+		// Build a shoebox room (2 triangles per face) with a partition wall at x = 1
+		void buildTestRoom(Room& testRoom)
+		{
+			const Real x = 2.0, y = 3.0, z = 2.5;
+			std::vector<Vertices> faces = {
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, 0.0), Vec3(x, y, 0.0) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(x, 0.0, 0.0) },	// Floor
+				{ Vec3(0.0, 0.0, z), Vec3(x, y, z), Vec3(0.0, y, z) }, { Vec3(0.0, 0.0, z), Vec3(x, 0.0, z), Vec3(x, y, z) },				// Ceiling
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, z), Vec3(0.0, y, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, z), Vec3(0.0, y, 0.0) },	// x = 0
+				{ Vec3(x, 0.0, 0.0), Vec3(x, y, z), Vec3(x, 0.0, z) }, { Vec3(x, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(x, y, z) },				// x = x
+				{ Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(0.0, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, 0.0), Vec3(x, 0.0, z) },	// y = 0
+				{ Vec3(0.0, y, 0.0), Vec3(0.0, y, z), Vec3(x, y, z) }, { Vec3(0.0, y, 0.0), Vec3(x, y, z), Vec3(x, y, 0.0) },				// y = y
+				{ Vec3(1.0, 1.0, 0.5), Vec3(1.0, 2.0, 0.5), Vec3(1.0, 1.5, 2.0) }															// Partition
+			};
+
+			Coefficients<> testAbsorption = Coefficients<>::Constant(1, 0.5);
+			for (const Vertices& face : faces)
+			{
+				size_t materialID = testRoom.InitMaterial(testAbsorption);
+				Wall testWall(face, materialID);
+				size_t id = testRoom.AddWall(testWall);
+				testRoom.InitEdges(id);
+			}
+		}
+
+		// Build a shoebox room facing inwards with a two sided partition at x = 1 (front face +x, back face -x)
+		void buildInwardTestRoom(Room& testRoom)
+		{
+			const Real x = 2.0, y = 3.0, z = 2.5;
+			std::vector<Vertices> faces = {
+				{ Vec3(0.0, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(0.0, y, 0.0) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, 0.0), Vec3(x, y, 0.0) },	// Floor
+				{ Vec3(0.0, 0.0, z), Vec3(0.0, y, z), Vec3(x, y, z) }, { Vec3(0.0, 0.0, z), Vec3(x, y, z), Vec3(x, 0.0, z) },				// Ceiling
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, z), Vec3(0.0, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, 0.0), Vec3(0.0, y, z) },	// x = 0
+				{ Vec3(x, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, y, z) }, { Vec3(x, 0.0, 0.0), Vec3(x, y, z), Vec3(x, y, 0.0) },				// x = x
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, z), Vec3(x, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(x, 0.0, 0.0) },	// y = 0
+				{ Vec3(0.0, y, 0.0), Vec3(x, y, z), Vec3(0.0, y, z) }, { Vec3(0.0, y, 0.0), Vec3(x, y, 0.0), Vec3(x, y, z) },				// y = y
+				{ Vec3(1.0, 1.0, 0.5), Vec3(1.0, 2.0, 0.5), Vec3(1.0, 1.5, 2.0) },															// Partition front
+				{ Vec3(1.0, 1.0, 0.5), Vec3(1.0, 1.5, 2.0), Vec3(1.0, 2.0, 0.5) }															// Partition back
+			};
+
+			Coefficients<> testAbsorption = Coefficients<>::Constant(1, 0.5);
+			for (const Vertices& face : faces)
+			{
+				size_t materialID = testRoom.InitMaterial(testAbsorption);
+				Wall testWall(face, materialID);
+				size_t id = testRoom.AddWall(testWall);
+				testRoom.InitEdges(id);
+			}
+		}
+
+		static bool Contains(const std::vector<size_t>& indices, const size_t idx)
+		{
+			return std::find(indices.begin(), indices.end(), idx) != indices.end();
+		}
+
+	public:
+		TEST_METHOD(Sharing)
+		{
+			Room testRoom(1);
+			buildTestRoom(testRoom);
+
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			Assert::IsTrue(snapshot == testRoom.GetSnapshot(), L"Unchanged room created a new snapshot");
+			Assert::AreEqual(testRoom.GetVersion(), snapshot->GetVersion(), L"Incorrect snapshot version");
+
+			testRoom.RemoveWall(12);
+			std::shared_ptr<const RoomSnapshot> updated = testRoom.GetSnapshot();
+			Assert::IsFalse(snapshot == updated, L"Changed room did not create a new snapshot");
+			Assert::AreEqual(static_cast<size_t>(13), snapshot->NumWalls(), L"Previous snapshot was modified");
+			Assert::AreEqual(static_cast<size_t>(12), updated->NumWalls(), L"Incorrect number of walls");
+			Assert::IsNull(updated->FindWall(12), L"Removed wall found");
+			Assert::AreEqual(static_cast<size_t>(12), updated->GetWallBVH().Size(), L"Incorrect number of walls in BVH");
+			Assert::AreEqual(12, updated->GetTriangleMeshSoA().size(), L"Incorrect number of triangles");
+		}
+
+		TEST_METHOD(MatchesRoom)
+		{
+			Room testRoom(1);
+			buildTestRoom(testRoom);
+
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			PlaneMap planes = testRoom.GetPlanes();
+			WallMap walls = testRoom.GetWalls();
+			MaterialMap materials = testRoom.GetMaterials();
+			EdgeMap edges = testRoom.GetEdges();
+
+			Assert::AreEqual(planes.size(), snapshot->NumPlanes(), L"Incorrect number of planes");
+			Assert::AreEqual(walls.size(), snapshot->NumWalls(), L"Incorrect number of walls");
+			Assert::AreEqual(materials.size(), snapshot->NumMaterials(), L"Incorrect number of materials");
+			Assert::AreEqual(edges.size(), snapshot->NumEdges(), L"Incorrect number of edges");
+
+			for (size_t i = 0; i < snapshot->NumPlanes(); ++i)
+			{
+				const Plane& plane = planes.at(snapshot->GetPlaneID(i));
+				Assert::IsTrue(&snapshot->GetPlane(i) == snapshot->FindPlane(snapshot->GetPlaneID(i)), L"Incorrect plane index");
+				Assert::AreEqual(static_cast<int>(i), snapshot->FindPlaneIndex(snapshot->GetPlaneID(i)), L"Incorrect plane dense index");
+				Assert::IsTrue(plane.GetNormal() == snapshot->GetPlane(i).GetNormal(), L"Incorrect plane normal");
+				Assert::AreEqual(plane.GetD(), snapshot->GetPlane(i).GetD(), L"Incorrect plane d");
+
+				Real maxReflectance = 0.0;
+				for (const size_t wallID : plane.GetWalls())
+				{
+					const Coefficients<>& material = materials.at(walls.at(wallID).GetMaterialID());
+					for (int j = 0; j < material.Length(); ++j)
+						maxReflectance = std::max(maxReflectance, material[j]);
+				}
+				Assert::AreEqual(maxReflectance, snapshot->GetMaxPlaneReflectance(i), EPS, L"Incorrect plane reflectance");
+			}
+
+			for (size_t i = 0; i < snapshot->NumWalls(); ++i)
+			{
+				const Wall& wall = walls.at(snapshot->GetWallID(i));
+				Assert::IsTrue(&snapshot->GetWall(i) == snapshot->FindWall(snapshot->GetWallID(i)), L"Incorrect wall index");
+				Assert::AreEqual(wall.GetPlaneID(), snapshot->GetWall(i).GetPlaneID(), L"Incorrect wall plane");
+				Assert::IsNotNull(snapshot->FindMaterial(wall.GetMaterialID()), L"Wall material not found");
+				if (i > 0)
+					Assert::IsTrue(snapshot->GetWallID(i - 1) < snapshot->GetWallID(i), L"Walls not sorted by ID");
+			}
+
+			for (size_t i = 0; i < snapshot->NumEdges(); ++i)
+			{
+				Assert::IsTrue(&snapshot->GetEdge(i) == snapshot->FindEdge(snapshot->GetEdgeID(i)), L"Incorrect edge index");
+				Assert::AreEqual(static_cast<int>(i), snapshot->FindEdgeIndex(snapshot->GetEdgeID(i)), L"Incorrect edge dense index");
+			}
+
+			Assert::IsNull(snapshot->FindPlane(1000), L"Missing plane found");
+			Assert::AreEqual(-1, snapshot->FindPlaneIndex(1000), L"Missing plane index found");
+			Assert::IsNull(snapshot->FindMaterial(1000), L"Missing material found");
+		}
+
+		TEST_METHOD(VisibilityTables)
+		{
+			Room testRoom(1);
+			buildInwardTestRoom(testRoom);
+
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			WallMap walls = testRoom.GetWalls();
+			auto planeIndex = [&](const size_t wallID) { return static_cast<size_t>(snapshot->FindPlaneIndex(walls.at(wallID).GetPlaneID())); };
+
+			const size_t floor = planeIndex(0);
+			const size_t ceiling = planeIndex(2);
+			const size_t wallX0 = planeIndex(4);
+			const size_t wallX2 = planeIndex(6);
+			const size_t partitionFront = planeIndex(12);
+			const size_t partitionBack = planeIndex(13);
+
+			for (size_t i = 0; i < snapshot->NumPlanes(); ++i)
+				Assert::IsFalse(Contains(snapshot->GetPlanesVisibleFromPlane(i), i), L"Plane visible from itself");
+
+			Assert::IsTrue(Contains(snapshot->GetPlanesVisibleFromPlane(floor), ceiling), L"Ceiling not visible from floor");
+			Assert::IsTrue(Contains(snapshot->GetPlanesVisibleFromPlane(partitionFront), wallX2), L"Wall in front of partition not visible");
+			Assert::IsFalse(Contains(snapshot->GetPlanesVisibleFromPlane(partitionFront), wallX0), L"Wall behind partition visible");
+			Assert::IsFalse(Contains(snapshot->GetPlanesVisibleFromPlane(wallX0), partitionFront), L"Partition visible from behind");
+			Assert::IsTrue(Contains(snapshot->GetPlanesVisibleFromPlane(partitionBack), wallX0), L"Wall in front of partition back not visible");
+			Assert::IsFalse(Contains(snapshot->GetPlanesVisibleFromPlane(partitionBack), wallX2), L"Wall behind partition back visible");
+
+			Assert::IsTrue(snapshot->NumEdges() > 0, L"No partition edges");
+			for (size_t i = 0; i < snapshot->NumEdges(); ++i)
+			{
+				Assert::IsTrue(Contains(snapshot->GetEdgesVisibleFromPlane(floor), i), L"Edge not visible from floor");
+				Assert::IsTrue(Contains(snapshot->GetPlanesVisibleFromEdge(i), floor), L"Floor not visible from edge");
+				Assert::IsFalse(Contains(snapshot->GetPlanesVisibleFromEdge(i), partitionFront), L"Edge plane visible from edge");
+				Assert::IsFalse(Contains(snapshot->GetEdgesVisibleFromPlane(partitionBack), i), L"Edge visible from edge plane");
+			}
+		}
+	};
+}
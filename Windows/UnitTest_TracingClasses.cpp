@@ -4,10 +4,14 @@
 #include "Common/Definitions.h"
 #include "Common/Vec3.h"
 
+#include "Common/ThreadPool.h"
+
 #include "Spatialiser/Room.h"
 #include "Spatialiser/TracingUtils.h"
+#include "Spatialiser/TracingThread.h"
 
 #include <numeric>
+#include <random>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 namespace RAC
@@ -283,8 +287,8 @@ namespace RAC
 		{
 			Room testRoom(1);
 			buildTestMesh(testRoom);
-			testRoom.CreateTriangleMeshSoA();
-			Assert::AreEqual(14, testRoom.GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			Assert::AreEqual(14, snapshot->GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
 
 			std::vector<Vec3> testDirections;
 			testDirections.resize(6);
@@ -323,7 +327,7 @@ namespace RAC
 			int expected_idx_front, result_idx_front, expected_idx_back, result_idx_back;
 			for (int oi = 0; oi < 2; ++oi) {
 				testPencil.moveOrigin(testOrigins[oi]);
-				testPencil.traceAll(testRoom.GetTriangleMeshSoA());
+				testPencil.traceAll(snapshot->GetTriangleMeshSoA());
 
 				testPencil.getDistances(rayDistances);
 				testPencil.getCosines(rayCosines);
@@ -507,6 +511,63 @@ namespace RAC
 			// TODO: Test with non-normalized directions to ensure the cosine similarity calculation is still meaningful (weighted clustering).
 		}
 
+		// Test that clustering with a DirectionLookup matches the exhaustive clustering (validated in previous test), including ties.
+		TEST_METHOD(PencilClassClusteringLookup)
+		{
+			std::mt19937 rng(4);
+			std::normal_distribution<Real> normal(0.0, 1.0);
+			std::uniform_real_distribution<Real> weight(0.5, 2.0);
+
+			// Rays along the axes, cube edges and cube corners tie between symmetric reference directions
+			std::vector<Vec3> rayDirections;
+			for (int x = -1; x <= 1; ++x)
+				for (int y = -1; y <= 1; ++y)
+					for (int z = -1; z <= 1; ++z)
+						if (x != 0 || y != 0 || z != 0)
+							rayDirections.push_back(Vec3(static_cast<Real>(x), static_cast<Real>(y), static_cast<Real>(z)));
+			for (int i = 0; i < 2000; ++i)
+				rayDirections.push_back(Vec3(normal(rng), normal(rng), normal(rng)));
+
+			std::vector<Vec3> testDirections;
+			for (int numClusters : { 0, 1, 2, 3, 4, 6, 8, 12, 20, 24, 48 })
+			{
+				for (bool weighted : { false, true })
+				{
+					if (numClusters > 20)
+					{
+						// Random directions (more than DIRECTION_LOOKUP_MAX_EXHAUSTIVE, so searched with the cube map)
+						testDirections.resize(numClusters);
+						for (Vec3& direction : testDirections)
+							direction = Vec3(normal(rng), normal(rng), normal(rng)).Normalised();
+					}
+					else
+						PlatonicVertices(numClusters, testDirections);
+					if (weighted)
+					{
+						for (Vec3& direction : testDirections)
+							direction *= weight(rng);
+					}
+
+					DirectionLookup lookup;
+					lookup.build(testDirections);
+
+					for (bool hemisphereOnly : { true, false })
+					{
+						for (const RayPencil& testPencil : { RayPencil(rayDirections), RayPencil(1000, hemisphereOnly) })
+						{
+							const int numRays = testPencil.getNumRays();
+							Vec<int> expectedClusters = Vec<int>::Constant(numRays, -2);
+							Vec<int> rayClusters = Vec<int>::Constant(numRays, -2);
+							testPencil.clusterDirections(testDirections, expectedClusters);
+							testPencil.clusterDirections(lookup, rayClusters);
+							for (int i = 0; i < numRays; ++i)
+								Assert::AreEqual(expectedClusters(i), rayClusters(i), L"\nLookup cluster differs from exhaustive cluster.");
+						}
+					}
+				}
+			}
+		}
+
 		// Test hemisphere constructor of RayPencil, using directions clustering (validated in previous test)
 		TEST_METHOD(PencilClassHemisphere)
 		{
@@ -558,7 +619,209 @@ namespace RAC
 			}
 		}
 
-		// TODO: Test RayBundle::traceAll
+		// Test that RayPencil::traceAll and RayBundle::traceAll give the same results when tracing on a thread pool.
+		TEST_METHOD(TraceAllThreadPool)
+		{
+			Room testRoom(1);
+			buildTestMesh(testRoom);
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			const TriangleMeshSoA& triangles = snapshot->GetTriangleMeshSoA();
+
+			ThreadPool threadPool(3);
+			const Vec3 origin(0.1, 0.1, 1e-6);
+			for (const int numDirections : { 1, 63, 64, 1000 })
+			{
+				RayPencil serialPencil(numDirections, false);
+				RayPencil parallelPencil(numDirections, false);
+				serialPencil.moveOrigin(origin);
+				parallelPencil.moveOrigin(origin);
+				serialPencil.traceAll(triangles);
+				parallelPencil.traceAll(triangles, &threadPool);
+
+				Vec<> serialDistances(numDirections), parallelDistances(numDirections);
+				Vec<int> serialFront(numDirections), serialBack(numDirections), parallelFront(numDirections), parallelBack(numDirections);
+				serialPencil.getDistances(serialDistances);
+				parallelPencil.getDistances(parallelDistances);
+				serialPencil.getIndices(serialFront, serialBack);
+				parallelPencil.getIndices(parallelFront, parallelBack);
+				for (int i = 0; i < numDirections; ++i)
+				{
+					Assert::AreEqual(serialFront(i), parallelFront(i), L"\nIncorrect pencil front index.");
+					Assert::AreEqual(serialBack(i), parallelBack(i), L"\nIncorrect pencil back index.");
+					Assert::AreEqual(std::isnan(serialDistances(i)), std::isnan(parallelDistances(i)), L"\nIncorrect pencil distance.");
+					if (!std::isnan(serialDistances(i)))
+						Assert::AreEqual(serialDistances(i), parallelDistances(i), L"\nIncorrect pencil distance.");
+				}
+
+				std::vector<Vec3> directions(numDirections);
+				serialPencil.getDirections(directions);
+				RayBundle serialBundle(origin, directions);
+				RayBundle parallelBundle(origin, directions);
+				serialBundle.traceAll(triangles);
+				parallelBundle.traceAll(triangles, &threadPool);
+
+				Vec<int> serialCurrent(numDirections), serialPrevious(numDirections), parallelCurrent(numDirections), parallelPrevious(numDirections);
+				serialBundle.getIndices(serialCurrent, serialPrevious);
+				parallelBundle.getIndices(parallelCurrent, parallelPrevious);
+				for (int i = 0; i < numDirections; ++i)
+				{
+					Assert::AreEqual(serialCurrent(i), parallelCurrent(i), L"\nIncorrect bundle current index.");
+					Assert::AreEqual(serialPrevious(i), parallelPrevious(i), L"\nIncorrect bundle previous index.");
+				}
+			}
+		}
+
+		// Test that RayPencil::setDirections gives the same results as a pencil constructed with the new directions.
+		TEST_METHOD(PencilClassSetDirections)
+		{
+			Room testRoom(1);
+			buildTestMesh(testRoom);
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			const TriangleMeshSoA& triangles = snapshot->GetTriangleMeshSoA();
+
+			const int numDirections = 500;
+			const Vec3 origin(0.1, 0.1, 1e-6);
+			RayPencil testPencil(numDirections, true);
+			testPencil.moveOrigin(origin);
+
+			// Rotate the hemisphere about the x axis, so the mirror copies still cover the sphere
+			std::vector<Vec3> directions(2 * numDirections);
+			testPencil.getDirections(directions);
+			directions.resize(numDirections);
+			for (Vec3& direction : directions)
+				direction = Vec3(direction.x(), 0.6 * direction.y() - 0.8 * direction.z(), 0.8 * direction.y() + 0.6 * direction.z());
+			testPencil.setDirections(directions);
+			testPencil.traceAll(triangles);
+
+			RayPencil expectedPencil(directions);
+			expectedPencil.moveOrigin(origin);
+			expectedPencil.traceAll(triangles);
+
+			std::vector<Vec3> newDirections(2 * numDirections);
+			testPencil.getDirections(newDirections);
+			Vec<> distances(2 * numDirections), expectedDistances(numDirections);
+			Vec<int> front(2 * numDirections), back(2 * numDirections), expectedFront(numDirections), expectedBack(numDirections);
+			testPencil.getDistances(distances);
+			testPencil.getIndices(front, back);
+			expectedPencil.getDistances(expectedDistances);
+			expectedPencil.getIndices(expectedFront, expectedBack);
+			for (int i = 0; i < numDirections; ++i)
+			{
+				Assert::IsTrue((newDirections[i] - directions[i]).Normal() < EPS, L"\nIncorrect direction.");
+				Assert::IsTrue((newDirections[i + numDirections] + directions[i]).Normal() < EPS, L"\nIncorrect mirrored direction.");
+				Assert::AreEqual(expectedFront(i), front(i), L"\nIncorrect front index.");
+				Assert::AreEqual(expectedBack(i), back(i), L"\nIncorrect back index.");
+				Assert::AreEqual(expectedBack(i), front(i + numDirections), L"\nIncorrect mirrored front index.");
+				Assert::AreEqual(std::isnan(expectedDistances(i)), std::isnan(distances(i)), L"\nIncorrect distance.");
+				if (!std::isnan(expectedDistances(i)))
+					Assert::AreEqual(expectedDistances(i), distances(i), L"\nIncorrect distance.");
+			}
+		}
+
+		// Test that averaging the updates of a progressive target gives the result of tracing all the rays at once.
+		TEST_METHOD(ProgressiveTargetConvergence)
+		{
+			Room testRoom(1);
+			buildTestMesh(testRoom);
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			const TriangleMeshSoA& triangles = snapshot->GetTriangleMeshSoA();
+
+			// Fraction of the rays of a pencil that hit a triangle in front
+			const Vec3 origin(0.1, 0.1, 1e-6);
+			auto hitFraction = [&](RayPencil& pencil)
+				{
+					pencil.moveOrigin(origin);
+					pencil.traceAll(triangles);
+					const int numRays = pencil.getNumRays();
+					Vec<int> front(numRays), back(numRays);
+					pencil.getIndices(front, back);
+					int hits = 0;
+					for (int i = 0; i < numRays; ++i)
+						hits += front(i) >= 0 ? 1 : 0;
+					return static_cast<Real>(hits) / static_cast<Real>(numRays);
+				};
+
+			RayPencil fullPencil(1200, false);
+			const int numRays = fullPencil.getNumRays();
+			const Real expected = hitFraction(fullPencil);
+			std::vector<Vec3> directions(numRays);
+			fullPencil.getDirections(directions);
+
+			// Each update traces a different quarter of the rays
+			const int numPencilRays = numRays / 4;
+			const int updatesToConverge = 4;
+			const Real smoothing = static_cast<Real>(numPencilRays) / static_cast<Real>(numRays);
+			ProgressiveTarget target;
+			Real accumulated = 0.0;
+			for (int update = 0; update < updatesToConverge; ++update)
+			{
+				Assert::IsTrue(target.NeedsRefinement(origin, updatesToConverge), L"\nConverged too early.");
+				RayPencil pencil(std::vector<Vec3>(directions.begin() + update * numPencilRays, directions.begin() + (update + 1) * numPencilRays));
+				const Real value = hitFraction(pencil);
+				const Real weight = target.BeginUpdate(origin, (Real)0.05, smoothing);
+				accumulated = weight >= 1.0 ? value : accumulated + weight * (value - accumulated);
+			}
+			Assert::IsFalse(target.NeedsRefinement(origin, updatesToConverge), L"\nNot converged.");
+			Assert::AreEqual(expected, accumulated, EPS, L"\nIncorrect accumulated result.");
+		}
+
+		// Test that a progressive target restarts its accumulation once it moves further than the threshold.
+		TEST_METHOD(ProgressiveTargetRestart)
+		{
+			const Real threshold = (Real)0.5;
+			const Real smoothing = (Real)0.25;
+			const Vec3 anchor(1.0, 2.0, 3.0);
+			ProgressiveTarget target(2);
+			Assert::AreEqual((Real)1.0, target.BeginUpdate(anchor, threshold, smoothing), EPS, L"\nIncorrect first weight.");
+			target.UpdateDirection(0, smoothing);
+
+			// Small movements keep accumulating, measured from the position of the last restart
+			Vec3 position = anchor + Vec3(0.3, 0.0, 0.0);
+			Assert::AreEqual((Real)0.5, target.BeginUpdate(position, threshold, smoothing), EPS, L"\nIncorrect second weight.");
+			target.UpdateDirection(0, smoothing);
+			Assert::IsTrue(target.NeedsRefinement(anchor, 2), L"\nMoved target does not need refinement.");
+			Assert::IsFalse(target.NeedsRefinement(position, 2), L"\nConverged target needs refinement.");
+			position = anchor + Vec3(0.45, 0.0, 0.0);
+			Assert::AreEqual((Real)(1.0 / 3.0), target.BeginUpdate(position, threshold, smoothing), EPS, L"\nIncorrect third weight.");
+			Assert::AreEqual(3, target.GetNumUpdates(), L"\nIncorrect number of updates.");
+			Assert::AreEqual(2, target.GetNumDirectionUpdates(0), L"\nIncorrect number of direction updates.");
+
+			// Moving beyond the threshold restarts the target and its directions
+			position = anchor + Vec3(0.6, 0.0, 0.0);
+			Assert::AreEqual((Real)1.0, target.BeginUpdate(position, threshold, smoothing), EPS, L"\nIncorrect weight after restart.");
+			Assert::AreEqual(1, target.GetNumUpdates(), L"\nIncorrect number of updates after restart.");
+			Assert::AreEqual(0, target.GetNumDirectionUpdates(0), L"\nDirection updates not restarted.");
+			Assert::AreEqual((Real)1.0, target.UpdateDirection(0, smoothing), EPS, L"\nIncorrect direction weight after restart.");
+
+			target.Reset();
+			Assert::AreEqual(0, target.GetNumUpdates(), L"\nIncorrect number of updates after reset.");
+			Assert::IsTrue(target.NeedsRefinement(position, 1), L"\nReset target does not need refinement.");
+			Assert::AreEqual((Real)1.0, target.BeginUpdate(position, threshold, smoothing), EPS, L"\nIncorrect weight after reset.");
+		}
+
+		// Test that converged targets weight updates by the smoothing, and that directions skipped by an update are weighted by their own updates.
+		TEST_METHOD(ProgressiveTargetSmoothing)
+		{
+			const Real smoothing = (Real)0.25;
+			const Vec3 position(1.0, 2.0, 3.0);
+			ProgressiveTarget target(2);
+			int direction1Updates = 0;
+			for (int update = 1; update <= 12; ++update)
+			{
+				const Real expectedWeight = std::max(smoothing, (Real)1.0 / update);
+				Assert::AreEqual(expectedWeight, target.BeginUpdate(position, (Real)0.05, smoothing), EPS, L"\nIncorrect target weight.");
+				Assert::AreEqual(expectedWeight, target.UpdateDirection(0, smoothing), EPS, L"\nIncorrect direction weight.");
+
+				// Direction 1 only receives rays on every third update
+				if (update % 3 != 0)
+					continue;
+				++direction1Updates;
+				Assert::AreEqual(std::max(smoothing, (Real)1.0 / direction1Updates), target.UpdateDirection(1, smoothing), EPS, L"\nIncorrect skipped direction weight.");
+			}
+			Assert::AreEqual(smoothing, target.BeginUpdate(position, (Real)0.05, smoothing), EPS, L"\nIncorrect steady state weight.");
+			Assert::AreEqual(4, target.GetNumDirectionUpdates(1), L"\nIncorrect number of skipped direction updates.");
+		}
+
 		// TODO: Implement and test RayBundle::advanceAndReflect
 		// TODO: Implement and test RayBundle::clusterDirections
 		// TODO: Implement and test a third contructor of RayBundle, with single origin and hemisphere distribution
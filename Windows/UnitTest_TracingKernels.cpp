@@ -0,0 +1,172 @@
+#include "CppUnitTest.h"
+#include "UtilityFunctions.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/TracingUtils.h"
+#include "Spatialiser/TracingKernels.h"
+
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(TracingKernelsTests)
+	{
+		// Build a mesh of random triangles of varied size (not a multiple of the block size, so the last block is padded)
+		TriangleMeshSoA buildTestMesh(int numTriangles, std::mt19937& rng)
+		{
+			std::uniform_real_distribution<Real> position(-5.0, 5.0);
+			std::uniform_real_distribution<Real> logSize(-3.0, 1.0);
+			std::normal_distribution<Real> normal(0.0, 1.0);
+
+			TriangleMeshSoA mesh;
+			mesh.resize(numTriangles);
+			for (int i = 0; i < numTriangles; ++i)
+			{
+				const Real size = std::pow(REAL_CONST(10.0), logSize(rng));
+				const Vec3 a(position(rng), position(rng), position(rng));
+				const Vec3 b = a + size * Vec3(normal(rng), normal(rng), normal(rng));
+				const Vec3 c = a + size * Vec3(normal(rng), normal(rng), normal(rng));
+
+				Vec3 n = (b - a).cross(c - a);
+				n.Normalise();
+				mesh.A[i] = a;
+				mesh.edge1[i] = b - a;
+				mesh.edge2[i] = c - a;
+				mesh.n[i] = normal(rng) > 0.0 ? n : -n;
+				mesh.patchId[i] = i;
+				mesh.d0PlusEPS[i] = mesh.n[i].dot(a) + EPS_FACING;
+			}
+			mesh.build_blocks();
+			return mesh;
+		}
+
+		// Random ray, aimed at a vertex or an edge of a random triangle for half of the rays
+		void randomRay(const TriangleMeshSoA& mesh, std::mt19937& rng, Vec3& origin, Vec3& direction)
+		{
+			std::uniform_real_distribution<Real> position(-6.0, 6.0);
+			std::uniform_real_distribution<Real> unit(0.0, 1.0);
+			std::normal_distribution<Real> normal(0.0, 1.0);
+			std::uniform_int_distribution<int> triangle(0, mesh.size() - 1);
+
+			origin = Vec3(position(rng), position(rng), position(rng));
+			const int i = triangle(rng);
+			switch (rng() % 4)
+			{
+			case 0:
+				direction = mesh.A[i] - origin;
+				break;
+			case 1:
+				direction = mesh.A[i] + unit(rng) * mesh.edge1[i] - origin;
+				break;
+			default:
+				direction = Vec3(normal(rng), normal(rng), normal(rng));
+				break;
+			}
+			direction.Normalise();
+		}
+
+	public:
+		TEST_METHOD(FilterIsConservative)
+		{
+			if (!cpu_supports_avx2())
+				return;
+
+			std::mt19937 rng(3);
+			const TriangleMeshSoA mesh = buildTestMesh(203, rng);
+			Assert::AreEqual(26, mesh.blocks.num_blocks(), L"Incorrect number of blocks");
+
+			std::vector<uint8_t> masks(mesh.blocks.num_blocks());
+			int numRejected = 0;
+			for (int ray = 0; ray < 5000; ++ray)
+			{
+				Vec3 origin, direction;
+				randomRay(mesh, rng, origin, direction);
+				filter_triangles_avx2(mesh.blocks, 0, mesh.blocks.num_blocks(), origin, direction, masks.data());
+
+				for (int i = 0; i < mesh.size(); ++i)
+				{
+					const bool candidate = masks[i / TRIANGLE_BLOCK_SIZE] & (1 << (i % TRIANGLE_BLOCK_SIZE));
+					Real distance, cosine;
+					if (intersection_test(mesh, i, origin, direction, distance, cosine))
+						Assert::IsTrue(candidate, L"Kernel rejected an intersecting triangle");
+					else if (!candidate)
+						++numRejected;
+				}
+
+				// Padding triangles are always rejected
+				for (int i = mesh.size(); i < mesh.blocks.num_blocks() * TRIANGLE_BLOCK_SIZE; ++i)
+					Assert::IsFalse(masks[i / TRIANGLE_BLOCK_SIZE] & (1 << (i % TRIANGLE_BLOCK_SIZE)), L"Padding triangle not rejected");
+			}
+			Assert::IsTrue(numRejected > 5000 * 150, L"Kernel rejected too few triangles");
+		}
+
+		TEST_METHOD(CandidatesMatchBlocks)
+		{
+			if (!cpu_supports_avx2())
+				return;
+
+			std::mt19937 rng(9);
+			const TriangleMeshSoA mesh = buildTestMesh(203, rng);
+			std::vector<uint8_t> blockMasks(mesh.blocks.num_blocks());
+			std::uniform_int_distribution<int> triangle(0, mesh.size() - 1);
+			for (int ray = 0; ray < 2000; ++ray)
+			{
+				Vec3 origin, direction;
+				randomRay(mesh, rng, origin, direction);
+				filter_triangles_avx2(mesh.blocks, 0, mesh.blocks.num_blocks(), origin, direction, blockMasks.data());
+
+				// Random candidate list (not a multiple of the block size)
+				std::vector<int> candidates(1 + ray % 37);
+				for (int& i : candidates)
+					i = triangle(rng);
+				std::vector<uint8_t> masks((candidates.size() + TRIANGLE_BLOCK_SIZE - 1) / TRIANGLE_BLOCK_SIZE, 0xAA);
+				filter_candidates_avx2(mesh.blocks, candidates.data(), static_cast<int>(candidates.size()), origin, direction, masks.data());
+
+				for (int k = 0; k < static_cast<int>(masks.size()) * TRIANGLE_BLOCK_SIZE; ++k)
+				{
+					const bool candidate = masks[k / TRIANGLE_BLOCK_SIZE] & (1 << (k % TRIANGLE_BLOCK_SIZE));
+					if (k >= static_cast<int>(candidates.size()))
+					{
+						Assert::IsFalse(candidate, L"Padding candidate not rejected");
+						continue;
+					}
+					const int i = candidates[k];
+					const bool expected = blockMasks[i / TRIANGLE_BLOCK_SIZE] & (1 << (i % TRIANGLE_BLOCK_SIZE));
+					Assert::AreEqual(expected, candidate, L"Gathered filter differs from block filter");
+				}
+			}
+		}
+
+		TEST_METHOD(TraceMatchesScalar)
+		{
+			std::mt19937 rng(5);
+			const TriangleMeshSoA mesh = buildTestMesh(61, rng);
+			TriangleMeshSoA scalarMesh = mesh;
+			scalarMesh.blocks.resize(0);
+
+			for (int ray = 0; ray < 5000; ++ray)
+			{
+				Vec3 origin, direction;
+				randomRay(mesh, rng, origin, direction);
+
+				int idxFront, idxBack, expectedIdxFront, expectedIdxBack;
+				Real distFront, distBack, cosFront, cosBack;
+				Real expectedDistFront, expectedDistBack, expectedCosFront, expectedCosBack;
+				trace_ray(mesh, origin, direction, idxFront, distFront, cosFront, idxBack, distBack, cosBack);
+				trace_ray(scalarMesh, origin, direction, expectedIdxFront, expectedDistFront, expectedCosFront, expectedIdxBack, expectedDistBack, expectedCosBack);
+
+				Assert::AreEqual(expectedIdxFront, idxFront, L"Incorrect front patch");
+				Assert::AreEqual(expectedIdxBack, idxBack, L"Incorrect back patch");
+				if (expectedIdxFront >= 0)
+					Assert::AreEqual(expectedDistFront, distFront, L"Incorrect front distance");
+				if (expectedIdxBack >= 0)
+					Assert::AreEqual(expectedDistBack, distBack, L"Incorrect back distance");
+			}
+		}
+	};
+}
@@ -132,8 +132,8 @@ namespace RAC
 		{
 			Room testRoom(1);
 			buildTestMesh(testRoom);
-			testRoom.CreateTriangleMeshSoA();
-			Assert::AreEqual(14, testRoom.GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			Assert::AreEqual(14, snapshot->GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
 
 			std::vector<Vec3> testDirections;
 			testDirections.resize(6);
@@ -158,7 +158,7 @@ namespace RAC
 						result_distance = std::numeric_limits<Real>::quiet_NaN();
 						result_cosine = std::numeric_limits<Real>::quiet_NaN();
 						const bool success = intersection_test(
-							testRoom.GetTriangleMeshSoA(), ti,
+							snapshot->GetTriangleMeshSoA(), ti,
 							testOrigins[oi], testDirections[di],
 							result_distance, result_cosine);
 
@@ -195,8 +195,8 @@ namespace RAC
 		{
 			Room testRoom(1);
 			buildTestMesh(testRoom);
-			testRoom.CreateTriangleMeshSoA();
-			Assert::AreEqual(14, testRoom.GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			Assert::AreEqual(14, snapshot->GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
 
 			std::vector<Vec3> testDirections;
 			testDirections.resize(6);
@@ -223,7 +223,7 @@ namespace RAC
 					expected_idx_back = EXPECTED_IDX_PAIR[oi][di][1];
 
 					trace_ray(
-						testRoom.GetTriangleMeshSoA(),
+						snapshot->GetTriangleMeshSoA(),
 						testOrigins[oi], testDirections[di],
 						result_idx_front, result_distance_front, result_cosine_front,
 						result_idx_back, result_distance_back, result_cosine_back);
@@ -271,8 +271,8 @@ namespace RAC
 		{
 			Room testRoom(1);
 			buildTestMesh(testRoom);
-			testRoom.CreateTriangleMeshSoA();
-			Assert::AreEqual(14, testRoom.GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			Assert::AreEqual(14, snapshot->GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
 
 			std::vector<Vec3> testDirections;
 			testDirections.resize(6);
@@ -307,7 +307,7 @@ namespace RAC
 						result_distance = std::numeric_limits<Real>::quiet_NaN();
 						result_cosine = std::numeric_limits<Real>::quiet_NaN();
 						const bool success = intersection_test(
-							testRoom.GetTriangleMeshSoA(), ti,
+							snapshot->GetTriangleMeshSoA(), ti,
 							testRays, di,
 							result_distance, result_cosine);
 
@@ -344,8 +344,8 @@ namespace RAC
 		{
 			Room testRoom(1);
 			buildTestMesh(testRoom);
-			testRoom.CreateTriangleMeshSoA();
-			Assert::AreEqual(14, testRoom.GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			Assert::AreEqual(14, snapshot->GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
 
 			std::vector<Vec3> testDirections;
 			testDirections.resize(6);
@@ -382,7 +382,7 @@ namespace RAC
 					expected_idx_back = EXPECTED_IDX_PAIR[oi][di][1];
 
 					trace_ray(
-						testRoom.GetTriangleMeshSoA(),
+						snapshot->GetTriangleMeshSoA(),
 						testRays, di,
 						result_idx_front, result_distance_front, result_cosine_front,
 						result_idx_back, result_distance_back, result_cosine_back);
@@ -432,8 +432,8 @@ namespace RAC
 		{
 			Room testRoom(1);
 			buildTestMesh(testRoom);
-			testRoom.CreateTriangleMeshSoA();
-			Assert::AreEqual(14, testRoom.GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			Assert::AreEqual(14, snapshot->GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
 
 			std::vector<Vec3> testDirections;
 			testDirections.resize(6);
@@ -470,7 +470,7 @@ namespace RAC
 						result_distance = std::numeric_limits<Real>::quiet_NaN();
 						result_cosine = std::numeric_limits<Real>::quiet_NaN();
 						const bool success = intersection_test(
-							testRoom.GetTriangleMeshSoA(), ti,
+							snapshot->GetTriangleMeshSoA(), ti,
 							testRays, di + (oi * 6),
 							result_distance, result_cosine);
 
@@ -507,8 +507,8 @@ namespace RAC
 		{
 			Room testRoom(1);
 			buildTestMesh(testRoom);
-			testRoom.CreateTriangleMeshSoA();
-			Assert::AreEqual(14, testRoom.GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
+			std::shared_ptr<const RoomSnapshot> snapshot = testRoom.GetSnapshot();
+			Assert::AreEqual(14, snapshot->GetTriangleMeshSoA().size(), L"\nThe test room does not contain 14 triangles.");
 
 			std::vector<Vec3> testDirections;
 			testDirections.resize(6);
@@ -547,7 +547,7 @@ namespace RAC
 					expected_idx_back = EXPECTED_IDX_PAIR[oi][di][1];
 
 					trace_ray(
-						testRoom.GetTriangleMeshSoA(),
+						snapshot->GetTriangleMeshSoA(),
 						testRays, di + (oi * 6),
 						result_idx_front, result_distance_front, result_cosine_front,
 						result_idx_back, result_distance_back, result_cosine_back);
@@ -590,6 +590,41 @@ namespace RAC
 			}
 		}
 
+		// Test that RayPacketSoA::build groups every ray into exactly one packet, with narrow bounding cones.
+		TEST_METHOD(PacketSoABuild)
+		{
+			for (const int numRays : { 1, 17, 1000, 5000 })
+			{
+				RayPencilSoA rays;
+				rays.resize(numRays);
+				rays.fill_uniform_sphere(false);
+
+				RayPacketSoA packets;
+				packets.build(rays.D);
+				// Packets do not span the faces of the cube, so each face may add one partial packet
+				const int minPackets = (numRays + RAY_PACKET_SIZE - 1) / RAY_PACKET_SIZE;
+				Assert::IsTrue(packets.num_packets() >= minPackets && packets.num_packets() <= minPackets + 6, L"\nIncorrect number of packets.");
+
+				std::vector<int> count(numRays, 0);
+				for (int packet = 0; packet < packets.num_packets(); ++packet)
+				{
+					Assert::IsTrue(packets.packet_size(packet) > 0 && packets.packet_size(packet) <= RAY_PACKET_SIZE, L"\nIncorrect packet size.");
+					for (int j = 0; j < packets.packet_size(packet); ++j)
+					{
+						const int i = packets.rayIndex[packets.packetStart[packet] + j];
+						++count[i];
+						Assert::IsTrue(rays.D[i].dot(packets.axis[packet]) >= packets.cosSpread[packet], L"\nRay outside the packet cone.");
+					}
+
+					// Packets of adjacent rays cover roughly RAY_PACKET_SIZE / numRays of the sphere
+					if (numRays >= 1000)
+						Assert::IsTrue(packets.cosSpread[packet] > 0.8, L"\nPacket is too wide.");
+				}
+				for (int i = 0; i < numRays; ++i)
+					Assert::AreEqual(1, count[i], L"\nRay not in exactly one packet.");
+			}
+		}
+
 		// TODO: Test RayBundleSoA::fill_uniform_sphere (by clustering?)
 
 		// TODO: Make sure surface normal vectors are normalized at all times.
@@ -0,0 +1,230 @@
+#include "CppUnitTest.h"
+#include "UtilityFunctions.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/TracingUtils.h"
+
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(TriangleBVHTests)
+	{
+		// Add a triangle with the normal facing the given point
+		void addTriangle(TriangleMeshSoA& mesh, const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& facing)
+		{
+			Vec3 normal = (b - a).cross(c - a);
+			normal.Normalise();
+			if (normal.dot(facing - a) < 0.0)
+				normal = -normal;
+
+			const int i = mesh.size();
+			mesh.A.push_back(a);
+			mesh.edge1.push_back(b - a);
+			mesh.edge2.push_back(c - a);
+			mesh.n.push_back(normal);
+			mesh.patchId.push_back(i);
+			mesh.d0PlusEPS.push_back(normal.dot(a) + EPS_FACING);
+		}
+
+		// Build a shoebox with each face split into a grid of triangles, z-fighting copies of some faces and random interior triangles
+		TriangleMeshSoA buildTestMesh(int gridSize, int numInterior, std::mt19937& rng)
+		{
+			const Vec3 size(4.0, 3.0, 2.5);
+			const Vec3 centre = 0.5 * size;
+			TriangleMeshSoA mesh;
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+				for (const Real side : { 0.0, 1.0 })
+				{
+					for (int i = 0; i < gridSize; ++i)
+					{
+						for (int j = 0; j < gridSize; ++j)
+						{
+							std::array<Vec3, 4> corners;
+							for (int k = 0; k < 4; ++k)
+							{
+								std::array<Real, 3> p;
+								p[axis] = side * (axis == 0 ? size.x() : axis == 1 ? size.y() : size.z());
+								p[u] = (i + (k & 1)) * (u == 0 ? size.x() : u == 1 ? size.y() : size.z()) / gridSize;
+								p[v] = (j + (k >> 1)) * (v == 0 ? size.x() : v == 1 ? size.y() : size.z()) / gridSize;
+								corners[k] = Vec3(p[0], p[1], p[2]);
+							}
+							addTriangle(mesh, corners[0], corners[1], corners[3], centre);
+							addTriangle(mesh, corners[0], corners[3], corners[2], centre);
+						}
+					}
+				}
+			}
+
+			// Copies of the x = 0 face z-fight with the originals. The offset copies chain over more than EPS_ZFIGHT,
+			// so the result depends on hits further than EPS_ZFIGHT from the nearest one
+			const int numFaceTriangles = mesh.size();
+			for (int i = 0; i < 2 * gridSize * gridSize; ++i)
+			{
+				const Vec3 a = mesh.A[i], b = a + mesh.edge1[i], c = a + mesh.edge2[i];
+				addTriangle(mesh, a, b, c, centre);
+				for (const Real offset : { 0.6 * EPS_ZFIGHT, 1.2 * EPS_ZFIGHT })
+				{
+					const Vec3 shift(offset, 0.0, 0.0);
+					addTriangle(mesh, a + shift, b + shift, c + shift, centre);
+				}
+			}
+
+			std::uniform_real_distribution<Real> unit(0.0, 1.0);
+			std::uniform_real_distribution<Real> spread(-0.5, 0.5);
+			for (int i = 0; i < numInterior; ++i)
+			{
+				const Vec3 a(unit(rng) * size.x(), unit(rng) * size.y(), unit(rng) * size.z());
+				const Vec3 b = a + Vec3(spread(rng), spread(rng), spread(rng));
+				const Vec3 c = a + Vec3(spread(rng), spread(rng), spread(rng));
+				const Vec3 facing = a + Vec3(spread(rng), spread(rng), spread(rng));
+				addTriangle(mesh, a, b, c, facing);
+			}
+			Assert::AreEqual(numFaceTriangles + 6 * gridSize * gridSize + numInterior, mesh.size(), L"Incorrect number of triangles");
+			return mesh;
+		}
+
+		void assertSameResult(const TriangleMeshSoA& mesh, const TriangleMeshSoA& bruteForce, const Vec3& origin, const Vec3& direction, int ignoredTriangleIndex)
+		{
+			int idxFront, idxBack, expectedIdxFront, expectedIdxBack;
+			Real distFront, distBack, cosFront, cosBack;
+			Real expectedDistFront, expectedDistBack, expectedCosFront, expectedCosBack;
+
+			trace_ray(mesh, origin, direction, idxFront, distFront, cosFront, idxBack, distBack, cosBack, ignoredTriangleIndex);
+			trace_ray(bruteForce, origin, direction, expectedIdxFront, expectedDistFront, expectedCosFront, expectedIdxBack, expectedDistBack, expectedCosBack, ignoredTriangleIndex);
+
+			Assert::AreEqual(expectedIdxFront, idxFront, L"Incorrect front patch");
+			Assert::AreEqual(expectedIdxBack, idxBack, L"Incorrect back patch");
+			Assert::AreEqual(std::isnan(expectedDistFront), std::isnan(distFront), L"Incorrect front hit");
+			Assert::AreEqual(std::isnan(expectedDistBack), std::isnan(distBack), L"Incorrect back hit");
+			if (!std::isnan(expectedDistFront))
+			{
+				Assert::AreEqual(expectedDistFront, distFront, L"Incorrect front distance");
+				Assert::AreEqual(expectedCosFront, cosFront, L"Incorrect front cosine");
+			}
+			if (!std::isnan(expectedDistBack))
+			{
+				Assert::AreEqual(expectedDistBack, distBack, L"Incorrect back distance");
+				Assert::AreEqual(expectedCosBack, cosBack, L"Incorrect back cosine");
+			}
+		}
+
+	public:
+		TEST_METHOD(Build)
+		{
+			std::mt19937 rng(1);
+			TriangleMeshSoA mesh = buildTestMesh(2, 10, rng);
+			Assert::IsTrue(mesh.bvh.Empty(), L"BVH built before Build");
+
+			mesh.bvh.Build(mesh.A, mesh.edge1, mesh.edge2);
+			Assert::AreEqual(static_cast<size_t>(mesh.size()), mesh.bvh.Size(), L"Incorrect number of triangles");
+
+			// Rays parallel to a face are traced against every triangle
+			Assert::IsTrue(mesh.bvh.IsGrazing(Vec3(1.0, 0.0, 0.0)), L"Ray parallel to a face not grazing");
+			Assert::IsFalse(mesh.bvh.IsGrazing(Vec3(1.0, 2.0, 3.0).Normalised()), L"Oblique ray is grazing");
+
+			mesh.resize(0);
+			Assert::IsTrue(mesh.bvh.Empty(), L"BVH not cleared by resize");
+			mesh.build_bvh();
+			Assert::IsTrue(mesh.bvh.Empty(), L"BVH of empty mesh not empty");
+
+			int idxFront, idxBack;
+			Real distFront, distBack, cosFront, cosBack;
+			trace_ray(mesh, Vec3(1.0, 1.0, 1.0), Vec3(0.0, 0.0, 1.0), idxFront, distFront, cosFront, idxBack, distBack, cosBack);
+			Assert::AreEqual(-1, idxFront, L"Hit in empty mesh");
+			Assert::AreEqual(-1, idxBack, L"Hit in empty mesh");
+		}
+
+		TEST_METHOD(MatchesBruteForce)
+		{
+			std::mt19937 rng(7);
+			for (const int gridSize : { 2, 3, 8 })
+			{
+				TriangleMeshSoA mesh = buildTestMesh(gridSize, 20 * gridSize, rng);
+				TriangleMeshSoA bruteForce = mesh;
+				mesh.bvh.Build(mesh.A, mesh.edge1, mesh.edge2);
+
+				std::uniform_real_distribution<Real> position(0.1, 2.4);
+				std::normal_distribution<Real> normal(0.0, 1.0);
+				std::uniform_int_distribution<int> triangle(0, mesh.size() - 1);
+				for (int i = 0; i < 2000; ++i)
+				{
+					const Vec3 origin(position(rng), position(rng), position(rng));
+
+					// Aim every other ray at a triangle vertex to exercise shared edges
+					Vec3 direction;
+					if (i % 2 == 0)
+						direction = mesh.A[triangle(rng)] - origin;
+					else
+						direction = Vec3(normal(rng), normal(rng), normal(rng));
+					direction.Normalise();
+
+					assertSameResult(mesh, bruteForce, origin, direction, -1);
+					assertSameResult(mesh, bruteForce, origin, direction, triangle(rng));
+				}
+
+				// Axis aligned and grazing rays
+				const Vec3 origin(1.0, 1.0, 1.0);
+				for (const Vec3& direction : { Vec3(1.0, 0.0, 0.0), Vec3(0.0, -1.0, 0.0), Vec3(0.0, 0.0, 1.0), Vec3(1.0, 1.0, 1e-5).Normalised() })
+					assertSameResult(mesh, bruteForce, origin, direction, -1);
+			}
+		}
+
+		TEST_METHOD(PacketsMatchSingleRays)
+		{
+			std::mt19937 rng(11);
+			for (const int gridSize : { 3, 8 })
+			{
+				TriangleMeshSoA mesh = buildTestMesh(gridSize, 20 * gridSize, rng);
+				mesh.bvh.Build(mesh.A, mesh.edge1, mesh.edge2);
+
+				std::uniform_real_distribution<Real> position(0.1, 2.4);
+				for (const bool hemisphereOnly : { false, true })
+				{
+					RayPencil packetPencil(3000, hemisphereOnly);
+					RayPencil singlePencil(3000, hemisphereOnly);
+					singlePencil.setPacketTracing(false);
+
+					const int numRays = packetPencil.getNumRays();
+					Vec<> distances(numRays), cosines(numRays), expectedDistances(numRays), expectedCosines(numRays);
+					Vec<int> front(numRays), back(numRays), expectedFront(numRays), expectedBack(numRays);
+					for (int i = 0; i < 10; ++i)
+					{
+						// Include an origin on a z-fighting face
+						const Vec3 origin = i == 0 ? Vec3(0.0, 1.0, 1.0) : Vec3(position(rng), position(rng), position(rng));
+						packetPencil.moveOrigin(origin);
+						singlePencil.moveOrigin(origin);
+						packetPencil.traceAll(mesh);
+						singlePencil.traceAll(mesh);
+
+						packetPencil.getIndices(front, back);
+						packetPencil.getDistances(distances);
+						packetPencil.getCosines(cosines);
+						singlePencil.getIndices(expectedFront, expectedBack);
+						singlePencil.getDistances(expectedDistances);
+						singlePencil.getCosines(expectedCosines);
+						for (int j = 0; j < numRays; ++j)
+						{
+							Assert::AreEqual(expectedFront(j), front(j), L"Incorrect front patch");
+							Assert::AreEqual(expectedBack(j), back(j), L"Incorrect back patch");
+							Assert::AreEqual(std::isnan(expectedDistances(j)), std::isnan(distances(j)), L"Incorrect front hit");
+							if (!std::isnan(expectedDistances(j)))
+							{
+								Assert::AreEqual(expectedDistances(j), distances(j), L"Incorrect front distance");
+								Assert::AreEqual(expectedCosines(j), cosines(j), L"Incorrect front cosine");
+							}
+						}
+					}
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,215 @@
+#include "CppUnitTest.h"
+#include "UtilityFunctions.h"
+
+#include "Common/Definitions.h"
+#include "Common/Vec3.h"
+
+#include "Spatialiser/Room.h"
+#include "Spatialiser/WallBVH.h"
+
+#include <random>
+#include <unordered_set>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+namespace RAC
+{
+	using namespace Spatialiser;
+
+	TEST_CLASS(WallBVHTests)
+	{
+		// Build a shoebox room (2 triangles per face) with a partition wall at x = 1
+		void buildTestRoom(Room& testRoom)
+		{
+			const Real x = 2.0, y = 3.0, z = 2.5;
+			std::vector<Vertices> faces = {
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, 0.0), Vec3(x, y, 0.0) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(x, 0.0, 0.0) },	// Floor
+				{ Vec3(0.0, 0.0, z), Vec3(x, y, z), Vec3(0.0, y, z) }, { Vec3(0.0, 0.0, z), Vec3(x, 0.0, z), Vec3(x, y, z) },				// Ceiling
+				{ Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, z), Vec3(0.0, y, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(0.0, y, z), Vec3(0.0, y, 0.0) },	// x = 0
+				{ Vec3(x, 0.0, 0.0), Vec3(x, y, z), Vec3(x, 0.0, z) }, { Vec3(x, 0.0, 0.0), Vec3(x, y, 0.0), Vec3(x, y, z) },				// x = x
+				{ Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, z), Vec3(0.0, 0.0, z) }, { Vec3(0.0, 0.0, 0.0), Vec3(x, 0.0, 0.0), Vec3(x, 0.0, z) },	// y = 0
+				{ Vec3(0.0, y, 0.0), Vec3(0.0, y, z), Vec3(x, y, z) }, { Vec3(0.0, y, 0.0), Vec3(x, y, z), Vec3(x, y, 0.0) },				// y = y
+				{ Vec3(1.0, 1.0, 0.5), Vec3(1.0, 2.0, 0.5), Vec3(1.0, 1.5, 2.0) }															// Partition
+			};
+
+			Coefficients<> testAbsorption = Coefficients<>::Constant(1, 0.5);
+			for (const Vertices& face : faces)
+			{
+				size_t materialID = testRoom.InitMaterial(testAbsorption);
+				Wall testWall(face, materialID);
+				testRoom.AddWall(testWall);
+			}
+		}
+
+		// Brute force obstruction test (matches the original ImageEdge::LineRoomObstruction)
+		bool bruteForceObstruction(const PlaneMap& planes, const WallMap& walls, const Vec3& start, const Vec3& end, const std::unordered_set<size_t>& excludedPlaneIds)
+		{
+			for (const auto& [planeID, plane] : planes)
+			{
+				if (excludedPlaneIds.find(planeID) != excludedPlaneIds.end())
+					continue;
+				if (!plane.LinePlaneObstruction(start, end))
+					continue;
+				for (const size_t wallID : plane.GetWalls())
+				{
+					if (walls.at(wallID).LineWallObstruction(start, end))
+						return true;
+				}
+			}
+			return false;
+		}
+
+	public:
+		TEST_METHOD(Obstruction)
+		{
+			Room testRoom(1);
+			buildTestRoom(testRoom);
+
+			PlaneMap planes = testRoom.GetPlanes();
+			WallMap walls = testRoom.GetWalls();
+			WallBVH bvh;
+			bvh.Build(planes, walls);
+			Assert::AreEqual(static_cast<size_t>(13), bvh.Size(), L"Incorrect number of walls");
+
+			// Line crosses the partition
+			Vec3 start(0.5, 1.5, 1.0);
+			Vec3 end(1.5, 1.5, 1.0);
+			Assert::IsTrue(bvh.AnyHit(start, end), L"Partition does not obstruct line");
+
+			// Line passes below the partition
+			start = Vec3(0.5, 1.5, 0.2);
+			end = Vec3(1.5, 1.5, 0.2);
+			Assert::IsFalse(bvh.AnyHit(start, end), L"Line below partition is obstructed");
+
+			// Line ends on a wall (not obstructed)
+			start = Vec3(0.5, 1.5, 1.0);
+			end = Vec3(0.5, 1.5, 0.0);
+			Assert::IsFalse(bvh.AnyHit(start, end), L"Line ending on wall is obstructed");
+
+			// Excluding the partition plane
+			start = Vec3(0.5, 1.5, 1.0);
+			end = Vec3(1.5, 1.5, 1.0);
+			size_t partitionPlane = walls.at(12).GetPlaneID();
+			Assert::IsFalse(bvh.AnyHit(start, end, { partitionPlane }), L"Excluded plane obstructs line");
+		}
+
+		TEST_METHOD(ObstructionMatchesBruteForce)
+		{
+			Room testRoom(1);
+			buildTestRoom(testRoom);
+
+			PlaneMap planes = testRoom.GetPlanes();
+			WallMap walls = testRoom.GetWalls();
+			WallBVH bvh;
+			bvh.Build(planes, walls);
+
+			std::mt19937 rng(42);
+			std::uniform_real_distribution<Real> dist(-1.0, 4.0);
+			for (int i = 0; i < 1000; ++i)
+			{
+				Vec3 start(dist(rng), dist(rng), dist(rng));
+				Vec3 end(dist(rng), dist(rng), dist(rng));
+				std::unordered_set<size_t> excluded;
+				const size_t excludedPlane = walls.at(static_cast<size_t>(i % walls.size())).GetPlaneID();
+				if (i % 2 == 0)
+					excluded.insert(excludedPlane);
+
+				bool expected = bruteForceObstruction(planes, walls, start, end, excluded);
+				bool actual = i % 2 == 0 ? bvh.AnyHit(start, end, { excludedPlane }) : bvh.AnyHit(start, end);
+				std::string error = "Obstruction mismatch for line " + ToStr(i);
+				std::wstring werror = std::wstring(error.begin(), error.end());
+				Assert::AreEqual(expected, actual, werror.c_str());
+			}
+		}
+
+		TEST_METHOD(ClosestHit)
+		{
+			Room testRoom(1);
+			buildTestRoom(testRoom);
+
+			PlaneMap planes = testRoom.GetPlanes();
+			WallMap walls = testRoom.GetWalls();
+			WallBVH bvh;
+			bvh.Build(planes, walls);
+
+			// Closest hit from inside the room towards the ceiling and through the partition
+			Vec3 start(0.5, 1.5, 1.0);
+			Vec3 end(3.0, 1.5, 1.0);
+			WallBVH::Hit hit;
+			Assert::IsTrue(bvh.ClosestHit(start, end, {}, hit), L"No intersection found");
+			Assert::AreEqual(static_cast<size_t>(12), hit.wallID, L"Closest wall is not the partition");
+			Assert::AreEqual(1.0, hit.intersection.x(), EPS, L"Incorrect intersection");
+			Assert::AreEqual(0.2, hit.t, EPS, L"Incorrect intersection position");
+
+			// Excluding the partition plane returns the far wall
+			size_t partitionPlane = walls.at(12).GetPlaneID();
+			Assert::IsTrue(bvh.ClosestHit(start, end, { partitionPlane }, hit), L"No intersection found");
+			Assert::AreEqual(walls.at(6).GetPlaneID(), hit.planeID, L"Closest wall is not the far wall");
+			Assert::AreEqual(2.0, hit.intersection.x(), EPS, L"Incorrect intersection");
+
+			// Restricting the query to a single plane matches Wall::LineWallIntersection
+			start = Vec3(0.5, 1.0, 1.0);
+			end = Vec3(0.5, 2.0, -1.0);
+			size_t floorPlane = walls.at(0).GetPlaneID();
+			Assert::IsTrue(bvh.ClosestHitInPlane(start, end, floorPlane, hit), L"No floor intersection found");
+
+			Vec3 expected;
+			bool valid = false;
+			for (const size_t wallID : planes.at(floorPlane).GetWalls())
+			{
+				if (walls.at(wallID).LineWallIntersection(start, end, expected))
+				{
+					valid = true;
+					Assert::AreEqual(wallID, hit.wallID, L"Incorrect floor wall");
+					break;
+				}
+			}
+			Assert::IsTrue(valid, L"Brute force found no floor intersection");
+			Assert::IsTrue(expected == hit.intersection, L"Incorrect floor intersection");
+		}
+
+		TEST_METHOD(ClosestHitInPlaneMatchesBruteForce)
+		{
+			Room testRoom(1);
+			buildTestRoom(testRoom);
+
+			PlaneMap planes = testRoom.GetPlanes();
+			WallMap walls = testRoom.GetWalls();
+			WallBVH bvh;
+			bvh.Build(planes, walls);
+
+			std::mt19937 rng(7);
+			std::uniform_real_distribution<Real> dist(-1.0, 4.0);
+			for (int i = 0; i < 1000; ++i)
+			{
+				Vec3 start(dist(rng), dist(rng), dist(rng));
+				Vec3 end(dist(rng), dist(rng), dist(rng));
+				for (const auto& [planeID, plane] : planes)
+				{
+					// The first wall added to the plane wins ties
+					size_t expectedWall = 0;
+					Vec3 intersection;
+					bool expected = false;
+					if (plane.LinePlaneIntersection(start, end))
+					{
+						for (const size_t wallID : plane.GetWalls())
+						{
+							if (walls.at(wallID).LineWallIntersection(start, end, intersection))
+							{
+								expectedWall = wallID;
+								expected = true;
+								break;
+							}
+						}
+					}
+
+					WallBVH::Hit hit;
+					std::string error = "Plane intersection mismatch for line " + ToStr(i);
+					std::wstring werror = std::wstring(error.begin(), error.end());
+					Assert::AreEqual(expected, bvh.ClosestHitInPlane(start, end, planeID, hit), werror.c_str());
+					if (expected)
+						Assert::AreEqual(expectedWall, hit.wallID, werror.c_str());
+				}
+			}
+		}
+	};
+}